@@ -65,15 +65,29 @@ extern NSString * const kaccuracy;
 @property (atomic, readwrite) NSString*         tsUrl;
 /**
  *  Timelines reported by TV as available for synchronisation. Each timeline object is a TimelineOption instance. 
+ *  Assigning this property re-indexes the timelines for timelineLookUp:; replace the array rather than
+ *  mutating it in place.
  */
 @property (atomic, readwrite) NSMutableArray*   timelines;
 
+/**
+ *  The timelines, indexed by lowercase timeline selector
+ */
+@property (atomic, readonly) NSDictionary*      timelinesBySelector;
+
 //------------------------------------------------------------------------------
 
 //------------------------------------------------------------------------------
 #pragma mark - Initialiser
 //------------------------------------------------------------------------------
 
+/**
+ *  Initialise an empty CII object, with no fields set and no timelines
+ *
+ *  @return CII instance
+ */
+- (id) init;
+
 /**
  *  Initialise a CII object with JSON string
  *
@@ -89,7 +103,7 @@ extern NSString * const kaccuracy;
 
 /**
  *  Search for a timeline in the available timelines
- * included in the CII message
+ * included in the CII message. Selectors are compared case-insensitively.
  *
  *  @param timelineSel timeline selector string
  *
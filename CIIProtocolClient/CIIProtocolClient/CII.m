@@ -48,26 +48,40 @@ NSString * const kaccuracy                      = @"accuracy";
 {
     
 }
+@synthesize timelines = _timelines;
+@synthesize timelinesBySelector = _timelinesBySelector;
 
 //------------------------------------------------------------------------------
 #pragma mark - Initialiser, lifecycle methods
 //------------------------------------------------------------------------------
-- (id) initWithJSONString:(NSString*) json
+- (id) init
 {
     self = [super init];
     
-    
     if (self != nil)
     {
         _timelines = [[NSMutableArray alloc] init];
+        _timelinesBySelector = [NSDictionary dictionary];
+    }
+    return self;
+}
+
+//------------------------------------------------------------------------------
+
+- (id) initWithJSONString:(NSString*) json
+{
+    self = [self init];
+    
     
+    if (self != nil)
+    {
         NSData *jsonData = [json dataUsingEncoding:NSUTF8StringEncoding];
         NSError *e=nil;
         
         // parse JSON
         NSDictionary *jsonDict = [NSJSONSerialization JSONObjectWithData:jsonData options:0 error:&e];
         
-        if (e) {
+        if (e || ![jsonDict isKindOfClass:[NSDictionary class]]) {
             MWLogError(@"Error parsing CII message: %@", e);
             
             return nil;
@@ -84,26 +98,18 @@ NSString * const kaccuracy                      = @"accuracy";
         
         
         
-        if (timelines_array)
+        if ([timelines_array isKindOfClass:[NSArray class]])
         {
-            [_timelines removeAllObjects];
+            NSMutableArray *timelines = [[NSMutableArray alloc] initWithCapacity:timelines_array.count];
             
             for (NSDictionary *dict in timelines_array)
             {
-                TimelineOption *timeOpt = [[TimelineOption alloc] init];
-                timeOpt.timelineSelector = [dict objectForKey:ktimelineSelector];
+                TimelineOption *timeOpt = [TimelineOption TimelineOptionWithDictionary:dict];
                 
-                NSDictionary* timelinePropertiesDict = [dict objectForKey:ktimelineProperties];
-                if (timelinePropertiesDict) {
-                    TimelineProperties *props = [[TimelineProperties alloc] init];
-                    props.unitsPerTick = [timelinePropertiesDict objectForKey:kunitsPerTick];
-                    props.unitsPerSecond = [timelinePropertiesDict objectForKey:kunitsPerSecond];
-                    props.accuracy = [timelinePropertiesDict objectForKey:kaccuracy];
-                    
-                    timeOpt.timelineProperties = props;
-                }
-                [_timelines addObject:timeOpt];
+                if (timeOpt)
+                    [timelines addObject:timeOpt];
             }
+            self.timelines = timelines;
         }
     }
     
@@ -120,10 +126,50 @@ NSString * const kaccuracy                      = @"accuracy";
     _presentationStatus = nil;
     _wcUrl = nil;
     _tsUrl = nil;
-    [_timelines removeAllObjects];
     _timelines = nil;
+    _timelinesBySelector = nil;
+
+}
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+#pragma mark - Getters and setters
+//------------------------------------------------------------------------------
+
+- (NSMutableArray*) timelines
+{
+    @synchronized(self) {
+        return _timelines;
+    }
+}
+
+//------------------------------------------------------------------------------
 
+- (void) setTimelines:(NSMutableArray*) timelines
+{
+    NSMutableDictionary *index = [[NSMutableDictionary alloc] initWithCapacity:timelines.count];
+    
+    for (TimelineOption *timelineOpt in timelines)
+    {
+        if (timelineOpt.timelineSelector)
+            [index setObject:timelineOpt forKey:[timelineOpt.timelineSelector lowercaseString]];
+    }
+    
+    @synchronized(self) {
+        _timelines = timelines;
+        _timelinesBySelector = index;
+    }
 }
+
+//------------------------------------------------------------------------------
+
+- (NSDictionary*) timelinesBySelector
+{
+    @synchronized(self) {
+        return _timelinesBySelector;
+    }
+}
+
 //------------------------------------------------------------------------------
 
 //------------------------------------------------------------------------------
@@ -132,14 +178,10 @@ NSString * const kaccuracy                      = @"accuracy";
 
 - (TimelineOption*) timelineLookUp:(NSString*) timelineSel
 {
-    for (id timeline in self.timelines) {
-        
-        TimelineOption *timelineOpt = (TimelineOption*) timeline;
-        
-        if ([timelineOpt.timelineSelector caseInsensitiveCompare:timelineSel])
-            return timelineOpt;
-    }
-    return nil;
+    if (![timelineSel isKindOfClass:[NSString class]])
+        return nil;
+    
+    return [self.timelinesBySelector objectForKey:[timelineSel lowercaseString]];
 }
 
 //------------------------------------------------------------------------------
@@ -21,27 +21,7 @@
 #import <Foundation/Foundation.h>
 #import <SocketRocketiOS/SocketRocketiOS.h>
 #import "CII.h"
-
-//------------------------------------------------------------------------------
-#pragma mark - Data Structures
-//------------------------------------------------------------------------------
-
-/**
- *  CII status bitmask
- */
-typedef enum: NSUInteger
-{
-    NewCIIReceived              = (1 << 0),
-    MRSUrlChanged               = (1 << 1),
-    ContentIdChanged            = (1 << 2),
-    ContentIdStatusChanged      = (1 << 3),
-    PresentationStatusChanged   = (1 << 4),
-    WCSUrlChanged               = (1 << 5),
-    TSSUrlChanged               = (1 << 6),
-    TimelineSelectorChanged     = (1 << 7),
-    TimelinesChanged            = (1 << 8),
-}CIIChangeStatus;
-
+#import "CIIState.h"
 
 //------------------------------------------------------------------------------
 #pragma mark - Notifications
@@ -64,9 +44,10 @@ extern NSString * const kCIIChangeStatusMask;
  *  to make a websocket connection with the CII protocol server running on the TV.
  *  
  *  CII messages when received are classified as a new unseen message (the first CII message from a newly discovered TV) 
- *  or as an update. Events are produced to notify observers about a new CII or the field(s) that were updated in the CII
- *  message. The events report changes to the CII state by sending a copy of the CII object and a CIIChangeStatus bitmask
- *  for identifying the fields in the state that were changed in the last CII protocol message.
+ *  or as an update. Updates are applied to the CII state as patches (see CIIState). Events are produced to notify
+ *  observers about a new CII or the field(s) that were updated in the CII message. The events report changes to the
+ *  CII state by sending a copy of the CII object and a CIIChangeStatus bitmask for identifying the fields in the state
+ *  that were changed in the last CII protocol message.
  *
  *  Please note that this CII Protocol Client implementation acts an endpoint to only one CII server. i.e. only
  *  one CII object is maintained.
@@ -34,6 +34,7 @@ NSString * const kCIIChangeStatusMask           = @"CIICIIChangeStatusMask";
 @implementation CIIClient
 {
     SRWebSocket *webSocket;
+    CIIState    *ciiState;
 }
 @synthesize devinfo = _devinfo;
 
@@ -52,6 +53,7 @@ NSString * const kCIIChangeStatusMask           = @"CIICIIChangeStatusMask";
         _ciiUrl = _devinfo.ciiURL;
         
         _ciiInstance = nil;
+        ciiState = [[CIIState alloc] init];
     }
 
     return self;
@@ -72,7 +74,7 @@ NSString * const kCIIChangeStatusMask           = @"CIICIIChangeStatusMask";
         _devinfo = [SyncKitGlobals getInstance];
         _ciiUrl = cii_url;
         
-        
+        ciiState = [[CIIState alloc] init];
     }
     return self;
     
@@ -153,133 +155,19 @@ NSString * const kCIIChangeStatusMask           = @"CIICIIChangeStatusMask";
     
     if ([message isKindOfClass:[NSString class]])
     {
-        //parse our JSON string
         MWLogDebug(@"CIIClient: received a cii message: %@", message);
-//        MWLogDebug(@"CIIClient: received a cii message.");
-        
-         NSMutableDictionary *dictionary = [[NSMutableDictionary alloc] init];
-        
-        CII* anotherCiiInstance = [[CII alloc] initWithJSONString:message];
         
-        if (!self.ciiInstance) {
-            ciiClientStatus |= NewCIIReceived;
-            self.ciiInstance = anotherCiiInstance;
-            
-        }else
-        {
-            if (anotherCiiInstance)
-            {
-                // check if field was included in message
-                
-                if (anotherCiiInstance.msrUrl) {
-                 
-                    if (self.ciiInstance.msrUrl == nil)
-                    {
-                        self.ciiInstance.msrUrl = anotherCiiInstance.msrUrl;
-                        ciiClientStatus |= MRSUrlChanged;
-                        
-                    }else if([self hasStringFieldValueChanged:self.ciiInstance.msrUrl New:anotherCiiInstance.msrUrl])
-                    {
-                        self.ciiInstance.msrUrl = anotherCiiInstance.msrUrl;
-                        ciiClientStatus |= MRSUrlChanged;
-                    }
-                } // end if (anotherCiiInstance.msrUrl)
-                
-                // content Id
-                if (anotherCiiInstance.contentId) {
-                    
-                    if (self.ciiInstance.contentId == nil)
-                    {
-                        self.ciiInstance.contentId = anotherCiiInstance.contentId;
-                        ciiClientStatus |= ContentIdChanged;
-                        
-                    }else if([self hasStringFieldValueChanged:self.ciiInstance.contentId New:anotherCiiInstance.contentId])
-                    {
-                        self.ciiInstance.contentId = anotherCiiInstance.contentId;
-                        ciiClientStatus |= ContentIdChanged;
-                    }
-                } // end if (anotherCiiInstance.contentId)
-
-                
-                // contentIdStatus
-                if (anotherCiiInstance.contentIdStatus) {
-                    
-                    if (self.ciiInstance.contentIdStatus == nil)
-                    {
-                        self.ciiInstance.contentIdStatus = anotherCiiInstance.contentIdStatus;
-                        ciiClientStatus |= ContentIdStatusChanged;
-                        
-                    }else if([self hasStringFieldValueChanged:self.ciiInstance.contentIdStatus New:anotherCiiInstance.contentIdStatus])
-                    {
-                        self.ciiInstance.contentIdStatus = anotherCiiInstance.contentIdStatus;
-                        ciiClientStatus |= ContentIdStatusChanged;
-                    }
-                } // end if (anotherCiiInstance.contentIdStatus)
-                
-                               
-                // presentationStatus
-                if (anotherCiiInstance.presentationStatus) {
-                    if (self.ciiInstance.presentationStatus == nil)
-                    {
-                        self.ciiInstance.presentationStatus = anotherCiiInstance.presentationStatus;
-                        ciiClientStatus |= PresentationStatusChanged;
-                        
-                    }else if([self hasStringFieldValueChanged:self.ciiInstance.presentationStatus New:anotherCiiInstance.presentationStatus])
-                    {
-                        self.ciiInstance.presentationStatus = anotherCiiInstance.presentationStatus;
-                        ciiClientStatus |= PresentationStatusChanged;
-                    }
-                } // end if (anotherCiiInstance.presentationStatus)
-                
-                // wcUrl
-                if (anotherCiiInstance.wcUrl) {
-                    if (self.ciiInstance.wcUrl == nil)
-                    {
-                        self.ciiInstance.wcUrl = anotherCiiInstance.wcUrl;
-                        ciiClientStatus |= WCSUrlChanged;
-                        
-                    }else if([self hasStringFieldValueChanged:self.ciiInstance.wcUrl New:anotherCiiInstance.wcUrl])
-                    {
-                        self.ciiInstance.wcUrl = anotherCiiInstance.wcUrl;
-                        ciiClientStatus |= WCSUrlChanged;
-                    }
-                } // end if (anotherCiiInstance.wcUrl)
-                
-                
-                // tsUrl
-                if (anotherCiiInstance.tsUrl) {
-                    if (self.ciiInstance.tsUrl == nil)
-                    {
-                        self.ciiInstance.tsUrl = anotherCiiInstance.tsUrl;
-                        ciiClientStatus |= TSSUrlChanged;
-                        
-                    }else if([self hasStringFieldValueChanged:self.ciiInstance.tsUrl New:anotherCiiInstance.tsUrl])
-                    {
-                        self.ciiInstance.tsUrl = anotherCiiInstance.tsUrl;
-                        ciiClientStatus |= TSSUrlChanged;
-                    }
-                } // end if (anotherCiiInstance.tsUrl)
-                
-                
-                // timelines
-                if (anotherCiiInstance.timelines){
-                    if (![self.ciiInstance.timelines isEqualToArray:anotherCiiInstance.timelines]){
-                        
-                        ciiClientStatus |= TimelinesChanged | TimelineSelectorChanged;
-                        [self.ciiInstance.timelines removeAllObjects];
-                        self.ciiInstance.timelines = nil;
-                        self.ciiInstance.timelines = anotherCiiInstance.timelines;
-                    }
-                }
-                
-            }
-        }
+        // apply the message as a patch; the change mask is worked out as it is applied
+        ciiClientStatus = [ciiState applyMessage:message];
         
         if (ciiClientStatus!=0){
+            self.ciiInstance = ciiState.cii;
+            
             // inform listeners about new CII information
-            [dictionary setObject:self.ciiInstance forKey:kCIIDidChange];
-            [dictionary setObject:[NSNumber numberWithUnsignedInteger:ciiClientStatus] forKey:kCIIChangeStatusMask];
-            [[NSNotificationCenter defaultCenter] postNotificationName:kCIIDidChange object:nil userInfo:dictionary];
+            [[NSNotificationCenter defaultCenter] postNotificationName:kCIIDidChange
+                                                                object:nil
+                                                              userInfo:@{kCIIDidChange : self.ciiInstance,
+                                                                         kCIIChangeStatusMask : @(ciiClientStatus)}];
         }
         
         
@@ -290,37 +178,6 @@ NSString * const kCIIChangeStatusMask           = @"CIICIIChangeStatusMask";
 }
 
 
-- (BOOL) hasStringFieldValueChanged:(NSString*) origStr
-                                New:(NSString*) newStr
-{
-    NSNull *nullObject = [NSNull null];
-    
-    // check if both mrsURL fields are not NSNull
-    if (origStr!=newStr)
-    {
-        if ((origStr == nullObject) ||
-            (newStr == nullObject))
-        {
-           // one of them is NSNULL
-            return true;
-        }
-        
-        if ((origStr != nullObject) &&
-            (newStr != nullObject))
-        {
-            if ([origStr caseInsensitiveCompare:newStr] !=NSOrderedSame){
-                return true;
-            }
-        }
-    }
-    // else ciiInstance.msrUrl and anotherCiiInstance.msrUrl both point to NSNull singleton object.
-    
-    
-    return NO;
-    
-}
-
-
 #pragma mark notify methods
 
 /*
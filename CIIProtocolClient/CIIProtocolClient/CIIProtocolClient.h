@@ -31,5 +31,6 @@ FOUNDATION_EXPORT const unsigned char CIIProtocolClientVersionString[];
 
 #import <CIIProtocolClient/CIIClient.h>
 #import <CIIProtocolClient/CII.h>
+#import <CIIProtocolClient/CIIState.h>
 #import <CIIProtocolClient/TimelineOption.h>
 #import <CIIProtocolClient/TimelineProperties.h>
\ No newline at end of file
@@ -0,0 +1,92 @@
+//
+//  CIIState.h
+//  CIIProtocolClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+#import "CII.h"
+
+//------------------------------------------------------------------------------
+#pragma mark - Data Structures
+//------------------------------------------------------------------------------
+
+/**
+ *  CII status bitmask
+ */
+typedef enum: NSUInteger
+{
+    NewCIIReceived              = (1 << 0),
+    MRSUrlChanged               = (1 << 1),
+    ContentIdChanged            = (1 << 2),
+    ContentIdStatusChanged      = (1 << 3),
+    PresentationStatusChanged   = (1 << 4),
+    WCSUrlChanged               = (1 << 5),
+    TSSUrlChanged               = (1 << 6),
+    TimelineSelectorChanged     = (1 << 7),
+    TimelinesChanged            = (1 << 8),
+}CIIChangeStatus;
+
+
+//------------------------------------------------------------------------------
+#pragma mark - CIIState
+//------------------------------------------------------------------------------
+
+/**
+ *  The CII state received from a CII server. CII messages are applied as patches: only the
+ *  properties present in a message are changed, and a property with a null value is set to NSNull.
+ *  The CIIChangeStatus bitmask is worked out while the message's properties are applied, so a
+ *  message is walked once and no second CII object is built to compare against.
+ *
+ *  The first message applied creates the CII object and is reported as NewCIIReceived only.
+ *  Later messages update the same CII object in place. String properties are compared
+ *  case-insensitively. Timelines are compared by selector and timeline properties, regardless
+ *  of their order in the message.
+ */
+@interface CIIState : NSObject
+
+/**
+ *  The current CII state, or nil if no message has been applied yet
+ */
+@property (nonatomic, readonly) CII* cii;
+
+/**
+ *  Apply a CII message received from the server
+ *
+ *  @param json a CII message
+ *
+ *  @return a CIIChangeStatus bitmask of the fields changed by this message; 0 if nothing changed
+ *          or the message could not be parsed
+ */
+- (CIIChangeStatus) applyMessage:(NSString*) json;
+
+/**
+ *  Apply a parsed CII message
+ *
+ *  @param patch CII properties, as parsed from a CII message's JSON object
+ *
+ *  @return a CIIChangeStatus bitmask of the fields changed by this message; 0 if nothing changed
+ */
+- (CIIChangeStatus) applyPatch:(NSDictionary*) patch;
+
+/**
+ *  Forget the CII state. The next message applied is reported as NewCIIReceived.
+ */
+- (void) reset;
+
+@end
@@ -0,0 +1,241 @@
+//
+//  CIIState.m
+//  CIIProtocolClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <SimpleLogger/SimpleLogger.h>
+#import "CIIState.h"
+
+//------------------------------------------------------------------------------
+#pragma mark - helpers
+//------------------------------------------------------------------------------
+
+/**
+ *  Whether a string property (an NSString or NSNull) takes a new value
+ */
+static BOOL stringFieldChanged(id current, id value)
+{
+    if (current == value)
+        return NO;  // includes both being the NSNull singleton
+
+    if ((current == nil) ||
+        (![current isKindOfClass:[NSString class]]) ||
+        (![value isKindOfClass:[NSString class]]))
+        return YES;
+
+    return ([current caseInsensitiveCompare:value] != NSOrderedSame);
+}
+
+//------------------------------------------------------------------------------
+
+static BOOL numberFieldChanged(NSNumber *current, NSNumber *value)
+{
+    if (current == value)
+        return NO;
+
+    return ((current == nil) || (value == nil) || ![current isEqual:value]);
+}
+
+//------------------------------------------------------------------------------
+
+static BOOL timelinePropertiesChanged(TimelineProperties *current, TimelineProperties *value)
+{
+    if (current == value)
+        return NO;
+
+    return (numberFieldChanged(current.unitsPerTick, value.unitsPerTick) ||
+            numberFieldChanged(current.unitsPerSecond, value.unitsPerSecond) ||
+            numberFieldChanged(current.accuracy, value.accuracy));
+}
+
+
+//------------------------------------------------------------------------------
+#pragma mark - CIIState implementation
+//------------------------------------------------------------------------------
+
+@implementation CIIState
+{
+    NSLock *lock;
+}
+
+//------------------------------------------------------------------------------
+#pragma mark - Initialiser, lifecycle methods
+//------------------------------------------------------------------------------
+
+- (id) init
+{
+    self = [super init];
+    if (self != nil) {
+        lock = [[NSLock alloc] init];
+        _cii = nil;
+    }
+    return self;
+}
+
+//------------------------------------------------------------------------------
+#pragma mark - private methods
+//------------------------------------------------------------------------------
+
+/**
+ *  Replace the timelines if the message's timelines differ from the current ones. The
+ *  new array and its index are built in the same pass as the comparison.
+ */
+- (CIIChangeStatus) patchTimelines:(id) value
+{
+    NSArray *entries = [value isKindOfClass:[NSArray class]] ? value : nil;
+    NSMutableArray *timelines = [[NSMutableArray alloc] initWithCapacity:entries.count];
+    BOOL changed = NO;
+
+    if ((value != [NSNull null]) && (entries == nil)) {
+        MWLogWarning(@"CIIState: ignoring timelines property that is not an array");
+        return 0;
+    }
+
+    for (NSDictionary *dict in entries)
+    {
+        TimelineOption *timeOpt = [TimelineOption TimelineOptionWithDictionary:dict];
+
+        if (!timeOpt) continue;
+
+        if (!changed)
+        {
+            TimelineOption *current = [_cii timelineLookUp:timeOpt.timelineSelector];
+
+            changed = (current == nil) || timelinePropertiesChanged(current.timelineProperties, timeOpt.timelineProperties);
+        }
+        [timelines addObject:timeOpt];
+    }
+
+    // a timeline may have been withdrawn
+    if (timelines.count != _cii.timelines.count)
+        changed = YES;
+
+    if (!changed)
+        return 0;
+
+    _cii.timelines = timelines;
+
+    return TimelinesChanged | TimelineSelectorChanged;
+}
+
+//------------------------------------------------------------------------------
+#pragma mark - public methods
+//------------------------------------------------------------------------------
+
+- (CIIChangeStatus) applyMessage:(NSString*) json
+{
+    NSData *jsonData = [json dataUsingEncoding:NSUTF8StringEncoding];
+    NSError *e = nil;
+    id patch;
+
+    if (!jsonData)
+        return 0;
+
+    patch = [NSJSONSerialization JSONObjectWithData:jsonData options:0 error:&e];
+
+    if (e || ![patch isKindOfClass:[NSDictionary class]]) {
+        MWLogError(@"CIIState: error parsing CII message: %@", e);
+        return 0;
+    }
+
+    return [self applyPatch:patch];
+}
+
+//------------------------------------------------------------------------------
+
+- (CIIChangeStatus) applyPatch:(NSDictionary*) patch
+{
+    __block CIIChangeStatus status = 0;
+    BOOL first;
+
+    if (![patch isKindOfClass:[NSDictionary class]])
+        return 0;
+
+    [lock lock];
+
+    first = (_cii == nil);
+    if (first)
+        _cii = [[CII alloc] init];
+
+    // one pass over the properties present in the message
+    [patch enumerateKeysAndObjectsUsingBlock:^(NSString *key, id value, BOOL *stop) {
+
+        if ([key isEqualToString:ktimelines]) {
+            status |= [self patchTimelines:value];
+            return;
+        }
+
+        if (![value isKindOfClass:[NSString class]] && (value != [NSNull null])) {
+            MWLogWarning(@"CIIState: ignoring property %@ with a value that is not a string", key);
+            return;
+        }
+
+        if ([key isEqualToString:kcontentId]) {
+            if (stringFieldChanged(_cii.contentId, value)) {
+                _cii.contentId = value;
+                status |= ContentIdChanged;
+            }
+        }else if ([key isEqualToString:kcontentIdStatus]) {
+            if (stringFieldChanged(_cii.contentIdStatus, value)) {
+                _cii.contentIdStatus = value;
+                status |= ContentIdStatusChanged;
+            }
+        }else if ([key isEqualToString:kpresentationStatus]) {
+            if (stringFieldChanged(_cii.presentationStatus, value)) {
+                _cii.presentationStatus = value;
+                status |= PresentationStatusChanged;
+            }
+        }else if ([key isEqualToString:kMRSUrl]) {
+            if (stringFieldChanged(_cii.msrUrl, value)) {
+                _cii.msrUrl = value;
+                status |= MRSUrlChanged;
+            }
+        }else if ([key isEqualToString:kwcUrl]) {
+            if (stringFieldChanged(_cii.wcUrl, value)) {
+                _cii.wcUrl = value;
+                status |= WCSUrlChanged;
+            }
+        }else if ([key isEqualToString:ktsUrl]) {
+            if (stringFieldChanged(_cii.tsUrl, value)) {
+                _cii.tsUrl = value;
+                status |= TSSUrlChanged;
+            }
+        }else if ([key isEqualToString:kprotocolVersion]) {
+            _cii.protocolVersion = value;
+        }
+    }];
+
+    [lock unlock];
+
+    // the first CII is reported as new, not as a set of changes
+    return first ? NewCIIReceived : status;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) reset
+{
+    [lock lock];
+    _cii = nil;
+    [lock unlock];
+}
+
+//------------------------------------------------------------------------------
+
+@end
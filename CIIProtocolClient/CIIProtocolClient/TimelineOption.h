@@ -39,6 +39,15 @@
                             UnitsPerSecond:(int) units_sec
                                   Accuracy:(int) accuracy;
 
+/**
+ *  Creates a TimelineOption instance from a timeline entry of a CII message
+ *
+ *  @param dict a parsed JSON object with timelineSelector and timelineProperties members
+ *
+ *  @return a TimelineOption instance, or nil if the entry has no timeline selector
+ */
++(instancetype) TimelineOptionWithDictionary:(NSDictionary*) dict;
+
 /**
  *  Initialiser
  *
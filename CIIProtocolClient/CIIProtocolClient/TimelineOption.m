@@ -7,6 +7,7 @@
 //
 
 #import "TimelineOption.h"
+#import "CII.h"
 
 @implementation TimelineOption
 
@@ -24,6 +25,32 @@
                                            Accuracy:accuracy];
 }
 
++(instancetype) TimelineOptionWithDictionary:(NSDictionary*) dict
+{
+    TimelineOption *timeOpt;
+    NSDictionary *propsDict;
+    
+    if (![dict isKindOfClass:[NSDictionary class]])
+        return nil;
+    
+    if (![[dict objectForKey:ktimelineSelector] isKindOfClass:[NSString class]])
+        return nil;
+    
+    timeOpt = [[TimelineOption alloc] init];
+    timeOpt.timelineSelector = [dict objectForKey:ktimelineSelector];
+    
+    propsDict = [dict objectForKey:ktimelineProperties];
+    if ([propsDict isKindOfClass:[NSDictionary class]]) {
+        TimelineProperties *props = [[TimelineProperties alloc] init];
+        props.unitsPerTick = [propsDict objectForKey:kunitsPerTick];
+        props.unitsPerSecond = [propsDict objectForKey:kunitsPerSecond];
+        props.accuracy = [propsDict objectForKey:kaccuracy];
+        
+        timeOpt.timelineProperties = props;
+    }
+    return timeOpt;
+}
+
 - (id) init: (NSString*) timeline_select Options:(TimelineProperties*) timeline_props{
     
     if ((self = [super init])) {
@@ -0,0 +1,98 @@
+//
+//  CIIStateTests.m
+//  CIIProtocolClientTests
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+#import <CIIProtocolClient/CIIProtocolClient.h>
+
+@interface CIIStateTests : XCTestCase
+
+@end
+
+@implementation CIIStateTests
+
+
+- (CIIState*) stateWithFirstMessage
+{
+    CIIState *state = [[CIIState alloc] init];
+
+    CIIChangeStatus status = [state applyMessage:@"{\"protocolVersion\":\"1.1\",\"contentId\":\"dvb://233a.1004.1044\",\"contentIdStatus\":\"final\",\"presentationStatus\":\"okay\",\"wcUrl\":\"udp://192.168.1.5:6677\",\"tsUrl\":\"ws://192.168.1.5:7681/ts\",\"timelines\":[{\"timelineSelector\":\"urn:dvb:css:timeline:pts\",\"timelineProperties\":{\"unitsPerTick\":1,\"unitsPerSecond\":90000}},{\"timelineSelector\":\"urn:dvb:css:timeline:temi:1:1\",\"timelineProperties\":{\"unitsPerTick\":1,\"unitsPerSecond\":1000}}]}"];
+
+    XCTAssertEqual(status, NewCIIReceived, @"the first CII is only reported as new");
+
+    return state;
+}
+
+
+- (void)testFirstMessageCreatesState {
+    CIIState *state = [self stateWithFirstMessage];
+
+    XCTAssertEqualObjects(state.cii.contentId, @"dvb://233a.1004.1044");
+    XCTAssertEqual(state.cii.timelines.count, 2);
+    XCTAssertEqualObjects([state.cii timelineLookUp:@"URN:DVB:CSS:TIMELINE:PTS"].timelineProperties.unitsPerSecond, @90000);
+    XCTAssertNil([state.cii timelineLookUp:@"urn:dvb:css:timeline:temi:1:2"]);
+}
+
+
+- (void)testPartialUpdateOnlyChangesFieldsPresent {
+    CIIState *state = [self stateWithFirstMessage];
+    CII *cii = state.cii;
+
+    CIIChangeStatus status = [state applyMessage:@"{\"contentId\":\"dvb://233a.1004.1080\",\"presentationStatus\":\"OKAY\"}"];
+
+    XCTAssertEqual(status, ContentIdChanged, @"presentationStatus differs only in case");
+    XCTAssertEqual(state.cii, cii, @"the CII is patched in place");
+    XCTAssertEqualObjects(cii.contentId, @"dvb://233a.1004.1080");
+    XCTAssertEqualObjects(cii.tsUrl, @"ws://192.168.1.5:7681/ts");
+    XCTAssertEqual(cii.timelines.count, 2, @"timelines omitted from an update are kept");
+
+    XCTAssertEqual([state applyMessage:@"{\"contentId\":\"dvb://233a.1004.1080\"}"], 0);
+}
+
+
+- (void)testNullValues {
+    CIIState *state = [self stateWithFirstMessage];
+
+    XCTAssertEqual([state applyMessage:@"{\"tsUrl\":null,\"mrsUrl\":null}"], TSSUrlChanged | MRSUrlChanged);
+    XCTAssertEqualObjects(state.cii.tsUrl, [NSNull null]);
+    XCTAssertEqual([state applyMessage:@"{\"tsUrl\":null}"], 0);
+}
+
+
+- (void)testTimelineChanges {
+    CIIState *state = [self stateWithFirstMessage];
+
+    // same timelines, other order
+    XCTAssertEqual([state applyMessage:@"{\"timelines\":[{\"timelineSelector\":\"urn:dvb:css:timeline:temi:1:1\",\"timelineProperties\":{\"unitsPerTick\":1,\"unitsPerSecond\":1000}},{\"timelineSelector\":\"urn:dvb:css:timeline:pts\",\"timelineProperties\":{\"unitsPerTick\":1,\"unitsPerSecond\":90000}}]}"], 0);
+
+    // a timeline withdrawn
+    XCTAssertEqual([state applyMessage:@"{\"timelines\":[{\"timelineSelector\":\"urn:dvb:css:timeline:pts\",\"timelineProperties\":{\"unitsPerTick\":1,\"unitsPerSecond\":90000}}]}"], TimelinesChanged | TimelineSelectorChanged);
+    XCTAssertNil([state.cii timelineLookUp:@"urn:dvb:css:timeline:temi:1:1"]);
+
+    // a timeline's properties changed
+    XCTAssertEqual([state applyMessage:@"{\"timelines\":[{\"timelineSelector\":\"urn:dvb:css:timeline:pts\",\"timelineProperties\":{\"unitsPerTick\":2,\"unitsPerSecond\":90000}}]}"], TimelinesChanged | TimelineSelectorChanged);
+    XCTAssertEqualObjects([state.cii timelineLookUp:@"urn:dvb:css:timeline:pts"].timelineProperties.unitsPerTick, @2);
+}
+
+
+- (void)testMalformedMessagesAreIgnored {
+    CIIState *state = [[CIIState alloc] init];
+
+    XCTAssertEqual([state applyMessage:@"not json"], 0);
+    XCTAssertEqual([state applyMessage:@"[1, 2]"], 0);
+    XCTAssertNil(state.cii);
+
+    state = [self stateWithFirstMessage];
+    XCTAssertEqual([state applyMessage:@"{\"contentId\":42}"], 0);
+    XCTAssertEqualObjects(state.cii.contentId, @"dvb://233a.1004.1044");
+
+    [state reset];
+    XCTAssertEqual([state applyMessage:@"{\"contentId\":\"dvb://1\"}"], NewCIIReceived);
+}
+
+@end
@@ -377,6 +377,161 @@ static IMP __originalTimeMethod_Imp;
 
 
 
+-(void) testCachedPathFollowsCorrelationChange
+{
+    CorrelatedClock *a1, *a2, *b1;
+    NSError *error;
+    
+    timenow = 5020.80f;
+    
+    // our clock hierarchy
+    SystemClock *a = [[SystemClock alloc] initWithTickRate:1000000];
+    
+    Correlation corel_a1 = [CorrelationFactory create:50 Correlation:0];
+    a1 = [[CorrelatedClock alloc] initWithParentClock:a TickRate:100 Correlation:&corel_a1];
+    
+    Correlation corel_a2 = [CorrelationFactory create:28 Correlation:999];
+    a2 = [[CorrelatedClock alloc] initWithParentClock:a1 TickRate:78 Correlation:&corel_a2];
+    
+    Correlation corel_b1 = [CorrelationFactory create:10 Correlation:20];
+    b1 = [[CorrelatedClock alloc] initWithParentClock:a TickRate:1000 Correlation:&corel_b1];
+    
+    // resolve and cache the path
+    XCTAssertEqual([a2 toOtherClock:b1 Ticks:500 WithError:&error], [b1 fromParentTicks:[a1 toParentTicks:[a2 toParentTicks:500]]]);
+    XCTAssertNil(error);
+    
+    // change a clock in the middle of the path
+    a1.correlation = [CorrelationFactory create:1000 Correlation:7];
+    XCTAssertEqual([a2 toOtherClock:b1 Ticks:500 WithError:&error], [b1 fromParentTicks:[a1 toParentTicks:[a2 toParentTicks:500]]]);
+    XCTAssertNil(error);
+    
+    // change the target clock
+    b1.correlation = [CorrelationFactory create:-30 Correlation:12345];
+    XCTAssertEqual([a2 toOtherClock:b1 Ticks:500 WithError:&error], [b1 fromParentTicks:[a1 toParentTicks:[a2 toParentTicks:500]]]);
+    XCTAssertNil(error);
+    
+    // change tick rate and speed of the source clock
+    a2.tickRate = 25;
+    a2.speed = 2.0;
+    XCTAssertEqual([a2 toOtherClock:b1 Ticks:500 WithError:&error], [b1 fromParentTicks:[a1 toParentTicks:[a2 toParentTicks:500]]]);
+    XCTAssertNil(error);
+    
+    // freeze a clock on the path
+    a1.speed = 0.0;
+    XCTAssertEqual([a2 toOtherClock:b1 Ticks:500 WithError:&error], [b1 fromParentTicks:[a1 toParentTicks:[a2 toParentTicks:500]]]);
+    XCTAssertNil(error);
+}
+
+
+-(void) testCachedPathFollowsTunableClockAdjustment
+{
+    CorrelatedClock *c1;
+    NSError *error;
+    
+    timenow = 5020.80f;
+    
+    // our clock hierarchy
+    SystemClock *a = [[SystemClock alloc] initWithTickRate:1000000];
+    TunableClock *wallclock = [[TunableClock alloc] initWithParentClock:a TickRate:1000000000 Ticks:0];
+    
+    Correlation corel_c1 = [CorrelationFactory create:0 Correlation:0];
+    c1 = [[CorrelatedClock alloc] initWithParentClock:wallclock TickRate:90000 Correlation:&corel_c1];
+    
+    XCTAssertEqual([c1 toOtherClock:a Ticks:900000 WithError:&error], [wallclock toParentTicks:[c1 toParentTicks:900000]]);
+    XCTAssertNil(error);
+    
+    // adjust the wall clock, as the WallClock algorithm does
+    [wallclock adjustTimeNanos:-1500000];
+    XCTAssertEqual([c1 toOtherClock:a Ticks:900000 WithError:&error], [wallclock toParentTicks:[c1 toParentTicks:900000]]);
+    XCTAssertNil(error);
+    
+    wallclock.slew = 100000;
+    XCTAssertEqual([c1 toOtherClock:a Ticks:900000 WithError:&error], [wallclock toParentTicks:[c1 toParentTicks:900000]]);
+    XCTAssertNil(error);
+}
+
+
+-(void) testExactConversionAtLargeTickValues
+{
+    // our clock hierarchy: nanosecond and microsecond timelines with tick values beyond 2^53
+    SystemClock *a = [[SystemClock alloc] initWithTickRate:1000000000];
+    
+    Correlation corel_a1 = [CorrelationFactory create:0 Correlation:0];
+    CorrelatedClock *a1 = [[CorrelatedClock alloc] initWithParentClock:a TickRate:1000000000 Correlation:&corel_a1];
+    
+    Correlation corel_a2 = [CorrelationFactory create:3 Correlation:7];
+    CorrelatedClock *a2 = [[CorrelatedClock alloc] initWithParentClock:a1 TickRate:1000000 Correlation:&corel_a2];
+    
+    int64_t ticks = (1LL << 60) + 1;
+    
+    XCTAssertEqual([a1 toParentTicks:ticks], ticks);
+    XCTAssertEqual([a1 fromParentTicks:ticks], ticks);
+    
+    // microseconds to nanoseconds and back is exact
+    int64_t us = (1LL << 52) + 12345;
+    XCTAssertEqual([a2 toParentTicks:us], 3 + (us - 7) * 1000);
+    XCTAssertEqual([a2 fromParentTicks:[a2 toParentTicks:us]], us);
+    
+    // a speed that is not a power of two
+    a2.speed = 1.5;
+    XCTAssertEqual([a2 toParentTicks:7 + 3 * 1000000003LL], 3 + 2000000006000LL);
+    XCTAssertEqual([a2 fromParentTicks:[a2 toParentTicks:us]], us);
+}
+
+
+-(void) testBatchConversionMatchesScalar
+{
+    CorrelatedClock *a1, *a2, *b1;
+    NSError *error;
+    const NSUInteger count = 1000;
+    int64_t ticks[count], results[count];
+    
+    timenow = 5020.80f;
+    
+    // our clock hierarchy
+    SystemClock *a = [[SystemClock alloc] initWithTickRate:1000000];
+    TunableClock *wallclock = [[TunableClock alloc] initWithParentClock:a TickRate:1000000000 Ticks:0];
+    
+    Correlation corel_a1 = [CorrelationFactory create:50 Correlation:0];
+    a1 = [[CorrelatedClock alloc] initWithParentClock:wallclock TickRate:100 Correlation:&corel_a1];
+    
+    Correlation corel_a2 = [CorrelationFactory create:28 Correlation:999];
+    a2 = [[CorrelatedClock alloc] initWithParentClock:a1 TickRate:78 Correlation:&corel_a2];
+    
+    Correlation corel_b1 = [CorrelationFactory create:10 Correlation:20];
+    b1 = [[CorrelatedClock alloc] initWithParentClock:wallclock TickRate:90000 Correlation:&corel_b1];
+    
+    a2.speed = 1.5;
+    wallclock.slew = 100000;
+    
+    for (NSUInteger i = 0; i < count; i++)
+        ticks[i] = ((int64_t) i - 500) * 7919;
+    
+    NSArray *targets = @[a, wallclock, a1, a2, b1];
+    for (ClockBase *target in targets) {
+        XCTAssertTrue([a2 toOtherClock:target Ticks:ticks Results:results Count:count WithError:&error]);
+        XCTAssertNil(error);
+        
+        for (NSUInteger i = 0; i < count; i++)
+            XCTAssertEqual(results[i], [a2 toOtherClock:target Ticks:ticks[i] WithError:&error]);
+    }
+    
+    // in place, through a frozen clock
+    a1.speed = 0.0;
+    int64_t expected = [a2 toOtherClock:b1 Ticks:ticks[1] WithError:&error];
+    XCTAssertTrue([a2 toOtherClock:b1 Ticks:ticks Results:ticks Count:count WithError:&error]);
+    XCTAssertEqual(ticks[1], expected);
+    XCTAssertEqual(ticks[count - 1], expected);
+    
+    // no common ancestor: results untouched
+    SystemClock *other = [[SystemClock alloc] initWithTickRate:1000000];
+    results[0] = 42;
+    XCTAssertFalse([a2 toOtherClock:other Ticks:ticks Results:results Count:count WithError:&error]);
+    XCTAssertEqual(error.code, NoCommonAncestorClockError);
+    XCTAssertEqual(results[0], 42);
+}
+
+
 // ------------------- utility methods ---------------
 Float64 ClockHierarchyTickConversions_mocktime(id self, SEL _cmd)
 {
@@ -21,6 +21,8 @@
 
 #import <Foundation/Foundation.h>
 #import "ClockProtocol.h"
+#import "TickRatio.h"
+#import "ClockChangeListener.h"
 
 #define MSDesignatedInitializer(__SEL__) __attribute__((unavailable("Invoke the designated initializer `" # __SEL__ "` instead.")))
 
@@ -34,6 +36,155 @@ enum ClockError{
     
 };
 
+/**
+ *  The form of a single parent/child tick conversion step. See `TickTransform`.
+ */
+typedef NS_ENUM(uint8_t, TickTransformType){
+    
+    /** conversion cannot be expressed as a TickTransform; the clock's own conversion method must be called */
+    TickTransformUnresolved = 0,
+    
+    /** result is always `base` e.g. a clock with zero speed */
+    TickTransformConstant,
+    
+    /** base + (((ticks - origin) / divisor) * multiplier) / speed */
+    TickTransformToParent,
+    
+    /** base + (((ticks - origin) * multiplier) * speed) / divisor */
+    TickTransformFromParentScaled,
+    
+    /** base + (((ticks - origin) / divisor) * multiplier) * speed */
+    TickTransformFromParentDivided
+};
+
+/**
+ *  Struct describing a clock's tick conversion to/from its parent clock's timescale as an
+ *  affine map. The scale factor is held both as an exact ratio, used whenever the tick rates and
+ *  speed can be represented in it, and as floating point values in the operation order of the
+ *  original floating point conversion.
+ */
+typedef struct _tickTransform{
+    
+    // form of the conversion
+    TickTransformType type;
+    
+    // tick value subtracted from the input
+    int64_t origin;
+    
+    // tick value added to the scaled elapsed ticks
+    int64_t base;
+    
+    Float64 divisor;
+    
+    Float64 multiplier;
+    
+    Float64 speed;
+    
+    // exact scale factor applied to (ticks - origin); invalid if the float path must be used
+    TickRatio ratio;
+    
+}TickTransform;
+
+
+/**
+ *  Struct holding the parameters that relate a clock's timescale to its parent's: a correlation
+ *  point (parentTicks, ticks), a tick rate and a speed. A clock's parameters are published with a
+ *  sequence lock so that readers always see a consistent set of values without taking a lock.
+ */
+typedef struct _clockParameters{
+    
+    // parent clock tick value at the correlation point
+    int64_t     parentTicks;
+    
+    // this clock's tick value at the correlation point
+    int64_t     ticks;
+    
+    // this clock's tick rate in ticks per second
+    uint64_t    tickRate;
+    
+    // this clock's speed relative to its parent
+    float       speed;
+    
+}ClockParameters;
+
+
+/**
+ *  Make a tick transform, computing its exact ratio.
+ *
+ *  @param type       form of the conversion; must not be TickTransformConstant or TickTransformUnresolved
+ *  @param origin     tick value subtracted from the input
+ *  @param base       tick value added to the scaled elapsed ticks
+ *  @param divisor    tick rate dividing the elapsed ticks
+ *  @param multiplier tick rate multiplying the elapsed ticks
+ *  @param speed      clock speed
+ *
+ *  @return a TickTransform
+ */
+static inline TickTransform TickTransformMake(TickTransformType type, int64_t origin, int64_t base,
+                                              uint64_t divisor, uint64_t multiplier, float speed)
+{
+    TickRatio speedRatio = TickRatioFromSpeed(speed);
+    
+    return (TickTransform){
+        .type       = type,
+        .origin     = origin,
+        .base       = base,
+        .divisor    = divisor,
+        .multiplier = multiplier,
+        .speed      = speed,
+        .ratio      = (type == TickTransformToParent) ? TickRatioDivided(multiplier, speedRatio, divisor)
+                                                      : TickRatioScaled(multiplier, speedRatio, divisor)
+    };
+}
+
+
+/**
+ *  Apply a tick transform to a tick value using floating point arithmetic. This is the
+ *  conversion clocks used before exact ratios were introduced; it loses precision once tick
+ *  values exceed the 53-bit mantissa of a Float64.
+ *
+ *  @param t     a TickTransform of type other than TickTransformUnresolved
+ *  @param ticks tick value to convert
+ *
+ *  @return converted tick value
+ */
+static inline int64_t TickTransformApplyFloat(const TickTransform *t, int64_t ticks)
+{
+    Float64 elapsed = (Float64) (ticks - t->origin);
+    
+    switch (t->type) {
+        case TickTransformToParent:
+            return t->base + ((elapsed / t->divisor) * t->multiplier) / t->speed;
+        case TickTransformFromParentScaled:
+            return t->base + ((elapsed * t->multiplier) * t->speed) / t->divisor;
+        case TickTransformFromParentDivided:
+            return t->base + ((elapsed / t->divisor) * t->multiplier) * t->speed;
+        default:
+            return t->base;
+    }
+}
+
+
+/**
+ *  Apply a tick transform to a tick value. Uses exact 128-bit integer arithmetic if the
+ *  transform has a valid ratio, otherwise falls back to `TickTransformApplyFloat`.
+ *
+ *  @param t     a TickTransform of type other than TickTransformUnresolved
+ *  @param ticks tick value to convert
+ *
+ *  @return converted tick value
+ */
+static inline int64_t TickTransformApply(const TickTransform *t, int64_t ticks)
+{
+    if (t->type == TickTransformConstant)
+        return t->base;
+    
+    if (TickRatioIsValid(t->ratio))
+        return TickRatioApply(t->base, ticks - t->origin, &t->ratio);
+    
+    return TickTransformApplyFloat(t, ticks);
+}
+
 /**
  A base class for all clock objects. New clock classes must subclass the ClockBase class.
  */
@@ -84,6 +235,24 @@ enum ClockError{
  */
 @property (nonatomic, readwrite) int64_t errorTicksFrom;
 
+/**
+ *  A counter incremented every time a property affecting this clock's tick conversions (e.g. parent,
+ *  tickRate, speed, correlation) changes. Used to detect stale conversion paths.
+ */
+@property (nonatomic, readonly) uint64_t changeGeneration;
+
+/**
+ *  The product of the speed properties of this clock and all of its parents up to the root clock. Cached, and
+ *  updated when the speed of this clock or of any of its ancestors changes. Key-value observable.
+ */
+@property (nonatomic, readonly) float effectiveSpeed;
+
+/**
+ *  The rate at which this clock ticks with respect to the root clock's timescale, in ticks per second:
+ *  tickRate multiplied by effectiveSpeed. Cached like effectiveSpeed. Key-value observable.
+ */
+@property (nonatomic, readonly) Float64 effectiveTickRate;
+
 
 
 
@@ -137,8 +306,83 @@ enum ClockError{
  */
 - (int64_t) fromParentTicks:(int64_t) ticks;
 
+/**
+ *  Tick value of this clock at a given host time, e.g. the time at which the kernel received a
+ *  packet. The host time is converted by the root (system) clock and then down the hierarchy
+ *  with `fromParentTicks:`.
+ *
+ *  @param units host absolute time, in host time units (see `MonotonicTime absoluteTimeUnits`)
+ *
+ *  @return tick value of this clock at that host time
+ */
+- (int64_t) ticksAtHostTime:(uint64_t) units;
+
+/**
+ *  Read a consistent snapshot of this clock's parameters. Lock-free: if a writer is updating the
+ *  parameters at the same time, the read is retried.
+ *
+ *  @return a copy of this clock's parameters
+ */
+- (ClockParameters) parameters;
+
+
+/**
+ *  Begin an update of this clock's parameters. For use by subclasses only. Waits for any other
+ *  writer to finish and returns a pointer to the parameters, which may be modified in place until
+ *  `endParametersUpdate` is called. Readers will retry until the update ends, so keep updates short
+ *  and do not call other methods of this clock in between.
+ *
+ *  @return pointer to this clock's parameters
+ */
+- (ClockParameters*) beginParametersUpdate;
+
+
+/**
+ *  Publish an update of this clock's parameters started with `beginParametersUpdate`.
+ */
+- (void) endParametersUpdate;
+
+
+/**
+ *  Describe this clock's `toParentTicks:` conversion as a TickTransform. The default implementation
+ *  returns a transform of type TickTransformUnresolved.
+ *
+ *  @return a TickTransform equivalent to `toParentTicks:` for the current state of this clock and its parent
+ */
+- (TickTransform) toParentTransform;
+
+
+/**
+ *  Describe this clock's `fromParentTicks:` conversion as a TickTransform. The default implementation
+ *  returns a transform of type TickTransformUnresolved.
+ *
+ *  @return a TickTransform equivalent to `fromParentTicks:` for the current state of this clock and its parent
+ */
+- (TickTransform) fromParentTransform;
+
+
+/**
+ *  Return `toParentTransform`, built again only when this clock's parameters, its parent or its
+ *  parent's tick rate have changed since it was last built. Use this in conversion methods.
+ *
+ *  @return a TickTransform equivalent to `toParentTicks:` for the current state of this clock and its parent
+ */
+- (TickTransform) cachedToParentTransform;
+
+
+/**
+ *  Return `fromParentTransform`, built again only when this clock's parameters, its parent or its
+ *  parent's tick rate have changed since it was last built. Use this in conversion methods.
+ *
+ *  @return a TickTransform equivalent to `fromParentTicks:` for the current state of this clock and its parent
+ */
+- (TickTransform) cachedFromParentTransform;
+
+
 /**
  *  Converts a tick value for this clock into a tick value corresponding to the timescale of another clock.
+ *  The path between the two clocks is resolved once and cached (see `ClockConversionPath`); it is resolved
+ *  again when a clock on the path changes its parent, tickRate, speed or correlation.
  *
  *  @param otherClock A ClockBase object representing another clock.
  *  @param ticks      A time (tick value) for this clock
@@ -151,6 +395,28 @@ enum ClockError{
                     Ticks:(int64_t) ticks
                 WithError:(NSError**) error;
 
+
+/**
+ *  Converts an array of tick values for this clock into tick values corresponding to the timescale of another
+ *  clock. The conversion path is resolved once for the whole array, and each step of the path is applied to
+ *  all values before moving on to the next. Results are identical to calling `toOtherClock:Ticks:WithError:`
+ *  for each value.
+ *
+ *  @param otherClock A ClockBase object representing another clock.
+ *  @param ticks      Array of `count` tick values for this clock
+ *  @param results    Array of `count` elements to receive the tick values of `otherClock`. May be the same array as `ticks`.
+ *  @param count      Number of tick values to convert
+ *  @param error      A pointer to an NSError pointer parameter
+ *
+ *  @return YES if the values were converted; NO if the clocks have no common ancestor, in which case `error` is
+ *  set and `results` is left unchanged.
+ */
+- (BOOL) toOtherClock:(ClockBase*) otherClock
+                Ticks:(const int64_t*) ticks
+              Results:(int64_t*) results
+                Count:(NSUInteger) count
+            WithError:(NSError**) error;
+
 /**
  *  measure this clock's precision
  *
@@ -172,6 +438,16 @@ enum ClockError{
 
 
 
+/**
+ *  Names of the properties whose changes affect this clock's tick conversions. A clock observes these
+ *  properties on itself to maintain `changeGeneration`. Subclasses adding conversion parameters
+ *  should extend the array returned by the superclass.
+ *
+ *  @return array of property names
+ */
++ (NSArray*) tickTransformKeys;
+
+
 /**
  *  Add an observer for clock state changes. Uses IOS's Key-Value-Coding mechanism.
  *
@@ -190,5 +466,47 @@ enum ClockError{
 - (void) removeObserver:(id) observer Context: (void*) context;
 
 
+/**
+ *  Register a listener to be called when this clock changes. Listeners are not retained and are
+ *  called on the thread that changed the clock, in the order they were added. A listener that is
+ *  deallocated is dropped from the list; it does not need to remove itself. Listeners may be added
+ *  and removed from any thread, including from within a listener call.
+ *
+ *  @param listener object to notify of clock changes
+ */
+- (void) addChangeListener:(id<ClockChangeListener>) listener;
+
+
+/**
+ *  Unregister a listener added with `addChangeListener:`.
+ *
+ *  @param listener the listener to remove
+ */
+- (void) removeChangeListener:(id<ClockChangeListener>) listener;
+
+
+/**
+ *  Start a group of changes to this clock. Change listeners are not called until the matching
+ *  `endChanges`, which delivers all the changes made in between as a single notification.
+ *  Calls may be nested. Key-value observers are still notified of each change as it happens.
+ */
+- (void) beginChanges;
+
+
+/**
+ *  End a group of changes started with `beginChanges`.
+ */
+- (void) endChanges;
+
+
+/**
+ *  Record a change to this clock for its change listeners. Called by clock property setters;
+ *  listeners are notified immediately unless a group of changes is in progress.
+ *
+ *  @param changes the kinds of change made
+ */
+- (void) notifyChanges:(ClockChangeFlags) changes;
+
+
 @end
 
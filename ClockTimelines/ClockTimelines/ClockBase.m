@@ -20,11 +20,41 @@
 //  limitations under the License.
 
 #import "ClockBase.h"
+#import "ClockConversionPath.h"
+#include <stdatomic.h>
+#include <pthread.h>
 
 
+/**
+ *  A tick transform and the state it was built from: the sequence number of the clock's parameters,
+ *  the clock's change generation (which covers a change of parent) and the parent's tick rate.
+ *  The entry is published with its own sequence lock; it is written by whichever reader rebuilds it.
+ */
+typedef struct _tickTransformCache{
+    
+    // odd while the entry is being written
+    _Atomic(uint32_t) sequence;
+    
+    uint32_t    paramsSequence;
+    uint64_t    generation;
+    uint64_t    parentTickRate;
+    TickTransform transform;
+    
+}TickTransformCache;
+
 
 @interface ClockBase()
 
+/**
+ *  Recompute effectiveSpeed and effectiveTickRate, notifying observers if they changed.
+ */
+- (void) updateEffectiveRates;
+
+/**
+ *  Return the transform held in a cache entry, rebuilding the entry if it is stale.
+ */
+- (TickTransform) transformFromCache:(TickTransformCache*) cache
+                            ToParent:(BOOL) toParent;
 
 @end
 
@@ -32,11 +62,40 @@ NSString * const ClockErrorDomain           = @"IOS.DVB.CSS.Clock.ErrorDomain";
 NSString * const kClockDidChangeTickOffset  = @"ClockDidChangeTickOffset";
 NSString * const kClockDidChangeRate        = @"ClockDidChangeRate";
 
+
 @implementation ClockBase
+{
+    // cached conversion paths to other clocks, keyed (weakly) by the other clock; guarded by conversionPathsMutex
+    NSMapTable *conversionPaths;
+    pthread_mutex_t conversionPathsMutex;
+    
+    // incremented when one of our conversion parameters changes
+    _Atomic(uint64_t) changeGeneration;
+    
+    // clock parameters and their sequence number; odd while an update is in progress
+    ClockParameters params;
+    _Atomic(uint32_t) paramsSequence;
+    
+    // change listeners (weak references), changes not yet delivered to them and beginChanges nesting depth;
+    // guarded by changeListenersMutex, since changes arrive from other threads (e.g. a WallClock client's)
+    NSPointerArray *changeListeners;
+    ClockChangeFlags pendingChanges;
+    NSUInteger changeGroupDepth;
+    pthread_mutex_t changeListenersMutex;
+    
+    // toParentTransform and fromParentTransform, rebuilt when the state they depend on changes
+    TickTransformCache toParentCache;
+    TickTransformCache fromParentCache;
+}
 
-@synthesize speed = _speed;
 @synthesize available = _available;
 
+static void *ClockTransformContext = &ClockTransformContext;
+static void *ClockEffectiveRateContext = &ClockEffectiveRateContext;
+
+static NSString * const kEffectiveSpeedKey      = @"effectiveSpeed";
+static NSString * const kEffectiveTickRateKey   = @"effectiveTickRate";
+
 
 #pragma mark initialisation and description routines
 ///-----------------------------------------------------------
@@ -46,32 +105,176 @@ NSString * const kClockDidChangeRate        = @"ClockDidChangeRate";
 {
     self = [super init];
     if (self != nil) {
-        _speed = 1.0;
+        params.speed = 1.0;
+        atomic_init(&paramsSequence, 0);
+        atomic_init(&changeGeneration, 0);
+        pthread_mutex_init(&conversionPathsMutex, NULL);
+        pthread_mutex_init(&changeListenersMutex, NULL);
+        
+        // parameters are never published with an odd sequence number, so the empty entries never match
+        atomic_init(&toParentCache.sequence, 0);
+        toParentCache.paramsSequence = 1;
+        atomic_init(&fromParentCache.sequence, 0);
+        fromParentCache.paramsSequence = 1;
+        _effectiveSpeed = 1.0;
+        _effectiveTickRate = 0;
         _available = true;
         self.parent = nil;
+        
+        // track changes to our own conversion parameters
+        for (NSString *key in [[self class] tickTransformKeys]) {
+            [self addObserver:self forKeyPath:key options:0 context:ClockTransformContext];
+        }
     }
     
     return self;
 }
 
+- (void)dealloc
+{
+    for (NSString *key in [[self class] tickTransformKeys]) {
+        [self removeObserver:self forKeyPath:key context:ClockTransformContext];
+    }
+    
+    [_parent removeObserver:self forKeyPath:kEffectiveSpeedKey context:ClockEffectiveRateContext];
+    [_parent removeObserver:self forKeyPath:kEffectiveTickRateKey context:ClockEffectiveRateContext];
+    
+    pthread_mutex_destroy(&conversionPathsMutex);
+    pthread_mutex_destroy(&changeListenersMutex);
+}
+
+
++ (NSArray*) tickTransformKeys
+{
+    return @[@"parent", @"tickRate", @"speed"];
+}
+
 - (NSString *)description
 {
     return [NSString stringWithFormat:@"ClockBase description:\ntickRate:%llu speed: %f parent: %@",self.tickRate, self.speed, [self.parent description]];
 }
 
 
-- (float) getEffectiveSpeed
+#pragma mark clock parameters
+///-----------------------------------------------------------
+/// @name clock parameters
+///-----------------------------------------------------------
+- (ClockParameters) parameters
 {
-    ClockBase *clock;
-    float s = 1.0;
+    ClockParameters snapshot;
+    uint32_t seq1, seq2;
     
-    clock = self;
-    while (clock != nil) {
-        s = s * clock.speed;
-        clock = self.parent;
-    }
+    do {
+        seq1 = atomic_load_explicit(&paramsSequence, memory_order_acquire);
+        snapshot = params;
+        atomic_thread_fence(memory_order_acquire);
+        seq2 = atomic_load_explicit(&paramsSequence, memory_order_relaxed);
+    } while ((seq1 & 1) || (seq1 != seq2));
+    
+    return snapshot;
+}
+
+
+- (ClockParameters*) beginParametersUpdate
+{
+    uint32_t seq;
+    
+    // an odd sequence number means another writer holds the parameters
+    do {
+        seq = atomic_load_explicit(&paramsSequence, memory_order_relaxed);
+    } while ((seq & 1) ||
+             !atomic_compare_exchange_weak_explicit(&paramsSequence, &seq, seq + 1,
+                                                    memory_order_acquire, memory_order_relaxed));
+    
+    atomic_thread_fence(memory_order_release);
+    
+    return &params;
+}
+
+
+- (void) endParametersUpdate
+{
+    atomic_fetch_add_explicit(&paramsSequence, 1, memory_order_release);
+}
+
+
+- (uint64_t) tickRate
+{
+    return [self parameters].tickRate;
+}
+
+
+- (void) setTickRate:(uint64_t)tickRate
+{
+    ClockParameters *p = [self beginParametersUpdate];
+    p->tickRate = tickRate;
+    [self endParametersUpdate];
+    [self notifyChanges:ClockChangeTickRate];
+}
+
+
+- (float) speed
+{
+    return [self parameters].speed;
+}
+
+
+- (void) setSpeed:(float)speed
+{
+    ClockParameters *p = [self beginParametersUpdate];
+    p->speed = speed;
+    [self endParametersUpdate];
+    [self notifyChanges:ClockChangeSpeed];
+}
+
+
+- (void) setAvailable:(BOOL)available
+{
+    _available = available;
+    [self notifyChanges:ClockChangeAvailability];
+}
+
+
+- (void) setParent:(ClockBase *)parent
+{
+    if (parent == _parent)
+        return;
+    
+    // follow the effective speed of our new parent
+    [_parent removeObserver:self forKeyPath:kEffectiveSpeedKey context:ClockEffectiveRateContext];
+    [_parent removeObserver:self forKeyPath:kEffectiveTickRateKey context:ClockEffectiveRateContext];
+    
+    _parent = parent;
+    
+    [_parent addObserver:self forKeyPath:kEffectiveSpeedKey options:0 context:ClockEffectiveRateContext];
+    [_parent addObserver:self forKeyPath:kEffectiveTickRateKey options:0 context:ClockEffectiveRateContext];
+    
+    [self updateEffectiveRates];
+}
+
+
+- (float) getEffectiveSpeed
+{
+    return _effectiveSpeed;
+}
+
 
-    return s;
+- (void) updateEffectiveRates
+{
+    ClockParameters p = [self parameters];
+    float speed = p.speed * ((_parent != nil) ? _parent.effectiveSpeed : 1.0f);
+    Float64 tickRate = p.tickRate * (Float64) speed;
+    
+    if (speed == _effectiveSpeed && tickRate == _effectiveTickRate)
+        return;
+    
+    // our children observe these keys and update their own effective rates in turn
+    [self willChangeValueForKey:kEffectiveSpeedKey];
+    [self willChangeValueForKey:kEffectiveTickRateKey];
+    _effectiveSpeed = speed;
+    _effectiveTickRate = tickRate;
+    [self didChangeValueForKey:kEffectiveTickRateKey];
+    [self didChangeValueForKey:kEffectiveSpeedKey];
 }
 
 
@@ -109,11 +312,91 @@ NSString * const kClockDidChangeRate        = @"ClockDidChangeRate";
 }
 
 
+// root clocks override this method
+- (int64_t) ticksAtHostTime:(uint64_t) units
+{
+    if (self.parent == nil) {
+        [self doesNotRecognizeSelector:_cmd];
+        return 0;
+    }
+    return [self fromParentTicks:[self.parent ticksAtHostTime:units]];
+}
+
+
 -(int64_t)dispersionAtTime:(int64_t)timeInNanos{
     [self doesNotRecognizeSelector:_cmd];
     return 0;
 }
 
+// subclasses describe their conversions by overriding these methods
+- (TickTransform) toParentTransform
+{
+    return (TickTransform){ .type = TickTransformUnresolved };
+}
+
+- (TickTransform) fromParentTransform
+{
+    return (TickTransform){ .type = TickTransformUnresolved };
+}
+
+
+- (TickTransform) cachedToParentTransform
+{
+    return [self transformFromCache:&toParentCache ToParent:YES];
+}
+
+
+- (TickTransform) cachedFromParentTransform
+{
+    return [self transformFromCache:&fromParentCache ToParent:NO];
+}
+
+
+/**
+ *  Return the cached transform if it was built from the current state, otherwise build it and
+ *  publish it in the cache. The state is read before the transform is built, so a cache entry is
+ *  never older than the state it is tagged with; at worst it is rebuilt once more than needed.
+ */
+- (TickTransform) transformFromCache:(TickTransformCache*) cache
+                            ToParent:(BOOL) toParent
+{
+    uint32_t paramsSeq = atomic_load_explicit(&paramsSequence, memory_order_acquire);
+    uint64_t generation = atomic_load_explicit(&changeGeneration, memory_order_acquire);
+    uint64_t parentTickRate = (_parent != nil) ? _parent.tickRate : 0;
+    uint32_t seq1, seq2;
+    uint32_t entryParamsSeq;
+    uint64_t entryGeneration, entryParentTickRate;
+    TickTransform t;
+    
+    seq1 = atomic_load_explicit(&cache->sequence, memory_order_acquire);
+    entryParamsSeq = cache->paramsSequence;
+    entryGeneration = cache->generation;
+    entryParentTickRate = cache->parentTickRate;
+    t = cache->transform;
+    atomic_thread_fence(memory_order_acquire);
+    seq2 = atomic_load_explicit(&cache->sequence, memory_order_relaxed);
+    
+    if (!(seq1 & 1) && (seq1 == seq2) &&
+        (entryParamsSeq == paramsSeq) && (entryGeneration == generation) && (entryParentTickRate == parentTickRate))
+        return t;
+    
+    t = toParent ? [self toParentTransform] : [self fromParentTransform];
+    
+    // publish, unless the parameters were being updated or another thread is writing the entry
+    if (!(paramsSeq & 1) && !(seq1 & 1) &&
+        atomic_compare_exchange_strong_explicit(&cache->sequence, &seq1, seq1 + 1,
+                                                memory_order_acquire, memory_order_relaxed)) {
+        atomic_thread_fence(memory_order_release);
+        cache->paramsSequence = paramsSeq;
+        cache->generation = generation;
+        cache->parentTickRate = parentTickRate;
+        cache->transform = t;
+        atomic_store_explicit(&cache->sequence, seq1 + 2, memory_order_release);
+    }
+    
+    return t;
+}
+
 #pragma mark class  methods
 ///-----------------------------------------------------------
 /// @name class methods
@@ -122,80 +405,85 @@ NSString * const kClockDidChangeRate        = @"ClockDidChangeRate";
                     Ticks:(int64_t) ticks
                 WithError:(NSError**) error
 {
-    NSMutableOrderedSet* selfAncestry = [[NSMutableOrderedSet alloc] init];
-    NSMutableOrderedSet* oCLKAncestry = [[NSMutableOrderedSet alloc] init];
-    NSMutableOrderedSet* intersectionSet = [[NSMutableOrderedSet alloc] init];
-    
-    ClockBase *child;
-    int64_t i_ticks =  ticks;
+    int64_t result = 0;
     
-    // get ancestry of this clock
-    child = self;
-    while (child != nil) {
-        [selfAncestry addObject:child];
-        child = child.parent;
-    }
+    if (![[self conversionPathToClock:otherClock] convertTicks:ticks Result:&result])
+        [self noCommonAncestorError:error];
     
-    // get ancestry of other clock
-    child = otherClock;
-    while (child != nil) {
-        [oCLKAncestry addObject:child];
-        child = child.parent;
+    return result;
+}
+
+
+- (BOOL) toOtherClock:(ClockBase*) otherClock
+                Ticks:(const int64_t*) ticks
+              Results:(int64_t*) results
+                Count:(NSUInteger) count
+            WithError:(NSError**) error
+{
+    if (![[self conversionPathToClock:otherClock] convertTicks:ticks Results:results Count:count])
+    {
+        [self noCommonAncestorError:error];
+        return NO;
     }
     
-    // check if there is a common ancestor
-    BOOL common = false;
+    return YES;
+}
 
-    if ([selfAncestry count] > [oCLKAncestry count]){
-        intersectionSet = [NSMutableOrderedSet orderedSetWithOrderedSet:selfAncestry];
+
+/**
+ *  Set a NoCommonAncestorClockError error
+ */
+- (void) noCommonAncestorError:(NSError**) error
+{
+    if (error) {
+        NSDictionary *userInfo = @{NSLocalizedDescriptionKey: @"Could not find a common ancestor to both clocks."};
         
-        [intersectionSet intersectOrderedSet:oCLKAncestry];
-    }
-    else{
-        intersectionSet = [NSMutableOrderedSet orderedSetWithOrderedSet:oCLKAncestry];
-        [intersectionSet intersectOrderedSet:selfAncestry];
+        *error = [NSError errorWithDomain:ClockErrorDomain
+                                     code:NoCommonAncestorClockError
+                                 userInfo:userInfo];
     }
+}
+
+
+/**
+ *  Get the cached conversion path from this clock to another clock, creating it on first use. The
+ *  cache is shared by every thread converting from this clock, so it is only accessed under
+ *  conversionPathsMutex; the path returned is safe to use without it.
+ *
+ *  @param otherClock the clock to convert tick values to
+ *
+ *  @return a ClockConversionPath object, or nil if otherClock is nil
+ */
+- (ClockConversionPath*) conversionPathToClock:(ClockBase*) otherClock
+{
+    ClockConversionPath *path;
     
+    if (otherClock == nil)
+        return nil;
     
-    if ([intersectionSet count] > 0)
-    {
-        common = true;
-        
-        [selfAncestry minusOrderedSet:intersectionSet];
-        [oCLKAncestry minusOrderedSet:intersectionSet];
+    pthread_mutex_lock(&conversionPathsMutex);
     
-        
-        // now we have a path from both clocks to a common ancestor.
-        // note that the lists do NOT include the common ancestor itself
-            
-        // 1) walk the path to the common ancestor converting tick values
-        for (ClockBase* clk in selfAncestry) {
-            i_ticks = [clk toParentTicks:i_ticks];
-        }
-        
-        //2) walk the path back up from the common ancestor to the other clock, converting tick values
-        NSEnumerator *reverseEnum =  [oCLKAncestry reverseObjectEnumerator];
-        
-        ClockBase* c;
-        
-        while (c=[reverseEnum nextObject]) {
-            i_ticks = [c fromParentTicks:i_ticks];
-        }
-        
-        return i_ticks;
-        
-    }
-    else{
-       
-            NSDictionary *userInfo = @{NSLocalizedDescriptionKey: @"Could not find a common ancestor to both clocks."};
-            
-            *error = [NSError errorWithDomain:ClockErrorDomain
-                                         code:NoCommonAncestorClockError
-                                     userInfo:userInfo];
-       
-        return 0;
+    if (conversionPaths == nil)
+        conversionPaths = [NSMapTable weakToStrongObjectsMapTable];
+    
+    path = [conversionPaths objectForKey:otherClock];
+    
+    if (path == nil)
+    {
+        path = [[ClockConversionPath alloc] initWithSourceClock:self TargetClock:otherClock];
+        [conversionPaths setObject:path forKey:otherClock];
     }
     
+    pthread_mutex_unlock(&conversionPathsMutex);
+    
+    return path;
+}
+
+
+- (uint64_t) changeGeneration
+{
+    // acquire: a reader that sees a new generation also sees the parameters that changed before it
+    return atomic_load_explicit(&changeGeneration, memory_order_acquire);
 }
 
 
@@ -343,6 +631,137 @@ NSString * const kClockDidChangeRate        = @"ClockDidChangeRate";
 }
 
 
+#pragma mark Clock change listeners
+///-----------------------------------------------------------
+/// @name Clock change listeners
+///-----------------------------------------------------------
+
+- (void) addChangeListener:(id<ClockChangeListener>) listener
+{
+    pthread_mutex_lock(&changeListenersMutex);
+    
+    if (changeListeners == nil)
+        changeListeners = [NSPointerArray weakObjectsPointerArray];
+    
+    [self compactChangeListeners];
+    [changeListeners addPointer:(__bridge void *) listener];
+    
+    pthread_mutex_unlock(&changeListenersMutex);
+}
+
+
+/**
+ *  Remove the slots of listeners that have been deallocated. A listener's weak reference is
+ *  zeroed before its dealloc runs, so it cannot remove itself; its NULL slot is dropped here.
+ *  (NSPointerArray's -compact does not reliably remove zeroed weak references.)
+ *  Must be called with changeListenersMutex held.
+ */
+- (void) compactChangeListeners
+{
+    for (NSUInteger i = changeListeners.count; i > 0; i--) {
+        if ([changeListeners pointerAtIndex:i - 1] == NULL)
+            [changeListeners removePointerAtIndex:i - 1];
+    }
+}
+
+
+- (void) removeChangeListener:(id<ClockChangeListener>) listener
+{
+    pthread_mutex_lock(&changeListenersMutex);
+    
+    for (NSUInteger i = 0; i < changeListeners.count; i++) {
+        if ([changeListeners pointerAtIndex:i] == (__bridge void *) listener) {
+            [changeListeners removePointerAtIndex:i];
+            break;
+        }
+    }
+    
+    pthread_mutex_unlock(&changeListenersMutex);
+}
+
+
+- (void) beginChanges
+{
+    pthread_mutex_lock(&changeListenersMutex);
+    changeGroupDepth++;
+    pthread_mutex_unlock(&changeListenersMutex);
+}
+
+
+- (void) endChanges
+{
+    pthread_mutex_lock(&changeListenersMutex);
+    NSUInteger depth = changeGroupDepth;
+    
+    if (depth > 0)
+        changeGroupDepth--;
+    pthread_mutex_unlock(&changeListenersMutex);
+    
+    NSAssert(depth > 0, @"endChanges called without beginChanges");
+    
+    if (depth == 1)
+        [self deliverChanges];
+}
+
+
+- (void) notifyChanges:(ClockChangeFlags) changes
+{
+    pthread_mutex_lock(&changeListenersMutex);
+    pendingChanges |= changes;
+    BOOL deliver = (changeGroupDepth == 0);
+    pthread_mutex_unlock(&changeListenersMutex);
+    
+    if (deliver)
+        [self deliverChanges];
+}
+
+
+- (void) deliverChanges
+{
+    pthread_mutex_lock(&changeListenersMutex);
+    
+    ClockChangeFlags changes = pendingChanges;
+    
+    pendingChanges = 0;
+    
+    if (changes == 0) {
+        pthread_mutex_unlock(&changeListenersMutex);
+        return;
+    }
+    
+    [self compactChangeListeners];
+    
+    // listeners are called without the lock held, from a snapshot: they may add or remove
+    // listeners (themselves included), and the snapshot keeps them alive while being notified
+    NSArray *listeners = [changeListeners allObjects];
+    
+    pthread_mutex_unlock(&changeListenersMutex);
+    
+    // listeners run inside the property setter, before automatic KVO updates our effective rates
+    // (and, through them, our children's); bring them up to date first
+    if (changes & (ClockChangeSpeed | ClockChangeTickRate))
+        [self updateEffectiveRates];
+    
+    for (id<ClockChangeListener> listener in listeners) {
+        [listener clock:self didChange:changes];
+    }
+}
+
+
+- (void) observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context
+{
+    if (context == ClockTransformContext) {
+        // one of our conversion parameters changed; cached conversion paths through this clock are now stale
+        atomic_fetch_add_explicit(&changeGeneration, 1, memory_order_release);
+        [self updateEffectiveRates];
+    } else if (context == ClockEffectiveRateContext) {
+        [self updateEffectiveRates];
+    } else {
+        [super observeValueForKeyPath:keyPath ofObject:object change:change context:context];
+    }
+}
+
+
 
 
 
@@ -0,0 +1,64 @@
+//
+//  ClockChangeListener.h
+//  ClockTimelines
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+@class ClockBase;
+
+/**
+ *  Kinds of clock change reported to a ClockChangeListener. Several may be reported in one notification.
+ */
+typedef NS_OPTIONS(uint32_t, ClockChangeFlags){
+
+    /** the clock's tickRate changed (or its parent's, for a clock locked to its parent) */
+    ClockChangeTickRate     = 1 << 0,
+
+    /** the clock's speed changed (or its parent's) */
+    ClockChangeSpeed        = 1 << 1,
+
+    /** the clock's correlation changed (or its parent's) */
+    ClockChangeCorrelation  = 1 << 2,
+
+    /** the clock's availability changed */
+    ClockChangeAvailability = 1 << 3,
+
+    /** the clock's tick value was adjusted e.g. `TunableClock adjustTicks:`. Not propagated to child clocks. */
+    ClockChangeTicks        = 1 << 4
+};
+
+
+/**
+ *  A lightweight alternative to key-value observing of a clock. Listeners registered with
+ *  `ClockBase addChangeListener:` are called directly, with a bitmask of the kinds of change, and
+ *  without boxing old and new values. Changes made between `ClockBase beginChanges` and
+ *  `ClockBase endChanges` are delivered as one notification.
+ */
+@protocol ClockChangeListener <NSObject>
+
+/**
+ *  Called after a clock has changed. Read the clock's properties for its new state.
+ *
+ *  @param clock   the clock that changed
+ *  @param changes the kinds of change made since the last notification
+ */
+- (void) clock:(ClockBase*) clock didChange:(ClockChangeFlags) changes;
+
+@end
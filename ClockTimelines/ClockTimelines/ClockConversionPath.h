@@ -0,0 +1,96 @@
+//
+//  ClockConversionPath.h
+//  ClockTimelines
+//
+//  Created by Rajiv Ramdhany on 14/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "ClockBase.h"
+
+
+/**
+ `ClockConversionPath` holds the resolved path between two clocks in a clock hierarchy: the clocks from
+ the source clock up to the common ancestor, and from the common ancestor down to the target clock. Each
+ step of the path is stored as a `TickTransform` so that converting a tick value requires no message sends
+ or memory allocation.
+
+ The path records the `changeGeneration` of every clock it depends on, read before the clock's transforms.
+ Each conversion compares these with the clocks' current values and re-resolves the path if any clock's
+ parent, tickRate, speed or correlation has changed.
+
+ A path may be used from several threads. A resolution is never modified once built: re-resolving builds
+ a new one and swaps it in, and a conversion already under way finishes with the resolution it started with.
+
+ A path does not retain the clocks. It is owned by the source clock (see `ClockBase toOtherClock:Ticks:WithError:`)
+ and must only be used while the target clock is alive.
+ */
+@interface ClockConversionPath : NSObject
+
+/**
+ *  YES if the source and target clocks share a common ancestor.
+ */
+@property (nonatomic, readonly) BOOL hasCommonAncestor;
+
+/**
+ *  Number of conversion steps in this path.
+ */
+@property (nonatomic, readonly) NSUInteger length;
+
+
+/**
+ *  Default-value init method disallowed. Use initWithSourceClock:TargetClock: method instead.
+ *
+ */
+- (instancetype)init MSDesignatedInitializer(initWithSourceClock:TargetClock:);
+
+/**
+ *  Initialise a conversion path between two clocks. The path is resolved on first use.
+ *
+ *  @param source clock whose tick values will be converted
+ *  @param target clock to whose timescale tick values are converted
+ *
+ *  @return ClockConversionPath instance
+ */
+- (instancetype) initWithSourceClock:(ClockBase*) source
+                         TargetClock:(ClockBase*) target;
+
+/**
+ *  Convert a tick value of the source clock to the timescale of the target clock.
+ *
+ *  @param ticks  a tick value for the source clock
+ *  @param result set to the tick value of the target clock representing the same moment in time
+ *
+ *  @return NO if the source and target clocks have no common ancestor
+ */
+- (BOOL) convertTicks:(int64_t) ticks
+               Result:(int64_t*) result;
+
+/**
+ *  Convert an array of tick values of the source clock to the timescale of the target clock. Each step of
+ *  the path is applied to the whole array in turn.
+ *
+ *  @param ticks   array of `count` tick values for the source clock
+ *  @param results array of `count` elements to receive the converted values; may be the same array as `ticks`
+ *  @param count   number of tick values to convert
+ *
+ *  @return NO if the source and target clocks have no common ancestor
+ */
+- (BOOL) convertTicks:(const int64_t*) ticks
+              Results:(int64_t*) results
+                Count:(NSUInteger) count;
+
+@end
@@ -0,0 +1,368 @@
+//
+//  ClockConversionPath.m
+//  ClockTimelines
+//
+//  Created by Rajiv Ramdhany on 14/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "ClockConversionPath.h"
+
+
+/**
+ *  One resolution of a conversion path. Built once by `initWithSourceClock:TargetClock:` and never
+ *  modified afterwards, so that any number of threads can convert ticks with it while another
+ *  thread builds its replacement.
+ */
+@interface ClockConversionSteps : NSObject
+
+@property (nonatomic, readonly) BOOL hasCommonAncestor;
+@property (nonatomic, readonly) NSUInteger length;
+
+- (instancetype) initWithSourceClock:(ClockBase*) source
+                         TargetClock:(ClockBase*) target;
+- (BOOL) isCurrent;
+- (int64_t) convertTicks:(int64_t) ticks;
+- (void) convertTicks:(const int64_t*) ticks
+              Results:(int64_t*) results
+                Count:(NSUInteger) count;
+
+@end
+
+
+@implementation ClockConversionSteps
+{
+    // clocks the path depends on, ordered from the source and target clocks upwards,
+    // and their change generations, read before the steps were built
+    __unsafe_unretained ClockBase **watched;
+    uint64_t *generations;
+    NSUInteger watchedCount;
+
+    // conversion steps
+    TickTransform *steps;
+    __unsafe_unretained ClockBase **stepClocks;
+    BOOL *stepToParent;
+}
+
+
+//------------------------------------------------------------------------------
+#pragma mark - Lifecycle methods: Initialization, Dealloc, etc
+//------------------------------------------------------------------------------
+
+- (instancetype) initWithSourceClock:(ClockBase*) source
+                         TargetClock:(ClockBase*) target
+{
+    self = [super init];
+    if (self != nil) {
+        [self resolveFromClock:source ToClock:target];
+    }
+    return self;
+}
+
+//------------------------------------------------------------------------------
+
+- (void)dealloc
+{
+    free(watched);
+    free(generations);
+    free(steps);
+    free(stepClocks);
+    free(stepToParent);
+}
+
+//------------------------------------------------------------------------------
+#pragma mark - Actions
+//------------------------------------------------------------------------------
+
+/**
+ *  Check that none of the clocks on the path has changed since the path was resolved.
+ *  Clocks are checked from the end clocks upwards: an unchanged clock still has the same
+ *  parent, so the next clock in the list is guaranteed to still be alive.
+ */
+- (BOOL) isCurrent
+{
+    for (NSUInteger i = 0; i < watchedCount; i++) {
+        if (watched[i].changeGeneration != generations[i])
+            return NO;
+    }
+    return YES;
+}
+
+//------------------------------------------------------------------------------
+
+- (int64_t) convertTicks:(int64_t) ticks
+{
+    int64_t t = ticks;
+
+    for (NSUInteger i = 0; i < _length; i++) {
+
+        if (steps[i].type != TickTransformUnresolved)
+            t = TickTransformApply(&steps[i], t);
+        else if (stepToParent[i])
+            t = [stepClocks[i] toParentTicks:t];
+        else
+            t = [stepClocks[i] fromParentTicks:t];
+    }
+
+    return t;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) convertTicks:(const int64_t*) ticks
+              Results:(int64_t*) results
+                Count:(NSUInteger) count
+{
+    const int64_t *in = ticks;
+    NSUInteger i, k;
+
+    if (_length == 0 && results != ticks)
+        memmove(results, ticks, count * sizeof(int64_t));
+
+    for (i = 0; i < _length; i++, in = results) {
+
+        const TickTransform *t = &steps[i];
+
+        if (t->type == TickTransformConstant)
+        {
+            for (k = 0; k < count; k++)
+                results[k] = t->base;
+        }
+        else if (t->type != TickTransformUnresolved && TickRatioIsValid(t->ratio))
+        {
+            // copy the transform's fields to locals so the loop does not reload them after each store
+            const TickRatio ratio = t->ratio;
+            const int64_t origin = t->origin, base = t->base;
+
+            for (k = 0; k < count; k++)
+                results[k] = TickRatioApply(base, in[k] - origin, &ratio);
+        }
+        else if (t->type != TickTransformUnresolved)
+        {
+            const TickTransform local = *t;
+
+            for (k = 0; k < count; k++)
+                results[k] = TickTransformApplyFloat(&local, in[k]);
+        }
+        else if (stepToParent[i])
+        {
+            for (k = 0; k < count; k++)
+                results[k] = [stepClocks[i] toParentTicks:in[k]];
+        }
+        else
+        {
+            for (k = 0; k < count; k++)
+                results[k] = [stepClocks[i] fromParentTicks:in[k]];
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+#pragma mark - Private methods
+//------------------------------------------------------------------------------
+
+/**
+ *  Append a clock and its ancestors to the watched list, recording each clock's change generation
+ *  before its parent is read.
+ *
+ *  @return number of clocks appended
+ */
+- (NSUInteger) watchChainFromClock:(ClockBase*) clock Capacity:(NSUInteger*) capacity
+{
+    NSUInteger n = 0;
+
+    for (ClockBase *clk = clock; clk != nil; clk = clk.parent, n++) {
+
+        if (watchedCount == *capacity) {
+            *capacity = (*capacity > 0) ? *capacity * 2 : 8;
+            watched     = (__unsafe_unretained ClockBase **) realloc(watched, *capacity * sizeof(ClockBase*));
+            generations = (uint64_t*) realloc(generations, *capacity * sizeof(uint64_t));
+        }
+        generations[watchedCount] = clk.changeGeneration;
+        watched[watchedCount++] = clk;
+    }
+    return n;
+}
+
+//------------------------------------------------------------------------------
+
+/**
+ *  Resolve the path. Every clock's change generation is read before the clock's parent and
+ *  transforms are: if a clock changes while the path is being built, the recorded generation is
+ *  already out of date and the path is resolved again on its next use.
+ */
+- (void) resolveFromClock:(ClockBase*) sourceClock ToClock:(ClockBase*) targetClock
+{
+    NSUInteger capacity = 0;
+    NSUInteger srcDepth, tgtDepth;
+    NSUInteger i, j = 0;
+
+    // list both ancestries: source chain first, then target chain
+    srcDepth = [self watchChainFromClock:sourceClock Capacity:&capacity];
+    tgtDepth = [self watchChainFromClock:targetClock Capacity:&capacity];
+
+    // find the nearest common ancestor: source chain index i, target chain index j
+    BOOL found = NO;
+    for (i = 0; i < srcDepth && !found; i++) {
+        for (j = 0; j < tgtDepth; j++) {
+            if (watched[i] == watched[srcDepth + j]) {
+                found = YES;
+                break;
+            }
+        }
+    }
+
+    _hasCommonAncestor = found;
+    _length = 0;
+
+    if (!found)
+        return; // watch both chains; a change of parent may give the clocks a common ancestor
+
+    i--; // undo the loop increment
+
+    steps        = (TickTransform*) malloc((i + j) * sizeof(TickTransform));
+    stepClocks   = (__unsafe_unretained ClockBase **) malloc((i + j) * sizeof(ClockBase*));
+    stepToParent = (BOOL*) malloc((i + j) * sizeof(BOOL));
+
+    // 1) the path from the source clock up to the common ancestor
+    NSUInteger n = 0;
+    for (NSUInteger k = 0; k < i; k++, n++) {
+        stepClocks[n]   = watched[k];
+        stepToParent[n] = YES;
+        steps[n]        = [watched[k] toParentTransform];
+    }
+
+    // 2) the path back down from the common ancestor to the target clock
+    for (NSUInteger k = j; k > 0; k--, n++) {
+        stepClocks[n]   = watched[srcDepth + k - 1];
+        stepToParent[n] = NO;
+        steps[n]        = [watched[srcDepth + k - 1] fromParentTransform];
+    }
+    _length = n;
+
+    // watch the source chain up to and including the common ancestor, then the target chain below it
+    memmove(&watched[i + 1], &watched[srcDepth], j * sizeof(ClockBase*));
+    memmove(&generations[i + 1], &generations[srcDepth], j * sizeof(uint64_t));
+    watchedCount = i + 1 + j;
+}
+
+//------------------------------------------------------------------------------
+
+@end
+
+
+
+@interface ClockConversionPath()
+
+// the current resolution of the path; replaced, never modified, when a clock on the path changes
+@property (atomic, strong) ClockConversionSteps *resolution;
+
+@end
+
+
+@implementation ClockConversionPath
+{
+    __unsafe_unretained ClockBase *sourceClock;
+    __unsafe_unretained ClockBase *targetClock;
+}
+
+
+//------------------------------------------------------------------------------
+#pragma mark - Lifecycle methods: Initialization, Dealloc, etc
+//------------------------------------------------------------------------------
+
+- (instancetype) initWithSourceClock:(ClockBase*) source
+                         TargetClock:(ClockBase*) target
+{
+    self = [super init];
+    if (self != nil) {
+        sourceClock = source;
+        targetClock = target;
+    }
+    return self;
+}
+
+//------------------------------------------------------------------------------
+#pragma mark - Getters
+//------------------------------------------------------------------------------
+
+- (BOOL) hasCommonAncestor
+{
+    return [self currentSteps].hasCommonAncestor;
+}
+
+//------------------------------------------------------------------------------
+
+- (NSUInteger) length
+{
+    return [self currentSteps].length;
+}
+
+//------------------------------------------------------------------------------
+#pragma mark - Actions
+//------------------------------------------------------------------------------
+
+- (BOOL) convertTicks:(int64_t) ticks
+               Result:(int64_t*) result
+{
+    ClockConversionSteps *path = [self currentSteps];
+
+    if (!path.hasCommonAncestor)
+        return NO;
+
+    *result = [path convertTicks:ticks];
+    return YES;
+}
+
+//------------------------------------------------------------------------------
+
+- (BOOL) convertTicks:(const int64_t*) ticks
+              Results:(int64_t*) results
+                Count:(NSUInteger) count
+{
+    ClockConversionSteps *path = [self currentSteps];
+
+    if (!path.hasCommonAncestor)
+        return NO;
+
+    [path convertTicks:ticks Results:results Count:count];
+    return YES;
+}
+
+//------------------------------------------------------------------------------
+#pragma mark - Private methods
+//------------------------------------------------------------------------------
+
+/**
+ *  The current resolution of the path, re-resolved if a clock on it has changed. Threads racing
+ *  to re-resolve each build their own resolution; the one stored last is kept, and a thread
+ *  still converting with a replaced resolution holds a strong reference to it.
+ */
+- (ClockConversionSteps*) currentSteps
+{
+    ClockConversionSteps *path = self.resolution;
+
+    if ((path == nil) || ![path isCurrent])
+    {
+        path = [[ClockConversionSteps alloc] initWithSourceClock:sourceClock TargetClock:targetClock];
+        self.resolution = path;
+    }
+    return path;
+}
+
+//------------------------------------------------------------------------------
+
+@end
@@ -33,3 +33,6 @@ FOUNDATION_EXPORT const unsigned char ClockTimelinesVersionString[];
 #import <ClockTimelines/SystemClock.h>
 #import <ClockTimelines/CorrelatedClock.h>
 #import <ClockTimelines/TunableClock.h>
+#import <ClockTimelines/TickRatio.h>
+#import <ClockTimelines/ClockChangeListener.h>
+#import <ClockTimelines/ClockConversionPath.h>
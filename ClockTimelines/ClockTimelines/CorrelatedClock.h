@@ -121,7 +121,7 @@ FOUNDATION_EXPORT NSString* const  kStartTicksKey;
             c.correlation = ( parent.ticks, c.ticks )
             c.speed = 0.5;
  */
-@interface CorrelatedClock : ClockBase
+@interface CorrelatedClock : ClockBase <ClockChangeListener>
 
 //------------------------------------------------------------------------------
 #pragma mark - properties
@@ -60,8 +60,6 @@ NSString* const  kStartTicksKey     = @"startTicks";
 @synthesize errorRate   = _errorRate;
 @synthesize staticError = _staticError;
 
-static void *correlationCLKContext = &correlationCLKContext;
-
 //------------------------------------------------------------------------------
 #pragma mark - Lifecycle methods: Initialization, Dealloc, etc
 //------------------------------------------------------------------------------
@@ -82,7 +80,7 @@ static void *correlationCLKContext = &correlationCLKContext;
         
         self.available = NO;
         
-        [parentClock addObserver:self context:correlationCLKContext];
+        [parentClock addChangeListener:self];
         
     }
     return self;
@@ -90,19 +88,31 @@ static void *correlationCLKContext = &correlationCLKContext;
 
 //------------------------------------------------------------------------------
 
-- (void)dealloc
+- (NSString*) description
 {
-    
-   [self.parent removeObserver:self
-                       Context:correlationCLKContext];
+    return [NSString stringWithFormat:@"parent clock: %@ %lu, tickrate: %llu Correlation (parentTicksValue, ticksValue): (%lld , %lld)",NSStringFromClass([self.parent class]), (unsigned long)[self.parent hash], self.tickRate, self.correlation.parentTickValue, self.correlation.tickValue];
+}
+
+//------------------------------------------------------------------------------
+#pragma mark - Getters and setters
+//------------------------------------------------------------------------------
 
+- (Correlation) correlation
+{
+    ClockParameters p = [self parameters];
+    
+    return (Correlation){p.parentTicks, p.ticks};
 }
 
 //------------------------------------------------------------------------------
 
-- (NSString*) description
+- (void) setCorrelation:(Correlation)correlation
 {
-    return [NSString stringWithFormat:@"parent clock: %@ %lu, tickrate: %llu Correlation (parentTicksValue, ticksValue): (%lld , %lld)",NSStringFromClass([self.parent class]), (unsigned long)[self.parent hash], self.tickRate, self.correlation.parentTickValue, self.correlation.tickValue];
+    ClockParameters *p = [self beginParametersUpdate];
+    p->parentTicks  = correlation.parentTickValue;
+    p->ticks        = correlation.tickValue;
+    [self endParametersUpdate];
+    [self notifyChanges:ClockChangeCorrelation];
 }
 
 //------------------------------------------------------------------------------
@@ -123,21 +133,9 @@ static void *correlationCLKContext = &correlationCLKContext;
 // Correlated Clock - calculate time from ticks
 - (Float64) computeTime:(int64_t) ticks{
     
-    int64_t parentticks;
+    TickTransform t = [self cachedToParentTransform];
     
-      if (self.speed == 0.0)
-        parentticks = self.correlation.parentTickValue;
-    else{
-        
-        
-        Float64 ticksElapsed =  (ticks - _correlation.tickValue) * 1.0;
-//        NSLog(@"In Correlated Clock: correlation.tickValue: %lld ticksElapsed: %lf", _correlation.tickValue, ticksElapsed);
-        
-        
-        parentticks = self.correlation.parentTickValue + (((ticksElapsed/self.tickRate) * self.parent.tickRate)/self.speed);
-//        NSLog(@"In Correlated Clock: parentticks:%llu", parentticks);
-    }
-    return [self.parent computeTime:parentticks];
+    return [self.parent computeTime:TickTransformApply(&t, ticks)];
 }
 
 //------------------------------------------------------------------------------
@@ -150,22 +148,42 @@ static void *correlationCLKContext = &correlationCLKContext;
 
 - (int64_t) toParentTicks:(int64_t) ticks
 {
-    if (self.speed == 0.0)
-        return self.correlation.parentTickValue;
-    else{
-        Float64 ticksElapsed = (Float64) ticks - (Float64) self.correlation.tickValue;
-//        Float64 x = self.correlation.parentTickValue + ((ticksElapsed/self.tickRate) * self.parent.tickRate)/self.speed;
-        
-        return self.correlation.parentTickValue + ((ticksElapsed/self.tickRate) * self.parent.tickRate)/self.speed;
-    }
+    TickTransform t = [self cachedToParentTransform];
+    
+    return TickTransformApply(&t, ticks);
 }
 
 //------------------------------------------------------------------------------
 
 - (int64_t) fromParentTicks:(int64_t) parent_ticks
 {
-    Float64 ticksElapsed = (Float64) (parent_ticks - self.correlation.parentTickValue);
-    return self.correlation.tickValue + (ticksElapsed * self.tickRate * self.speed)/ self.parent.tickRate;
+    TickTransform t = [self cachedFromParentTransform];
+    
+    return TickTransformApply(&t, parent_ticks);
+}
+
+//------------------------------------------------------------------------------
+
+- (TickTransform) toParentTransform
+{
+    // one consistent snapshot of correlation, tickRate and speed
+    ClockParameters p = [self parameters];
+    
+    if (p.speed == 0.0)
+        return (TickTransform){ .type = TickTransformConstant, .base = p.parentTicks };
+    
+    return TickTransformMake(TickTransformToParent,
+                             p.ticks, p.parentTicks, p.tickRate, self.parent.tickRate, p.speed);
+}
+
+//------------------------------------------------------------------------------
+
+- (TickTransform) fromParentTransform
+{
+    ClockParameters p = [self parameters];
+    
+    return TickTransformMake(TickTransformFromParentScaled,
+                             p.parentTicks, p.ticks, self.parent.tickRate, p.tickRate, p.speed);
 }
 
 //------------------------------------------------------------------------------
@@ -216,6 +234,13 @@ static void *correlationCLKContext = &correlationCLKContext;
 /// @name Overriding ClockBase's Clock Key-Value observation methods
 //------------------------------------------------------------------------------
 
++ (NSArray*) tickTransformKeys
+{
+    return [[super tickTransformKeys] arrayByAddingObject:kCorrelationKey];
+}
+
+//------------------------------------------------------------------------------
+
 /**
  *  Add an observer for clock state changes. Uses IOS's Key-Value-Coding mechanism.
  *
@@ -274,56 +299,36 @@ static void *correlationCLKContext = &correlationCLKContext;
 
 //------------------------------------------------------------------------------
 
-- (void) observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context
+//------------------------------------------------------------------------------
+#pragma mark - ClockChangeListener methods
+//------------------------------------------------------------------------------
+
+- (void) clock:(ClockBase*) clock didChange:(ClockChangeFlags) changes
 {
-    //NSLog(@"%@", change);
+    // our parent changed: re-set our own properties to the same values so that our own observers
+    // and listeners learn that this timeline has moved. Listeners get a single notification.
+    [self beginChanges];
     
-//    BOOL parentChanged = ([keyPath isEqualToString:kTickRateKey] ||
-//                            [keyPath isEqualToString:kSpeedKey] ||
-//                            [keyPath isEqualToString:kCorrelationKey] ||
-//                          [keyPath isEqualToString:kStartTicksKey]);
-    
-    // trigger a KVO notification to dependents/observers through a fake change to a similar property
-    
-    if ([keyPath isEqualToString:kTickRateKey]) {
-        
+    if (changes & ClockChangeTickRate) {
         uint64_t temp = self.tickRate;
         self.tickRate = temp;
     }
     
-    if ([keyPath isEqualToString:kSpeedKey]) {
-        
-        float oldSpeed = [[change objectForKey:@"old"]floatValue];
-        float newSpeed = [[change objectForKey:@"new"]floatValue];
-        
-        self.speed = newSpeed;
-        
-        //NSLog(@"CorrelatedClock: parent's speed changed from %f to %f", oldSpeed, newSpeed);
+    if (changes & ClockChangeSpeed) {
+        float temp = self.speed;
+        self.speed = temp;
     }
     
-    if ([keyPath isEqualToString:kCorrelationKey]) {
+    if (changes & ClockChangeCorrelation) {
         Correlation temp = self.correlation; // deep copy
         self.correlation = temp;
     }
     
-    if ([keyPath isEqualToString:kAvailableKey]) {
-        
-        
-        BOOL old = [[change objectForKey:@"old"]boolValue];
-        BOOL new = [[change objectForKey:@"new"]boolValue];
-        
-       
-        self.available = new;
-    
-    
+    if (changes & ClockChangeAvailability) {
+        self.available = clock.available;
     }
     
-    
-//    if ([keyPath isEqualToString:kStartTicksKey]) {
-//        Correlation temp = self.s; // deep copy
-//        self.correlation = temp;
-//    }
-    
+    [self endChanges];
 }
 
 
@@ -78,6 +78,17 @@
 - (UInt64) absoluteTimeUnits;
 
 
+/**
+ *  Convert a host absolute time (e.g. a kernel packet timestamp) to nanoseconds, in the same
+ *  timescale as `timeNanos`
+ *
+ *  @param units host absolute time, in host time units
+ *
+ *  @return host time in nanoseconds
+ */
+- (UInt64) nanosForAbsoluteTimeUnits:(UInt64) units;
+
+
 /**
  *  Return host clock's frequency
  *
@@ -20,6 +20,7 @@
 //  limitations under the License.
 
 #import "MonotonicTime.h"
+#import "TickRatio.h"
 
 
 @interface MonotonicTime()
@@ -35,16 +36,37 @@
 
 @implementation MonotonicTime
 {
-    // dividers
-    Float64 dividerSecs;
-    Float64 dividerMillis;
-    Float64 dividerMicros;
-    Float64 dividerNanos;
+    // host time units to nanoseconds: numerator/denominator as a precomputed multiply-shift,
+    // and as a floating point factor where 128-bit integers are not available
+    TickRatio unitsToNanos;
+    Float64 nanosPerUnit;
+    BOOL unitsAreNanos;
 }
 
 static mach_timebase_info_data_t s_timebase_info;
 
 
+// host time units to nanoseconds
+static inline uint64_t UnitsToNanos(MonotonicTime *mt, uint64_t units)
+{
+    if (mt->unitsAreNanos)
+        return units;
+    
+    if (TickRatioIsValid(mt->unitsToNanos))
+        return (uint64_t) TickRatioApply(0, (int64_t) units, &mt->unitsToNanos);
+    
+    return units * mt->nanosPerUnit;
+}
+
+
+// current host time in nanoseconds; a function rather than a method so that the time, timeMillis
+// and timeMicros methods do not pay for a second message send
+static inline uint64_t HostTimeNanos(MonotonicTime *mt)
+{
+    return UnitsToNanos(mt, mach_absolute_time());
+}
+
+
 #pragma mark Initialisation
 
 - (id)init
@@ -52,7 +74,6 @@ static mach_timebase_info_data_t s_timebase_info;
     self = [super init];
     if (self != nil) {
         
-        
         _clockref = CMClockGetHostTimeClock();
         assert(_clockref != nil);
         
@@ -69,11 +90,14 @@ static mach_timebase_info_data_t s_timebase_info;
         self.frequency = (Float64)(self.sToNanosDenominator) / (Float64)(self.sToNanosNumerator);
         self.frequency *= 1.0e9;
         
-        dividerSecs     =  1.0e9 * self.sToNanosDenominator/self.sToNanosNumerator;
-        dividerMillis   =  1.0e6 * self.sToNanosDenominator/self.sToNanosNumerator;
-        dividerMicros   =  1000.0 * self.sToNanosDenominator/self.sToNanosNumerator;
-        dividerNanos    =  self.sToNanosDenominator/self.sToNanosNumerator;
+        unitsAreNanos = (self.sToNanosNumerator == self.sToNanosDenominator);
+        nanosPerUnit = (Float64) self.sToNanosNumerator / self.sToNanosDenominator;
         
+#if defined(__SIZEOF_INT128__)
+        unitsToNanos = TickRatioMake(self.sToNanosNumerator, self.sToNanosDenominator);
+#else
+        unitsToNanos = kTickRatioInvalid;
+#endif
     }
     
     return self;
@@ -87,7 +111,7 @@ static mach_timebase_info_data_t s_timebase_info;
  */
 - (Float64) time
 {
-    return mach_absolute_time() / dividerSecs;
+    return HostTimeNanos(self) * 1.0e-9;
 }
 
 /**
@@ -97,7 +121,7 @@ static mach_timebase_info_data_t s_timebase_info;
  */
 - (Float64) timeMillis
 {
-    return mach_absolute_time() / dividerMillis;
+    return HostTimeNanos(self) * 1.0e-6;
 }
 
 /**
@@ -107,7 +131,7 @@ static mach_timebase_info_data_t s_timebase_info;
  */
 - (Float64) timeMicros
 {
-    return mach_absolute_time() / dividerMicros;
+    return HostTimeNanos(self) * 1.0e-3;
 }
 
 /**
@@ -117,7 +141,7 @@ static mach_timebase_info_data_t s_timebase_info;
  */
 - (UInt64) timeNanos
 {
-    return mach_absolute_time() / dividerNanos;
+    return HostTimeNanos(self);
 }
 
 
@@ -132,6 +156,12 @@ static mach_timebase_info_data_t s_timebase_info;
 }
 
 
+- (UInt64) nanosForAbsoluteTimeUnits:(UInt64) units
+{
+    return UnitsToNanos(self, units);
+}
+
+
 /**
  *  Return host clock's frequency
  *
@@ -133,6 +133,13 @@
 }
 
 
+// same timescale as ticks: host time in seconds times the tick rate
+- (int64_t) ticksAtHostTime:(uint64_t) units
+{
+    return [monTime nanosForAbsoluteTimeUnits:units] * 1.0e-9 * self.tickRate;
+}
+
+
 - (uint32_t) errorRate
 {
     // clock  is root, return only the errorRate of this clock
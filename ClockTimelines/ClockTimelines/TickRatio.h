@@ -0,0 +1,286 @@
+//
+//  TickRatio.h
+//  ClockTimelines
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef ClockTimelines_TickRatio_h
+#define ClockTimelines_TickRatio_h
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+/**
+ *  Struct representing a non-negative rational scale factor num/den, used for integer-exact
+ *  tick conversions. A TickRatio with a zero denominator is invalid: the factor could not be
+ *  represented exactly in 64-bit numerator and denominator.
+ */
+typedef struct _tickRatio{
+
+    uint64_t num;
+
+    uint64_t den;
+
+    // num/den as a 64.64 fixed-point reciprocal: whole + frac/2^64, frac rounded down.
+    // Lets TickRatioApply divide with two multiplies instead of a 128-bit division.
+    uint64_t whole;
+
+    uint64_t frac;
+
+}TickRatio;
+
+
+static const TickRatio kTickRatioInvalid = { 0, 0, 0, 0 };
+
+
+/**
+ *  Check if a tick ratio can be used for exact conversions
+ */
+static inline bool TickRatioIsValid(TickRatio r)
+{
+    return r.den != 0;
+}
+
+
+// 128-bit integers are not available on 32-bit architectures (armv7); there, every ratio is
+// invalid and tick conversions use floating point arithmetic.
+#if defined(__SIZEOF_INT128__)
+
+static inline unsigned __int128 TickRatioGCD(unsigned __int128 a, unsigned __int128 b)
+{
+    // 64-bit division is much cheaper; tick rates and most speeds stay in this range
+    if (!(a >> 64) && !(b >> 64)) {
+        uint64_t x = (uint64_t) a, y = (uint64_t) b;
+        while (y != 0) {
+            uint64_t t = x % y;
+            x = y;
+            y = t;
+        }
+        return x;
+    }
+
+    while (b != 0) {
+        unsigned __int128 t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+
+/**
+ *  Make a ratio num/den reduced to lowest terms.
+ *
+ *  @param num numerator
+ *  @param den denominator
+ *
+ *  @return the reduced ratio, or kTickRatioInvalid if den is zero or the reduced terms do
+ *  not fit in 64 bits
+ */
+static inline TickRatio TickRatioMake(unsigned __int128 num, unsigned __int128 den)
+{
+    if (den == 0)
+        return kTickRatioInvalid;
+
+    if (num == 0)
+        return (TickRatio){ 0, 1, 0, 0 };
+
+    unsigned __int128 g = TickRatioGCD(num, den);
+    num /= g;
+    den /= g;
+
+    if ((num >> 64) || (den >> 64))
+        return kTickRatioInvalid;
+
+    uint64_t n = (uint64_t) num, d = (uint64_t) den;
+
+    return (TickRatio){ n, d, n / d, (uint64_t) (((unsigned __int128) (n % d) << 64) / d) };
+}
+
+
+/**
+ *  Exact rational value of a clock speed. A float is a 24-bit integer times a power of two, so
+ *  any non-negative finite speed in a usable range has an exact representation.
+ *
+ *  @param speed clock speed
+ *
+ *  @return the speed as a ratio, or kTickRatioInvalid if speed is negative, not finite or
+ *  outside the representable range
+ */
+static inline TickRatio TickRatioFromSpeed(float speed)
+{
+    if (!(speed >= 0.0f) || isinf(speed))
+        return kTickRatioInvalid;
+
+    if (speed == 0.0f)
+        return (TickRatio){ 0, 1, 0, 0 };
+
+    int exp;
+    float mantissa = frexpf(speed, &exp);               // speed = mantissa * 2^exp, 0.5 <= mantissa < 1
+    uint64_t m = (uint64_t) ldexpf(mantissa, 24);       // exact 24-bit integer
+    int shift = exp - 24;                               // speed = m * 2^shift
+
+    if (shift >= 0)
+        return (shift <= 39) ? TickRatioMake((unsigned __int128) m << shift, 1) : kTickRatioInvalid;
+
+    return (-shift <= 63) ? TickRatioMake(m, (unsigned __int128) 1 << -shift) : kTickRatioInvalid;
+}
+
+
+/**
+ *  Scale factor (multiplier * speed) / divisor as an exact ratio
+ */
+static inline TickRatio TickRatioScaled(uint64_t multiplier, TickRatio speed, uint64_t divisor)
+{
+    if (!TickRatioIsValid(speed))
+        return kTickRatioInvalid;
+
+    return TickRatioMake((unsigned __int128) multiplier * speed.num,
+                         (unsigned __int128) divisor * speed.den);
+}
+
+
+/**
+ *  Scale factor multiplier / (divisor * speed) as an exact ratio
+ */
+static inline TickRatio TickRatioDivided(uint64_t multiplier, TickRatio speed, uint64_t divisor)
+{
+    if (!TickRatioIsValid(speed))
+        return kTickRatioInvalid;
+
+    return TickRatioMake((unsigned __int128) multiplier * speed.den,
+                         (unsigned __int128) divisor * speed.num);
+}
+
+
+/**
+ *  Full-range implementation of TickRatioApply: negative values, results that need the exact
+ *  remainder and saturation. Kept out of line so that the common case stays small.
+ */
+static int64_t TickRatioApplySlow(int64_t base, int64_t elapsed, const TickRatio *r) __attribute__((noinline, unused));
+
+static int64_t TickRatioApplySlow(int64_t base, int64_t elapsed, const TickRatio *r)
+{
+    uint64_t e = (elapsed < 0) ? -(uint64_t) elapsed : (uint64_t) elapsed;
+
+    // estimate q = floor(e * num / den) from the fixed-point reciprocal; the truncated frac
+    // makes the estimate at most one too small
+    unsigned __int128 q = (unsigned __int128) e * r->whole
+                        + (((unsigned __int128) e * r->frac) >> 64);
+
+    // exact remainder; the true value is in [0, 2 * den) so wrapping arithmetic is safe
+    unsigned __int128 rem = (unsigned __int128) e * r->num - q * r->den;
+    if (rem >= r->den) {
+        q += 1;
+        rem -= r->den;
+    }
+
+    if (q >> 126)
+        return (elapsed < 0) ? INT64_MIN : INT64_MAX;
+
+    // floor division for negative elapsed ticks, so that the remainder is non-negative
+    __int128 sq = (__int128) q;
+    if (elapsed < 0) {
+        sq = -sq;
+        if (rem != 0) {
+            sq -= 1;
+            rem = r->den - rem;
+        }
+    }
+
+    __int128 v = (__int128) base + sq;
+
+    // the exact result is v + rem/den; truncate it towards zero
+    if (v < 0 && rem != 0)
+        v += 1;
+
+    if (v > INT64_MAX)
+        return INT64_MAX;
+    if (v < INT64_MIN)
+        return INT64_MIN;
+
+    return (int64_t) v;
+}
+
+
+/**
+ *  Compute base + elapsed * r, truncated towards zero, without intermediate rounding. The
+ *  product is formed in 128 bits, so it cannot overflow for any 64-bit elapsed value and
+ *  ratio. A result outside the int64_t range saturates.
+ *
+ *  Truncating the final sum (rather than the scaled elapsed ticks) matches the float
+ *  conversion, which computes base + scaled elapsed ticks in floating point and converts
+ *  the sum to an integer.
+ *
+ *  @param base    tick value added to the scaled elapsed ticks
+ *  @param elapsed ticks to scale
+ *  @param r       pointer to a valid ratio
+ *
+ *  @return converted tick value
+ */
+static inline int64_t TickRatioApply(int64_t base, int64_t elapsed, const TickRatio *r)
+{
+    // common case: frac's truncation error (less than elapsed / 2^64) cannot carry into the
+    // integer part, so q is exact, and a non-negative result is truncated by dropping the fraction
+    if (elapsed >= 0) {
+        uint64_t e = (uint64_t) elapsed;
+        unsigned __int128 fp = (unsigned __int128) e * r->frac;
+        uint64_t q;
+        int64_t v;
+
+        if (!__builtin_mul_overflow(e, r->whole, &q) &&
+            !__builtin_add_overflow(q, (uint64_t) (fp >> 64), &q) &&
+            (uint64_t) fp <= UINT64_MAX - e &&
+            q <= INT64_MAX &&
+            !__builtin_add_overflow(base, (int64_t) q, &v) &&
+            v >= 0)
+            return v;
+    }
+
+    return TickRatioApplySlow(base, elapsed, r);
+}
+
+#else
+
+static inline TickRatio TickRatioFromSpeed(float speed)
+{
+    return kTickRatioInvalid;
+}
+
+
+static inline TickRatio TickRatioScaled(uint64_t multiplier, TickRatio speed, uint64_t divisor)
+{
+    return kTickRatioInvalid;
+}
+
+
+static inline TickRatio TickRatioDivided(uint64_t multiplier, TickRatio speed, uint64_t divisor)
+{
+    return kTickRatioInvalid;
+}
+
+
+static inline int64_t TickRatioApply(int64_t base, int64_t elapsed, const TickRatio *r)
+{
+    return base + (elapsed * (double) r->num) / r->den;
+}
+
+#endif
+
+#endif
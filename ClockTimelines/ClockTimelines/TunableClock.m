@@ -21,9 +21,29 @@
 
 #import "TunableClock.h"
 
-@interface TunableClock()
+// TunableClock keeps its (lastTicks, startTicks) pair in the parentTicks and ticks
+// fields of the clock parameters, so that it is read together with tickRate and speed.
+
+/**
+ *  Advance startTicks and lastTicks to the parent's current tick value. Caller must hold the
+ *  parameters for update (see `ClockBase beginParametersUpdate`).
+ */
+static void RebaseParameters(ClockParameters *p, int64_t parentNow, uint64_t parentTickRate)
+{
+    TickTransform t = TickTransformMake(TickTransformFromParentDivided,
+                                        p->parentTicks, p->ticks, parentTickRate, p->tickRate, p->speed);
+    
+    p->ticks = TickTransformApply(&t, parentNow);
+    p->parentTicks = parentNow;
+}
 
 
+@interface TunableClock()
+
+/**
+ *  Rebase without notifying observers. Used by setters whose own change notification covers the rebase.
+ */
+- (void) rebaseQuietly;
 
 @end
 
@@ -31,9 +51,6 @@
 @implementation TunableClock
 
 
-@synthesize tickRate    = _tickRate;
-@synthesize speed       = _speed;
-@synthesize lastTicks   = _lastTicks;
 @synthesize slew        = _slew;
 @synthesize errorRate   = _errorRate;
 @synthesize staticError = _staticError;
@@ -50,9 +67,11 @@
     self = [super init];
     if (self != nil) {
         self.parent = parentClock;
-        _tickRate = tickRate;
-        _startTicks = ticks;
-        _speed = 1.0;
+        ClockParameters *p = [self beginParametersUpdate];
+        p->tickRate = tickRate;
+        p->ticks = ticks;
+        p->speed = 1.0;
+        [self endParametersUpdate];
         self.lastTicks = [parentClock ticks];
         self.staticError = [self estimatePrecision:10] * _kOneThousandMillion;
         self.errorRate = 0;
@@ -75,24 +94,77 @@
 
 -(void) setTickRate:(uint64_t)tickRate
 {
-    [self rebase];
-    _tickRate =  tickRate;
+    int64_t now = [self.parent ticks];
+    uint64_t parentTickRate = self.parent.tickRate;
+    
+    // rebase and change rate in one update so readers never see one without the other
+    ClockParameters *p = [self beginParametersUpdate];
+    RebaseParameters(p, now, parentTickRate);
+    p->tickRate = tickRate;
+    [self endParametersUpdate];
+    [self notifyChanges:ClockChangeTickRate];
     // observers of change are notified via KVO. (See ClockBase class for observer registration methods)
 }
 
 
 - (void) setSpeed:(float)speed
 {
-    [self rebase];
-    _speed = speed;
+    int64_t now = [self.parent ticks];
+    uint64_t parentTickRate = self.parent.tickRate;
+    
+    ClockParameters *p = [self beginParametersUpdate];
+    RebaseParameters(p, now, parentTickRate);
+    p->speed = speed;
+    [self endParametersUpdate];
+    [self notifyChanges:ClockChangeSpeed];
     // observers of change are notified via KVO. (See ClockBase class for observer registration methods)
 }
 
 
 -(void) setSlew:(int64_t)slew
 {
-    _speed = ((float) slew / self.tickRate) + 1.0;
+    int64_t now = [self.parent ticks];
+    uint64_t parentTickRate = self.parent.tickRate;
+    
+    // slew is a change of speed; let speed observers know. Rebase first, like setSpeed:, so
+    // that the new rate applies from now instead of stepping the clock.
+    [self willChangeValueForKey:@"speed"];
+    ClockParameters *p = [self beginParametersUpdate];
+    RebaseParameters(p, now, parentTickRate);
+    p->speed = ((float) slew / p->tickRate) + 1.0;
+    [self endParametersUpdate];
     _slew = slew;
+    [self didChangeValueForKey:@"speed"];
+    [self notifyChanges:ClockChangeSpeed];
+}
+
+
+- (int64_t) startTicks
+{
+    return [self parameters].ticks;
+}
+
+
+- (void) setStartTicks:(int64_t)startTicks
+{
+    ClockParameters *p = [self beginParametersUpdate];
+    p->ticks = startTicks;
+    [self endParametersUpdate];
+    [self notifyChanges:ClockChangeTicks];
+}
+
+
+- (int64_t) lastTicks
+{
+    return [self parameters].parentTicks;
+}
+
+
+- (void) setLastTicks:(int64_t)lastTicks
+{
+    ClockParameters *p = [self beginParametersUpdate];
+    p->parentTicks = lastTicks;
+    [self endParametersUpdate];
 }
 
 
@@ -108,13 +180,9 @@
     int64_t now = [self.parent ticks];
     //NSLog(@"Calculating tunable Clock ticks: system Clock ticks: %llu" , now);
     
-    int64_t ticksElapsed = now - _lastTicks;
-    //NSLog(@"Calculating tunable Clock ticks: ticks elapsed: %llu" , ticksElapsed);
-    
-    uint64_t ticksElapsedTuneCLK = ((ticksElapsed * self.speed* self.tickRate)/self.parent.tickRate);
-   //NSLog(@"Calculating tunable Clock ticks: ticksElapsedTuneCLK: %llu" , ticksElapsedTuneCLK);
+    TickTransform t = [self cachedFromParentTransform];
     
-    int64_t temp =  _startTicks + ticksElapsedTuneCLK;
+    int64_t temp = TickTransformApply(&t, now);
     //NSLog(@"Calculating tunable Clock ticks: ticks: %llu" , temp);
     
     return temp;
@@ -127,20 +195,34 @@
 ///-----------------------------------------------------------
 - (void) rebase
 {
-    uint64_t now = [self.parent ticks];
-    uint64_t ticksElapsed = now - _lastTicks;
+    [self willChangeValueForKey:@"startTicks"];
+    [self rebaseQuietly];
+    [self didChangeValueForKey:@"startTicks"];
+}
+
+
+- (void) rebaseQuietly
+{
+    int64_t now = [self.parent ticks];
+    uint64_t parentTickRate = self.parent.tickRate;
     
-    _startTicks += (ticksElapsed * self.tickRate * self.speed)/self.parent.tickRate;
-    _lastTicks = now;
+    ClockParameters *p = [self beginParametersUpdate];
+    RebaseParameters(p, now, parentTickRate);
+    [self endParametersUpdate];
 }
 
 
 
 -(void) adjustTicks:(int64_t) offset
 {
-    _startTicks +=  offset;
+    [self willChangeValueForKey:@"startTicks"];
+    ClockParameters *p = [self beginParametersUpdate];
+    p->ticks +=  offset;
+    [self endParametersUpdate];
+    [self didChangeValueForKey:@"startTicks"];
+    [self notifyChanges:ClockChangeTicks];
        
-    //NSLog(@"TunableClock: StartTicks updated to: %lld", _startTicks);
+    //NSLog(@"TunableClock: StartTicks updated to: %lld", self.startTicks);
     self.errorTicksFrom = [self ticks];
     
     // observers of change are notified via KVO. (See ClockBase class for observer registration methods)
@@ -187,24 +269,9 @@
 // Tunable Clock
 - (Float64) computeTime:(int64_t) __ticks__{
     
-    int64_t parentticks;
-    
-    if (self.speed == 0.0)
-        parentticks = _lastTicks;
-    else{
-        Float64 ticksElapsed = (__ticks__ - _startTicks) * 1.0;
-
-        // some debug statements
-//        Float64 test = (ticksElapsed/self.tickRate);
-//         Float64 test2 = (ticksElapsed/self.tickRate)* self.parent.tickRate;
-//        
-//        Float64 result = _lastTicks + test2;
-        
-        parentticks = _lastTicks + ((ticksElapsed/self.tickRate) * self.parent.tickRate)/self.speed;
-        
-    }
+    TickTransform t = [self cachedToParentTransform];
     
-    return [self.parent computeTime:parentticks];
+    return [self.parent computeTime:TickTransformApply(&t, __ticks__)];
 }
 
 - (Float64) computeTimeNanos:(int64_t) ticks{
@@ -215,24 +282,41 @@
 
 - (int64_t) toParentTicks:(int64_t) ticks_
 {
-    if (self.speed == 0.0)
-        return _lastTicks;
-    else{
-        Float64 ticksElapsed = ticks_ - _startTicks;
-        return _lastTicks + ((ticksElapsed/self.tickRate) * self.parent.tickRate)/self.speed;
-    }
+    TickTransform t = [self cachedToParentTransform];
     
+    return TickTransformApply(&t, ticks_);
 }
 
 - (int64_t) fromParentTicks:(int64_t) ticks
 {
-    if (self.speed == 0.0)
-        return self.ticks;
-    else{
-        Float64 parentTicksElapsed = ticks - _lastTicks;
-        
-        return _startTicks + ((parentTicksElapsed/self.parent.tickRate) * self.tickRate *self.speed);
-    }
+    TickTransform t = [self cachedFromParentTransform];
+    
+    return TickTransformApply(&t, ticks);
+}
+
+
+- (TickTransform) toParentTransform
+{
+    ClockParameters p = [self parameters];
+    
+    if (p.speed == 0.0)
+        return (TickTransform){ .type = TickTransformConstant, .base = p.parentTicks };
+    
+    return TickTransformMake(TickTransformToParent,
+                             p.ticks, p.parentTicks, p.tickRate, self.parent.tickRate, p.speed);
+}
+
+
+- (TickTransform) fromParentTransform
+{
+    ClockParameters p = [self parameters];
+    
+    // at zero speed, the clock is frozen at its start tick value
+    if (p.speed == 0.0)
+        return (TickTransform){ .type = TickTransformConstant, .base = p.ticks };
+    
+    return TickTransformMake(TickTransformFromParentDivided,
+                             p.parentTicks, p.ticks, self.parent.tickRate, p.tickRate, p.speed);
 }
 
 
@@ -261,6 +345,12 @@
 ///-----------------------------------------------------------
 /// @name Clock Key-Value observation methods from base class ClockBase
 ///-----------------------------------------------------------
+
++ (NSArray*) tickTransformKeys
+{
+    return [[super tickTransformKeys] arrayByAddingObjectsFromArray:@[@"startTicks", @"lastTicks"]];
+}
+
 /**
  *  Override observer registration  method from base class ClockBase
  *
@@ -302,6 +392,7 @@
     [self removeObserver:observer forKeyPath:@"tickRate" context:context];
     [self removeObserver:observer forKeyPath:@"speed" context:context];
     [self removeObserver:observer forKeyPath:@"ticks" context:context];
+    [self removeObserver:observer forKeyPath:@"startTicks" context:context];
 }
 
 
@@ -114,6 +114,47 @@ static void *child2Context = &child2Context;
 }
 
 
+- (void) testEffectiveSpeedFollowsAncestors
+{
+    ClockBase *root = [[ClockBase alloc] init];
+    ClockBase *child = [[ClockBase alloc] init];
+    ClockBase *grandchild = [[ClockBase alloc] init];
+    
+    root.tickRate = 1000000;
+    child.tickRate = 1000;
+    grandchild.tickRate = 90000;
+    
+    child.parent = root;
+    grandchild.parent = child;
+    
+    root.speed = 2.0;
+    child.speed = 3.0;
+    grandchild.speed = 0.5;
+    
+    XCTAssertEqual([root getEffectiveSpeed], 2.0);
+    XCTAssertEqual([child getEffectiveSpeed], 6.0);
+    XCTAssertEqual([grandchild getEffectiveSpeed], 3.0);
+    XCTAssertEqual(grandchild.effectiveTickRate, 270000.0);
+    
+    // a change at the root reaches the grandchild
+    root.speed = 1.0;
+    XCTAssertEqual([grandchild getEffectiveSpeed], 1.5);
+    XCTAssertEqual(grandchild.effectiveTickRate, 135000.0);
+    
+    // tick rate changes only affect the clock's own effective tick rate
+    child.tickRate = 2000;
+    XCTAssertEqual(child.effectiveTickRate, 6000.0);
+    XCTAssertEqual(grandchild.effectiveTickRate, 135000.0);
+    
+    // re-parenting
+    grandchild.parent = root;
+    XCTAssertEqual([grandchild getEffectiveSpeed], 0.5);
+    child.speed = 0.0;
+    XCTAssertEqual([grandchild getEffectiveSpeed], 0.5);
+    XCTAssertEqual([child getEffectiveSpeed], 0.0);
+}
+
+
 - (void) assertNotified{
     
     XCTAssertTrue([changeList count] == [md1.notifications count]);
@@ -0,0 +1,267 @@
+//
+//  ClockChangeListenerTests.m
+//  ClockTimelines
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <XCTest/XCTest.h>
+
+#import "CorrelatedClock.h"
+#import "SystemClock.h"
+
+// number of clock changes per measured block
+static const int kChanges = 100000;
+
+
+/**
+ *  Records the notifications received from clocks
+ */
+@interface RecordingListener : NSObject <ClockChangeListener>
+
+@property (nonatomic) NSUInteger count;
+@property (nonatomic) ClockChangeFlags lastChanges;
+@property (nonatomic, weak) ClockBase *lastClock;
+@property (nonatomic) float lastEffectiveSpeed;
+
+@end
+
+@implementation RecordingListener
+
+- (void) clock:(ClockBase*) clock didChange:(ClockChangeFlags) changes
+{
+    _count++;
+    _lastChanges = changes;
+    _lastClock = clock;
+    _lastEffectiveSpeed = clock.effectiveSpeed;
+}
+
+@end
+
+
+/**
+ *  Stops listening the first time it is notified
+ */
+@interface SelfRemovingListener : RecordingListener
+
+@end
+
+@implementation SelfRemovingListener
+
+- (void) clock:(ClockBase*) clock didChange:(ClockChangeFlags) changes
+{
+    [super clock:clock didChange:changes];
+    [clock removeChangeListener:self];
+}
+
+@end
+
+
+/**
+ *  Counts key-value observing notifications, for comparison with change listeners
+ */
+@interface CountingObserver : NSObject
+
+@property (nonatomic) NSUInteger count;
+
+@end
+
+@implementation CountingObserver
+
+- (void) observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context
+{
+    _count++;
+}
+
+@end
+
+
+@interface ClockChangeListenerTests : XCTestCase
+
+@end
+
+@implementation ClockChangeListenerTests
+{
+    SystemClock *sysCLK;
+    CorrelatedClock *timeline, *childTimeline;
+}
+
+- (void)setUp {
+    [super setUp];
+
+    sysCLK = [[SystemClock alloc] initWithTickRate:1000000000];
+
+    Correlation corel = [CorrelationFactory create:0 Correlation:0];
+    timeline = [[CorrelatedClock alloc] initWithParentClock:sysCLK TickRate:90000 Correlation:&corel];
+    childTimeline = [[CorrelatedClock alloc] initWithParentClock:timeline TickRate:1000 Correlation:&corel];
+}
+
+- (void)tearDown {
+    [super tearDown];
+}
+
+
+- (void) testListenerNotifiedOfChange
+{
+    RecordingListener *listener = [[RecordingListener alloc] init];
+    [timeline addChangeListener:listener];
+
+    timeline.speed = 0.5;
+
+    XCTAssertEqual(listener.count, 1);
+    XCTAssertEqual(listener.lastChanges, ClockChangeSpeed);
+    XCTAssertEqual(listener.lastClock, timeline);
+}
+
+
+- (void) testGroupedChangesCoalesced
+{
+    RecordingListener *listener = [[RecordingListener alloc] init];
+    [timeline addChangeListener:listener];
+
+    // a Control Timestamp update: new correlation, speed and availability together
+    Correlation corel = [CorrelationFactory create:1000 Correlation:500];
+
+    [timeline beginChanges];
+    timeline.correlation = corel;
+    timeline.speed = 2.0;
+    timeline.available = YES;
+    XCTAssertEqual(listener.count, 0);
+    [timeline endChanges];
+
+    XCTAssertEqual(listener.count, 1);
+    XCTAssertEqual(listener.lastChanges, ClockChangeCorrelation | ClockChangeSpeed | ClockChangeAvailability);
+}
+
+
+- (void) testChangesPropagateToChildClocks
+{
+    RecordingListener *listener = [[RecordingListener alloc] init];
+    [childTimeline addChangeListener:listener];
+
+    Correlation corel = [CorrelationFactory create:1000 Correlation:500];
+
+    [timeline beginChanges];
+    timeline.correlation = corel;
+    timeline.speed = 2.0;
+    [timeline endChanges];
+
+    // the child re-sets its own properties in a single group of changes
+    XCTAssertEqual(listener.count, 1);
+    XCTAssertEqual(listener.lastChanges, ClockChangeCorrelation | ClockChangeSpeed);
+    XCTAssertEqual(listener.lastClock, childTimeline);
+    XCTAssertEqual(childTimeline.speed, 1.0);
+}
+
+
+- (void) testPausedParentPausesChild
+{
+    RecordingListener *listener = [[RecordingListener alloc] init];
+    [childTimeline addChangeListener:listener];
+
+    timeline.speed = 0.0;
+
+    // the child keeps its own speed but stops moving, and its listeners see that when notified
+    XCTAssertEqual(listener.count, 1);
+    XCTAssertEqual(listener.lastChanges, ClockChangeSpeed);
+    XCTAssertEqual(listener.lastEffectiveSpeed, 0.0);
+    XCTAssertEqual(childTimeline.speed, 1.0);
+    XCTAssertEqual(childTimeline.effectiveSpeed, 0.0);
+}
+
+
+- (void) testRemovedListenerNotNotified
+{
+    RecordingListener *listener = [[RecordingListener alloc] init];
+    [timeline addChangeListener:listener];
+    [timeline removeChangeListener:listener];
+
+    timeline.speed = 0.5;
+
+    XCTAssertEqual(listener.count, 0);
+}
+
+
+- (void) testListenerRemovingItselfDuringDelivery
+{
+    SelfRemovingListener *remover = [[SelfRemovingListener alloc] init];
+    RecordingListener *listener = [[RecordingListener alloc] init];
+    [timeline addChangeListener:remover];
+    [timeline addChangeListener:listener];
+
+    // the listener after the one that removed itself is not skipped
+    timeline.speed = 0.5;
+    XCTAssertEqual(remover.count, 1);
+    XCTAssertEqual(listener.count, 1);
+
+    timeline.speed = 2.0;
+    XCTAssertEqual(remover.count, 1);
+    XCTAssertEqual(listener.count, 2);
+}
+
+
+
+- (void) testDeallocatedListenersDropped
+{
+    RecordingListener *listener = [[RecordingListener alloc] init];
+    Correlation corel = [CorrelationFactory create:0 Correlation:0];
+    int i;
+
+    // child clocks listen to their parent, and are gone before they could remove themselves
+    for (i = 0; i < 100; i++) @autoreleasepool {
+        CorrelatedClock *child = [[CorrelatedClock alloc] initWithParentClock:timeline TickRate:1000 Correlation:&corel];
+        (void) child;
+    }
+    [timeline addChangeListener:listener];
+
+    // childTimeline and the listener are all that is left
+    XCTAssertEqual([(NSPointerArray*) [timeline valueForKey:@"changeListeners"] count], 2);
+
+    timeline.speed = 0.5;
+    XCTAssertEqual(listener.count, 1);
+}
+
+- (void) testPerformanceChangeListenerNotification
+{
+    RecordingListener *listener = [[RecordingListener alloc] init];
+    [timeline addChangeListener:listener];
+
+    [self measureBlock:^{
+        for (int i = 0; i < kChanges; i++)
+            timeline.speed = (i & 1) ? 1.0 : 0.5;
+    }];
+
+    XCTAssertTrue(listener.count >= kChanges);
+}
+
+
+- (void) testPerformanceKVONotification
+{
+    CountingObserver *observer = [[CountingObserver alloc] init];
+    [timeline addObserver:observer context:nil];
+
+    [self measureBlock:^{
+        for (int i = 0; i < kChanges; i++)
+            timeline.speed = (i & 1) ? 1.0 : 0.5;
+    }];
+
+    XCTAssertTrue(observer.count >= kChanges);
+
+    [timeline removeObserver:observer Context:nil];
+}
+
+@end
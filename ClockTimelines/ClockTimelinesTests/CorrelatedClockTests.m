@@ -135,4 +135,63 @@
 
 
 
+- (void) testCachedTransformFollowsChanges
+{
+    SystemClock *sysCLK = [[SystemClock alloc] initWithTickRate:1000];
+    
+    Correlation corel = [CorrelationFactory create:0 Correlation:0];
+    
+    corelCLK_a = [[CorrelatedClock alloc] initWithParentClock:sysCLK TickRate:1000 Correlation:&corel];
+    corelCLK_b = [[CorrelatedClock alloc] initWithParentClock:corelCLK_a TickRate:1000 Correlation:&corel];
+    
+    XCTAssertEqual([corelCLK_b toParentTicks:1000], 1000);
+    
+    // each conversion must see the change just made, not a transform cached before it
+    corelCLK_b.correlation = [CorrelationFactory create:50 Correlation:0];
+    XCTAssertEqual([corelCLK_b toParentTicks:1000], 1050);
+    
+    corelCLK_b.speed = 2.0;
+    XCTAssertEqual([corelCLK_b toParentTicks:1000], 550);
+    XCTAssertEqual([corelCLK_b fromParentTicks:550], 1000);
+    
+    corelCLK_a.tickRate = 2000;
+    XCTAssertEqual([corelCLK_b toParentTicks:1000], 1050);
+    
+    corelCLK_b.parent = sysCLK;
+    XCTAssertEqual([corelCLK_b toParentTicks:1000], 550);
+}
+
+
+- (void) testCorrelationSnapshotNotTornByConcurrentWriter
+{
+    SystemClock *sysCLK = [[SystemClock alloc] initWithTickRate:1000];
+    
+    Correlation corel = [CorrelationFactory create:0 Correlation:0];
+    
+    corelCLK = [[CorrelatedClock alloc] initWithParentClock:sysCLK TickRate:1000 Correlation:&corel];
+    
+    CorrelatedClock *clk = corelCLK;
+    dispatch_semaphore_t done = dispatch_semaphore_create(0);
+    
+    // writer keeps tickValue at twice parentTickValue
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        for (int64_t i = 1; i <= 100000; i++)
+            clk.correlation = (Correlation){i, 2 * i};
+        dispatch_semaphore_signal(done);
+    });
+    
+    BOOL torn = NO;
+    while (dispatch_semaphore_wait(done, DISPATCH_TIME_NOW) != 0) {
+        Correlation c = clk.correlation;
+        if (c.tickValue != 2 * c.parentTickValue)
+            torn = YES;
+    }
+    
+    XCTAssertFalse(torn);
+    XCTAssertEqual(clk.correlation.parentTickValue, 100000);
+    XCTAssertEqual(clk.correlation.tickValue, 200000);
+}
+
+
+
 @end
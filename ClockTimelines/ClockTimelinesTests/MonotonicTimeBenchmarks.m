@@ -0,0 +1,120 @@
+//
+//  MonotonicTimeBenchmarks.m
+//  ClockTimelines
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <XCTest/XCTest.h>
+#import "MonotonicTime.h"
+#import "SystemClock.h"
+
+// number of calls per measurement
+static const int kCalls = 1000000;
+
+// time kCalls evaluations of an expression and return the mean cost in nanoseconds per call
+#define NANOS_PER_CALL(_mt, _expr) ({                                   \
+    UInt64 _start = [(_mt) timeNanos];                                  \
+    for (int _i = 0; _i < kCalls; _i++) { _expr; }                      \
+    (Float64) ([(_mt) timeNanos] - _start) / kCalls;                    \
+})
+
+
+/**
+ *  Nanobenchmarks for reading the time from MonotonicTime and the SystemClock at the root of
+ *  every clock hierarchy.
+ *
+ *  SystemClockTests replaces MonotonicTime's time method with a mock for the rest of the test
+ *  run; run this class on its own for representative SystemClock figures.
+ */
+@interface MonotonicTimeBenchmarks : XCTestCase
+
+@end
+
+@implementation MonotonicTimeBenchmarks
+{
+    MonotonicTime *mtime;
+    SystemClock *sysCLK;
+}
+
+- (void)setUp {
+    [super setUp];
+
+    mtime = [[MonotonicTime alloc] init];
+    sysCLK = [[SystemClock alloc] initWithTickRate:1000000000];
+}
+
+- (void)tearDown {
+    [super tearDown];
+}
+
+
+- (void) testReportNanosPerCall
+{
+    volatile int64_t isink = 0;
+    volatile Float64 fsink = 0;
+
+    Float64 timeNanos   = NANOS_PER_CALL(mtime, isink += [mtime timeNanos]);
+    Float64 ticks       = NANOS_PER_CALL(mtime, isink += [sysCLK ticks]);
+    Float64 nanoSeconds = NANOS_PER_CALL(mtime, isink += [sysCLK nanoSeconds]);
+    Float64 time        = NANOS_PER_CALL(mtime, fsink += [sysCLK time]);
+
+    NSLog(@"MonotonicTime timeNanos: %.2f ns/call", timeNanos);
+    NSLog(@"SystemClock ticks: %.2f ns/call, nanoSeconds: %.2f ns/call, time: %.2f ns/call",
+          ticks, nanoSeconds, time);
+
+    XCTAssertGreaterThan(isink, 0);
+}
+
+
+- (void) testNanosMatchSeconds
+{
+    UInt64 nanos = [mtime timeNanos];
+    Float64 secs = [mtime time];
+    UInt64 nanosAfter = [mtime timeNanos];
+
+    XCTAssertGreaterThanOrEqual(secs, nanos * 1.0e-9);
+    XCTAssertLessThanOrEqual(secs, nanosAfter * 1.0e-9);
+}
+
+
+- (void) testPerformanceTimeNanos
+{
+    __block UInt64 sink = 0;
+
+    [self measureBlock:^{
+        for (int i = 0; i < kCalls; i++)
+            sink += [mtime timeNanos];
+    }];
+
+    XCTAssertNotEqual(sink, 0);
+}
+
+
+- (void) testPerformanceSystemClockTicks
+{
+    __block int64_t sink = 0;
+
+    [self measureBlock:^{
+        for (int i = 0; i < kCalls; i++)
+            sink += [sysCLK ticks];
+    }];
+
+    XCTAssertNotEqual(sink, 0);
+}
+
+@end
@@ -0,0 +1,229 @@
+//
+//  TickConversionBenchmarks.m
+//  ClockTimelines
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <XCTest/XCTest.h>
+#import "ClockBase.h"
+#import "CorrelatedClock.h"
+#import "TunableClock.h"
+#import "SystemClock.h"
+
+// number of conversions per measured block
+static const int kConversions = 1000000;
+
+// five days of nanosecond ticks
+static const int64_t kUptimeNanos = 5LL * 86400 * 1000000000LL;
+
+
+/**
+ *  CorrelatedClock's toParentTicks: as implemented before exact ratios: clock parameters read through
+ *  their properties, then floating point arithmetic.
+ */
+static int64_t FloatToParentTicks(CorrelatedClock *clock, int64_t ticks)
+{
+    if (clock.speed == 0.0)
+        return clock.correlation.parentTickValue;
+    
+    Float64 ticksElapsed = (Float64) ticks - (Float64) clock.correlation.tickValue;
+    
+    return clock.correlation.parentTickValue + ((ticksElapsed/clock.tickRate) * clock.parent.tickRate)/clock.speed;
+}
+
+
+/**
+ *  TunableClock's ticks as implemented before exact ratios.
+ */
+static int64_t FloatTunableTicks(TunableClock *clock)
+{
+    int64_t ticksElapsed = [clock.parent ticks] - clock.lastTicks;
+    
+    return clock.startTicks + (int64_t) ((ticksElapsed * clock.speed * clock.tickRate) / clock.parent.tickRate);
+}
+
+
+/**
+ *  Compares throughput and accuracy of exact (128-bit ratio) and floating point tick conversions.
+ */
+@interface TickConversionBenchmarks : XCTestCase
+
+@end
+
+@implementation TickConversionBenchmarks
+{
+    TickTransform toParent;     // 90kHz timeline -> nanosecond wall clock, slewed
+    TickTransform fromParent;   // nanosecond wall clock -> 90kHz timeline, slewed
+    
+    SystemClock *sysCLK;
+    TunableClock *wallclock;    // nanosecond wall clock, slewed
+    CorrelatedClock *timeline;  // 90kHz timeline on the wall clock
+}
+
+- (void)setUp {
+    [super setUp];
+
+    float speed = 1.0f + 25.0f/1000000.0f; // 25ppm
+
+    toParent = TickTransformMake(TickTransformToParent, 0, kUptimeNanos, 90000, 1000000000, speed);
+    fromParent = TickTransformMake(TickTransformFromParentScaled, kUptimeNanos, 0, 1000000000, 90000, speed);
+    
+    sysCLK = [[SystemClock alloc] initWithTickRate:1000000000];
+    wallclock = [[TunableClock alloc] initWithParentClock:sysCLK TickRate:1000000000 Ticks:kUptimeNanos];
+    wallclock.speed = speed;
+    
+    Correlation corel = [CorrelationFactory create:kUptimeNanos Correlation:0];
+    timeline = [[CorrelatedClock alloc] initWithParentClock:wallclock TickRate:90000 Correlation:&corel];
+    timeline.speed = speed;
+}
+
+- (void)tearDown {
+    [super tearDown];
+}
+
+
+- (void) testTransformsHaveExactRatios
+{
+    XCTAssertTrue(TickRatioIsValid(toParent.ratio));
+    XCTAssertTrue(TickRatioIsValid(fromParent.ratio));
+}
+
+
+- (void) testAccuracy
+{
+    int64_t floatErrors = 0, exactErrors = 0;
+    int64_t maxFloatError = 0;
+
+    // nanosecond -> microsecond -> nanosecond at multi-day uptimes; exact multiples of 1000
+    TickTransform nsToUs = TickTransformMake(TickTransformFromParentScaled, 0, 0, 1000000000, 1000000, 1.0f);
+    TickTransform usToNs = TickTransformMake(TickTransformToParent, 0, 0, 1000000, 1000000000, 1.0f);
+
+    for (int64_t i = 0; i < kConversions; i++) {
+        int64_t ns = (kUptimeNanos << 10) + i * 1000;
+
+        int64_t exact = TickTransformApply(&usToNs, TickTransformApply(&nsToUs, ns));
+        int64_t approx = TickTransformApplyFloat(&usToNs, TickTransformApplyFloat(&nsToUs, ns));
+
+        if (exact != ns) exactErrors++;
+        if (approx != ns) {
+            floatErrors++;
+            maxFloatError = MAX(maxFloatError, llabs(approx - ns));
+        }
+    }
+
+    NSLog(@"round trips: %d, float path errors: %lld (max %lld ticks), exact path errors: %lld",
+          kConversions, floatErrors, maxFloatError, exactErrors);
+
+    XCTAssertEqual(exactErrors, 0);
+}
+
+
+- (void) testPerformanceFloatConversion
+{
+    __block int64_t sink = 0;
+
+    [self measureBlock:^{
+        for (int64_t i = 0; i < kConversions; i++)
+            sink += TickTransformApplyFloat(&fromParent, TickTransformApplyFloat(&toParent, i * 3003));
+    }];
+
+    XCTAssertNotEqual(sink, 0);
+}
+
+
+- (void) testPerformanceExactConversion
+{
+    __block int64_t sink = 0;
+
+    [self measureBlock:^{
+        for (int64_t i = 0; i < kConversions; i++)
+            sink += TickTransformApply(&fromParent, TickTransformApply(&toParent, i * 3003));
+    }];
+
+    XCTAssertNotEqual(sink, 0);
+}
+
+
+- (void) testPerformanceMakeTransform
+{
+    __block int64_t sink = 0;
+
+    // the cost of rebuilding a clock's transform, paid once per change of its parameters
+    [self measureBlock:^{
+        for (int64_t i = 0; i < kConversions; i++) {
+            TickTransform t = TickTransformMake(TickTransformToParent, i, 0, 90000, 1000000000, 1.0f + i * 1e-9f);
+            sink += t.ratio.den;
+        }
+    }];
+
+    XCTAssertNotEqual(sink, 0);
+}
+
+
+- (void) testPerformanceClockToParentTicksFloat
+{
+    __block int64_t sink = 0;
+
+    [self measureBlock:^{
+        for (int64_t i = 0; i < kConversions; i++)
+            sink += FloatToParentTicks(timeline, i * 3003);
+    }];
+
+    XCTAssertNotEqual(sink, 0);
+}
+
+
+- (void) testPerformanceClockToParentTicks
+{
+    __block int64_t sink = 0;
+
+    [self measureBlock:^{
+        for (int64_t i = 0; i < kConversions; i++)
+            sink += [timeline toParentTicks:i * 3003];
+    }];
+
+    XCTAssertNotEqual(sink, 0);
+}
+
+
+- (void) testPerformanceTunableClockTicksFloat
+{
+    __block int64_t sink = 0;
+
+    [self measureBlock:^{
+        for (int64_t i = 0; i < kConversions; i++)
+            sink += FloatTunableTicks(wallclock);
+    }];
+
+    XCTAssertNotEqual(sink, 0);
+}
+
+
+- (void) testPerformanceTunableClockTicks
+{
+    __block int64_t sink = 0;
+
+    [self measureBlock:^{
+        for (int64_t i = 0; i < kConversions; i++)
+            sink += [wallclock ticks];
+    }];
+
+    XCTAssertNotEqual(sink, 0);
+}
+
+@end
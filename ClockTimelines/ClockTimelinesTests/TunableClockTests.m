@@ -155,6 +155,30 @@
 }
 
 
+/**
+ *  Test conversion of a host time (e.g. a kernel packet timestamp) down a hierarchy of clocks
+ */
+- (void) testTicksAtHostTime
+{
+    MonotonicTime *montime = [[MonotonicTime alloc] init];
+    sysCLK = [[SystemClock alloc] initWithTickRate:_kOneThousandMillion];
+    TunableClock *tuneCLK = [[TunableClock alloc] initWithParentClock:sysCLK TickRate:1000000 Ticks:5];
+    
+    [tuneCLK adjustTimeNanos:123456789000];
+    tuneCLK.speed = 1.0001;
+    
+    uint64_t hostTime = [montime absoluteTimeUnits];
+    int64_t nowTuneCLKTicks = [tuneCLK ticks];
+    
+    XCTAssertEqualWithAccuracy([sysCLK ticksAtHostTime:hostTime], [sysCLK ticks], 100000);
+    XCTAssertEqualWithAccuracy([tuneCLK ticksAtHostTime:hostTime], nowTuneCLKTicks, 100);
+    
+    // a host time 10ms in the past
+    uint64_t earlier = hostTime - (uint64_t) ([montime hostFrequency] / 100);
+    XCTAssertEqualWithAccuracy([tuneCLK ticksAtHostTime:hostTime] - [tuneCLK ticksAtHostTime:earlier], 10001, 2);
+}
+
+
 /**
  *  Test compute to host time function with a hierarchy of clocks
  */
@@ -30,4 +30,6 @@ FOUNDATION_EXPORT const unsigned char CSASynchroniserVersionString[];
 #import <CSASynchroniser/Synchroniser.h>
 #import <CSASynchroniser/MediaPlayerObject.h>
 #import <CSASynchroniser/SynchroniserDelegate.h>
+#import <CSASynchroniser/StartupTimings.h>
+#import <CSASynchroniser/PrerollScheduler.h>
 
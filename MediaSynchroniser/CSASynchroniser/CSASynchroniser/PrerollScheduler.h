@@ -0,0 +1,107 @@
+//
+//  PrerollScheduler.h
+//  CSASynchroniser
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+#import <ClockTimelines/ClockTimelines.h>
+
+#import "MediaPlayerObject.h"
+#import "StartupTimings.h"
+
+//------------------------------------------------------------------------------
+#pragma mark - PrerollScheduler
+//------------------------------------------------------------------------------
+
+/**
+ *  Starts media players in sync with as little delay as possible once the WallClock and the
+ *  Synchronisation Timeline are being synchronised in parallel.
+ *
+ *  As soon as both clocks are available (i.e. after the first CSS-WC candidate and the first
+ *  Control Timestamp) each video player is paused and pre-buffered at the media position the
+ *  clocks predict. When the WallClock's dispersion has fallen under the dispersion threshold and
+ *  the players have prerolled, each locally played video is started with a single
+ *  setRate:time:atHostTime: a short lead time ahead, so the player needs no further seek when
+ *  its SyncController takes over. Streamed video is only pre-buffered; its SyncController seeks
+ *  within the buffered media as before. Other players are left to their SyncControllers.
+ *
+ *  The scheduler runs on the main queue, and gives up waiting for convergence after maxWait.
+ */
+@interface PrerollScheduler : NSObject
+
+/**
+ *  WallClock dispersion, in milliseconds, under which playback is started. If 0, playback
+ *  starts as soon as the players have prerolled.
+ */
+@property (nonatomic) NSTimeInterval dispersionThreshold;
+
+/**
+ *  Time, in seconds, between issuing setRate:time:atHostTime: and the host time at which
+ *  playback starts. Default 0.1 s.
+ */
+@property (nonatomic) NSTimeInterval leadTime;
+
+/**
+ *  Longest time, in seconds, to wait after prerolling starts for the dispersion to converge and
+ *  the players to preroll. Default 5 s.
+ */
+@property (nonatomic) NSTimeInterval maxWait;
+
+/**
+ *  Interval, in seconds, at which the clocks are checked. Default 20 ms.
+ */
+@property (nonatomic) NSTimeInterval pollInterval;
+
+/**
+ *  Where the Prerolled and DispersionConverged stages are recorded
+ */
+@property (nonatomic, readonly) StartupTimings *timings;
+
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Initialise a scheduler
+ *
+ *  @param wallclock     the WallClock being synchronised by CSS-WC
+ *  @param sync_timeline the Synchronisation Timeline being synchronised by CSS-TS
+ *  @param timings       start-up timings to record stages in
+ *
+ *  @return a PrerollScheduler instance
+ */
+- (instancetype) initWithWallClock:(ClockBase*) wallclock
+                      SyncTimeline:(CorrelatedClock*) sync_timeline
+                           Timings:(StartupTimings*) timings;
+
+/**
+ *  Preroll and start media players. Call on the main queue.
+ *
+ *  @param media_objects MediaPlayerObject instances to start
+ *  @param completion    called on the main queue once playback has started (or the wait has
+ *                       timed out), when SyncControllers should be set up for the media objects
+ */
+- (void) startWithMediaObjects:(NSArray<MediaPlayerObject *> *) media_objects
+                    Completion:(void (^)(void)) completion;
+
+/**
+ *  Stop waiting; the completion handler is not called
+ */
+- (void) cancel;
+
+@end
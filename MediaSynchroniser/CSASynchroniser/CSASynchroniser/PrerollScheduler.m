@@ -0,0 +1,268 @@
+//
+//  PrerollScheduler.m
+//  CSASynchroniser
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <SimpleLogger/MWLogging.h>
+#import <VideoPlayer/VideoPlayerViewController.h>
+#import "PrerollScheduler.h"
+
+#define PREROLL_LEAD_TIME_DEFAULT       0.1     // s
+#define PREROLL_MAX_WAIT_DEFAULT        5.0     // s
+#define PREROLL_POLL_INTERVAL_DEFAULT   0.02    // s
+
+
+@implementation PrerollScheduler
+{
+    ClockBase               *wallclock;
+    CorrelatedClock         *syncTimeline;
+    MonotonicTime           *monotonicTime;
+    NSArray<MediaPlayerObject *> *mediaObjects;
+    void                    (^completionHandler)(void);
+    dispatch_source_t       pollTimer;
+    NSUInteger              generation;         // changes when the scheduler is started or cancelled
+    BOOL                    prerolling;
+    UInt64                  prerollStartNanos;
+    NSUInteger              pendingPrerolls;
+    NSMutableSet            *prerolledPlayers;  // players ready for setRate:time:atHostTime:
+}
+
+
+- (instancetype) initWithWallClock:(ClockBase*) wall_clock
+                      SyncTimeline:(CorrelatedClock*) sync_timeline
+                           Timings:(StartupTimings*) timings
+{
+    self = [super init];
+    if (self != nil) {
+        wallclock = wall_clock;
+        syncTimeline = sync_timeline;
+        _timings = timings;
+        _leadTime = PREROLL_LEAD_TIME_DEFAULT;
+        _maxWait = PREROLL_MAX_WAIT_DEFAULT;
+        _pollInterval = PREROLL_POLL_INTERVAL_DEFAULT;
+        monotonicTime = [[MonotonicTime alloc] init];
+        prerolledPlayers = [NSMutableSet set];
+    }
+    return self;
+}
+
+
+- (void) dealloc
+{
+    [self cancel];
+}
+
+
+#pragma mark private methods
+
+/**
+ *  The expected timeline for a media object, as its SyncController will compute it
+ */
+- (CorrelatedClock*) mediaTimelineForObject:(MediaPlayerObject*) media_obj
+{
+    Correlation corel = [CorrelationFactory create:media_obj.correlation.parentTickValue Correlation:media_obj.correlation.tickValue];
+
+    return [[CorrelatedClock alloc] initWithParentClock:syncTimeline
+                                               TickRate:_kOneThousandMillion
+                                            Correlation:&corel];
+}
+
+
+- (BOOL) isStreamed:(VideoPlayerViewController*) player
+{
+    NSString *scheme = player.videoURL.scheme;
+
+    return (scheme != nil) && (([scheme caseInsensitiveCompare:@"http"] == NSOrderedSame) ||
+                               ([scheme caseInsensitiveCompare:@"https"] == NSOrderedSame));
+}
+
+
+/**
+ *  Pause every video player and pre-buffer it where the clocks say it should be now
+ */
+- (void) prerollPlayers
+{
+    NSUInteger started = generation;
+    __weak PrerollScheduler *weakSelf = self;
+
+    prerolling = YES;
+    prerollStartNanos = [monotonicTime timeNanos];
+
+    for (MediaPlayerObject *media_obj in mediaObjects)
+    {
+        if ([media_obj.mediaPlayer class] != [VideoPlayerViewController class])
+            continue;
+
+        VideoPlayerViewController *player = (VideoPlayerViewController*) media_obj.mediaPlayer;
+        CorrelatedClock *mediaTimeline = [self mediaTimelineForObject:media_obj];
+        Float64 predicted = [mediaTimeline ticksToNanoSeconds:[mediaTimeline ticks]] / 1e9;
+        BOOL streamed = [self isStreamed:player];
+
+        pendingPrerolls++;
+
+        MWLogDebug(@"PrerollScheduler: prerolling %@ at %.3f s", media_obj.mediaURL, predicted);
+
+        [player prerollAtTime:predicted CompletionHandler:^(BOOL finished) {
+            PrerollScheduler *scheduler = weakSelf;
+
+            if ((scheduler == nil) || (scheduler->generation != started)) return;
+
+            if (finished && !streamed)
+                [scheduler->prerolledPlayers addObject:player];
+
+            if (--scheduler->pendingPrerolls == 0)
+                [scheduler.timings mark:StartupStagePrerolled];
+        }];
+    }
+
+    if (pendingPrerolls == 0)
+        [_timings mark:StartupStagePrerolled];
+}
+
+
+/**
+ *  Start every video player at the position the clocks give for a host time leadTime from now
+ */
+- (void) startPlayers
+{
+    NSUInteger started = generation;
+    __weak PrerollScheduler *weakSelf = self;
+    int64_t leadNanos = (int64_t) (_leadTime * _kOneThousandMillion);
+
+    for (MediaPlayerObject *media_obj in mediaObjects)
+    {
+        if ([media_obj.mediaPlayer class] != [VideoPlayerViewController class])
+            continue;
+
+        VideoPlayerViewController *player = (VideoPlayerViewController*) media_obj.mediaPlayer;
+        CorrelatedClock *mediaTimeline = [self mediaTimelineForObject:media_obj];
+        int64_t ticks = [mediaTimeline ticks];
+        float speed = mediaTimeline.effectiveSpeed;
+
+        if ([prerolledPlayers containsObject:player])
+        {
+            Float64 mediaTimeNanos = [mediaTimeline ticksToNanoSeconds:ticks] + leadNanos * speed;
+            Float64 hostTimeNanos = [mediaTimeline computeTimeNanos:ticks] + leadNanos;
+
+            [player setRate:speed time:mediaTimeNanos atHostTime:hostTimeNanos];
+        }else
+        {
+            // streamed, or could not be prerolled: seek as its SyncController would, within what has been buffered
+            [player seekToTime:[mediaTimeline time]];
+            if (speed != 0.0)
+                [player play];
+        }
+    }
+
+    // let the players start before their SyncControllers first look at them
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, leadNanos), dispatch_get_main_queue(), ^{
+        PrerollScheduler *scheduler = weakSelf;
+        void (^completion)(void);
+
+        if ((scheduler == nil) || (scheduler->generation != started)) return;
+
+        completion = scheduler->completionHandler;
+        scheduler->completionHandler = nil;
+        scheduler->mediaObjects = nil;
+        [scheduler->prerolledPlayers removeAllObjects];
+
+        if (completion) completion();
+    });
+}
+
+
+- (void) poll
+{
+    BOOL converged, timedOut;
+
+    if (!prerolling)
+    {
+        // the first CSS-WC candidate and the first Control Timestamp give a usable prediction
+        if (!wallclock.available || !syncTimeline.available)
+            return;
+
+        [self prerollPlayers];
+    }
+
+    if (_dispersionThreshold <= 0) {
+        converged = YES;
+    }else
+    {
+        int64_t dispersion = [wallclock dispersionAtTime:[wallclock nanoSeconds]];
+
+        converged = ((Float64) dispersion / 1000000.0) <= _dispersionThreshold;
+    }
+    if (converged)
+        [_timings mark:StartupStageDispersionConverged];
+
+    timedOut = ((double) ([monotonicTime timeNanos] - prerollStartNanos) / 1e9) > _maxWait;
+
+    if ((converged && (pendingPrerolls == 0)) || timedOut)
+    {
+        if (!converged || (pendingPrerolls > 0))
+            MWLogWarning(@"PrerollScheduler: starting after %.1f s without convergence (%lu prerolls pending)", _maxWait, (unsigned long) pendingPrerolls);
+
+        dispatch_source_cancel(pollTimer);
+        pollTimer = nil;
+
+        [self startPlayers];
+    }
+}
+
+
+#pragma mark public methods
+
+- (void) startWithMediaObjects:(NSArray<MediaPlayerObject *> *) media_objects
+                    Completion:(void (^)(void)) completion
+{
+    __weak PrerollScheduler *weakSelf = self;
+
+    [self cancel];
+
+    mediaObjects = [media_objects copy];
+    completionHandler = completion;
+    prerolling = NO;
+    pendingPrerolls = 0;
+
+    pollTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_main_queue());
+    if (pollTimer)
+    {
+        uint64_t interval = (uint64_t) (_pollInterval * NSEC_PER_SEC);
+
+        dispatch_source_set_timer(pollTimer, dispatch_time(DISPATCH_TIME_NOW, 0), interval, interval / 10);
+        dispatch_source_set_event_handler(pollTimer, ^{ [weakSelf poll]; });
+        dispatch_resume(pollTimer);
+    }
+}
+
+
+- (void) cancel
+{
+    generation++;
+
+    if (pollTimer) {
+        dispatch_source_cancel(pollTimer);
+        pollTimer = nil;
+    }
+    completionHandler = nil;
+    mediaObjects = nil;
+    [prerolledPlayers removeAllObjects];
+}
+
+@end
@@ -0,0 +1,126 @@
+//
+//  StartupTimings.h
+//  CSASynchroniser
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+//------------------------------------------------------------------------------
+#pragma mark - Data Structures
+//------------------------------------------------------------------------------
+
+/**
+ *  Stages a Synchroniser goes through between enableSynchronisation and synchronised playback
+ */
+typedef NS_ENUM(NSUInteger, StartupStage)
+{
+    /**
+     *  enableSynchronisation called
+     */
+    StartupStageEnabled = 0,
+    /**
+     *  First CII message received from the TV
+     */
+    StartupStageCIIReceived,
+    /**
+     *  WallClock available, i.e. the first CSS-WC candidate has been applied
+     */
+    StartupStageWallClockAvailable,
+    /**
+     *  Synchronisation Timeline available, i.e. the first Control Timestamp has been applied
+     */
+    StartupStageTimelineAvailable,
+    /**
+     *  Media pre-buffered at its predicted position (pipelined start-up only)
+     */
+    StartupStagePrerolled,
+    /**
+     *  WallClock dispersion under the sync threshold (pipelined start-up only)
+     */
+    StartupStageDispersionConverged,
+    /**
+     *  Media players started in sync and handed to their SyncControllers
+     */
+    StartupStageSyncStarted,
+    /**
+     *  Number of stages
+     */
+    StartupStageCount
+};
+
+
+//------------------------------------------------------------------------------
+#pragma mark - StartupTimings
+//------------------------------------------------------------------------------
+
+/**
+ *  When a Synchroniser reached each start-up stage, on the host's monotonic clock. Only the first
+ *  time a stage is reached is recorded. Stages may be reached out of order in a pipelined
+ *  start-up, e.g. the Synchronisation Timeline may become available before the WallClock.
+ */
+@interface StartupTimings : NSObject
+
+/**
+ *  Record that a stage has been reached now, if it has not been reached before
+ *
+ *  @param stage a start-up stage
+ *
+ *  @return YES if this is the first time the stage has been reached
+ */
+- (BOOL) mark:(StartupStage) stage;
+
+/**
+ *  Whether a stage has been reached
+ */
+- (BOOL) reached:(StartupStage) stage;
+
+/**
+ *  Time at which a stage was reached, relative to StartupStageEnabled
+ *
+ *  @param stage a start-up stage
+ *
+ *  @return seconds since synchronisation was enabled, or a negative value if either stage has not been reached
+ */
+- (NSTimeInterval) timeOfStage:(StartupStage) stage;
+
+/**
+ *  Time taken by a stage: from the latest earlier stage that has been reached, to this one
+ *
+ *  @param stage a start-up stage
+ *
+ *  @return duration in seconds, or a negative value if the stage has not been reached
+ */
+- (NSTimeInterval) durationOfStage:(StartupStage) stage;
+
+/**
+ *  Forget all stages reached
+ */
+- (void) reset;
+
+/**
+ *  Name of a stage, for reports
+ */
++ (NSString*) nameOfStage:(StartupStage) stage;
+
+/**
+ *  A one-line breakdown of the stage durations, e.g. for logging
+ */
+- (NSString*) breakdown;
+
+@end
@@ -0,0 +1,173 @@
+//
+//  StartupTimings.m
+//  CSASynchroniser
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <ClockTimelines/MonotonicTime.h>
+#import "StartupTimings.h"
+
+
+@implementation StartupTimings
+{
+    NSLock          *lock;
+    MonotonicTime   *monotonicTime;
+    UInt64          marks[StartupStageCount];   // host time in nanoseconds
+    BOOL            reachedStages[StartupStageCount];
+}
+
+
+- (id) init
+{
+    self = [super init];
+    if (self != nil) {
+        lock = [[NSLock alloc] init];
+        monotonicTime = [[MonotonicTime alloc] init];
+    }
+    return self;
+}
+
+
++ (NSString*) nameOfStage:(StartupStage) stage
+{
+    switch (stage)
+    {
+        case StartupStageEnabled:               return @"enabled";
+        case StartupStageCIIReceived:           return @"CII";
+        case StartupStageWallClockAvailable:    return @"WC";
+        case StartupStageTimelineAvailable:     return @"TS";
+        case StartupStagePrerolled:             return @"preroll";
+        case StartupStageDispersionConverged:   return @"dispersion";
+        case StartupStageSyncStarted:           return @"sync";
+        default:                                return @"unknown";
+    }
+}
+
+
+- (BOOL) mark:(StartupStage) stage
+{
+    UInt64 now = [monotonicTime timeNanos];
+    BOOL first;
+
+    if (stage >= StartupStageCount) return NO;
+
+    [lock lock];
+    first = !reachedStages[stage];
+    if (first) {
+        marks[stage] = now;
+        reachedStages[stage] = YES;
+    }
+    [lock unlock];
+
+    return first;
+}
+
+
+- (BOOL) reached:(StartupStage) stage
+{
+    BOOL reached;
+
+    if (stage >= StartupStageCount) return NO;
+
+    [lock lock];
+    reached = reachedStages[stage];
+    [lock unlock];
+
+    return reached;
+}
+
+
+- (NSTimeInterval) timeOfStage:(StartupStage) stage
+{
+    NSTimeInterval time = -1.0;
+
+    if (stage >= StartupStageCount) return time;
+
+    [lock lock];
+    if (reachedStages[StartupStageEnabled] && reachedStages[stage])
+        time = (double) ((int64_t) (marks[stage] - marks[StartupStageEnabled])) / 1e9;
+    [lock unlock];
+
+    return time;
+}
+
+
+- (NSTimeInterval) durationOfStage:(StartupStage) stage
+{
+    NSTimeInterval duration = -1.0;
+    NSUInteger previous;
+    UInt64 from = 0;
+    BOOL found = NO;
+
+    if (stage >= StartupStageCount) return duration;
+
+    [lock lock];
+    if (reachedStages[stage])
+    {
+        // stages can complete out of order when they run in parallel; measure from the latest
+        // earlier stage that completed before this one
+        for (previous = 0; previous < stage; previous++)
+        {
+            if (!reachedStages[previous] || (marks[previous] > marks[stage])) continue;
+            if (!found || (marks[previous] > from)) {
+                from = marks[previous];
+                found = YES;
+            }
+        }
+        duration = found ? (double) (marks[stage] - from) / 1e9 : 0.0;
+    }
+    [lock unlock];
+
+    return duration;
+}
+
+
+- (void) reset
+{
+    [lock lock];
+    memset(marks, 0, sizeof(marks));
+    memset(reachedStages, 0, sizeof(reachedStages));
+    [lock unlock];
+}
+
+
+- (NSString*) breakdown
+{
+    NSMutableString *report = [NSMutableString string];
+    NSUInteger stage;
+
+    for (stage = StartupStageCIIReceived; stage < StartupStageCount; stage++)
+    {
+        NSTimeInterval duration = [self durationOfStage:stage];
+
+        if (duration < 0) continue;
+        [report appendFormat:@"%@%@ +%.0f ms", (report.length > 0) ? @", " : @"", [StartupTimings nameOfStage:stage], duration * 1000];
+    }
+    if ([self reached:StartupStageSyncStarted])
+        [report appendFormat:@" (total %.0f ms)", [self timeOfStage:StartupStageSyncStarted] * 1000];
+
+    return report;
+}
+
+
+- (NSString*) description
+{
+    return [NSString stringWithFormat:@"StartupTimings: %@", [self breakdown]];
+}
+
+@end
@@ -30,6 +30,8 @@
 
 #import "SynchroniserDelegate.h"
 #import "MediaPlayerObject.h"
+#import "StartupTimings.h"
+#import "PrerollScheduler.h"
 
 //------------------------------------------------------------------------------
 #pragma mark - constants
@@ -60,6 +62,29 @@ FOUNDATION_EXPORT NSTimeInterval const kAudioCallibrationOffset;      // millise
  */
 FOUNDATION_EXPORT NSTimeInterval const kWebCallibrationOffset;      // milliseconds
 
+//------------------------------------------------------------------------------
+#pragma mark - Data Structures
+//------------------------------------------------------------------------------
+
+/**
+ *  How the Synchroniser brings up synchronisation after enableSynchronisation
+ */
+typedef NS_ENUM(NSUInteger, SynchroniserStartupMode)
+{
+    /**
+     *  One protocol after another: CSS-TS once the WallClock is available, then SyncControllers
+     *  once the Synchronisation Timeline is available
+     */
+    SynchroniserStartupSerial = 0,
+    /**
+     *  CSS-WC and CSS-TS started together as soon as CII arrives; media pre-buffered at its
+     *  predicted position and started once the WallClock dispersion is under the sync threshold.
+     *  Only the first start-up is pipelined: once sync has started, the Synchronisation Timeline
+     *  becoming available again is handled as in SynchroniserStartupSerial. See PrerollScheduler.
+     */
+    SynchroniserStartupPipelined
+};
+
 //------------------------------------------------------------------------------
 #pragma mark - Notifications
 //------------------------------------------------------------------------------
@@ -95,7 +120,7 @@ FOUNDATION_EXPORT NSString* const  kSynchroniserSyncTimelinesAvailableNotificati
  *
  *  See README.md for usage explanation.
  */
-@interface Synchroniser : NSObject <TimelineSynchroniserDelegate, SyncControllerDelegate>
+@interface Synchroniser : NSObject <TimelineSynchroniserDelegate, SyncControllerDelegate, ClockChangeListener>
 
 //------------------------------------------------------------------------------
 #pragma mark - Properties
@@ -183,6 +208,16 @@ FOUNDATION_EXPORT NSString* const  kSynchroniserSyncTimelinesAvailableNotificati
  */
 @property (nonatomic, readwrite) NSTimeInterval             syncThreshold;
 
+/**
+ *  How synchronisation is brought up; set before enableSynchronisation. Default SynchroniserStartupSerial.
+ */
+@property (nonatomic, readwrite) SynchroniserStartupMode    startupMode;
+
+/**
+ *  When each start-up stage was reached since enableSynchronisation was last called
+ */
+@property (nonatomic, readonly) StartupTimings              *startupTimings;
+
 
 
 //------------------------------------------------------------------------------
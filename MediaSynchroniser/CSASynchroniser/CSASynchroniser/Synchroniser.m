@@ -60,7 +60,6 @@ NSTimeInterval const kWebCallibrationOffset        = 0.0;  // milliseconds
 static void *AudioSyncControllerContext         = &AudioSyncControllerContext;
 static void *AudioObjectTimelineContext         = &AudioObjectTimelineContext;
 static void *WallClockContext                   = &WallClockContext;
-static void *TVTimelineContext                  = &TVTimelineContext;
 
 
 //------------------------------------------------------------------------------
@@ -96,6 +95,7 @@ NSString* const  kSynchroniserSyncTimelinesAvailableNotification = @"Synchronise
 @property (nonatomic, readwrite) CorrelatedClock       *syncTimeline;
 @property (nonatomic, readwrite) NSTimeInterval        error;
 @property (nonatomic, readwrite) SynchroniserState     state;
+@property (nonatomic, readwrite) StartupTimings        *startupTimings;
 
 //------------------------------------------------------------------------------
 #pragma mark - Object-scope Properties
@@ -183,6 +183,8 @@ NSString* const  kSynchroniserSyncTimelinesAvailableNotification = @"Synchronise
 
     dispatch_source_t   syncAccuracyTimer;
     CII *currentCII;
+    BOOL syncTimelineAvailable;     // last availability reported by the syncTimeline
+    PrerollScheduler *prerollScheduler; // set while a pipelined start-up is waiting to start the players
 }
 
 
@@ -302,6 +304,9 @@ NSString* const  kSynchroniserSyncTimelinesAvailableNotification = @"Synchronise
         self.syncControllerList = [[NSMutableArray alloc] init];
         
         self.syncTimelineOffset = kVideoCallibrationOffset; // a default callibration offset, it will be updated later
+        
+        self.startupMode = SynchroniserStartupSerial;
+        self.startupTimings = [[StartupTimings alloc] init];
     }
     
     return self;
@@ -342,6 +347,10 @@ NSString* const  kSynchroniserSyncTimelinesAvailableNotification = @"Synchronise
 - (void) enableSynchronisation:(float) syncThreshold Error:(NSError** ) error
 {
     self.syncThreshold = syncThreshold;
+    
+    [_startupTimings reset];
+    [_startupTimings mark:StartupStageEnabled];
+    
     // --- 1. start CSS-CII protocol client to receive CII messages ----
     
     [self registerForCIINotifications];
@@ -389,7 +398,8 @@ NSString* const  kSynchroniserSyncTimelinesAvailableNotification = @"Synchronise
     }
        
     
-    if (_syncTimeline)
+    // a pipelined start-up in progress sets up sync controllers for every registered media object when it completes
+    if ((_syncTimeline) && (!prerollScheduler))
     {
         if (_syncTimeline.available)
         {
@@ -536,14 +546,32 @@ NSString* const  kSynchroniserSyncTimelinesAvailableNotification = @"Synchronise
                     }
                 });
                 
+                [_startupTimings mark:StartupStageCIIReceived];
+                
                 // 3 ---- start WallClock Synchronisation ---
                 [self startWallClockSync];
                 
+                // ... and, in a pipelined start-up, Timeline Synchronisation alongside it
+                if ((_startupMode == SynchroniserStartupPipelined) && (!_tvTimelineSyncer))
+                    [self startTimelineSync];
+                
             }
         }
         
+        if (ciiChangeStatus & TimelinesChanged) {
+
+            if ([temp isKindOfClass:[CII class]])
+            {
+                currentCII = temp;
+            }
+            self.availableTimelines = [currentCII.timelines copy];
+
+            if ((self.syncTimelineProperties) && ![currentCII timelineLookUp:self.syncTimelineProperties.timelineSelector])
+                MWLogWarning(@"Synchroniser: timeline %@ is not offered by the TV", self.syncTimelineProperties.timelineSelector);
+        }
+
         if (ciiChangeStatus  & ContentIdChanged) {
-            
+
             if ([temp isKindOfClass:[CII class]])
             {
                 currentCII = temp;
@@ -682,7 +710,8 @@ NSString* const  kSynchroniserSyncTimelinesAvailableNotification = @"Synchronise
     
     _tvTimelineSyncer.delegate = self;
     
-    [_syncTimeline addObserver:self context:TVTimelineContext];
+    syncTimelineAvailable = _syncTimeline.available;
+    [_syncTimeline addChangeListener:self];
     
     [_tvTimelineSyncer start];
     
@@ -695,9 +724,11 @@ NSString* const  kSynchroniserSyncTimelinesAvailableNotification = @"Synchronise
     
     
 //    dispatch_source_cancel(UIUpdateTimer);
+    [self cancelPreroll];
+    
     if (_tvTimelineSyncer){
         [_tvTimelineSyncer stop];
-        [_syncTimeline removeObserver:self Context:TVTimelineContext ];
+        [_syncTimeline removeChangeListener:self];
         _tvTimelineSyncer.delegate = nil;
         _tvTimelineSyncer= nil;
         _syncTimeline= nil;
@@ -1076,7 +1107,7 @@ dispatch_source_t CreateDispatchTimer(uint64_t interval,
 
 
 //------------------------------------------------------------------------------
-#pragma mark - KVO for WallClock and TVTimeline
+#pragma mark - KVO for WallClock
 //------------------------------------------------------------------------------
 
 - (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary<NSString *,id> *)change context:(void *)context
@@ -1093,35 +1124,38 @@ dispatch_source_t CreateDispatchTimer(uint64_t interval,
             
         } // end if
     }
-    else if (context == TVTimelineContext) {
-        
-        // ----- SyncTimeline clock KVO ------
-        if ([keyPath isEqualToString:kTickRateKey])
-        {
-            // do nothing
-            
-        }else if ([keyPath isEqualToString:kSpeedKey])
-        {
-            [self syncTimeline:self.syncTimeline SpeedDidChange:[[change objectForKey:@"new"] floatValue]];
-            
-        }else if([keyPath isEqualToString:kCorrelationKey]) {
-           
-            Correlation newCorel;
-            id newobj = [change objectForKey:@"new"];
-            if ([newobj isKindOfClass:[NSValue class]])
-            {
-               [newobj getValue:&newCorel];
-                [self syncTimeline:self.syncTimeline CorrelationDidChange:&newCorel];
-            }
+}
 
-        }else if ([keyPath isEqualToString:kAvailableKey]) {
-            
-            // 4. If SyncTimeline is available, start timeline synchronisation
-            BOOL oldTVTimelineAvailable = [[change objectForKey:@"old"]boolValue];
-            BOOL newTVTimelineAvailable = [[change objectForKey:@"new"]boolValue];
-            
-            [self syncTimeline:self.syncTimeline AvailabilityDidChangeFrom:oldTVTimelineAvailable To:newTVTimelineAvailable];
-        }
+//------------------------------------------------------------------------------
+#pragma mark - ClockChangeListener methods
+//------------------------------------------------------------------------------
+
+- (void) clock:(ClockBase*) clock didChange:(ClockChangeFlags) changes
+{
+    // ----- SyncTimeline clock changes ------
+    if (clock != self.syncTimeline)
+        return;
+    
+    if (changes & ClockChangeSpeed)
+    {
+        [self syncTimeline:self.syncTimeline SpeedDidChange:self.syncTimeline.effectiveSpeed];
+    }
+    
+    if (changes & ClockChangeCorrelation)
+    {
+        Correlation newCorel = self.syncTimeline.correlation;
+        [self syncTimeline:self.syncTimeline CorrelationDidChange:&newCorel];
+    }
+    
+    if (changes & ClockChangeAvailability)
+    {
+        // 4. If SyncTimeline is available, start timeline synchronisation
+        BOOL oldTVTimelineAvailable = syncTimelineAvailable;
+        BOOL newTVTimelineAvailable = self.syncTimeline.available;
+        
+        syncTimelineAvailable = newTVTimelineAvailable;
+        
+        [self syncTimeline:self.syncTimeline AvailabilityDidChangeFrom:oldTVTimelineAvailable To:newTVTimelineAvailable];
     }
 }
 
@@ -1133,6 +1167,8 @@ dispatch_source_t CreateDispatchTimer(uint64_t interval,
     // ---- 4. WallClock is available, start timeline synchronisation -----
     // only start timeline sync when wallclock is in sync
     if (availability){
+        [_startupTimings mark:StartupStageWallClockAvailable];
+        
         if (!_tvTimelineSyncer)
             [self startTimelineSync];
         
@@ -1188,17 +1224,23 @@ AvailabilityDidChangeFrom:(BOOL) oldAvailability
     
     if (newAvailability){
         
+        [_startupTimings mark:StartupStageTimelineAvailable];
+        
         self.state = SyncTimelineAvailable;
         
-        // --- for every media player or web view, start a Sync Controller object ---
-        for (id obj in _mediaPlayerObjectList)
+        // only the first start-up prerolls; after that (e.g. a CSS-TS reconnect or a null contentTime),
+        // the players keep playing and their Sync Controllers pick up the timeline again
+        if ((_startupMode == SynchroniserStartupPipelined) && ![_startupTimings reached:StartupStageSyncStarted])
         {
-            [self setUpSyncController:(MediaPlayerObject*) obj
-                         SyncTimeline:self.syncTimeline
-                      AndSyncInterval:kDefaultResyncInterval];
-        } // end for
+            // --- preroll the media players, then start a Sync Controller for each ---
+            [self startPreroll];
+        }else
+        {
+            [self setUpSyncControllers];
+        }
     }else
     {
+         [self cancelPreroll];
          self.state = SyncTimelineUnavailable;
         // TODO: Handle Synchronisation Timeline becoming unavailable
         // SyncController objects are already handling Synchronisation Timeline availability changes via KVO
@@ -1206,6 +1248,97 @@ AvailabilityDidChangeFrom:(BOOL) oldAvailability
     }
 }
 
+//------------------------------------------------------------------------------
+#pragma mark - Start-up private methods
+//------------------------------------------------------------------------------
+
+/**
+ *  For every media player or web view, start a Sync Controller object
+ */
+- (void) setUpSyncControllers
+{
+    for (id obj in _mediaPlayerObjectList)
+    {
+        [self setUpSyncController:(MediaPlayerObject*) obj
+                     SyncTimeline:self.syncTimeline
+                  AndSyncInterval:kDefaultResyncInterval];
+    } // end for
+    
+    if ([_startupTimings mark:StartupStageSyncStarted])
+        [self reportStartupTimings];
+}
+
+//------------------------------------------------------------------------------
+
+/**
+ *  Pipelined start-up: wait for the WallClock and the Synchronisation Timeline, preroll the
+ *  media players at their predicted positions and start them, then set up their Sync Controllers
+ */
+- (void) startPreroll
+{
+    __weak Synchroniser *weakSelf = self;
+    
+    dispatch_async(dispatch_get_main_queue(), ^{
+        
+        Synchroniser *synchroniser = weakSelf;
+        PrerollScheduler *scheduler;
+        
+        if ((synchroniser == nil) || (synchroniser.syncTimeline == nil)) return;
+        
+        [synchroniser cancelPreroll];
+        
+        scheduler = [[PrerollScheduler alloc] initWithWallClock:synchroniser.wallclock
+                                                   SyncTimeline:synchroniser.syncTimeline
+                                                        Timings:synchroniser.startupTimings];
+        scheduler.dispersionThreshold = synchroniser.syncThreshold;
+        synchroniser->prerollScheduler = scheduler;
+        
+        [scheduler startWithMediaObjects:synchroniser.mediaPlayerObjectList Completion:^{
+            
+            Synchroniser *strongSelf = weakSelf;
+            
+            if (strongSelf == nil) return;
+            
+            strongSelf->prerollScheduler = nil;
+            [strongSelf setUpSyncControllers];
+        }];
+    });
+}
+
+//------------------------------------------------------------------------------
+
+- (void) cancelPreroll
+{
+    // the scheduler runs on the main queue
+    if (![NSThread isMainThread])
+    {
+        __weak Synchroniser *weakSelf = self;
+        
+        dispatch_async(dispatch_get_main_queue(), ^{ [weakSelf cancelPreroll]; });
+        return;
+    }
+    
+    [prerollScheduler cancel];
+    prerollScheduler = nil;
+}
+
+//------------------------------------------------------------------------------
+
+- (void) reportStartupTimings
+{
+    MWLogInfo(@"Synchroniser: start-up took %@", [_startupTimings breakdown]);
+    
+    __weak Synchroniser *weakSelf = self;
+    
+    dispatch_async(dispatch_get_main_queue(), ^{
+        
+        id<SynchroniserDelegate> delegate = weakSelf.delegate;
+        
+        if ([delegate respondsToSelector:@selector(Synchroniser:DidStartSyncWithTimings:)])
+            [delegate Synchroniser:weakSelf DidStartSyncWithTimings:weakSelf.startupTimings];
+    });
+}
+
 //------------------------------------------------------------------------------
 #pragma mark - Notify Observers methods
 //------------------------------------------------------------------------------
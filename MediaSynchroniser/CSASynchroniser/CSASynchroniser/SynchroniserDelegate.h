@@ -18,6 +18,7 @@
 #import <CIIProtocolClient/CIIProtocolClient.h>
 
 @class Synchroniser;
+@class StartupTimings;
 //------------------------------------------------------------------------------
 #pragma mark - Data Structures
 //------------------------------------------------------------------------------
@@ -160,6 +161,19 @@ typedef NS_ENUM(NSUInteger, SynchroniserState)
 
 //------------------------------------------------------------------------------
 
+@optional
+
+/**
+ *  Reports how long each stage of start-up took, once the media players have first been
+ *  started in sync.
+ *
+ *  @param synchroniser the synchroniser object overseeing DVB-CSS synchronisation
+ *  @param timings      start-up stage timings
+ */
+- (void) Synchroniser: (Synchroniser*) synchroniser DidStartSyncWithTimings:(StartupTimings*) timings;
+
+//------------------------------------------------------------------------------
+
 
 
 
@@ -0,0 +1,66 @@
+//
+//  StartupTimingsTests.m
+//  CSASynchroniserTests
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+#import <CSASynchroniser/CSASynchroniser.h>
+
+@interface StartupTimingsTests : XCTestCase
+
+@end
+
+@implementation StartupTimingsTests
+
+
+- (void) pause:(NSTimeInterval) secs
+{
+    [NSThread sleepForTimeInterval:secs];
+}
+
+
+- (void)testStagesAreRecordedOnce {
+    StartupTimings *timings = [[StartupTimings alloc] init];
+
+    XCTAssertFalse([timings reached:StartupStageEnabled]);
+    XCTAssertLessThan([timings timeOfStage:StartupStageCIIReceived], 0);
+
+    XCTAssertTrue([timings mark:StartupStageEnabled]);
+    [self pause:0.05];
+    XCTAssertTrue([timings mark:StartupStageCIIReceived]);
+    [self pause:0.05];
+    XCTAssertFalse([timings mark:StartupStageCIIReceived], @"only the first time counts");
+
+    XCTAssertEqualWithAccuracy([timings timeOfStage:StartupStageCIIReceived], 0.05, 0.03);
+    XCTAssertEqualWithAccuracy([timings durationOfStage:StartupStageCIIReceived], 0.05, 0.03);
+    XCTAssertLessThan([timings durationOfStage:StartupStageSyncStarted], 0);
+
+    [timings reset];
+    XCTAssertFalse([timings reached:StartupStageCIIReceived]);
+}
+
+
+- (void)testParallelStagesAreMeasuredFromTheLatestCompleted {
+    StartupTimings *timings = [[StartupTimings alloc] init];
+
+    [timings mark:StartupStageEnabled];
+    [timings mark:StartupStageCIIReceived];
+    [self pause:0.05];
+    [timings mark:StartupStageTimelineAvailable];      // the first Control Timestamp beats the WallClock
+    [self pause:0.1];
+    [timings mark:StartupStageWallClockAvailable];
+    [self pause:0.05];
+    [timings mark:StartupStagePrerolled];
+
+    XCTAssertEqualWithAccuracy([timings durationOfStage:StartupStageTimelineAvailable], 0.05, 0.03);
+    XCTAssertEqualWithAccuracy([timings durationOfStage:StartupStageWallClockAvailable], 0.15, 0.03);
+    XCTAssertEqualWithAccuracy([timings durationOfStage:StartupStagePrerolled], 0.05, 0.03, @"measured from the WallClock, the later of the two");
+
+    XCTAssertTrue([[timings breakdown] hasPrefix:@"CII +"]);
+}
+
+@end
@@ -80,7 +80,7 @@ FOUNDATION_EXPORT NSString* const  kAudioSyncControllerResyncNotification;
  *  2. Generalise component to synchronise media player timelines instead of actual players. Players will respond to changes in their timelines.
  */
 
-@interface AudioSyncController : NSObject
+@interface AudioSyncController : NSObject <ClockChangeListener>
 
 
 //------------------------------------------------------------------------------
@@ -47,7 +47,6 @@ NSTimeInterval const kAudioRateAdaptionPeriodThreshold   = 10.0;
 //------------------------------------------------------------------------------
 
 static void *AudioSyncControllerContext         = &AudioSyncControllerContext;
-static void *AudioObjectTimelineContext         = &AudioObjectTimelineContext;
 
 
 //------------------------------------------------------------------------------
@@ -145,7 +144,7 @@ NSString* const  kAudioSyncControllerResyncNotification     =   @"AudioSyncContr
                                                                 Correlation:correlation];
         
         // register this controller to listen to changes to this clock (availability,
-        [_mediaObjectTimeline addObserver:self context:AudioObjectTimelineContext ];
+        [_mediaObjectTimeline addChangeListener:self];
         
         _mediaObjectTimeline.available = _syncTimeline.available;
         
@@ -292,7 +291,7 @@ NSString* const  kAudioSyncControllerResyncNotification     =   @"AudioSyncContr
     self.delegate = nil;
 
     // unregister this object as an observer of the mediaObjectTimeline
-    [_mediaObjectTimeline removeObserver:self Context:AudioObjectTimelineContext];
+    [_mediaObjectTimeline removeChangeListener:self];
     
     MWLogDebug(@"AudioSyncController for media player object %@ stopped.", _audioPlayer.audioFile.url.absoluteString);
     self.audioPlayer = nil;
@@ -317,61 +316,46 @@ NSString* const  kAudioSyncControllerResyncNotification     =   @"AudioSyncContr
 //------------------------------------------------------------------------------
 
 //------------------------------------------------------------------------------
-#pragma mark - KVO for WallClock and TVTimeline
+#pragma mark - ClockChangeListener methods
 //------------------------------------------------------------------------------
 
-- (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary<NSString *,id> *)change context:(void *)context
+- (void) clock:(ClockBase*) clock didChange:(ClockChangeFlags) changes
 {
-    if (context == AudioObjectTimelineContext) {
+    if (changes & ClockChangeAvailability) {
         
+        BOOL newAvailable = clock.available;
         
-        if ([keyPath isEqualToString:kTickRateKey]) {
-            
-            
-        }else if ([keyPath isEqualToString:kSpeedKey]) {
-            
-            NSLog(@"AudioSyncController: media object timeline speed changed.");
-            
-            // set the speed
-            //            float oldSpeed = [[change objectForKey:@"old"] floatValue];
-            //            float newSpeed = [[change objectForKey:@"new"] floatValue];
-            
-            // trigger a resync with speed == 0.0
-            
-            if (self.state == AudioSyncCrtlRunning) [self ReSync];
-            
-        }else if([keyPath isEqualToString:kCorrelationKey]) {
-            NSLog(@"AudioSyncController: media object timeline correlation changed.");
-            
-            // trigger a resync
-            if (self.state == AudioSyncCrtlRunning) [self ReSync];
-            
-            
-            
-            
-        }else if ([keyPath isEqualToString:kAvailableKey]) {
-            
-            BOOL oldAvailable = [[change objectForKey:@"old"]boolValue];
-            BOOL newAvailable = [[change objectForKey:@"new"]boolValue];
-            
-            NSString *msg = [NSString stringWithFormat:@"changed from %d to %d", oldAvailable, newAvailable];
-            
-            NSLog(@"AudioSyncController: media object timeline availability  %@", msg);
-            
-            // if available == true AND VideoPlayerSyncController is not sync'ing, start resync
+        NSLog(@"AudioSyncController: media object timeline availability changed to %d", newAvailable);
+        
+        // if available == true AND AudioSyncController is not sync'ing, start resync
+        
+        if ((newAvailable) && ((_state == AudioSyncCrtlInitialised) || (_state == AudioSyncCrtlSyncTimelineUnavailable)))
+        {
+            self.state = AudioSyncCrtlSyncTimelineAvailable;
             
-            if ((newAvailable) && ((_state == AudioSyncCrtlInitialised) || (_state == AudioSyncCrtlSyncTimelineUnavailable)))
-            {
-                self.state = AudioSyncCrtlSyncTimelineAvailable;
-                
-                [self start];
-            }else if ((!newAvailable) && ((_state == AudioSyncCrtlRunning) || (_state == AudioSyncCrtlSynchronising)))
-            {
-                [self suspend];
-            }
+            [self start];
+            return;
+        }else if ((!newAvailable) && ((_state == AudioSyncCrtlRunning) || (_state == AudioSyncCrtlSynchronising)))
+        {
+            [self suspend];
+            return;
         }
     }
     
+    // a correlation and speed change made together (e.g. by a new Control Timestamp) needs a single resync
+    if (changes & ClockChangeSpeed) {
+        
+        NSLog(@"AudioSyncController: media object timeline speed changed.");
+        
+        if (self.state == AudioSyncCrtlRunning) [self ReSync];
+        
+    }else if (changes & ClockChangeCorrelation) {
+        
+        NSLog(@"AudioSyncController: media object timeline correlation changed.");
+        
+        // trigger a resync
+        if (self.state == AudioSyncCrtlRunning) [self ReSync];
+    }
 }
 
 
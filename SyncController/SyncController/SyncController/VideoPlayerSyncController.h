@@ -75,7 +75,7 @@ FOUNDATION_EXPORT NSString* const  kVideoSyncControllerResyncNotification;
  *  1. Allow for different playback adaptation algorithms e.g. QoE-aware algo to be plugged in at configuration time
  *  2. Generalise component to synchronise media player timelines instead of actual players. Players will respond to changes in their timelines.
  */
-@interface VideoPlayerSyncController : NSObject
+@interface VideoPlayerSyncController : NSObject <ClockChangeListener>
 
 
 //------------------------------------------------------------------------------
@@ -45,7 +45,6 @@ NSTimeInterval const kRateAdaptionPeriodThreshold   = 10.0;
 //------------------------------------------------------------------------------
 
 static void *SyncControllerContext          = &SyncControllerContext;
-static void *MediaObjectTimelineContext     = &MediaObjectTimelineContext;
 //------------------------------------------------------------------------------
 #pragma mark - Notifications
 //------------------------------------------------------------------------------
@@ -138,7 +137,7 @@ NSString* const  kVideoSyncControllerResyncNotification     =   @"VideoSyncContr
                                                                   Correlation:correlation];
         
         // register this controller to listen to changes to this clock (availability,
-        [_mediaObjectTimeline addObserver:self context:MediaObjectTimelineContext ];
+        [_mediaObjectTimeline addChangeListener:self];
         
        
             
@@ -284,7 +283,7 @@ NSString* const  kVideoSyncControllerResyncNotification     =   @"VideoSyncContr
     self.delegate = nil;
     
     // unregister this object as an observer of the mediaObjectTimeline 
-    [_mediaObjectTimeline removeObserver:self Context:MediaObjectTimelineContext];
+    [_mediaObjectTimeline removeChangeListener:self];
      MWLogDebug(@"VideoPlayerSyncController for player %@ stopped.", [_videoPlayer.videoURL absoluteString]);
     self.videoPlayer = nil;
     
@@ -315,61 +314,46 @@ NSString* const  kVideoSyncControllerResyncNotification     =   @"VideoSyncContr
 //------------------------------------------------------------------------------
 
 //------------------------------------------------------------------------------
-#pragma mark - KVO for WallClock and TVTimeline
+#pragma mark - ClockChangeListener methods
 //------------------------------------------------------------------------------
 
-- (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary<NSString *,id> *)change context:(void *)context
+- (void) clock:(ClockBase*) clock didChange:(ClockChangeFlags) changes
 {
-    if (context == MediaObjectTimelineContext) {
-       
+    if (changes & ClockChangeAvailability) {
         
-        if ([keyPath isEqualToString:kTickRateKey]) {
-            
-            
-        }else if ([keyPath isEqualToString:kSpeedKey]) {
-            
-            NSLog(@"VideoPlayerSyncController: media object timeline speed changed.");
-            
-            // set the speed
-//            float oldSpeed = [[change objectForKey:@"old"] floatValue];
-//            float newSpeed = [[change objectForKey:@"new"] floatValue];
-            
-            // trigger a resync with speed == 0.0
-            
-           [self ReSync];
-            
-        }else if([keyPath isEqualToString:kCorrelationKey]) {
-            NSLog(@"VideoPlayerSyncController: media object timeline correlation changed.");
-            
-            // trigger a resync
-            if (self.state == VideoSyncCrtlRunning) [self ReSync];
-            
-            
-            
-            
-        }else if ([keyPath isEqualToString:kAvailableKey]) {
-            
-            BOOL oldAvailable = [[change objectForKey:@"old"]boolValue];
-            BOOL newAvailable = [[change objectForKey:@"new"]boolValue];
-            
-            NSString *msg = [NSString stringWithFormat:@"changed from %d to %d", oldAvailable, newAvailable];
-            
-            NSLog(@"VideoPlayerSyncController: media object timeline availability  %@", msg);
-            
-            // if available == true AND VideoPlayerSyncController is not sync'ing, start resync
+        BOOL newAvailable = clock.available;
+        
+        NSLog(@"VideoPlayerSyncController: media object timeline availability changed to %d", newAvailable);
+        
+        // if available == true AND VideoPlayerSyncController is not sync'ing, start resync
+        
+        if ((newAvailable) && ((_state == VideoSyncCrtlInitialised) || (_state == VideoSyncCrtlSyncTimelineUnavailable)))
+        {
+            self.state = VideoSyncCrtlSyncTimelineAvailable;
             
-            if ((newAvailable) && ((_state == VideoSyncCrtlInitialised) || (_state == VideoSyncCrtlSyncTimelineUnavailable)))
-            {
-                self.state = VideoSyncCrtlSyncTimelineAvailable;
-                
-                [self start];
-            }else if ((!newAvailable) && ((_state == VideoSyncCrtlRunning) || (_state == VideoSyncCrtlSynchronising)))
-            {
-                [self suspend];
-            }
+            [self start];
+            return;
+        }else if ((!newAvailable) && ((_state == VideoSyncCrtlRunning) || (_state == VideoSyncCrtlSynchronising)))
+        {
+            [self suspend];
+            return;
         }
     }
     
+    // a correlation and speed change made together (e.g. by a new Control Timestamp) needs a single resync
+    if (changes & ClockChangeSpeed) {
+        
+        NSLog(@"VideoPlayerSyncController: media object timeline speed changed.");
+        
+        [self ReSync];
+        
+    }else if (changes & ClockChangeCorrelation) {
+        
+        NSLog(@"VideoPlayerSyncController: media object timeline correlation changed.");
+        
+        // trigger a resync
+        if (self.state == VideoSyncCrtlRunning) [self ReSync];
+    }
 }
 
 
@@ -423,10 +407,10 @@ NSString* const  kVideoSyncControllerResyncNotification     =   @"VideoSyncContr
             
             NSLog(@"VideoPlayerSyncController resync(): jitter in ms: %f", jitterMs);
             
-            if ((fabs(jitterMs) > _reSyncJitterThreshold) || (_mediaObjectTimeline.speed != self.videoPlayer.rate))
+            if ((fabs(jitterMs) > _reSyncJitterThreshold) || (_mediaObjectTimeline.effectiveSpeed != self.videoPlayer.rate))
             {
                 if (!_httpStreaming){
-                    [self.videoPlayer setRate:_mediaObjectTimeline.speed
+                    [self.videoPlayer setRate:_mediaObjectTimeline.effectiveSpeed
                                          time: expectedVideoTimeNanos
                                    atHostTime:expectedVideoHostTimeNanos];
                 }else
@@ -65,7 +65,7 @@ FOUNDATION_EXPORT NSString* const  kWebSyncControllerResyncNotification;
 /**
  *  A class to send timestamps reporting progress of a TV programme to a web view.
  */
-@interface WebViewSyncController : NSObject <InvocationProcessor>
+@interface WebViewSyncController : NSObject <InvocationProcessor, ClockChangeListener>
 
 //------------------------------------------------------------------------------
 #pragma mark - Properties
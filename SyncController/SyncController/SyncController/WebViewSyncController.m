@@ -40,7 +40,6 @@ NSTimeInterval const kWebReSyncIntervalDefault  = 1.0;
 //------------------------------------------------------------------------------
 
 static void *WebSyncControllerContext         = &WebSyncControllerContext;
-static void *WebObjectTimelineContext         = &WebObjectTimelineContext;
 
 
 //------------------------------------------------------------------------------
@@ -144,7 +143,7 @@ NSString* const  kWebSyncControllerResyncNotification     =   @"WebSyncControlle
                                                                 Correlation:correlation];
         
         // register this controller to listen to changes to this clock (availability,
-        [_programmeTimeline addObserver:self context:WebObjectTimelineContext ];
+        [_programmeTimeline addChangeListener:self];
         
         _programmeTimeline.available = _syncTimeline.available;
         
@@ -302,7 +301,7 @@ NSString* const  kWebSyncControllerResyncNotification     =   @"WebSyncControlle
     
     
     // unregister the media Object Timeline clock as an observer of the synctimeline clock
-    [_programmeTimeline removeObserver:self Context:WebObjectTimelineContext];
+    [_programmeTimeline removeChangeListener:self];
     
     
     self.state = WebSyncCrtlStopped;
@@ -346,59 +345,46 @@ NSString* const  kWebSyncControllerResyncNotification     =   @"WebSyncControlle
 //------------------------------------------------------------------------------
 
 //------------------------------------------------------------------------------
-#pragma mark - KVO for WallClock and TVTimeline
+#pragma mark - ClockChangeListener methods
 //------------------------------------------------------------------------------
 
-- (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary<NSString *,id> *)change context:(void *)context
+- (void) clock:(ClockBase*) clock didChange:(ClockChangeFlags) changes
 {
-    if (context == WebObjectTimelineContext) {
+    if (changes & ClockChangeAvailability) {
         
+        BOOL newAvailable = clock.available;
         
-        if ([keyPath isEqualToString:kTickRateKey]) {
-            
-            
-        }else if ([keyPath isEqualToString:kSpeedKey]) {
-            
-            NSLog(@"WebViewSyncController: media object timeline speed changed.");
-            
-            // set the speed
-            //            float oldSpeed = [[change objectForKey:@"old"] floatValue];
-            //            float newSpeed = [[change objectForKey:@"new"] floatValue];
-            
-            // trigger a resync with speed == 0.0
-            
-            if (self.state == WebSyncCrtlRunning) [self ReSync];
-            
-        }else if([keyPath isEqualToString:kCorrelationKey]) {
-            NSLog(@"WebViewSyncController: media object timeline correlation changed.");
-            
-            // trigger a resync
-            if (self.state == WebSyncCrtlRunning) [self ReSync];
-            
-          
-        }else if ([keyPath isEqualToString:kAvailableKey]) {
-            
-            BOOL oldAvailable = [[change objectForKey:@"old"]boolValue];
-            BOOL newAvailable = [[change objectForKey:@"new"]boolValue];
-            
-            NSString *msg = [NSString stringWithFormat:@"changed from %d to %d", oldAvailable, newAvailable];
-            
-            NSLog(@"WebViewSyncController: media object timeline availability  %@", msg);
-            
-            // if available == true AND VideoPlayerSyncController is not sync'ing, start resync
+        NSLog(@"WebViewSyncController: media object timeline availability changed to %d", newAvailable);
+        
+        // if available == true AND WebViewSyncController is not sync'ing, start resync
+        
+        if ((newAvailable) && ((_state == WebSyncCrtlInitialised) || (_state == WebSyncCrtlSyncTimelineUnavailable)))
+        {
+            self.state = WebSyncCrtlSyncTimelineAvailable;
             
-            if ((newAvailable) && ((_state == WebSyncCrtlInitialised) || (_state == WebSyncCrtlSyncTimelineUnavailable)))
-            {
-                self.state = WebSyncCrtlSyncTimelineAvailable;
-                
-                [self start];
-            }else if ((!newAvailable) && ((_state == WebSyncCrtlRunning) || (_state == WebSyncCrtlSynchronising)))
-            {
-                [self suspend];
-            }
+            [self start];
+            return;
+        }else if ((!newAvailable) && ((_state == WebSyncCrtlRunning) || (_state == WebSyncCrtlSynchronising)))
+        {
+            [self suspend];
+            return;
         }
     }
     
+    // a correlation and speed change made together (e.g. by a new Control Timestamp) needs a single resync
+    if (changes & ClockChangeSpeed) {
+        
+        NSLog(@"WebViewSyncController: media object timeline speed changed.");
+        
+        if (self.state == WebSyncCrtlRunning) [self ReSync];
+        
+    }else if (changes & ClockChangeCorrelation) {
+        
+        NSLog(@"WebViewSyncController: media object timeline correlation changed.");
+        
+        // trigger a resync
+        if (self.state == WebSyncCrtlRunning) [self ReSync];
+    }
 }
 
 
@@ -433,7 +419,7 @@ NSString* const  kWebSyncControllerResyncNotification     =   @"WebSyncControlle
         
         [paramsDict setObject:[NSNumber numberWithDouble:programmeTimeNowSecs]
                        forKey:@"contentTime"];
-        [paramsDict setObject:[NSNumber numberWithFloat:self.programmeTimeline.speed]
+        [paramsDict setObject:[NSNumber numberWithFloat:self.programmeTimeline.effectiveSpeed]
                        forKey:@"timespeedMultiplier"];
         
 //        MWLogDebug(@"WebViewSyncController:  ContentTime: %@", [paramsDict objectForKey:@"contentTime"]);
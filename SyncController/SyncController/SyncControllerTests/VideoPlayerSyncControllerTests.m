@@ -0,0 +1,91 @@
+//
+//  VideoPlayerSyncControllerTests.m
+//  SyncControllerTests
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright © 2016 BBC RD. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <ClockTimelines/ClockTimelines.h>
+#import <VideoPlayer/VideoPlayer.h>
+#import <SyncController/SyncController.h>
+
+/**
+ *  A video player that records the rate changes requested by its SyncController
+ */
+@interface StubVideoPlayer : VideoPlayerViewController
+
+@property (nonatomic) float stubRate;
+@property (nonatomic) NSUInteger setRateCount;
+
+@end
+
+@implementation StubVideoPlayer
+
+- (float) rate
+{
+    return _stubRate;
+}
+
+- (NSTimeInterval) currentTime
+{
+    return 0.0;
+}
+
+- (void) setRate: (float)rate time:(Float64)itemTime atHostTime:(Float64)hostClockTime
+{
+    _setRateCount++;
+    _stubRate = rate;
+}
+
+@end
+
+
+@interface VideoPlayerSyncControllerTests : XCTestCase
+
+@end
+
+@implementation VideoPlayerSyncControllerTests
+{
+    SystemClock *sysCLK;
+    CorrelatedClock *tvTimeline;
+    StubVideoPlayer *player;
+}
+
+- (void)setUp {
+    [super setUp];
+
+    sysCLK = [[SystemClock alloc] initWithTickRate:1000000000];
+
+    Correlation corel = [CorrelationFactory create:0 Correlation:0];
+    tvTimeline = [[CorrelatedClock alloc] initWithParentClock:sysCLK TickRate:1000 Correlation:&corel];
+
+    player = [[StubVideoPlayer alloc] initWithNibName:nil bundle:nil];
+    player.stubRate = 1.0;
+}
+
+- (void)tearDown {
+    [super tearDown];
+}
+
+
+- (void) testPausedTimelinePausesPlayer
+{
+    Correlation corel = [CorrelationFactory create:0 Correlation:0];
+    VideoPlayerSyncController *controller = [[VideoPlayerSyncController alloc] initWithVideoPlayer:player
+                                                                                         Timeline:tvTimeline
+                                                                             CorrelationTimestamp:&corel
+                                                                                   ReSyncInterval:1.0];
+
+    tvTimeline.speed = 0.0;
+
+    // the media object timeline follows the TV timeline's speed without taking it as its own
+    XCTAssertEqual(controller.mediaObjectTimeline.speed, 1.0);
+    XCTAssertEqual(controller.mediaObjectTimeline.effectiveSpeed, 0.0);
+
+    XCTAssertEqual(player.setRateCount, 1);
+    XCTAssertEqual(player.rate, 0.0);
+}
+
+@end
@@ -45,7 +45,9 @@
         node = first;
         first = first.next;
         
-        free((__bridge void *)(node));
+        // unlink rather than free(): the nodes are ARC objects, released with their last
+        // reference; unlinking one at a time avoids a recursive release down a long list
+        node.next = nil;
     }
     
     first = nil;
@@ -96,6 +98,7 @@
     }
     node  = first;
     first = first.next;
+    node.next = nil;
     
     if (first == nil) {
         last = nil; //Empty queue
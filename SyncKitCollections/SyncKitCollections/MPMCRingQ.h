@@ -0,0 +1,72 @@
+//
+//  MPMCRingQ.h
+//  SyncKitCollections
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+/**
+ *  A bounded, lock-free queue for any number of producer and consumer threads.
+ *
+ *  Each slot of the ring carries a sequence number that tells producers and consumers whether
+ *  it is free or full for their turn around the ring; a thread claims a slot with one
+ *  compare-and-swap on the shared index. Neither put: nor poll blocks: a full queue refuses
+ *  objects and an empty one returns nil.
+ */
+@interface MPMCRingQ<ObjectType> : NSObject
+
+/**
+ *  Number of objects the queue can hold
+ */
+@property (nonatomic, readonly) NSUInteger capacity;
+
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Initialise the queue
+ *
+ *  @param capacity - number of objects the queue can hold; rounded up to a power of two
+ *
+ *  @return ring queue instance
+ */
+- (instancetype) initWithCapacity:(NSUInteger) capacity;
+
+/**
+ *  Add an object at the tail of the queue. Thread-safe.
+ *
+ *  @param obj - object to queue; retained until it is taken
+ *
+ *  @return NO if the queue is full, in which case the object is not queued
+ */
+- (BOOL) put:(ObjectType) obj;
+
+/**
+ *  Remove the object at the head of the queue, without waiting. Thread-safe.
+ *
+ *  @return the object, or nil if the queue is empty
+ */
+- (ObjectType) poll;
+
+/**
+ *  Number of objects in the queue; approximate while other threads put or poll
+ */
+- (NSUInteger) count;
+
+@end
@@ -0,0 +1,167 @@
+//
+//  MPMCRingQ.m
+//  SyncKitCollections
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "MPMCRingQ.h"
+#import <stdatomic.h>
+
+// keeps the producers' and consumers' indices on separate cache lines
+#define MPMCRINGQ_CACHE_LINE 64
+
+
+/**
+ *  A slot of the ring. A slot at position pos is free for the producer of pos when
+ *  sequence == pos, and full for the consumer of pos when sequence == pos + 1.
+ */
+typedef struct {
+    atomic_size_t   sequence;
+    void            *obj;           // retained object, bridged out of ARC
+} MPMCRingSlot;
+
+
+@implementation MPMCRingQ
+{
+    MPMCRingSlot        *slots;
+    NSUInteger          mask;
+
+    char                pad0[MPMCRINGQ_CACHE_LINE];
+    atomic_size_t       tail;           // next position to put
+    char                pad1[MPMCRINGQ_CACHE_LINE];
+    atomic_size_t       head;           // next position to take
+    char                pad2[MPMCRINGQ_CACHE_LINE];
+}
+
+
+- (instancetype) initWithCapacity:(NSUInteger) capacity
+{
+    NSUInteger i;
+
+    self = [super init];
+    if (self != nil) {
+        // at least two slots: with one, a full slot (pos + 1) looks free for the next lap
+        _capacity = 2;
+        while (_capacity < capacity) _capacity <<= 1;
+        mask = _capacity - 1;
+
+        slots = calloc(_capacity, sizeof(MPMCRingSlot));
+        if (slots == NULL) return nil;
+
+        for (i = 0; i < _capacity; i++)
+            atomic_init(&slots[i].sequence, i);
+
+        atomic_init(&tail, 0);
+        atomic_init(&head, 0);
+    }
+    return self;
+}
+
+
+- (void) dealloc
+{
+    // release objects that were never taken
+    while ([self poll] != nil);
+
+    free(slots);
+}
+
+
+- (BOOL) put:(id) obj
+{
+    size_t pos = atomic_load_explicit(&tail, memory_order_relaxed);
+    MPMCRingSlot *slot;
+
+    assert(obj != nil);
+
+    for (;;)
+    {
+        slot = &slots[pos & mask];
+        intptr_t diff = (intptr_t) atomic_load_explicit(&slot->sequence, memory_order_acquire) - (intptr_t) pos;
+
+        if (diff == 0)
+        {
+            // free for this lap: claim it (a failed claim reloads pos)
+            if (atomic_compare_exchange_weak_explicit(&tail, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            // still holds the object put a lap ago
+            return NO;
+        }
+        else
+        {
+            // another producer claimed it
+            pos = atomic_load_explicit(&tail, memory_order_relaxed);
+        }
+    }
+
+    slot->obj = (void *) CFBridgingRetain(obj);
+    atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+
+    return YES;
+}
+
+
+- (id) poll
+{
+    size_t pos = atomic_load_explicit(&head, memory_order_relaxed);
+    MPMCRingSlot *slot;
+    void *obj;
+
+    for (;;)
+    {
+        slot = &slots[pos & mask];
+        intptr_t diff = (intptr_t) atomic_load_explicit(&slot->sequence, memory_order_acquire) - (intptr_t) (pos + 1);
+
+        if (diff == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&head, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            // not yet put
+            return nil;
+        }
+        else
+        {
+            pos = atomic_load_explicit(&head, memory_order_relaxed);
+        }
+    }
+
+    obj = slot->obj;
+    slot->obj = NULL;
+
+    // free for the producer of the next lap
+    atomic_store_explicit(&slot->sequence, pos + _capacity, memory_order_release);
+
+    return CFBridgingRelease(obj);
+}
+
+
+- (NSUInteger) count
+{
+    size_t h = atomic_load_explicit(&head, memory_order_relaxed);
+    size_t t = atomic_load_explicit(&tail, memory_order_relaxed);
+
+    return (t > h) ? MIN(t - h, _capacity) : 0;
+}
+
+@end
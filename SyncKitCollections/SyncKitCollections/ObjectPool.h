@@ -0,0 +1,86 @@
+//
+//  ObjectPool.h
+//  SyncKitCollections
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+/**
+ *  A thread-safe pool of reusable objects of one type, for objects made and discarded at a high
+ *  rate, such as per-message records.
+ *
+ *  acquire hands out a pooled object if there is one, or makes a new one with the factory block.
+ *  An object given back with recycle: is reset and kept for the next acquire; if the pool is
+ *  full it is released instead. The free objects are held in an MPMCRingQ, so acquire and
+ *  recycle: do not lock.
+ *
+ *  The pool does not track the objects it hands out: an object that is never recycled is simply
+ *  released by ARC, and one must not be recycled while it is still in use elsewhere.
+ */
+@interface ObjectPool<ObjectType> : NSObject
+
+/**
+ *  Most free objects the pool keeps
+ */
+@property (nonatomic, readonly) NSUInteger capacity;
+
+/**
+ *  Called on an object as it is recycled, to clear its state. Optional; set before the pool
+ *  is shared between threads.
+ */
+@property (nonatomic, copy) void (^reset)(ObjectType obj);
+
+/**
+ *  Number of objects made by the factory block
+ */
+@property (nonatomic, readonly) uint64_t created;
+
+/**
+ *  Number of acquires served from the pool
+ */
+@property (nonatomic, readonly) uint64_t reused;
+
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Initialise an empty pool
+ *
+ *  @param capacity - most free objects to keep
+ *  @param factory  - makes a new object when the pool is empty
+ *
+ *  @return object pool instance
+ */
+- (instancetype) initWithCapacity:(NSUInteger) capacity Factory:(ObjectType (^)(void)) factory;
+
+/**
+ *  Get an object: a pooled one if available, otherwise a new one from the factory block
+ *
+ *  @return an object
+ */
+- (ObjectType) acquire;
+
+/**
+ *  Give an object back to the pool
+ *
+ *  @param obj - an object no longer in use
+ */
+- (void) recycle:(ObjectType) obj;
+
+@end
@@ -0,0 +1,91 @@
+//
+//  ObjectPool.m
+//  SyncKitCollections
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "ObjectPool.h"
+#import "MPMCRingQ.h"
+#import <stdatomic.h>
+
+
+@implementation ObjectPool
+{
+    MPMCRingQ               *freeObjects;
+    id                      (^factory)(void);
+    atomic_uint_fast64_t    createdCount;
+    atomic_uint_fast64_t    reusedCount;
+}
+
+
+- (instancetype) initWithCapacity:(NSUInteger) capacity Factory:(id (^)(void)) factory_block
+{
+    assert(factory_block != nil);
+
+    self = [super init];
+    if (self != nil) {
+        freeObjects = [[MPMCRingQ alloc] initWithCapacity:capacity];
+        if (freeObjects == nil) return nil;
+
+        _capacity = freeObjects.capacity;
+        factory = [factory_block copy];
+        atomic_init(&createdCount, 0);
+        atomic_init(&reusedCount, 0);
+    }
+    return self;
+}
+
+
+- (id) acquire
+{
+    id obj = [freeObjects poll];
+
+    if (obj != nil)
+    {
+        atomic_fetch_add_explicit(&reusedCount, 1, memory_order_relaxed);
+        return obj;
+    }
+
+    atomic_fetch_add_explicit(&createdCount, 1, memory_order_relaxed);
+    return factory();
+}
+
+
+- (void) recycle:(id) obj
+{
+    if (obj == nil) return;
+
+    if (_reset != nil) _reset(obj);
+
+    // a full pool lets the object go
+    [freeObjects put:obj];
+}
+
+
+- (uint64_t) created
+{
+    return atomic_load_explicit(&createdCount, memory_order_relaxed);
+}
+
+
+- (uint64_t) reused
+{
+    return atomic_load_explicit(&reusedCount, memory_order_relaxed);
+}
+
+@end
@@ -41,7 +41,7 @@
         node = first;
         first = first.next;
         
-        free((__bridge void *)(node));
+        node.next = nil;    // ARC releases it
     }
     
     first = nil;
@@ -0,0 +1,77 @@
+//
+//  SPSCRingQ.h
+//  SyncKitCollections
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+/**
+ *  A bounded, lock-free queue for exactly one producer thread and one consumer thread.
+ *
+ *  Objects are held in a ring of slots; the producer and consumer each own one index, so
+ *  put: and take: do not lock. A consumer that finds the queue empty sleeps on a semaphore with
+ *  a deadline on the monotonic clock; the producer signals it only when it is asleep, so a busy
+ *  queue makes no system calls.
+ *
+ *  Unlike BlockingQ, the queued objects need not be Nodes, and put: fails rather than grow the
+ *  queue when it is full.
+ */
+@interface SPSCRingQ : NSObject
+
+/**
+ *  Number of objects the queue can hold
+ */
+@property (nonatomic, readonly) NSUInteger capacity;
+
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Initialise the queue
+ *
+ *  @param capacity - number of objects the queue can hold; rounded up to a power of two
+ *
+ *  @return ring queue instance
+ */
+- (instancetype) initWithCapacity:(NSUInteger) capacity;
+
+/**
+ *  Add an object at the tail of the queue. Called by the producer thread only.
+ *
+ *  @param obj - object to queue; retained until it is taken
+ *
+ *  @return NO if the queue is full, in which case the object is not queued
+ */
+- (BOOL) put:(id) obj;
+
+/**
+ *  Remove the object at the head of the queue. Called by the consumer thread only.
+ *
+ *  @param timeout - period in millisec the consumer waits if the queue is empty
+ *
+ *  @return the object, or nil if the queue stayed empty for the timeout period
+ */
+- (id) take:(uint32_t) timeout;
+
+/**
+ *  Number of objects in the queue. Exact when called from the producer or consumer thread.
+ */
+- (NSUInteger) count;
+
+@end
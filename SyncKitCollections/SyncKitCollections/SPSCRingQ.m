@@ -0,0 +1,172 @@
+//
+//  SPSCRingQ.m
+//  SyncKitCollections
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "SPSCRingQ.h"
+#import <stdatomic.h>
+
+// keeps the producer's and consumer's indices on separate cache lines
+#define SPSCRINGQ_CACHE_LINE 64
+
+
+@implementation SPSCRingQ
+{
+    void                **slots;        // retained objects, bridged out of ARC
+    NSUInteger          mask;
+    dispatch_semaphore_t wakeup;
+
+    // written by the consumer
+    char                pad0[SPSCRINGQ_CACHE_LINE];
+    atomic_size_t       head;
+    atomic_bool         sleeping;       // consumer is, or is about to be, waiting on wakeup
+    size_t              tailCache;      // consumer's last view of tail
+
+    // written by the producer
+    char                pad1[SPSCRINGQ_CACHE_LINE];
+    atomic_size_t       tail;
+    size_t              headCache;      // producer's last view of head
+    char                pad2[SPSCRINGQ_CACHE_LINE];
+}
+
+
+- (instancetype) initWithCapacity:(NSUInteger) capacity
+{
+    self = [super init];
+    if (self != nil) {
+        _capacity = 1;
+        while (_capacity < capacity) _capacity <<= 1;
+        mask = _capacity - 1;
+
+        slots = calloc(_capacity, sizeof(void *));
+        if (slots == NULL) return nil;
+
+        wakeup = dispatch_semaphore_create(0);
+        atomic_init(&head, 0);
+        atomic_init(&tail, 0);
+        atomic_init(&sleeping, false);
+        tailCache = 0;
+        headCache = 0;
+    }
+    return self;
+}
+
+
+- (void) dealloc
+{
+    id obj;
+
+    // release objects that were never taken
+    while ((obj = [self poll]) != nil);
+
+    free(slots);
+}
+
+
+- (BOOL) put:(id) obj
+{
+    size_t t = atomic_load_explicit(&tail, memory_order_relaxed);
+
+    assert(obj != nil);
+
+    if (t - headCache == _capacity)
+    {
+        headCache = atomic_load_explicit(&head, memory_order_acquire);
+        if (t - headCache == _capacity) return NO;
+    }
+
+    slots[t & mask] = (void *) CFBridgingRetain(obj);
+    atomic_store_explicit(&tail, t + 1, memory_order_release);
+
+    // pairs with the fence in take: either the consumer sees the new tail before it sleeps, or
+    // we see it sleeping and wake it
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&sleeping, memory_order_relaxed) && atomic_exchange(&sleeping, false))
+        dispatch_semaphore_signal(wakeup);
+
+    return YES;
+}
+
+
+/**
+ Take the head object without waiting; consumer thread only
+ */
+- (id) poll
+{
+    size_t h = atomic_load_explicit(&head, memory_order_relaxed);
+    void *slot;
+
+    if (h == tailCache)
+    {
+        tailCache = atomic_load_explicit(&tail, memory_order_acquire);
+        if (h == tailCache) return nil;
+    }
+
+    slot = slots[h & mask];
+    slots[h & mask] = NULL;
+    atomic_store_explicit(&head, h + 1, memory_order_release);
+
+    return CFBridgingRelease(slot);
+}
+
+
+- (id) take:(uint32_t) timeout
+{
+    dispatch_time_t deadline;
+    id obj;
+
+    if ((obj = [self poll]) != nil) return obj;
+    if (timeout == 0) return nil;
+
+    // dispatch_time() counts from the monotonic clock, so the deadline is not moved by changes
+    // to the time of day
+    deadline = dispatch_time(DISPATCH_TIME_NOW, (int64_t) timeout * NSEC_PER_MSEC);
+
+    for (;;)
+    {
+        atomic_store_explicit(&sleeping, true, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+
+        if ((obj = [self poll]) == nil)
+        {
+            // a signal means the producer cleared the flag; look again
+            if (dispatch_semaphore_wait(wakeup, deadline) == 0) continue;
+
+            obj = [self poll];
+        }
+
+        // if the producer has already cleared the flag, its signal is on the way: consume it, so
+        // that it does not cut short a later wait
+        if (!atomic_exchange(&sleeping, false))
+            dispatch_semaphore_wait(wakeup, DISPATCH_TIME_FOREVER);
+
+        return obj;
+    }
+}
+
+
+- (NSUInteger) count
+{
+    // head first: tail, read after it, cannot be behind it
+    size_t h = atomic_load_explicit(&head, memory_order_acquire);
+
+    return atomic_load_explicit(&tail, memory_order_acquire) - h;
+}
+
+@end
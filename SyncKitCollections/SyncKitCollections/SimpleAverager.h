@@ -39,7 +39,8 @@
 @end
 
 /**
- A moving averager class for candidate offsets
+ A moving averager class for candidate offsets: the mean of the last capacity offsets, each
+ weighted by 1/dispersion. Built on WindowedStats.
  */
 @interface SimpleAverager : NSObject <OffsetAverager>
 
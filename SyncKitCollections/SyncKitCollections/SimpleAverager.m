@@ -19,58 +19,22 @@
 //  limitations under the License.
 
 #import "SimpleAverager.h"
-#import "Node.h"
+#import "WindowedStats.h"
 #import <pthread.h>
-
-/** private node class for SimpleAverager's internal linked-list (for queue) */
-@interface OffsetTuple : Node
-
-    /** a measurement to average */
-    @property (nonatomic, readwrite) uint64_t offset;
-    /** the weight of the measurement to the moving average */
-    @property (nonatomic, readwrite) float_t weight;
-
-@end
-
-@implementation OffsetTuple
-{
-    
-
-    
-    
-}
-
-@synthesize offset;
-@synthesize weight;
-
-@end
-
-
-
+#import <float.h>
 
 
 @implementation SimpleAverager
 {
-    Node *first, *last;
+    WindowedStats   *window;
     pthread_mutex_t lock;
-    
 }
 
-@synthesize count = _count;
 @synthesize capacity = _capacity;
 
 - (id) init
 {
-    self = [super init];
-    if (self != nil) {
-        _count = 0;
-        _capacity = 10;
-        first = nil;
-        last = nil;
-        pthread_mutex_init(&lock, NULL);
-    }
-    return self;
-
+    return [self initWithCapacity:10];
 }
 
 - (id) initWithCapacity:(int32_t)capacity__
@@ -78,11 +42,9 @@
     
     self = [super init];
     if (self != nil) {
-        _count = 0;
-        _capacity = capacity__;
-        first = nil;
-        last = nil;
-         pthread_mutex_init(&lock, NULL);
+        _capacity = MAX(capacity__, 1);
+        window = [[WindowedStats alloc] initWithCapacity:_capacity];
+        pthread_mutex_init(&lock, NULL);
     }
     return self;
 
@@ -91,102 +53,60 @@
 
 - (void) dealloc
 {
-    Node* node;
-    while(first!=nil)
-    {
-        node = first;
-        first = first.next;
-        
-        free((__bridge void *)(node));
-    }
-    
-    first = nil;
-    last = nil;
     pthread_mutex_destroy(&lock);
+}
 
+
+- (int32_t) count
+{
+    int32_t count;
+    
+    pthread_mutex_lock(&lock);
+    count = (int32_t) window.count;
+    pthread_mutex_unlock(&lock);
+    
+    return count;
+}
+
+
+- (void) setCapacity:(int32_t)capacity
+{
+    pthread_mutex_lock(&lock);
+    _capacity = MAX(capacity, 1);
+    [window resizeToCapacity:_capacity];
+    pthread_mutex_unlock(&lock);
 }
 
 
 /**
- Add a new item to averager's FIFO list. Keep adding to end of queue until max capacity os reached.
- Then, remove the oldest member (remove from front) and add the new tuple
+ Add a new item to averager's window, evicting the oldest once the window is at capacity. The
+ weighted mean is kept up to date as items come and go, rather than recomputed from the list.
  */
 -  (uint64_t)  put:(uint64_t) offset Dispersion:(float_t) dispersion {
     
-    Node* node = nil;
-    OffsetTuple* temp;
-    
-    OffsetTuple* tuple = [[OffsetTuple alloc] init];
-    tuple.offset = offset;
-    tuple.weight = 1/dispersion;
-    tuple.next = nil;
-    
-    
-    
-    float_t  totalWeightedOffsets = 0;
-    float_t  totalWeights = 0;
-    
-   
+    double mean;
     
     pthread_mutex_lock(&lock);
     
-    if (_count >= _capacity)
-    {
-        // remove first (oldest) item in our queue
-        node  = first;
-        first = first.next;
-        
-        if (first == nil) {
-            last = nil; //Empty queue
-        }
-        
-        _count--;
-        
-    }
-    
-    if (last != nil) {
-        last.next = tuple;
-    }
-    if (first == nil) {
-        first = tuple;
-    }
-    
-    last = tuple;
-   
-    _count++;
-   
-    for (node=first; node!=last.next; node= node.next) {
-        temp = (OffsetTuple*) node;
-        totalWeightedOffsets += (temp.offset * temp.weight);
-        totalWeights += (temp.weight);
-    }
+    // a zero dispersion would give an infinite weight
+    [window put:(double) offset Weight:1.0 / MAX(dispersion, FLT_MIN)];
+    mean = [window mean];
     
     pthread_mutex_unlock(&lock);
     
-    return (totalWeightedOffsets/totalWeights);
+    return (uint64_t) llround(mean);
 }
 
-/** get moving average */
+/** get moving average; 0 if no items have been added */
 - (uint64_t) getMovingAverage{
-    Node* node = nil;
-    OffsetTuple* temp;
-    
-    float_t  totalWeightedOffsets = 0;
-    float_t  totalWeights = 0;
-    
     
+    double mean;
     
     pthread_mutex_lock(&lock);
-    
-    for (node=first; node==last.next; node= node.next) {
-        temp = (OffsetTuple*) node;
-        totalWeightedOffsets += (temp.offset * temp.weight);
-        totalWeights += (temp.weight);
-    }
-    
+    mean = [window mean];
     pthread_mutex_unlock(&lock);
     
-    return (totalWeightedOffsets/totalWeights);
+    return isnan(mean) ? 0 : (uint64_t) llround(mean);
 }
 
 
@@ -30,11 +30,15 @@ FOUNDATION_EXPORT const unsigned char SyncKitCollectionsVersionString[];
 
 #import <SyncKitCollections/BlockingQ.h>
 #import <SyncKitCollections/DataNode.h>
+#import <SyncKitCollections/MPMCRingQ.h>
 #import <SyncKitCollections/Node.h>
 #import <SyncKitCollections/NSStack.h>
+#import <SyncKitCollections/ObjectPool.h>
 #import <SyncKitCollections/Queue.h>
 #import <SyncKitCollections/SimpleAverager.h>
+#import <SyncKitCollections/SPSCRingQ.h>
 #import <SyncKitCollections/utils.h>
+#import <SyncKitCollections/WindowedStats.h>
 
 
 
@@ -0,0 +1,130 @@
+//
+//  WindowedStats.h
+//  SyncKitCollections
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+/**
+ *  Statistics over a sliding window of the most recent samples.
+ *
+ *  Samples are kept in a ring buffer; a new sample beyond the window's capacity evicts the
+ *  oldest. Each statistic is kept up to date as samples come and go:
+ *
+ *  - weighted mean and variance from a running mean and sum of squares, in O(1)
+ *  - min and max from monotonic deques, in amortised O(1)
+ *  - median and percentiles from an order-statistic tree, in O(log n)
+ *
+ *  The running mean and sum of squares are recomputed from the window once every capacity
+ *  evictions, and when an outlier leaves the window, so that rounding errors do not build up.
+ *
+ *  A WindowedStats object is not thread-safe.
+ */
+@interface WindowedStats : NSObject
+
+/**
+ *  Most samples in the window
+ */
+@property (nonatomic, readonly) NSUInteger capacity;
+
+/**
+ *  Samples in the window
+ */
+@property (nonatomic, readonly) NSUInteger count;
+
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Initialise an empty window
+ *
+ *  @param capacity - most samples in the window (at least one)
+ *
+ *  @return a WindowedStats instance
+ */
+- (instancetype) initWithCapacity:(NSUInteger) capacity;
+
+/**
+ *  Add a sample with weight 1
+ *
+ *  @param value - the sample; not NaN
+ */
+- (void) put:(double) value;
+
+/**
+ *  Add a weighted sample. The weight counts towards the mean and variance only.
+ *
+ *  @param value  - the sample; not NaN
+ *  @param weight - its weight; positive and finite
+ */
+- (void) put:(double) value Weight:(double) weight;
+
+/**
+ *  Remove all samples
+ */
+- (void) reset;
+
+/**
+ *  Change the capacity of the window, keeping the most recent samples that fit
+ *
+ *  @param capacity - most samples in the window (at least one)
+ */
+- (void) resizeToCapacity:(NSUInteger) capacity;
+
+/**
+ *  @return weighted mean of the samples, or NaN if the window is empty
+ */
+- (double) mean;
+
+/**
+ *  @return weighted variance of the samples about their weighted mean (sum of w(x - mean)^2
+ *  over sum of w), or NaN if the window is empty
+ */
+- (double) variance;
+
+/**
+ *  @return square root of the weighted variance
+ */
+- (double) standardDeviation;
+
+/**
+ *  @return smallest sample, or NaN if the window is empty
+ */
+- (double) min;
+
+/**
+ *  @return largest sample, or NaN if the window is empty
+ */
+- (double) max;
+
+/**
+ *  @return median of the samples, or NaN if the window is empty
+ */
+- (double) median;
+
+/**
+ *  A percentile of the samples, interpolated linearly between the closest ranks
+ *
+ *  @param fraction - 0.0 for the smallest sample to 1.0 for the largest
+ *
+ *  @return the percentile, or NaN if the window is empty
+ */
+- (double) percentile:(double) fraction;
+
+@end
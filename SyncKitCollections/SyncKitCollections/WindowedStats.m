@@ -0,0 +1,435 @@
+//
+//  WindowedStats.m
+//  SyncKitCollections
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "WindowedStats.h"
+#import <math.h>
+
+// sum of squares recomputed when an eviction removes this many times what is left of it
+#define WINDOW_CANCELLATION_RATIO 1e4
+
+
+/**
+ *  Window state. Sample number seq (counted from the first sample ever put) lives in ring slot
+ *  seq % capacity; the same slot number identifies the sample's node in the order-statistic
+ *  tree, and the deques hold sample numbers.
+ */
+typedef struct {
+    NSUInteger  capacity;
+    uint64_t    next;           // number of the next sample
+    NSUInteger  count;
+
+    double      *values;
+    double      *weights;
+    uint64_t    *seqs;
+
+    // running weighted mean, and sum of w(x - mean)^2, updated as in West (1979)
+    double      sumW;
+    double      mean;
+    double      sumSquares;
+    NSUInteger  evictions;      // since they were last recomputed
+
+    // monotonic deques of sample numbers: values increasing in minQ, decreasing in maxQ
+    uint64_t    *minQ, *maxQ;
+    uint64_t    minFront, minBack, maxFront, maxBack;
+
+    // treap ordered by (value, seq), with subtree sizes
+    int32_t     *left, *right, *size;
+    uint32_t    *priority;
+    int32_t     root;
+    uint32_t    random;
+} WindowState;
+
+
+#pragma mark order-statistic tree
+
+static inline int32_t TreeSize(const WindowState *w, int32_t t)
+{
+    return (t < 0) ? 0 : w->size[t];
+}
+
+static inline void TreeUpdate(WindowState *w, int32_t t)
+{
+    w->size[t] = 1 + TreeSize(w, w->left[t]) + TreeSize(w, w->right[t]);
+}
+
+static inline BOOL TreeLess(const WindowState *w, int32_t a, int32_t b)
+{
+    if (w->values[a] != w->values[b]) return w->values[a] < w->values[b];
+    return w->seqs[a] < w->seqs[b];
+}
+
+/** split t into the nodes ordered before node n and the rest */
+static void TreeSplit(WindowState *w, int32_t t, int32_t n, int32_t *l, int32_t *r)
+{
+    if (t < 0) { *l = *r = -1; return; }
+
+    if (TreeLess(w, t, n)) {
+        TreeSplit(w, w->right[t], n, &w->right[t], r);
+        *l = t;
+    } else {
+        TreeSplit(w, w->left[t], n, l, &w->left[t]);
+        *r = t;
+    }
+    TreeUpdate(w, t);
+}
+
+/** join two trees, every node of a ordered before every node of b */
+static int32_t TreeMerge(WindowState *w, int32_t a, int32_t b)
+{
+    if (a < 0) return b;
+    if (b < 0) return a;
+
+    if (w->priority[a] > w->priority[b]) {
+        w->right[a] = TreeMerge(w, w->right[a], b);
+        TreeUpdate(w, a);
+        return a;
+    }
+    w->left[b] = TreeMerge(w, a, w->left[b]);
+    TreeUpdate(w, b);
+    return b;
+}
+
+static int32_t TreeInsert(WindowState *w, int32_t t, int32_t n)
+{
+    if (t < 0) return n;
+
+    if (w->priority[n] > w->priority[t]) {
+        TreeSplit(w, t, n, &w->left[n], &w->right[n]);
+        TreeUpdate(w, n);
+        return n;
+    }
+
+    if (TreeLess(w, n, t))
+        w->left[t] = TreeInsert(w, w->left[t], n);
+    else
+        w->right[t] = TreeInsert(w, w->right[t], n);
+    TreeUpdate(w, t);
+    return t;
+}
+
+static int32_t TreeErase(WindowState *w, int32_t t, int32_t n)
+{
+    if (t == n) return TreeMerge(w, w->left[t], w->right[t]);
+
+    if (TreeLess(w, n, t))
+        w->left[t] = TreeErase(w, w->left[t], n);
+    else
+        w->right[t] = TreeErase(w, w->right[t], n);
+    TreeUpdate(w, t);
+    return t;
+}
+
+/** the k-th smallest value, counting from 0 */
+static double TreeSelect(const WindowState *w, NSUInteger k)
+{
+    int32_t t = w->root;
+
+    for (;;)
+    {
+        NSUInteger left_size = (NSUInteger) TreeSize(w, w->left[t]);
+
+        if (k < left_size) {
+            t = w->left[t];
+        } else if (k == left_size) {
+            return w->values[t];
+        } else {
+            k -= left_size + 1;
+            t = w->right[t];
+        }
+    }
+}
+
+
+#pragma mark window
+
+static BOOL WindowAllocate(WindowState *w, NSUInteger capacity)
+{
+    memset(w, 0, sizeof(*w));
+
+    w->capacity = MAX(capacity, 1);
+    w->values = calloc(w->capacity, sizeof(double));
+    w->weights = calloc(w->capacity, sizeof(double));
+    w->seqs = calloc(w->capacity, sizeof(uint64_t));
+    w->minQ = calloc(w->capacity, sizeof(uint64_t));
+    w->maxQ = calloc(w->capacity, sizeof(uint64_t));
+    w->left = calloc(w->capacity, sizeof(int32_t));
+    w->right = calloc(w->capacity, sizeof(int32_t));
+    w->size = calloc(w->capacity, sizeof(int32_t));
+    w->priority = calloc(w->capacity, sizeof(uint32_t));
+    w->root = -1;
+    w->random = 2463534242u;
+
+    return (w->values && w->weights && w->seqs && w->minQ && w->maxQ &&
+            w->left && w->right && w->size && w->priority);
+}
+
+static void WindowFree(WindowState *w)
+{
+    free(w->values);
+    free(w->weights);
+    free(w->seqs);
+    free(w->minQ);
+    free(w->maxQ);
+    free(w->left);
+    free(w->right);
+    free(w->size);
+    free(w->priority);
+    memset(w, 0, sizeof(*w));
+}
+
+/** two-pass recomputation of the mean and sum of squares, to shed accumulated rounding errors */
+static void WindowRecomputeSums(WindowState *w)
+{
+    uint64_t seq, first = w->next - w->count;
+    double sum = 0;
+
+    w->sumW = 0;
+    w->sumSquares = 0;
+    w->evictions = 0;
+
+    for (seq = first; seq < w->next; seq++) {
+        w->sumW += w->weights[seq % w->capacity];
+        sum += w->weights[seq % w->capacity] * w->values[seq % w->capacity];
+    }
+    w->mean = sum / w->sumW;
+
+    for (seq = first; seq < w->next; seq++) {
+        double d = w->values[seq % w->capacity] - w->mean;
+        w->sumSquares += w->weights[seq % w->capacity] * d * d;
+    }
+}
+
+static void WindowEvictOldest(WindowState *w)
+{
+    uint64_t seq = w->next - w->count;
+    NSUInteger slot = seq % w->capacity;
+    double x = w->values[slot], weight = w->weights[slot];
+    double d = x - w->mean;
+
+    w->sumW -= weight;
+    if (w->count > 1) {
+        double removed;
+
+        w->mean -= d * weight / w->sumW;
+        removed = weight * d * (x - w->mean);
+        w->sumSquares -= removed;
+
+        // an outlier leaving cancels most of the sum, and its rounding error with it
+        if (removed > WINDOW_CANCELLATION_RATIO * w->sumSquares) w->evictions = w->capacity;
+    }
+    w->evictions++;
+
+    if ((w->minFront != w->minBack) && (w->minQ[w->minFront % w->capacity] == seq)) w->minFront++;
+    if ((w->maxFront != w->maxBack) && (w->maxQ[w->maxFront % w->capacity] == seq)) w->maxFront++;
+
+    w->root = TreeErase(w, w->root, (int32_t) slot);
+    w->count--;
+}
+
+static void WindowPut(WindowState *w, double value, double weight)
+{
+    uint64_t seq = w->next;
+    NSUInteger slot = seq % w->capacity;
+    double d;
+
+    if (w->count == w->capacity) WindowEvictOldest(w);
+    if (w->count == 0) {
+        w->sumW = w->mean = w->sumSquares = 0;
+        w->evictions = 0;
+    }
+
+    w->values[slot] = value;
+    w->weights[slot] = weight;
+    w->seqs[slot] = seq;
+    w->next++;
+    w->count++;
+
+    d = value - w->mean;
+    w->sumW += weight;
+    w->mean += d * weight / w->sumW;
+    w->sumSquares += weight * d * (value - w->mean);
+
+    // drop samples that can no longer be the min (or max) while this one is in the window
+    while ((w->minBack != w->minFront) && (w->values[w->minQ[(w->minBack - 1) % w->capacity] % w->capacity] >= value)) w->minBack--;
+    w->minQ[w->minBack++ % w->capacity] = seq;
+
+    while ((w->maxBack != w->maxFront) && (w->values[w->maxQ[(w->maxBack - 1) % w->capacity] % w->capacity] <= value)) w->maxBack--;
+    w->maxQ[w->maxBack++ % w->capacity] = seq;
+
+    // xorshift32 priorities keep the tree balanced in expectation
+    w->random ^= w->random << 13;
+    w->random ^= w->random >> 17;
+    w->random ^= w->random << 5;
+    w->priority[slot] = w->random;
+    w->left[slot] = w->right[slot] = -1;
+    w->size[slot] = 1;
+    w->root = TreeInsert(w, w->root, (int32_t) slot);
+
+    if (w->evictions >= w->capacity) WindowRecomputeSums(w);
+}
+
+
+
+@implementation WindowedStats
+{
+    WindowState     window;
+}
+
+
+- (instancetype) initWithCapacity:(NSUInteger) capacity
+{
+    self = [super init];
+    if (self != nil) {
+        assert(capacity <= INT32_MAX);
+
+        if (!WindowAllocate(&window, capacity)) {
+            WindowFree(&window);
+            return nil;
+        }
+    }
+    return self;
+}
+
+
+- (void) dealloc
+{
+    WindowFree(&window);
+}
+
+
+- (NSUInteger) capacity
+{
+    return window.capacity;
+}
+
+
+- (NSUInteger) count
+{
+    return window.count;
+}
+
+
+- (void) put:(double) value
+{
+    [self put:value Weight:1.0];
+}
+
+
+- (void) put:(double) value Weight:(double) weight
+{
+    assert(!isnan(value));
+    assert((weight > 0) && isfinite(weight));
+
+    WindowPut(&window, value, weight);
+}
+
+
+- (void) reset
+{
+    NSUInteger capacity = window.capacity;
+
+    WindowFree(&window);
+    WindowAllocate(&window, capacity);
+}
+
+
+- (void) resizeToCapacity:(NSUInteger) capacity
+{
+    WindowState old = window;
+    NSUInteger keep = MIN(old.count, MAX(capacity, 1));
+    uint64_t seq;
+
+    if (!WindowAllocate(&window, capacity)) {
+        WindowFree(&window);
+        window = old;
+        return;
+    }
+
+    for (seq = old.next - keep; seq < old.next; seq++)
+        WindowPut(&window, old.values[seq % old.capacity], old.weights[seq % old.capacity]);
+
+    WindowFree(&old);
+}
+
+
+- (double) mean
+{
+    if (window.count == 0) return NAN;
+
+    return window.mean;
+}
+
+
+- (double) variance
+{
+    if (window.count == 0) return NAN;
+
+    return MAX(window.sumSquares / window.sumW, 0.0);
+}
+
+
+- (double) standardDeviation
+{
+    return sqrt([self variance]);
+}
+
+
+- (double) min
+{
+    if (window.count == 0) return NAN;
+
+    return window.values[window.minQ[window.minFront % window.capacity] % window.capacity];
+}
+
+
+- (double) max
+{
+    if (window.count == 0) return NAN;
+
+    return window.values[window.maxQ[window.maxFront % window.capacity] % window.capacity];
+}
+
+
+- (double) median
+{
+    return [self percentile:0.5];
+}
+
+
+- (double) percentile:(double) fraction
+{
+    double rank, lower, upper;
+    NSUInteger k;
+
+    if (window.count == 0) return NAN;
+
+    rank = MIN(MAX(fraction, 0.0), 1.0) * (window.count - 1);
+    k = (NSUInteger) floor(rank);
+
+    lower = TreeSelect(&window, k);
+    if (k + 1 >= window.count) return lower;
+
+    upper = TreeSelect(&window, k + 1);
+
+    return lower + (rank - k) * (upper - lower);
+}
+
+@end
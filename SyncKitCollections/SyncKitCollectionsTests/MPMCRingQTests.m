@@ -0,0 +1,286 @@
+//
+//  MPMCRingQTests.m
+//  SyncKitCollectionsTests
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+#import <SyncKitCollections/SyncKitCollections.h>
+#import <mach/mach_time.h>
+#import <stdatomic.h>
+
+// contention: threads on each side, and objects put by each producer
+static const NSUInteger kStressThreads      = 4;
+static const NSUInteger kStressItems        = 250000;
+
+static const NSUInteger kBenchmarkItems     = 400000;
+static const NSUInteger kPoolIterations     = 1000000;
+
+static const NSUInteger kRingCapacity       = 1024;
+
+
+static uint64_t NanosSince(uint64_t start)
+{
+    static mach_timebase_info_data_t timebase;
+
+    if (timebase.denom == 0) mach_timebase_info(&timebase);
+
+    return (mach_absolute_time() - start) * timebase.numer / timebase.denom;
+}
+
+
+@interface MPMCRingQTests : XCTestCase
+
+@end
+
+@implementation MPMCRingQTests
+{
+    atomic_size_t   taken;
+    atomic_size_t   duplicates;
+}
+
+- (void)testOrderAndCapacity {
+    MPMCRingQ<NSNumber *> *q = [[MPMCRingQ alloc] initWithCapacity:3];
+    NSUInteger i;
+
+    XCTAssertEqual(q.capacity, 4);
+
+    for (i = 0; i < q.capacity; i++)
+        XCTAssertTrue([q put:@(i)]);
+
+    XCTAssertFalse([q put:@(i)], @"full queue refuses objects");
+    XCTAssertEqual([q count], q.capacity);
+
+    for (i = 0; i < q.capacity; i++)
+        XCTAssertEqualObjects([q poll], @(i));
+
+    XCTAssertNil([q poll]);
+    XCTAssertEqual([q count], 0);
+
+    // and round again
+    XCTAssertTrue([q put:@(42)]);
+    XCTAssertEqualObjects([q poll], @(42));
+}
+
+
+- (void)testQueuedObjectsAreReleased {
+    __weak DataNode *weak_node;
+
+    @autoreleasepool {
+        MPMCRingQ *q = [[MPMCRingQ alloc] initWithCapacity:4];
+        DataNode *node = [[DataNode alloc] init];
+
+        weak_node = node;
+        [q put:node];
+        node = nil;
+
+        XCTAssertNotNil(weak_node, @"held by the queue");
+    }
+    XCTAssertNil(weak_node, @"released with the queue");
+}
+
+
+/**
+ *  Producers and consumers hammer a small ring at once; every object must come out exactly once
+ */
+- (void)testStressUnderContention {
+    MPMCRingQ<NSNumber *> *q = [[MPMCRingQ alloc] initWithCapacity:64];
+    const NSUInteger total = kStressThreads * kStressItems;
+    atomic_uchar *seen = calloc(total, sizeof(atomic_uchar));
+    dispatch_group_t group = dispatch_group_create();
+    dispatch_queue_t queue = dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0);
+    NSUInteger t;
+
+    atomic_init(&taken, 0);
+    atomic_init(&duplicates, 0);
+
+    for (t = 0; t < kStressThreads; t++)
+    {
+        NSUInteger first = t * kStressItems;
+
+        dispatch_group_async(group, queue, ^{
+            NSUInteger i;
+            for (i = first; i < first + kStressItems; i++)
+                while (![q put:@(i)]) sched_yield();
+        });
+
+        dispatch_group_async(group, queue, ^{
+            while (atomic_load(&self->taken) < total)
+            {
+                NSNumber *n = [q poll];
+
+                if (n == nil) { sched_yield(); continue; }
+
+                if (atomic_exchange(&seen[n.unsignedIntegerValue], 1) != 0)
+                    atomic_fetch_add(&self->duplicates, 1);
+                atomic_fetch_add(&self->taken, 1);
+            }
+        });
+    }
+
+    XCTAssertEqual(dispatch_group_wait(group, dispatch_time(DISPATCH_TIME_NOW, 60 * NSEC_PER_SEC)), 0);
+
+    XCTAssertEqual(atomic_load(&self->taken), total);
+    XCTAssertEqual(atomic_load(&duplicates), 0);
+    for (t = 0; t < total; t++)
+        if (atomic_load(&seen[t]) == 0) { XCTFail(@"object %lu lost", (unsigned long) t); break; }
+    XCTAssertNil([q poll]);
+
+    free(seen);
+}
+
+
+/**
+ *  Objects per second through a queue, with kStressThreads producers and as many consumers
+ */
+- (double) throughputWithItems:(NSArray *) items Put:(BOOL (^)(id)) put Take:(id (^)(void)) take
+{
+    const NSUInteger per_thread = items.count / kStressThreads;
+    dispatch_group_t group = dispatch_group_create();
+    dispatch_queue_t queue = dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0);
+    NSUInteger t;
+
+    atomic_init(&taken, 0);
+    uint64_t start = mach_absolute_time();
+
+    for (t = 0; t < kStressThreads; t++)
+    {
+        NSArray *mine = [items subarrayWithRange:NSMakeRange(t * per_thread, per_thread)];
+
+        dispatch_group_async(group, queue, ^{
+            for (id obj in mine)
+                while (!put(obj)) sched_yield();
+        });
+
+        dispatch_group_async(group, queue, ^{
+            while (atomic_load_explicit(&self->taken, memory_order_relaxed) < per_thread * kStressThreads)
+                if (take() != nil) atomic_fetch_add_explicit(&self->taken, 1, memory_order_relaxed);
+                else sched_yield();
+        });
+    }
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+
+    return per_thread * kStressThreads * 1e9 / NanosSince(start);
+}
+
+
+- (void)testThroughputAgainstBlockingQ {
+    NSMutableArray<DataNode *> *items = [NSMutableArray arrayWithCapacity:kBenchmarkItems];
+    MPMCRingQ *ring = [[MPMCRingQ alloc] initWithCapacity:kRingCapacity];
+    BlockingQ *blocking = [[BlockingQ alloc] init];
+    NSUInteger i;
+
+    for (i = 0; i < kBenchmarkItems; i++)
+        [items addObject:[[DataNode alloc] init]];
+
+    double ring_rate = [self throughputWithItems:items Put:^BOOL(id obj) { return [ring put:obj]; }
+                                            Take:^id{ return [ring poll]; }];
+
+    double blocking_rate = [self throughputWithItems:items Put:^BOOL(id obj) { [blocking put:obj]; return YES; }
+                                                Take:^id{ return [blocking take:1]; }];
+
+    NSLog(@"throughput, %lu producers and consumers: MPMCRingQ %.0f/s, BlockingQ %.0f/s",
+          (unsigned long) kStressThreads, ring_rate, blocking_rate);
+}
+
+@end
+
+
+
+@interface ObjectPoolTests : XCTestCase
+
+@end
+
+@implementation ObjectPoolTests
+
+- (void)testRecycledObjectsAreReused {
+    ObjectPool<DataNode *> *pool = [[ObjectPool alloc] initWithCapacity:2 Factory:^DataNode *{
+        return [[DataNode alloc] init];
+    }];
+    pool.reset = ^(DataNode *node) { node.data = nil; };
+
+    DataNode *a = [pool acquire];
+    DataNode *b = [pool acquire];
+    DataNode *c = [pool acquire];
+    XCTAssertEqual(pool.created, 3);
+
+    a.data = @"stale";
+    [pool recycle:a];
+    [pool recycle:b];
+    [pool recycle:c];          // pool full: released
+
+    DataNode *d = [pool acquire];
+    XCTAssertEqual(d, a, @"first recycled, first reused");
+    XCTAssertNil(d.data, @"reset on recycle");
+    XCTAssertEqual([pool acquire], b);
+    XCTAssertEqual(pool.reused, 2);
+
+    [pool acquire];
+    XCTAssertEqual(pool.created, 4);
+}
+
+
+- (void)testStressUnderContention {
+    ObjectPool<DataNode *> *pool = [[ObjectPool alloc] initWithCapacity:16 Factory:^DataNode *{
+        return [[DataNode alloc] init];
+    }];
+    dispatch_group_t group = dispatch_group_create();
+    NSUInteger t;
+
+    for (t = 0; t < kStressThreads; t++)
+    {
+        dispatch_group_async(group, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+            NSUInteger i;
+            for (i = 0; i < kStressItems; i++) {
+                DataNode *node = [pool acquire];
+
+                // an object is never handed to two threads at once
+                XCTAssertNil(node.data);
+                node.data = @(i);
+                node.data = nil;
+                [pool recycle:node];
+            }
+        });
+    }
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+
+    XCTAssertEqual(pool.created + pool.reused, kStressThreads * kStressItems);
+    XCTAssertLessThanOrEqual(pool.created, kStressThreads * kStressItems / 100);
+}
+
+
+- (void)testAcquireAgainstAlloc {
+    ObjectPool<DataNode *> *pool = [[ObjectPool alloc] initWithCapacity:16 Factory:^DataNode *{
+        return [[DataNode alloc] init];
+    }];
+    NSUInteger i;
+    uint64_t start;
+
+    start = mach_absolute_time();
+    for (i = 0; i < kPoolIterations; i++) {
+        @autoreleasepool {
+            DataNode *node = [[DataNode alloc] init];
+            node.data = nil;
+        }
+    }
+    uint64_t alloc_nanos = NanosSince(start);
+
+    start = mach_absolute_time();
+    for (i = 0; i < kPoolIterations; i++) {
+        @autoreleasepool {
+            DataNode *node = [pool acquire];
+            node.data = nil;
+            [pool recycle:node];
+        }
+    }
+    uint64_t pool_nanos = NanosSince(start);
+
+    NSLog(@"per object: alloc/init %.1f ns, pool acquire/recycle %.1f ns",
+          (double) alloc_nanos / kPoolIterations, (double) pool_nanos / kPoolIterations);
+    XCTAssertEqual(pool.created, 1);
+}
+
+@end
@@ -0,0 +1,223 @@
+//
+//  SPSCRingQTests.m
+//  SyncKitCollectionsTests
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+#import <SyncKitCollections/SyncKitCollections.h>
+#import <mach/mach_time.h>
+
+// throughput: objects passed from producer to consumer
+static const NSUInteger kThroughputItems    = 1000000;
+
+// latency: objects put one at a time, with the consumer asleep in between
+static const NSUInteger kLatencyItems       = 2000;
+static const useconds_t kLatencyGapUSecs    = 200;
+
+static const NSUInteger kRingCapacity       = 1024;
+
+
+static int CompareUInt64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+
+    return (x > y) - (x < y);
+}
+
+
+@interface SPSCRingQTests : XCTestCase
+
+@end
+
+@implementation SPSCRingQTests
+{
+    NSArray<DataNode *>     *nodes;
+    mach_timebase_info_data_t timebase;
+}
+
+- (void)setUp {
+    [super setUp];
+
+    NSMutableArray<DataNode *> *array = [NSMutableArray arrayWithCapacity:kThroughputItems];
+    NSUInteger i;
+
+    // queued objects are made up front, so that the benchmarks time the queues alone
+    for (i = 0; i < kThroughputItems; i++) {
+        DataNode *node = [[DataNode alloc] init];
+        node.data = @(i);
+        [array addObject:node];
+    }
+    nodes = array;
+
+    mach_timebase_info(&timebase);
+}
+
+- (void)tearDown {
+    nodes = nil;
+    [super tearDown];
+}
+
+
+- (uint64_t) nanosFromAbsolute:(uint64_t) t
+{
+    return t * timebase.numer / timebase.denom;
+}
+
+
+- (void)testOrderAndCapacity {
+    SPSCRingQ *q = [[SPSCRingQ alloc] initWithCapacity:5];
+    NSUInteger i;
+
+    XCTAssertEqual(q.capacity, 8);
+
+    for (i = 0; i < q.capacity; i++)
+        XCTAssertTrue([q put:nodes[i]]);
+
+    XCTAssertFalse([q put:nodes[i]], @"full queue refuses objects");
+    XCTAssertEqual([q count], q.capacity);
+
+    for (i = 0; i < q.capacity; i++)
+        XCTAssertEqual([q take:0], nodes[i]);
+
+    XCTAssertNil([q take:0]);
+    XCTAssertEqual([q count], 0);
+}
+
+
+- (void)testTakeTimesOut {
+    SPSCRingQ *q = [[SPSCRingQ alloc] initWithCapacity:kRingCapacity];
+    uint64_t start = mach_absolute_time();
+
+    XCTAssertNil([q take:50]);
+
+    uint64_t waited = [self nanosFromAbsolute:mach_absolute_time() - start];
+    XCTAssertGreaterThanOrEqual(waited, 50000000ULL);
+    XCTAssertLessThan(waited, 500000000ULL);
+}
+
+
+- (void)testTakeWakesOnPut {
+    SPSCRingQ *q = [[SPSCRingQ alloc] initWithCapacity:kRingCapacity];
+    DataNode *node = nodes[0];
+
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, 20 * NSEC_PER_MSEC), dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        [q put:node];
+    });
+
+    XCTAssertEqual([q take:2000], node);
+    XCTAssertNil([q take:10], @"no stale wakeup left behind");
+}
+
+
+///-----------------------------------------------------------
+/// @name Benchmarks against BlockingQ
+///-----------------------------------------------------------
+
+/**
+ *  Objects per second through a queue, with a producer and a consumer thread
+ */
+- (double) throughputWithPut:(BOOL (^)(id)) put Take:(id (^)(void)) take
+{
+    dispatch_semaphore_t done = dispatch_semaphore_create(0);
+    __block NSUInteger received = 0;
+    NSArray<DataNode *> *items = nodes;
+
+    uint64_t start = mach_absolute_time();
+
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        while (received < kThroughputItems)
+            if (take() != nil) received++;
+        dispatch_semaphore_signal(done);
+    });
+
+    for (DataNode *node in items)
+        while (!put(node)) sched_yield();
+
+    dispatch_semaphore_wait(done, DISPATCH_TIME_FOREVER);
+
+    uint64_t elapsed = [self nanosFromAbsolute:mach_absolute_time() - start];
+    XCTAssertEqual(received, kThroughputItems);
+
+    return kThroughputItems * 1e9 / elapsed;
+}
+
+
+/**
+ *  Time from put to take, for objects put while the consumer is waiting; sorted
+ */
+- (uint64_t*) latenciesWithPut:(BOOL (^)(id)) put Take:(id (^)(void)) take
+{
+    uint64_t *put_times = calloc(kLatencyItems, sizeof(uint64_t));
+    uint64_t *latencies = calloc(kLatencyItems, sizeof(uint64_t));
+    dispatch_semaphore_t done = dispatch_semaphore_create(0);
+    NSArray<DataNode *> *items = nodes;
+    NSUInteger i;
+
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        NSUInteger n;
+
+        for (n = 0; n < kLatencyItems; n++) {
+            DataNode *node = take();
+            NSUInteger index = [node.data unsignedIntegerValue];
+
+            latencies[index] = mach_absolute_time();
+        }
+        dispatch_semaphore_signal(done);
+    });
+
+    for (i = 0; i < kLatencyItems; i++) {
+        usleep(kLatencyGapUSecs);
+        put_times[i] = mach_absolute_time();
+        put(items[i]);
+    }
+
+    dispatch_semaphore_wait(done, DISPATCH_TIME_FOREVER);
+
+    for (i = 0; i < kLatencyItems; i++)
+        latencies[i] = [self nanosFromAbsolute:latencies[i] - put_times[i]];
+
+    qsort(latencies, kLatencyItems, sizeof(uint64_t), CompareUInt64);
+    free(put_times);
+
+    return latencies;
+}
+
+
+- (void)testThroughputAgainstBlockingQ {
+    SPSCRingQ *ring = [[SPSCRingQ alloc] initWithCapacity:kRingCapacity];
+    BlockingQ *blocking = [[BlockingQ alloc] init];
+
+    double ring_rate = [self throughputWithPut:^BOOL(id obj) { return [ring put:obj]; }
+                                          Take:^id{ return [ring take:2000]; }];
+
+    double blocking_rate = [self throughputWithPut:^BOOL(id obj) { [blocking put:obj]; return YES; }
+                                              Take:^id{ return [blocking take:2000]; }];
+
+    NSLog(@"throughput: SPSCRingQ %.0f/s, BlockingQ %.0f/s", ring_rate, blocking_rate);
+}
+
+
+- (void)testLatencyAgainstBlockingQ {
+    SPSCRingQ *ring = [[SPSCRingQ alloc] initWithCapacity:kRingCapacity];
+    BlockingQ *blocking = [[BlockingQ alloc] init];
+
+    uint64_t *ring_latencies = [self latenciesWithPut:^BOOL(id obj) { return [ring put:obj]; }
+                                                 Take:^id{ return [ring take:2000]; }];
+
+    uint64_t *blocking_latencies = [self latenciesWithPut:^BOOL(id obj) { [blocking put:obj]; return YES; }
+                                                     Take:^id{ return [blocking take:2000]; }];
+
+    NSLog(@"put to take, SPSCRingQ: p50 %llu us, p99 %llu us",
+          ring_latencies[kLatencyItems / 2] / 1000, ring_latencies[kLatencyItems * 99 / 100] / 1000);
+    NSLog(@"put to take, BlockingQ: p50 %llu us, p99 %llu us",
+          blocking_latencies[kLatencyItems / 2] / 1000, blocking_latencies[kLatencyItems * 99 / 100] / 1000);
+
+    free(ring_latencies);
+    free(blocking_latencies);
+}
+
+@end
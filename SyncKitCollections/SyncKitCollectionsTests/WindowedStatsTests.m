@@ -0,0 +1,170 @@
+//
+//  WindowedStatsTests.m
+//  SyncKitCollectionsTests
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+#import <SyncKitCollections/SyncKitCollections.h>
+#import <mach/mach_time.h>
+
+static const NSUInteger kWindow             = 37;
+static const NSUInteger kSamples            = 5000;
+static const NSUInteger kBenchmarkSamples   = 1000000;
+
+
+static int CompareDouble(const void *a, const void *b)
+{
+    double x = *(const double *) a, y = *(const double *) b;
+
+    return (x > y) - (x < y);
+}
+
+
+@interface WindowedStatsTests : XCTestCase
+
+@end
+
+@implementation WindowedStatsTests
+
+- (void)testEmptyWindow {
+    WindowedStats *stats = [[WindowedStats alloc] initWithCapacity:4];
+
+    XCTAssertEqual(stats.count, 0);
+    XCTAssertTrue(isnan([stats mean]));
+    XCTAssertTrue(isnan([stats min]));
+    XCTAssertTrue(isnan([stats median]));
+}
+
+
+- (void)testPercentilesInterpolate {
+    WindowedStats *stats = [[WindowedStats alloc] initWithCapacity:4];
+
+    [stats put:40];
+    [stats put:10];
+    [stats put:30];
+    [stats put:20];
+
+    XCTAssertEqual([stats percentile:0.0], 10);
+    XCTAssertEqual([stats percentile:1.0], 40);
+    XCTAssertEqual([stats median], 25);
+    XCTAssertEqualWithAccuracy([stats percentile:0.9], 37, 1e-9);
+
+    // 40 leaves
+    [stats put:50];
+    XCTAssertEqual([stats max], 50);
+    XCTAssertEqualWithAccuracy([stats percentile:2.0 / 3], 30, 1e-9);
+}
+
+
+/**
+ *  Every statistic, after every sample of a random stream, against a recomputation from scratch.
+ *  The stream jumps by 10^9 half way, so an outlier-heavy window drains through the running sums.
+ */
+- (void)testAgainstBruteForce {
+    WindowedStats *stats = [[WindowedStats alloc] initWithCapacity:kWindow];
+    double *values = calloc(kSamples, sizeof(double));
+    double *weights = calloc(kSamples, sizeof(double));
+    double sorted[kWindow];
+    NSUInteger i, j;
+
+    srandom(1);
+
+    for (i = 0; i < kSamples; i++)
+    {
+        NSUInteger n = MIN(i + 1, kWindow);
+        double sum_w = 0, sum_wx = 0, mean, variance = 0;
+
+        // repeated values exercise ties in the tree and the deques
+        values[i] = ((random() % 4) == 0 && i > 0) ? values[i - 1] : (random() % 1000) + ((i > kSamples / 2) ? 1e9 : 0);
+        weights[i] = 1 + random() % 5;
+        [stats put:values[i] Weight:weights[i]];
+
+        for (j = 0; j < n; j++) {
+            sorted[j] = values[i - j];
+            sum_w += weights[i - j];
+            sum_wx += weights[i - j] * values[i - j];
+        }
+        mean = sum_wx / sum_w;
+        for (j = 0; j < n; j++)
+            variance += weights[i - j] * (values[i - j] - mean) * (values[i - j] - mean);
+        variance /= sum_w;
+        qsort(sorted, n, sizeof(double), CompareDouble);
+
+        XCTAssertEqual(stats.count, n);
+        XCTAssertEqualWithAccuracy([stats mean], mean, 1e-6);
+        XCTAssertEqualWithAccuracy([stats variance], variance, 1e-6 * MAX(variance, 1.0));
+        XCTAssertEqual([stats min], sorted[0]);
+        XCTAssertEqual([stats max], sorted[n - 1]);
+        XCTAssertEqual([stats percentile:0.0], sorted[0]);
+        XCTAssertEqual([stats percentile:1.0], sorted[n - 1]);
+        if (n % 2 == 1)
+            XCTAssertEqual([stats median], sorted[n / 2]);
+    }
+
+    free(values);
+    free(weights);
+}
+
+
+- (void)testResizeKeepsNewestSamples {
+    WindowedStats *stats = [[WindowedStats alloc] initWithCapacity:8];
+    NSUInteger i;
+
+    for (i = 1; i <= 8; i++) [stats put:i];
+
+    [stats resizeToCapacity:3];
+    XCTAssertEqual(stats.capacity, 3);
+    XCTAssertEqual(stats.count, 3);
+    XCTAssertEqual([stats min], 6);
+    XCTAssertEqual([stats mean], 7);
+
+    [stats put:9];
+    XCTAssertEqual([stats min], 7);
+
+    [stats reset];
+    XCTAssertEqual(stats.count, 0);
+}
+
+
+- (void)testSimpleAverager {
+    SimpleAverager *averager = [[SimpleAverager alloc] initWithCapacity:3];
+
+    XCTAssertEqual([averager getMovingAverage], 0);
+
+    XCTAssertEqual([averager put:100 Dispersion:1], 100);
+    XCTAssertEqual([averager put:200 Dispersion:1], 150);
+    XCTAssertEqual([averager put:400 Dispersion:0.5], 275);    // (100 + 200 + 2 * 400) / 4
+    XCTAssertEqual([averager getMovingAverage], 275);
+
+    // 100 leaves
+    XCTAssertEqual([averager put:400 Dispersion:0.5], 360);    // (200 + 2 * 400 + 2 * 400) / 5
+    XCTAssertEqual(averager.count, 3);
+
+    XCTAssertEqual([averager put:500 Dispersion:0], 500, @"no infinite weights");
+}
+
+
+- (void)testPutPerformance {
+    WindowedStats *stats = [[WindowedStats alloc] initWithCapacity:256];
+    double sink = 0;
+    NSUInteger i;
+
+    uint64_t start = mach_absolute_time();
+    for (i = 0; i < kBenchmarkSamples; i++) {
+        [stats put:(double) (random() % 100000)];
+        sink += [stats mean] + [stats min] + [stats median];
+    }
+    uint64_t elapsed = mach_absolute_time() - start;
+
+    mach_timebase_info_data_t timebase;
+    mach_timebase_info(&timebase);
+
+    NSLog(@"WindowedStats, 256-sample window: %.0f ns per put with mean, min and median (%g)",
+          (double) elapsed * timebase.numer / timebase.denom / kBenchmarkSamples, sink);
+}
+
+@end
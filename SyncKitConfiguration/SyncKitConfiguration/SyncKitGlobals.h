@@ -32,6 +32,7 @@
 @property (atomic, readwrite) uint32_t CachedWCREQTimeOutUSecs;  // in microseconds
 @property (atomic, readwrite) uint32_t CachedWCRESPTimeOutUSecs;  // in microseconds
 @property (atomic, readwrite) uint32_t WCREQSendPeriodUSecs;  // in microseconds
+@property (atomic, readwrite) uint32_t WCREQMaxSendPeriodUSecs;  // in microseconds
 @property (atomic, readwrite) uint32_t SyncAccuracyTargetMilliSecs;  // in millisecs
 
 
@@ -40,6 +40,7 @@
 @synthesize CachedWCRESPTimeOutUSecs = _CachedWCRESPTimeOutUSecs;
 @synthesize SocketSelectTimeOutUSecs = _SocketSelectTimeOutUSecs;
 @synthesize WCREQSendPeriodUSecs = _WCREQSendPeriodUSecs;
+@synthesize WCREQMaxSendPeriodUSecs = _WCREQMaxSendPeriodUSecs;
 @synthesize WCRTTThresholdMSecs = _WCRTTThresholdMSecs;
 
 /**
@@ -81,6 +82,7 @@
     self.SyncAccuracyTargetMilliSecs = [config unsignedIntegerForKey:@"SYNC_ACCURACY_TARGET_MS" defaultValue:0];
     self.SocketSelectTimeOutUSecs = [config unsignedIntegerForKey:@"SOCK_SELECT_TIMEOUT_US" defaultValue:1000];
     self.WCREQSendPeriodUSecs = [config unsignedIntegerForKey:@"WC_REQ_SEND_PERIOD_US" defaultValue:1000000];
+    self.WCREQMaxSendPeriodUSecs = [config unsignedIntegerForKey:@"WC_REQ_MAX_SEND_PERIOD_US" defaultValue:10000000];
     
     self.ciiURL = [config stringForKey:@"CII_URL" defaultValue:@"ws://rd35628.rd.bbc.co.uk:7681"];
     self.mrsURL = [config stringForKey:@"MRS_URL" defaultValue:@"http://bbc.co.uk/MRS"];
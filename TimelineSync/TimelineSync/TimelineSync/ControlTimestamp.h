@@ -7,6 +7,7 @@
 
 #import <Foundation/Foundation.h>
 #import <ClockTimelines/CorrelatedClock.h>
+#import "ControlTimestampParser.h"
 
 //------------------------------------------------------------------------------
 #pragma mark - keys
@@ -62,6 +63,13 @@ FOUNDATION_EXPORT NSString * const kCrtlTimestampTimelineSpeedMultiplier;
  */
 @property (nonatomic, assign) double timelineSpeedMultiplier;
 
+/**
+ *  The Control Timestamp's fields as numbers. Times set as strings are read with strtoll(); a
+ *  time out of the range of int64_t sets contentTimeOutOfRange or wallClockTimeOutOfRange, and
+ *  its value is then not valid. contentTimeIsNull is set when contentTime is nil.
+ */
+@property (nonatomic, readonly) ControlTimestampValues values;
+
 //------------------------------------------------------------------------------
 
 
@@ -78,6 +86,17 @@ FOUNDATION_EXPORT NSString * const kCrtlTimestampTimelineSpeedMultiplier;
  */
 + (instancetype)ControlTimestampWithDictionary:(NSDictionary *)dict;
 
+/**
+ *  Create a ControlTimestamp instance from a Control Timestamp message. The message is parsed
+ *  by parseControlTimestamp(); messages it refuses (e.g. a time too long for 64 bits) are parsed
+ *  with NSJSONSerialization instead, keeping the times exactly as sent.
+ *
+ *  @param json a Control Timestamp message
+ *
+ *  @return a ControlTimestamp instance
+ */
++ (instancetype)ControlTimestampWithJSONString:(NSString *)json;
+
 //------------------------------------------------------------------------------
 #pragma mark - Initialisation
 //------------------------------------------------------------------------------
@@ -91,6 +110,16 @@ FOUNDATION_EXPORT NSString * const kCrtlTimestampTimelineSpeedMultiplier;
  */
 - (instancetype)initWithDictionary:(NSDictionary *)dict;
 
+/**
+ *  Initialise with the fields of a parsed Control Timestamp. The contentTime and wallClockTime
+ *  strings are only made if they are asked for.
+ *
+ *  @param values fields of a Control Timestamp
+ *
+ *  @return a ControlTimestamp instance
+ */
+- (instancetype)initWithValues:(const ControlTimestampValues *)values;
+
 
 //------------------------------------------------------------------------------
 #pragma mark - Encoding methods
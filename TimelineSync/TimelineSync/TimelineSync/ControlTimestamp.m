@@ -6,6 +6,7 @@
 //
 
 #import "ControlTimestamp.h"
+#import <errno.h>
 
 //------------------------------------------------------------------------------
 #pragma mark - constants
@@ -15,6 +16,9 @@ NSString *const kCrtlTimestampContentTime = @"contentTime";
 NSString *const kCrtlTimestampWallClockTime = @"wallClockTime";
 NSString *const kCrtlTimestampTimelineSpeedMultiplier = @"timelineSpeedMultiplier";
 
+/** longest message parsed from a copy of its bytes on the stack */
+#define CTS_MESSAGE_MAX 256
+
 
 
 //------------------------------------------------------------------------------
@@ -36,15 +40,53 @@ NSString *const kCrtlTimestampTimelineSpeedMultiplier = @"timelineSpeedMultiplie
 
 
 
+//------------------------------------------------------------------------------
+#pragma mark - helpers
+//------------------------------------------------------------------------------
+
+/**
+ *  Read a time sent as a string of decimal digits
+ *
+ *  @param time       the time, or nil
+ *  @param outOfRange set if the time does not fit in an int64_t
+ *
+ *  @return the time; 0 if it is nil or out of range
+ */
+static int64_t timeFromString(NSString *time, BOOL *outOfRange)
+{
+    int64_t value;
+
+    *outOfRange = NO;
+    if (time == nil)
+        return 0;
+
+    errno = 0;
+    value = strtoll([time UTF8String], NULL, 10);
+
+    // strtoll() clamps to INT64_MIN or INT64_MAX, which would pass as a real time
+    if (errno == ERANGE) {
+        *outOfRange = YES;
+        return 0;
+    }
+    return value;
+}
+
+
+
 //------------------------------------------------------------------------------
 #pragma mark - ControlTimestamp implementation
 //------------------------------------------------------------------------------
 
 @implementation ControlTimestamp
+{
+    // strings not yet made for times given as numbers
+    BOOL contentTimeFromValues;
+    BOOL wallClockTimeFromValues;
+}
 
 @synthesize contentTime = _contentTime;
 @synthesize wallClockTime = _wallClockTime;
-@synthesize timelineSpeedMultiplier = _timelineSpeedMultiplier;
+@synthesize values = _values;
 
 
 
@@ -56,13 +98,45 @@ NSString *const kCrtlTimestampTimelineSpeedMultiplier = @"timelineSpeedMultiplie
     return [[self alloc] initWithDictionary:dict];
 }
 
+//------------------------------------------------------------------------------
+
++ (instancetype)ControlTimestampWithJSONString:(NSString *)json
+{
+    char buffer[CTS_MESSAGE_MAX];
+    const char *bytes = json ? CFStringGetCStringPtr((__bridge CFStringRef) json, kCFStringEncodingUTF8) : NULL;
+    ControlTimestampValues values;
+
+    // use the string's own bytes if it keeps them as UTF-8, else copy them
+    if ((bytes == NULL) && [json getCString:buffer maxLength:sizeof(buffer) encoding:NSUTF8StringEncoding])
+        bytes = buffer;
+
+    if ((bytes != NULL) && parseControlTimestamp(bytes, strlen(bytes), &values))
+        return [[self alloc] initWithValues:&values];
+
+    NSData *jsonData = [json dataUsingEncoding:NSUTF8StringEncoding];
+    NSDictionary *jsonDict = jsonData ? [NSJSONSerialization JSONObjectWithData:jsonData options:0 error:nil] : nil;
+
+    return [[self alloc] initWithDictionary:jsonDict];
+}
+
 
 //------------------------------------------------------------------------------
 #pragma mark - Initialisation methods
 //------------------------------------------------------------------------------
-- (instancetype)initWithDictionary:(NSDictionary *)dict
+- (instancetype)init
 {
     self = [super init];
+    if (self) {
+        _values.contentTimeIsNull = YES;
+    }
+    return self;
+}
+
+//------------------------------------------------------------------------------
+
+- (instancetype)initWithDictionary:(NSDictionary *)dict
+{
+    self = [self init];
     
     // This check serves to make sure that a non-NSDictionary object
     // passed into the model class doesn't break the parsing.
@@ -77,6 +151,79 @@ NSString *const kCrtlTimestampTimelineSpeedMultiplier = @"timelineSpeedMultiplie
     
 }
 
+//------------------------------------------------------------------------------
+
+- (instancetype)initWithValues:(const ControlTimestampValues *)values
+{
+    self = [self init];
+    if (self) {
+        _values = *values;
+        contentTimeFromValues = !values->contentTimeIsNull;
+        wallClockTimeFromValues = YES;
+    }
+    return self;
+}
+
+//------------------------------------------------------------------------------
+#pragma mark - Accessors
+//------------------------------------------------------------------------------
+
+- (NSString *)contentTime
+{
+    if (contentTimeFromValues)
+        return [NSString stringWithFormat:@"%lld", _values.contentTime];
+    return _contentTime;
+}
+
+//------------------------------------------------------------------------------
+
+- (void)setContentTime:(NSString *)contentTime
+{
+    // NSJSONSerialization gives times sent as bare numbers as NSNumbers
+    if ([contentTime isKindOfClass:[NSNumber class]])
+        contentTime = [(NSNumber *) contentTime stringValue];
+
+    _contentTime = contentTime;
+    contentTimeFromValues = NO;
+    _values.contentTimeIsNull = (contentTime == nil);
+    _values.contentTime = timeFromString(contentTime, &_values.contentTimeOutOfRange);
+}
+
+//------------------------------------------------------------------------------
+
+- (NSString *)wallClockTime
+{
+    if (wallClockTimeFromValues)
+        return [NSString stringWithFormat:@"%lld", _values.wallClockTime];
+    return _wallClockTime;
+}
+
+//------------------------------------------------------------------------------
+
+- (void)setWallClockTime:(NSString *)wallClockTime
+{
+    if ([wallClockTime isKindOfClass:[NSNumber class]])
+        wallClockTime = [(NSNumber *) wallClockTime stringValue];
+
+    _wallClockTime = wallClockTime;
+    wallClockTimeFromValues = NO;
+    _values.wallClockTime = timeFromString(wallClockTime, &_values.wallClockTimeOutOfRange);
+}
+
+//------------------------------------------------------------------------------
+
+- (double)timelineSpeedMultiplier
+{
+    return _values.timelineSpeedMultiplier;
+}
+
+//------------------------------------------------------------------------------
+
+- (void)setTimelineSpeedMultiplier:(double)timelineSpeedMultiplier
+{
+    _values.timelineSpeedMultiplier = timelineSpeedMultiplier;
+}
+
 //------------------------------------------------------------------------------
 #pragma mark -  Converter methods
 //------------------------------------------------------------------------------
@@ -112,7 +259,7 @@ NSString *const kCrtlTimestampTimelineSpeedMultiplier = @"timelineSpeedMultiplie
 
 - (id)initWithCoder:(NSCoder *)aDecoder
 {
-    self = [super init];
+    self = [self init];
 
     self.contentTime = [aDecoder decodeObjectForKey:kCrtlTimestampContentTime];
     self.wallClockTime = [aDecoder decodeObjectForKey:kCrtlTimestampWallClockTime];
@@ -125,9 +272,9 @@ NSString *const kCrtlTimestampTimelineSpeedMultiplier = @"timelineSpeedMultiplie
 - (void)encodeWithCoder:(NSCoder *)aCoder
 {
 
-    [aCoder encodeObject:_contentTime forKey:kCrtlTimestampContentTime];
-    [aCoder encodeObject:_wallClockTime forKey:kCrtlTimestampWallClockTime];
-    [aCoder encodeDouble:_timelineSpeedMultiplier forKey:kCrtlTimestampTimelineSpeedMultiplier];
+    [aCoder encodeObject:self.contentTime forKey:kCrtlTimestampContentTime];
+    [aCoder encodeObject:self.wallClockTime forKey:kCrtlTimestampWallClockTime];
+    [aCoder encodeDouble:self.timelineSpeedMultiplier forKey:kCrtlTimestampTimelineSpeedMultiplier];
 }
 
 //------------------------------------------------------------------------------
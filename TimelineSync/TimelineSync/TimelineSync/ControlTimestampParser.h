@@ -0,0 +1,57 @@
+//
+//  ControlTimestampParser.h
+//  TimelineSync
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+
+/**
+ *  The fields of a Control Timestamp, as numbers
+ */
+typedef struct {
+    BOOL        contentTimeIsNull;          // contentTime was null: the timeline is unavailable
+    int64_t     contentTime;                // ticks on the TV's timeline; 0 when null
+    int64_t     wallClockTime;              // WallClock time in nanoseconds
+    double      timelineSpeedMultiplier;
+    BOOL        contentTimeOutOfRange;      // contentTime did not fit in 64 bits; contentTime is not valid
+    BOOL        wallClockTimeOutOfRange;    // wallClockTime did not fit in 64 bits; wallClockTime is not valid
+} ControlTimestampValues;
+
+
+/**
+ *  Parse a Control Timestamp message in one pass over its UTF-8 bytes, without making any
+ *  objects.
+ *
+ *  The message must be a JSON object with exactly the keys contentTime, wallClockTime and
+ *  timelineSpeedMultiplier, in any order. contentTime and wallClockTime are integers of any
+ *  number of digits, as strings or bare numbers; contentTime may be null.
+ *  timelineSpeedMultiplier is a number.
+ *
+ *  Anything else is refused rather than guessed at: other or repeated keys, escapes in key
+ *  names, a time that does not fit in 64 bits, a null wallClockTime or speed, and messages that
+ *  are not well formed. The caller can hand such messages to a general JSON parser.
+ *
+ *  @param json   - the message
+ *  @param length - its length in bytes
+ *  @param values - on success, the fields; undefined otherwise
+ *
+ *  @return YES if the message was parsed
+ */
+BOOL parseControlTimestamp(const char *json, size_t length, ControlTimestampValues *values);
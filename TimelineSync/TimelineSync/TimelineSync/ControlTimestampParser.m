@@ -0,0 +1,184 @@
+//
+//  ControlTimestampParser.m
+//  TimelineSync
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "ControlTimestampParser.h"
+
+/** longest timelineSpeedMultiplier accepted, in characters */
+#define CTS_NUMBER_MAX 40
+
+enum {
+    CTSContentTime      = 1,
+    CTSWallClockTime    = 2,
+    CTSSpeedMultiplier  = 4,
+    CTSAllFields        = 7
+};
+
+
+static inline const char* skipSpace(const char *p, const char *end)
+{
+    while ((p < end) && ((*p == ' ') || (*p == '\t') || (*p == '\n') || (*p == '\r'))) p++;
+    return p;
+}
+
+
+static inline BOOL isNumberChar(char c)
+{
+    return ((c >= '0') && (c <= '9')) || (c == '-') || (c == '+') || (c == '.') || (c == 'e') || (c == 'E');
+}
+
+
+static unsigned fieldForKey(const char *key, size_t length)
+{
+    if ((length == 11) && (memcmp(key, "contentTime", 11) == 0)) return CTSContentTime;
+    if ((length == 13) && (memcmp(key, "wallClockTime", 13) == 0)) return CTSWallClockTime;
+    if ((length == 23) && (memcmp(key, "timelineSpeedMultiplier", 23) == 0)) return CTSSpeedMultiplier;
+    return 0;
+}
+
+
+/**
+ *  Read an integer, quoted or not. Leading zeros are skipped, so only a value that is out of
+ *  range (not merely long) is refused.
+ *
+ *  @return the position after the integer, or NULL
+ */
+static const char* readInteger(const char *p, const char *end, int64_t *value)
+{
+    BOOL quoted = NO, negative = NO;
+    uint64_t magnitude = 0, limit;
+    const char *digits;
+
+    if ((p < end) && (*p == '"')) { quoted = YES; p++; }
+    if ((p < end) && (*p == '-')) { negative = YES; p++; }
+
+    limit = negative ? (uint64_t) INT64_MAX + 1 : (uint64_t) INT64_MAX;
+
+    for (digits = p; (p < end) && (*p >= '0') && (*p <= '9'); p++)
+    {
+        unsigned digit = *p - '0';
+
+        if (magnitude > (limit - digit) / 10) return NULL;
+        magnitude = magnitude * 10 + digit;
+    }
+    if (p == digits) return NULL;
+
+    if (quoted) {
+        if ((p >= end) || (*p != '"')) return NULL;
+        p++;
+    }
+
+    if (!negative)
+        *value = (int64_t) magnitude;
+    else
+        *value = (magnitude == 0) ? 0 : -(int64_t) (magnitude - 1) - 1;
+
+    return p;
+}
+
+
+/**
+ *  Read a JSON number
+ *
+ *  @return the position after the number, or NULL
+ */
+static const char* readDouble(const char *p, const char *end, double *value)
+{
+    char number[CTS_NUMBER_MAX + 1];
+    char *stop;
+    size_t n = 0;
+
+    while ((p + n < end) && isNumberChar(p[n]))
+        if (++n > CTS_NUMBER_MAX) return NULL;
+    if (n == 0) return NULL;
+
+    memcpy(number, p, n);
+    number[n] = '\0';
+
+    *value = strtod(number, &stop);
+    if ((stop != number + n) || !isfinite(*value)) return NULL;
+
+    return p + n;
+}
+
+
+BOOL parseControlTimestamp(const char *json, size_t length, ControlTimestampValues *values)
+{
+    const char *p = json, *end = json + length;
+    unsigned seen = 0;
+
+    // times that do not fit are refused below, so a parsed message has none
+    values->contentTimeOutOfRange = NO;
+    values->wallClockTimeOutOfRange = NO;
+
+    p = skipSpace(p, end);
+    if ((p >= end) || (*p++ != '{')) return NO;
+
+    for (;;)
+    {
+        const char *key;
+        size_t key_length;
+        unsigned field;
+
+        p = skipSpace(p, end);
+        if ((p >= end) || (*p++ != '"')) return NO;
+
+        for (key = p; (p < end) && (*p != '"') && (*p != '\\'); p++);
+        if ((p >= end) || (*p != '"')) return NO;
+        key_length = p++ - key;
+
+        p = skipSpace(p, end);
+        if ((p >= end) || (*p++ != ':')) return NO;
+        p = skipSpace(p, end);
+
+        field = fieldForKey(key, key_length);
+        if ((field == 0) || (seen & field)) return NO;
+        seen |= field;
+
+        switch (field)
+        {
+            case CTSContentTime:
+                values->contentTimeIsNull = (end - p >= 4) && (memcmp(p, "null", 4) == 0);
+                if (values->contentTimeIsNull) {
+                    values->contentTime = 0;
+                    p += 4;
+                } else
+                    p = readInteger(p, end, &values->contentTime);
+                break;
+
+            case CTSWallClockTime:
+                p = readInteger(p, end, &values->wallClockTime);
+                break;
+
+            default:
+                p = readDouble(p, end, &values->timelineSpeedMultiplier);
+                break;
+        }
+        if (p == NULL) return NO;
+
+        p = skipSpace(p, end);
+        if (p >= end) return NO;
+        if (*p == ',') { p++; continue; }
+        if (*p++ != '}') return NO;
+        break;
+    }
+
+    return (skipSpace(p, end) == end) && (seen == CTSAllFields);
+}
@@ -0,0 +1,175 @@
+//
+//  CorrelationUpdatePolicy.h
+//  TimelineSync
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+#import <ClockTimelines/CorrelatedClock.h>
+
+
+//------------------------------------------------------------------------------
+#pragma mark - Data Structures
+//------------------------------------------------------------------------------
+
+/**
+ *  How a timeline clock follows the correlations it is given
+ */
+typedef NS_ENUM(NSUInteger, CorrelationUpdateMode) {
+    /**
+     *  Apply every new correlation as it arrives
+     */
+    CorrelationUpdateStep,
+    /**
+     *  Apply a new correlation only if it moves the timeline by more than the dead band
+     */
+    CorrelationUpdateThreshold,
+    /**
+     *  Ignore changes within the dead band; move the timeline onto the new correlation gradually
+     *  over the slew window if it is out by no more than maxSlewNanos, else apply it at once
+     */
+    CorrelationUpdateSlew
+};
+
+/**
+ *  What was done with a correlation
+ */
+typedef NS_ENUM(NSUInteger, CorrelationUpdateAction) {
+    /**
+     *  Left the clock as it was
+     */
+    CorrelationUpdateIgnored,
+    /**
+     *  Set the clock's correlation and speed
+     */
+    CorrelationUpdateStepped,
+    /**
+     *  Started moving the clock towards the correlation
+     */
+    CorrelationUpdateSlewing
+};
+
+
+//------------------------------------------------------------------------------
+#pragma mark - CorrelationUpdatePolicy
+//------------------------------------------------------------------------------
+
+/**
+ *  Decides how a CorrelatedClock takes up a new correlation (and speed) for its timeline, e.g.
+ *  from a Control Timestamp, so that jitter in the correlations does not turn into a stream of
+ *  clock changes and player resyncs.
+ *
+ *  A new correlation is compared with the clock by its error: how far, in nanoseconds of
+ *  timeline time, the clock now is from where the correlation puts it. Errors within the dead
+ *  band - thresholdNanos, or the parent clock's dispersionAtTime: now if that is larger, since
+ *  the correlation is no more certain than the parent clock - are jitter.
+ *
+ *  In slew mode a larger error is not applied as a jump: the correlation is rebased at the
+ *  clock's current ticks and the clock's speed is changed so that it closes the error over
+ *  slewWindow, after which the new correlation and speed are set exactly. Listeners see two
+ *  changes and the timeline never jumps, so players are not made to seek.
+ *
+ *  In every mode, a change of speed, and the first correlation given to an unavailable clock,
+ *  are applied at once.
+ *
+ *  The policy keeps state for one clock.
+ */
+@interface CorrelationUpdatePolicy : NSObject
+
+/**
+ *  The policy's mode
+ */
+@property (nonatomic, readonly) CorrelationUpdateMode mode;
+
+/**
+ *  Smallest error acted on in threshold and slew modes, in nanoseconds. Default 10 ms.
+ */
+@property (nonatomic) int64_t thresholdNanos;
+
+/**
+ *  Largest error slewed rather than stepped, in nanoseconds. Default 250 ms.
+ */
+@property (nonatomic) int64_t maxSlewNanos;
+
+/**
+ *  Time taken to slew onto a new correlation, in seconds. Default 2 s.
+ */
+@property (nonatomic) NSTimeInterval slewWindow;
+
+/**
+ *  Number of correlations applied at once
+ */
+@property (nonatomic, readonly) uint64_t stepCount;
+
+/**
+ *  Number of correlations slewed to
+ */
+@property (nonatomic, readonly) uint64_t slewCount;
+
+/**
+ *  Number of correlations ignored
+ */
+@property (nonatomic, readonly) uint64_t ignoredCount;
+
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Initialise a policy
+ *
+ *  @param mode the policy's mode
+ *
+ *  @return a CorrelationUpdatePolicy instance
+ */
+- (instancetype) initWithMode:(CorrelationUpdateMode) mode;
+
+/**
+ *  Bring a clock up to date with a new correlation and speed, as the policy's mode says. Changes
+ *  to the clock are grouped, so its listeners are notified once.
+ *
+ *  @param clock       the timeline clock; made available if it is not
+ *  @param correlation the new correlation
+ *  @param speed       the new speed
+ *
+ *  @return what was done
+ */
+- (CorrelationUpdateAction) updateClock:(CorrelatedClock*) clock
+                            Correlation:(Correlation) correlation
+                                  Speed:(float) speed;
+
+/**
+ *  Error of a clock against a correlation and speed: how far, in nanoseconds of timeline time,
+ *  the correlation is ahead of the clock at the parent clock's current time
+ *
+ *  @param clock       a clock
+ *  @param correlation a correlation for the clock
+ *  @param speed       speed for the correlation
+ *
+ *  @return error in nanoseconds
+ */
++ (double) errorOfClock:(CorrelatedClock*) clock
+          Correlation:(Correlation) correlation
+                Speed:(float) speed;
+
+/**
+ *  Stop any slew in progress and forget the last correlation, e.g. when the timeline becomes
+ *  unavailable. The next correlation is then applied at once.
+ */
+- (void) reset;
+
+@end
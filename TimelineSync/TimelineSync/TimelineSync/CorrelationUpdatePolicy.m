@@ -0,0 +1,192 @@
+//
+//  CorrelationUpdatePolicy.m
+//  TimelineSync
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "CorrelationUpdatePolicy.h"
+
+#define CORRELATION_THRESHOLD_DEFAULT   10000000    // 10 ms
+#define CORRELATION_MAX_SLEW_DEFAULT    250000000   // 250 ms
+#define CORRELATION_SLEW_WINDOW_DEFAULT 2.0         // s
+
+
+@implementation CorrelationUpdatePolicy
+{
+    NSLock          *lock;
+    BOOL            hasTarget;
+    Correlation     targetCorrelation;  // the last correlation taken up
+    float           targetSpeed;
+    NSUInteger      slewGeneration;     // changes when a slew is started or abandoned
+}
+
+
+- (instancetype) initWithMode:(CorrelationUpdateMode) mode
+{
+    self = [super init];
+    if (self != nil) {
+        _mode = mode;
+        _thresholdNanos = CORRELATION_THRESHOLD_DEFAULT;
+        _maxSlewNanos = CORRELATION_MAX_SLEW_DEFAULT;
+        _slewWindow = CORRELATION_SLEW_WINDOW_DEFAULT;
+        lock = [[NSLock alloc] init];
+    }
+    return self;
+}
+
+
++ (double) errorOfClock:(CorrelatedClock*) clock
+          Correlation:(Correlation) correlation
+                Speed:(float) speed
+{
+    ClockBase *parent = clock.parent;
+    int64_t parent_now = [parent ticks];
+    int64_t clock_now = [clock fromParentTicks:parent_now];
+    double elapsed = (double) (parent_now - correlation.parentTickValue) / parent.tickRate;
+    double target_now = correlation.tickValue + elapsed * speed * clock.tickRate;
+
+    return (target_now - clock_now) * 1e9 / clock.tickRate;
+}
+
+
+#pragma mark private methods
+
+/**
+ *  Set the clock to the target. Called with the lock held.
+ */
+- (void) stepClock:(CorrelatedClock*) clock
+{
+    [clock beginChanges];
+
+    clock.correlation = targetCorrelation;
+    if (clock.speed != targetSpeed)
+        clock.speed = targetSpeed;
+    if (!clock.available)
+        clock.available = YES;
+
+    [clock endChanges];
+}
+
+
+/**
+ *  Rebase the clock where it is now and speed it up or slow it down to close the error over the
+ *  slew window; then set the target. Called with the lock held.
+ */
+- (void) slewClock:(CorrelatedClock*) clock Error:(double) error_nanos
+{
+    int64_t parent_now = [clock.parent ticks];
+    NSUInteger generation = ++slewGeneration;
+    __weak CorrelationUpdatePolicy *weakSelf = self;
+    __weak CorrelatedClock *weakClock = clock;
+
+    [clock beginChanges];
+    clock.correlation = [CorrelationFactory create:parent_now Correlation:[clock fromParentTicks:parent_now]];
+    clock.speed = targetSpeed + (float) (error_nanos / 1e9 / _slewWindow);
+    [clock endChanges];
+
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t) (_slewWindow * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        CorrelationUpdatePolicy *policy = weakSelf;
+        CorrelatedClock *slewed = weakClock;
+
+        if ((policy == nil) || (slewed == nil)) return;
+
+        [policy->lock lock];
+        if (policy->slewGeneration == generation)
+            [policy stepClock:slewed];
+        [policy->lock unlock];
+    });
+}
+
+
+#pragma mark public methods
+
+- (CorrelationUpdateAction) updateClock:(CorrelatedClock*) clock
+                            Correlation:(Correlation) correlation
+                                  Speed:(float) speed
+{
+    CorrelationUpdateAction action = CorrelationUpdateStepped;
+    double error_nanos = 0, dead_band;
+    int64_t dispersion;
+    BOOL repeat, jump;
+
+    [lock lock];
+
+    // TVs sometimes send the same Control Timestamp more than once
+    repeat = hasTarget && (targetCorrelation.parentTickValue == correlation.parentTickValue)
+                       && (targetCorrelation.tickValue == correlation.tickValue) && (targetSpeed == speed);
+
+    jump = !clock.available || !hasTarget || (targetSpeed != speed) || (speed == 0);
+
+    if (repeat)
+    {
+        action = CorrelationUpdateIgnored;
+    }
+    else if ((_mode != CorrelationUpdateStep) && !jump)
+    {
+        error_nanos = [CorrelationUpdatePolicy errorOfClock:clock Correlation:correlation Speed:speed];
+
+        // a correlation is as uncertain as the parent clock it is expressed in
+        dispersion = [clock.parent dispersionAtTime:[clock.parent ticksToNanoSeconds:[clock.parent ticks]]];
+        dead_band = MAX((double) _thresholdNanos, (double) MAX(dispersion, 0));
+
+        if (fabs(error_nanos) <= dead_band)
+            action = CorrelationUpdateIgnored;
+        else if ((_mode == CorrelationUpdateSlew) && (fabs(error_nanos) <= _maxSlewNanos) && (_slewWindow > 0))
+            action = CorrelationUpdateSlewing;
+    }
+
+    if (action != CorrelationUpdateIgnored)
+    {
+        hasTarget = YES;
+        targetCorrelation = correlation;
+        targetSpeed = speed;
+    }
+
+    switch (action)
+    {
+        case CorrelationUpdateStepped:
+            slewGeneration++;
+            [self stepClock:clock];
+            _stepCount++;
+            break;
+
+        case CorrelationUpdateSlewing:
+            [self slewClock:clock Error:error_nanos];
+            _slewCount++;
+            break;
+
+        default:
+            _ignoredCount++;
+            break;
+    }
+
+    [lock unlock];
+
+    return action;
+}
+
+
+- (void) reset
+{
+    [lock lock];
+    hasTarget = NO;
+    slewGeneration++;
+    [lock unlock];
+}
+
+@end
@@ -311,15 +311,7 @@ NSString * const kTSClientStateChangeNotification   = @"TSClientStateChangeNotif
       
         MWLogDebug(@"TimelineSyncClient: received string: %@", message);
         // MWLogDebug(@"TimelineSyncClient: received control timestamp");
-        NSData *jsonData = [message dataUsingEncoding:NSUTF8StringEncoding];
-        NSError *e;
-        
-        NSDictionary *jsonDict = [NSJSONSerialization JSONObjectWithData:jsonData options:0 error:&e];
-        
-        ControlTimestamp* timelineUpdate = [ControlTimestamp ControlTimestampWithDictionary:jsonDict];
-        
-       // uint64_t tv_contentTimePTSTicks = strtoull([ctime.contentTime UTF8String], NULL, 0);
-        //uint64_t tv_wallclockTimeNanos = strtoull([ctime.wallClockTime UTF8String], NULL, 0);
+        ControlTimestamp* timelineUpdate = [ControlTimestamp ControlTimestampWithJSONString:message];
         
         if (self.running){
         
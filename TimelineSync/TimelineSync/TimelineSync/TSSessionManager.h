@@ -0,0 +1,130 @@
+//
+//  TSSessionManager.h
+//  TimelineSync
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+#import "TSClient.h"
+
+
+/**
+ *  Shares CSS-TS protocol connections between the objects that want Control Timestamps for
+ *  the same timeline.
+ *
+ *  A CSS-TS connection carries one setup message, so one timeline, for its whole life: a
+ *  session here is one TSClient connection to an endpoint for a timeline selector (and content
+ *  id stem), and every subscriber to it is sent each Control Timestamp and state change of that
+ *  connection. A subscriber joining a session that is already running is sent the session's
+ *  state and its latest Control Timestamp straight away, rather than waiting for the TV's next
+ *  one.
+ *
+ *  When its last subscriber leaves, a session stays open for lingerInterval seconds, so that a
+ *  synchroniser stopped and started again (e.g. on a content change) finds its connection
+ *  already set up. openURL:ContentId:TimelineSelectors: opens the connections for several
+ *  timelines at once, before they are needed.
+ *
+ *  Subscribers are held weakly, and called on the threads TSClient calls its delegate on.
+ */
+@interface TSSessionManager : NSObject
+
+/**
+ *  Seconds an unused session is kept open; 0 closes it as its last subscriber leaves.
+ *  Default 30 s.
+ */
+@property (nonatomic) NSTimeInterval lingerInterval;
+
+/**
+ *  If YES, sessions are set up with an empty content id stem, so that one connection follows a
+ *  timeline across content changes; the subscribers' content ids are then not sent to the TV
+ *  (it reports a null content time while the timeline is unavailable). Applies to sessions
+ *  opened after it is set. Default NO.
+ */
+@property (nonatomic) BOOL matchAnyContent;
+
+/**
+ *  Number of open sessions
+ */
+@property (nonatomic, readonly) NSUInteger sessionCount;
+
+
+/**
+ *  The shared session manager
+ *
+ *  @return the TSSessionManager singleton
+ */
++ (TSSessionManager *) getInstance;
+
+/**
+ *  Subscribe to Control Timestamps for a timeline, opening a connection if there is not one
+ *  already
+ *
+ *  @param subscriber        - object to send the Control Timestamps and connection state changes to
+ *  @param ts_endpoint       - CSS-TS server endpoint URL
+ *  @param content_id        - content id stem
+ *  @param timeline_selector - timeline selector
+ */
+- (void) addSubscriber:(id<TSClientDelegate>) subscriber
+                   URL:(NSString*) ts_endpoint
+             ContentId:(NSString*) content_id
+      TimelineSelector:(NSString*) timeline_selector;
+
+/**
+ *  Unsubscribe; the connection is closed once it has had no subscribers for lingerInterval
+ *
+ *  @param subscriber        - a subscriber
+ *  @param ts_endpoint       - CSS-TS server endpoint URL it subscribed with
+ *  @param content_id        - content id stem it subscribed with
+ *  @param timeline_selector - timeline selector it subscribed with
+ */
+- (void) removeSubscriber:(id<TSClientDelegate>) subscriber
+                      URL:(NSString*) ts_endpoint
+                ContentId:(NSString*) content_id
+         TimelineSelector:(NSString*) timeline_selector;
+
+/**
+ *  Open connections for several timelines at once, without subscribing. Connections that
+ *  nobody subscribes to are closed after lingerInterval.
+ *
+ *  @param ts_endpoint - CSS-TS server endpoint URL
+ *  @param content_id  - content id stem
+ *  @param selectors   - timeline selectors
+ */
+- (void) openURL:(NSString*) ts_endpoint
+       ContentId:(NSString*) content_id
+TimelineSelectors:(NSArray<NSString *> *) selectors;
+
+/**
+ *  The client of the open session for a timeline
+ *
+ *  @param ts_endpoint       - CSS-TS server endpoint URL
+ *  @param content_id        - content id stem
+ *  @param timeline_selector - timeline selector
+ *
+ *  @return the session's TSClient, or nil if there is no such session
+ */
+- (TSClient*) clientForURL:(NSString*) ts_endpoint
+                 ContentId:(NSString*) content_id
+          TimelineSelector:(NSString*) timeline_selector;
+
+/**
+ *  Close every session now
+ */
+- (void) closeAll;
+
+@end
@@ -0,0 +1,412 @@
+//
+//  TSSessionManager.m
+//  TimelineSync
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <SimpleLogger/MWLogging.h>
+#import "TSSessionManager.h"
+#import "ControlTimestamp.h"
+
+#define TS_SESSION_LINGER_DEFAULT 30.0
+
+
+//------------------------------------------------------------------------------
+#pragma mark - TSSession
+//------------------------------------------------------------------------------
+
+/**
+ *  One CSS-TS connection and the subscribers it is demultiplexed to
+ */
+@interface TSSession : NSObject <TSClientDelegate>
+
+@property (nonatomic, readonly) TSClient *client;
+
+/**
+ *  The connection has failed or closed; a new subscriber needs a new session
+ */
+@property (nonatomic, readonly) BOOL closed;
+
+/**
+ *  Changes whenever a subscriber joins or leaves
+ */
+@property (nonatomic, readonly) NSUInteger generation;
+
+- (instancetype) initWithURL:(NSString*) ts_endpoint ContentId:(NSString*) content_id TimelineSelector:(NSString*) timeline_selector;
+
+- (void) addSubscriber:(id<TSClientDelegate>) subscriber;
+
+/**
+ *  @return the number of subscribers left
+ */
+- (NSUInteger) removeSubscriber:(id<TSClientDelegate>) subscriber;
+
+- (void) start;
+
+- (void) close;
+
+@end
+
+
+@implementation TSSession
+{
+    NSLock              *lock;
+    NSHashTable         *subscribers;
+    ControlTimestamp    *lastTimestamp;
+    TSClientState       lastState;
+}
+
+
+- (instancetype) initWithURL:(NSString*) ts_endpoint ContentId:(NSString*) content_id TimelineSelector:(NSString*) timeline_selector
+{
+    self = [super init];
+    if (self != nil) {
+        _client = [[TSClient alloc] initWithEndpointURL:ts_endpoint ContentId:content_id TimelineSelector:timeline_selector];
+        lock = [[NSLock alloc] init];
+        subscribers = [NSHashTable weakObjectsHashTable];
+        lastState = TSClientInitalised;
+    }
+    return self;
+}
+
+
+- (void) start
+{
+    _client.delegate = self;
+    [_client start];
+}
+
+
+- (void) close
+{
+    [lock lock];
+    _closed = YES;
+    [lock unlock];
+
+    // the client holds its delegate strongly
+    _client.delegate = nil;
+    [_client stop];
+}
+
+
+- (void) addSubscriber:(id<TSClientDelegate>) subscriber
+{
+    ControlTimestamp *timestamp;
+    TSClientState state;
+
+    [lock lock];
+    [subscribers addObject:subscriber];
+    _generation++;
+    timestamp = lastTimestamp;
+    state = lastState;
+    [lock unlock];
+
+    // bring the newcomer up to date with the connection
+    if (state != TSClientInitalised)
+    {
+        __weak TSSession *weakSelf = self;
+        __weak id<TSClientDelegate> weakSubscriber = subscriber;
+
+        dispatch_async(dispatch_get_main_queue(), ^{
+            TSSession *session = weakSelf;
+
+            if (session == nil) return;
+
+            [weakSubscriber tsClient:session.client StateChanged:state];
+            if (timestamp)
+                [weakSubscriber didReceiveNewControlTimetamp:timestamp];
+        });
+    }
+}
+
+
+- (NSUInteger) removeSubscriber:(id<TSClientDelegate>) subscriber
+{
+    NSUInteger remaining;
+
+    [lock lock];
+    [subscribers removeObject:subscriber];
+    _generation++;
+    remaining = [[subscribers allObjects] count];
+
+    // the next subscriber may be following different content; only give it what arrives from now on
+    if (remaining == 0)
+        lastTimestamp = nil;
+    [lock unlock];
+
+    return remaining;
+}
+
+
+#pragma mark TSClientDelegate methods
+
+- (void) didReceiveNewControlTimetamp:(ControlTimestamp*) ctimetamp
+{
+    NSArray<id<TSClientDelegate>> *targets;
+
+    [lock lock];
+    lastTimestamp = ctimetamp;
+    targets = [subscribers allObjects];
+    [lock unlock];
+
+    for (id<TSClientDelegate> subscriber in targets)
+        [subscriber didReceiveNewControlTimetamp:ctimetamp];
+}
+
+
+- (void) tsClient:(TSClient*) ts_client StateChanged:(TSClientState) state
+{
+    NSArray<id<TSClientDelegate>> *targets;
+
+    [lock lock];
+    lastState = state;
+    if ((state == TSClientConnectionFailure) || (state == TSClientConnectionClosed) || (state == TSClientStopped))
+        _closed = YES;
+    targets = [subscribers allObjects];
+    [lock unlock];
+
+    for (id<TSClientDelegate> subscriber in targets)
+        [subscriber tsClient:ts_client StateChanged:state];
+}
+
+@end
+
+
+
+//------------------------------------------------------------------------------
+#pragma mark - TSSessionManager implementation
+//------------------------------------------------------------------------------
+
+@implementation TSSessionManager
+{
+    NSLock                                      *lock;
+    NSMutableDictionary<NSArray *, TSSession *> *sessions;
+}
+
+
++ (TSSessionManager *) getInstance
+{
+    static TSSessionManager *instance = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        instance = [[TSSessionManager alloc] init];
+    });
+    return instance;
+}
+
+
+- (id) init
+{
+    self = [super init];
+    if (self != nil) {
+        lock = [[NSLock alloc] init];
+        sessions = [NSMutableDictionary dictionary];
+        _lingerInterval = TS_SESSION_LINGER_DEFAULT;
+        _matchAnyContent = NO;
+    }
+    return self;
+}
+
+
+- (void) dealloc
+{
+    [self closeAll];
+}
+
+
+- (NSUInteger) sessionCount
+{
+    NSUInteger count;
+
+    [lock lock];
+    count = sessions.count;
+    [lock unlock];
+
+    return count;
+}
+
+
+#pragma mark private methods
+
+/**
+ *  Content id stem a session is set up with
+ */
+- (NSString*) stemForContentId:(NSString*) content_id
+{
+    return _matchAnyContent ? @"" : (content_id ?: @"");
+}
+
+
+- (NSArray*) keyForURL:(NSString*) ts_endpoint ContentId:(NSString*) content_id TimelineSelector:(NSString*) timeline_selector
+{
+    return @[ ts_endpoint ?: @"", [self stemForContentId:content_id], timeline_selector ?: @"" ];
+}
+
+
+/**
+ *  The open session for a key, opening one if necessary. Called with the lock held.
+ *
+ *  @return the session, and whether it is new and needs starting
+ */
+- (TSSession*) sessionForKey:(NSArray*) key Opened:(BOOL*) opened
+{
+    TSSession *session = sessions[key];
+
+    *opened = NO;
+    if ((session == nil) || session.closed)
+    {
+        [session close];
+        session = [[TSSession alloc] initWithURL:key[0] ContentId:key[1] TimelineSelector:key[2]];
+        sessions[key] = session;
+        *opened = YES;
+
+        MWLogDebug(@"TSSessionManager: opening session for %@ on %@", key[2], key[0]);
+    }
+    return session;
+}
+
+
+/**
+ *  Close a session once it has been left unused for the linger interval. Called with the lock held.
+ */
+- (void) retireSession:(TSSession*) session Key:(NSArray*) key
+{
+    NSUInteger generation = session.generation;
+    __weak TSSessionManager *weakSelf = self;
+
+    if (_lingerInterval <= 0)
+    {
+        [sessions removeObjectForKey:key];
+        [session close];
+        return;
+    }
+
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t) (_lingerInterval * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        TSSessionManager *manager = weakSelf;
+        BOOL idle;
+
+        if (manager == nil) return;
+
+        [manager->lock lock];
+        // still ours, and nobody has come or gone since
+        idle = (manager->sessions[key] == session) && (session.generation == generation);
+        if (idle)
+            [manager->sessions removeObjectForKey:key];
+        [manager->lock unlock];
+
+        if (idle) {
+            MWLogDebug(@"TSSessionManager: closing unused session for %@ on %@", key[2], key[0]);
+            [session close];
+        }
+    });
+}
+
+
+#pragma mark public methods
+
+- (void) addSubscriber:(id<TSClientDelegate>) subscriber
+                   URL:(NSString*) ts_endpoint
+             ContentId:(NSString*) content_id
+      TimelineSelector:(NSString*) timeline_selector
+{
+    NSArray *key;
+    TSSession *session;
+    BOOL opened;
+
+    [lock lock];
+    key = [self keyForURL:ts_endpoint ContentId:content_id TimelineSelector:timeline_selector];
+    session = [self sessionForKey:key Opened:&opened];
+    [session addSubscriber:subscriber];
+    [lock unlock];
+
+    if (opened)
+        [session start];
+}
+
+
+- (void) removeSubscriber:(id<TSClientDelegate>) subscriber
+                      URL:(NSString*) ts_endpoint
+                ContentId:(NSString*) content_id
+         TimelineSelector:(NSString*) timeline_selector
+{
+    NSArray *key;
+    TSSession *session;
+
+    [lock lock];
+    key = [self keyForURL:ts_endpoint ContentId:content_id TimelineSelector:timeline_selector];
+    session = sessions[key];
+    if ((session != nil) && ([session removeSubscriber:subscriber] == 0))
+        [self retireSession:session Key:key];
+    [lock unlock];
+}
+
+
+- (void) openURL:(NSString*) ts_endpoint
+       ContentId:(NSString*) content_id
+TimelineSelectors:(NSArray<NSString *> *) selectors
+{
+    NSMutableArray<TSSession *> *opened_sessions = [NSMutableArray array];
+
+    [lock lock];
+    for (NSString *selector in selectors)
+    {
+        NSArray *key = [self keyForURL:ts_endpoint ContentId:content_id TimelineSelector:selector];
+        BOOL opened;
+        TSSession *session = [self sessionForKey:key Opened:&opened];
+
+        if (opened) {
+            [opened_sessions addObject:session];
+            [self retireSession:session Key:key];
+        }
+    }
+    [lock unlock];
+
+    // the connections are set up concurrently
+    for (TSSession *session in opened_sessions)
+        [session start];
+}
+
+
+- (TSClient*) clientForURL:(NSString*) ts_endpoint
+                 ContentId:(NSString*) content_id
+          TimelineSelector:(NSString*) timeline_selector
+{
+    TSSession *session;
+
+    [lock lock];
+    session = sessions[[self keyForURL:ts_endpoint ContentId:content_id TimelineSelector:timeline_selector]];
+    [lock unlock];
+
+    return session.client;
+}
+
+
+- (void) closeAll
+{
+    NSArray<TSSession *> *open_sessions;
+
+    [lock lock];
+    open_sessions = [sessions allValues];
+    [sessions removeAllObjects];
+    [lock unlock];
+
+    for (TSSession *session in open_sessions)
+        [session close];
+}
+
+@end
@@ -19,4 +19,7 @@ FOUNDATION_EXPORT const unsigned char TimelineSyncVersionString[];
 #import <TimelineSync/TimelineSynchroniser.h>
 #import <TimelineSync/TSClient.h>
 #import <TimelineSync/ControlTimestamp.h>
+#import <TimelineSync/ControlTimestampParser.h>
+#import <TimelineSync/CorrelationUpdatePolicy.h>
+#import <TimelineSync/TSSessionManager.h>
 #import <TimelineSync/TSSetupMsg.h>
\ No newline at end of file
@@ -8,8 +8,10 @@
 
 #import <Foundation/Foundation.h>
 #import <ClockTimelines/ClockTimelines.h>
+#import "CorrelationUpdatePolicy.h"
 
 @class TimelineSynchroniser;
+@class TSSessionManager;
 
 //------------------------------------------------------------------------------
 #pragma mark - Data Structures
@@ -151,6 +153,21 @@ FOUNDATION_EXPORT NSString* const  kTSStateChangeNotification;
  */
 @property (nonatomic) id<TimelineSynchroniserDelegate> delegate;
 
+/**
+ *  How cssTVTimeline takes up the correlations in Control Timestamps: at once, only when they
+ *  differ from it by more than a threshold, or by slewing onto them. Defaults to a
+ *  CorrelationUpdateStep policy, which applies every new correlation.
+ */
+@property (nonatomic) CorrelationUpdatePolicy *correlationPolicy;
+
+/**
+ *  If set before start, the CSS-TS connection is got from this session manager, and shared with
+ *  any other synchroniser following the same timeline on the same endpoint; stop then leaves
+ *  the connection to the manager instead of closing it. If nil (the default), the synchroniser
+ *  has a connection of its own.
+ */
+@property (nonatomic) TSSessionManager *sessionManager;
+
 
 //------------------------------------------------------------------------------
 #pragma mark - Factory methods
@@ -199,7 +216,7 @@ FOUNDATION_EXPORT NSString* const  kTSStateChangeNotification;
 - (void) start;
 
 /**
- *  Stop the timeline sync, close open connections and clean up
+ *  Stop the timeline sync, close open connections (or leave them to the sessionManager) and clean up
  */
 - (void) stop;
 
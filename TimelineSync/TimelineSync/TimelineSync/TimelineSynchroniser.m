@@ -9,6 +9,7 @@
 #import <SimpleLogger/MWLogging.h>
 #import "TimelineSynchroniser.h"
 #import "TSClient.h"
+#import "TSSessionManager.h"
 
 
 //------------------------------------------------------------------------------
@@ -99,6 +100,7 @@ NSString * const kTSStateChangeNotification   = @"TSStateChangeNotification";
     newTimelineSyncer.isSynced = NO;
     newTimelineSyncer.tsEndpointURL = ts_endpoint;
     newTimelineSyncer.offset = offset_ms;
+    newTimelineSyncer.correlationPolicy = [[CorrelationUpdatePolicy alloc] initWithMode:CorrelationUpdateStep];
     
        
     NSRange semiColonRange =  [content_id rangeOfString:@"?"];
@@ -158,6 +160,14 @@ NSString * const kTSStateChangeNotification   = @"TSStateChangeNotification";
 
 - (void) start
 {
+    if (_sessionManager) {
+        lock = [[NSLock alloc] init];
+        [_sessionManager addSubscriber:self URL:_tsEndpointURL ContentId:_contentId TimelineSelector:_timelineSelector];
+        
+        MWLogDebug(@" TimelineSynchroniser, synchronising TV timeline %@ over a shared connection", _timelineSelector);
+        return;
+    }
+    
     if (!_tsclient) {
         _tsclient = [[TSClient alloc] initWithEndpointURL:_tsEndpointURL
                                                 ContentId:_contentId
@@ -176,7 +186,11 @@ NSString * const kTSStateChangeNotification   = @"TSStateChangeNotification";
 
 - (void) stop
 {
-    [self.tsclient stop];
+    if (_sessionManager)
+        [_sessionManager removeSubscriber:self URL:_tsEndpointURL ContentId:_contentId TimelineSelector:_timelineSelector];
+    else
+        [self.tsclient stop];
+    [self.correlationPolicy reset];
     self.cssTVTimeline.available = NO;
     self.state = TSClientStopped;
     self.tsclient = nil;
@@ -203,17 +217,24 @@ NSString * const kTSStateChangeNotification   = @"TSStateChangeNotification";
 {
      //MWLogDebug(@"TimeSynchroniser: received control timestamp {%@,%@, %f}", ctimestamp.wallClockTime ,ctimestamp.contentTime, ctimestamp.timelineSpeedMultiplier );
     
+    ControlTimestampValues values = ctimestamp.values;
+    
     // check if any timestamps are NULL
     
-    if ((ctimestamp.contentTime == nil) || (ctimestamp.contentTime == NULL))
+    if (values.contentTimeIsNull)
     {
         // the timeline is unavailable, set cssTVTimeline.available property and update state
+        [self.correlationPolicy reset];
         self.cssTVTimeline.available = NO;
         self.state = TSTimelineUnavailable;
+    }else if (values.contentTimeOutOfRange || values.wallClockTimeOutOfRange){
+        
+        // a time that does not fit in 64 bits cannot be turned into a correlation
+        MWLogWarning(@"TimeSynchroniser: ignoring control timestamp with a time out of range {%@,%@}", ctimestamp.wallClockTime, ctimestamp.contentTime);
     }else{
     
-        int64_t tv_contentTimePTSTicks = strtoll([ctimestamp.contentTime UTF8String], NULL, 0);
-        int64_t tv_wallclockTimeNanos = strtoll([ctimestamp.wallClockTime UTF8String], NULL, 0);
+        int64_t tv_contentTimePTSTicks = values.contentTime;
+        int64_t tv_wallclockTimeNanos = values.wallClockTime;
         
         tv_wallclockTimeNanos += (self.offset * 1000000);
         
@@ -229,20 +250,14 @@ NSString * const kTSStateChangeNotification   = @"TSStateChangeNotification";
             corel.tickValue = tv_contentTimePTSTicks;
             
             
-            // set new correlation after checking that it is different (TV sometimes sends the same correlation timestamp more than once)
+            // the policy decides whether and how the timeline takes up the new correlation
+            CorrelationUpdateAction action = [self.correlationPolicy updateClock:self.cssTVTimeline
+                                                                     Correlation:corel
+                                                                           Speed:values.timelineSpeedMultiplier];
             
-            if (self.cssTVTimeline.correlation.parentTickValue!=corel.parentTickValue){
-                
-                MWLogDebug(@"TimeSynchroniser: updating cssTVTimeline with correlation {%lld,%lld, %f}.", corel.parentTickValue, corel.tickValue, ctimestamp.timelineSpeedMultiplier);
-                
-                self.cssTVTimeline.correlation = corel;
-                if (self.cssTVTimeline.speed != ctimestamp.timelineSpeedMultiplier) {
-                    self.cssTVTimeline.speed = ctimestamp.timelineSpeedMultiplier;
-                }
-                
-                if(!self.cssTVTimeline.available)
-                    self.cssTVTimeline.available= YES;
-             }
+            if (action != CorrelationUpdateIgnored) {
+                MWLogDebug(@"TimeSynchroniser: updating cssTVTimeline with correlation {%lld,%lld, %f}.", corel.parentTickValue, corel.tickValue, values.timelineSpeedMultiplier);
+            }
             
             [lock unlock];
             
@@ -0,0 +1,157 @@
+//
+//  ControlTimestampParserTests.m
+//  TimelineSyncTests
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+#import <TimelineSync/TimelineSync.h>
+#import <mach/mach_time.h>
+
+static const NSUInteger kBenchmarkMessages = 100000;
+
+
+@interface ControlTimestampParserTests : XCTestCase
+
+@end
+
+@implementation ControlTimestampParserTests
+
+- (BOOL) parse:(const char *) json Values:(ControlTimestampValues *) values
+{
+    return parseControlTimestamp(json, strlen(json), values);
+}
+
+
+- (void)testParsesControlTimestamp {
+    ControlTimestampValues values;
+
+    XCTAssertTrue([self parse:"{\"contentTime\":\"829407\",\"wallClockTime\":\"1467905219033540864\",\"timelineSpeedMultiplier\":1.0}" Values:&values]);
+    XCTAssertFalse(values.contentTimeIsNull);
+    XCTAssertEqual(values.contentTime, 829407);
+    XCTAssertEqual(values.wallClockTime, 1467905219033540864);
+    XCTAssertEqual(values.timelineSpeedMultiplier, 1.0);
+
+    // any key order, whitespace, bare numbers
+    XCTAssertTrue([self parse:" {\n \"timelineSpeedMultiplier\" : -0.5e0 ,\"wallClockTime\": 42, \"contentTime\" : \"-7\" } " Values:&values]);
+    XCTAssertEqual(values.contentTime, -7);
+    XCTAssertEqual(values.wallClockTime, 42);
+    XCTAssertEqual(values.timelineSpeedMultiplier, -0.5);
+}
+
+
+- (void)testNullContentTime {
+    ControlTimestampValues values;
+
+    XCTAssertTrue([self parse:"{\"contentTime\":null,\"wallClockTime\":\"100\",\"timelineSpeedMultiplier\":0}" Values:&values]);
+    XCTAssertTrue(values.contentTimeIsNull);
+    XCTAssertEqual(values.wallClockTime, 100);
+
+    ControlTimestamp *ctimestamp = [ControlTimestamp ControlTimestampWithJSONString:@"{\"contentTime\":null,\"wallClockTime\":\"100\",\"timelineSpeedMultiplier\":0}"];
+    XCTAssertNil(ctimestamp.contentTime);
+    XCTAssertEqualObjects(ctimestamp.wallClockTime, @"100");
+}
+
+
+- (void)testLongIntegers {
+    ControlTimestampValues values;
+
+    XCTAssertTrue([self parse:"{\"contentTime\":\"-9223372036854775808\",\"wallClockTime\":\"000000000000000000000000009223372036854775807\",\"timelineSpeedMultiplier\":1}" Values:&values]);
+    XCTAssertEqual(values.contentTime, INT64_MIN);
+    XCTAssertEqual(values.wallClockTime, INT64_MAX);
+    XCTAssertFalse(values.contentTimeOutOfRange);
+    XCTAssertFalse(values.wallClockTimeOutOfRange);
+
+    // one past the end of the range is refused, not wrapped
+    XCTAssertFalse([self parse:"{\"contentTime\":\"9223372036854775808\",\"wallClockTime\":\"1\",\"timelineSpeedMultiplier\":1}" Values:&values]);
+
+    // ... and ends up with the general parser, which keeps the digits
+    NSString *huge = @"123456789012345678901234567890";
+    NSString *json = [NSString stringWithFormat:@"{\"contentTime\":\"%@\",\"wallClockTime\":\"1\",\"timelineSpeedMultiplier\":1}", huge];
+    ControlTimestamp *ctimestamp = [ControlTimestamp ControlTimestampWithJSONString:json];
+
+    XCTAssertEqualObjects(ctimestamp.contentTime, huge);
+    XCTAssertTrue(ctimestamp.values.contentTimeOutOfRange, @"not clamped to INT64_MAX");
+    XCTAssertFalse(ctimestamp.values.wallClockTimeOutOfRange);
+    XCTAssertEqual(ctimestamp.values.wallClockTime, 1);
+
+    ctimestamp.contentTime = @"-9223372036854775809";
+    XCTAssertTrue(ctimestamp.values.contentTimeOutOfRange);
+
+    ctimestamp.contentTime = @"9223372036854775807";
+    XCTAssertFalse(ctimestamp.values.contentTimeOutOfRange);
+    XCTAssertEqual(ctimestamp.values.contentTime, INT64_MAX);
+}
+
+
+- (void)testRefusesOtherMessages {
+    ControlTimestampValues values;
+
+    XCTAssertFalse([self parse:"" Values:&values]);
+    XCTAssertFalse([self parse:"{\"contentTime\":\"1\",\"wallClockTime\":\"1\"}" Values:&values]);
+    XCTAssertFalse([self parse:"{\"contentTime\":\"1\",\"wallClockTime\":\"1\",\"timelineSpeedMultiplier\":1,\"x\":0}" Values:&values]);
+    XCTAssertFalse([self parse:"{\"contentTime\":\"1\",\"contentTime\":\"1\",\"timelineSpeedMultiplier\":1}" Values:&values]);
+    XCTAssertFalse([self parse:"{\"contentTime\":\"\",\"wallClockTime\":\"1\",\"timelineSpeedMultiplier\":1}" Values:&values]);
+    XCTAssertFalse([self parse:"{\"contentTime\":\"1\",\"wallClockTime\":\"1\",\"timelineSpeedMultiplier\":0x10}" Values:&values]);
+    XCTAssertFalse([self parse:"{\"contentTime\":\"1\",\"wallClockTime\":\"1\",\"timelineSpeedMultiplier\":1" Values:&values]);
+    XCTAssertFalse([self parse:"{\"contentTime\":\"1\",\"wallClockTime\":\"1\",\"timelineSpeedMultiplier\":1} {" Values:&values]);
+}
+
+
+- (void)testStringsAndValuesAgree {
+    ControlTimestamp *parsed = [ControlTimestamp ControlTimestampWithJSONString:@"{\"contentTime\":\"5\",\"wallClockTime\":\"6\",\"timelineSpeedMultiplier\":2}"];
+    ControlTimestamp *fromDictionary = [ControlTimestamp ControlTimestampWithDictionary:@{ kCrtlTimestampContentTime: @"5",
+                                                                                          kCrtlTimestampWallClockTime: @6,
+                                                                                          kCrtlTimestampTimelineSpeedMultiplier: @2 }];
+
+    XCTAssertEqualObjects([parsed toDictionary], [fromDictionary toDictionary]);
+    XCTAssertEqual(fromDictionary.values.wallClockTime, 6);
+
+    ControlTimestamp *copy = [parsed copy];
+    XCTAssertEqual(copy.values.contentTime, 5);
+    XCTAssertEqual(copy.timelineSpeedMultiplier, 2);
+}
+
+
+/**
+ *  The old path: NSJSONSerialization into a dictionary, strings in the ControlTimestamp, then
+ *  strtoll in TimelineSynchroniser. Against ControlTimestampWithJSONString and its values.
+ */
+- (void)testParsePerformance {
+    NSString *message = @"{\"contentTime\":\"829407\",\"wallClockTime\":\"1467905219033540864\",\"timelineSpeedMultiplier\":1.0}";
+    mach_timebase_info_data_t timebase;
+    int64_t sink = 0;
+    NSUInteger i;
+
+    mach_timebase_info(&timebase);
+
+    uint64_t start = mach_absolute_time();
+    for (i = 0; i < kBenchmarkMessages; i++) @autoreleasepool {
+        NSData *jsonData = [message dataUsingEncoding:NSUTF8StringEncoding];
+        NSDictionary *jsonDict = [NSJSONSerialization JSONObjectWithData:jsonData options:0 error:nil];
+        ControlTimestamp *ctimestamp = [ControlTimestamp ControlTimestampWithDictionary:jsonDict];
+
+        sink += strtoll([ctimestamp.contentTime UTF8String], NULL, 0) + strtoll([ctimestamp.wallClockTime UTF8String], NULL, 0);
+    }
+    uint64_t json_elapsed = mach_absolute_time() - start;
+
+    start = mach_absolute_time();
+    for (i = 0; i < kBenchmarkMessages; i++) @autoreleasepool {
+        ControlTimestamp *ctimestamp = [ControlTimestamp ControlTimestampWithJSONString:message];
+        ControlTimestampValues values = ctimestamp.values;
+
+        sink -= values.contentTime + values.wallClockTime;
+    }
+    uint64_t parser_elapsed = mach_absolute_time() - start;
+
+    XCTAssertEqual(sink, 0);
+
+    NSLog(@"Control Timestamp: NSJSONSerialization %.0f ns, ControlTimestampWithJSONString %.0f ns per message",
+          (double) json_elapsed * timebase.numer / timebase.denom / kBenchmarkMessages,
+          (double) parser_elapsed * timebase.numer / timebase.denom / kBenchmarkMessages);
+}
+
+@end
@@ -0,0 +1,154 @@
+//
+//  CorrelationUpdatePolicyTests.m
+//  TimelineSyncTests
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+#import <ClockTimelines/ClockTimelines.h>
+#import <TimelineSync/TimelineSync.h>
+
+static const uint64_t kPTSTickRate  = 90000;
+static const int64_t kMillis        = 1000000;
+
+
+/**
+ *  Counts the change notifications a clock sends
+ */
+@interface CountingListener : NSObject <ClockChangeListener>
+
+@property (nonatomic) NSUInteger notifications;
+
+@end
+
+@implementation CountingListener
+
+- (void) clock:(ClockBase*) clock didChange:(ClockChangeFlags) changes
+{
+    _notifications++;
+}
+
+@end
+
+
+
+@interface CorrelationUpdatePolicyTests : XCTestCase
+
+@end
+
+@implementation CorrelationUpdatePolicyTests
+{
+    SystemClock         *sysclock;
+    CorrelatedClock     *timeline;
+    CountingListener    *listener;
+    Correlation         base;
+}
+
+- (void)setUp {
+    [super setUp];
+
+    Correlation corel = [CorrelationFactory create:0 Correlation:0];
+
+    sysclock = [[SystemClock alloc] initWithTickRate:_kOneThousandMillion];
+    timeline = [[CorrelatedClock alloc] initWithParentClock:sysclock TickRate:kPTSTickRate Correlation:&corel];
+    timeline.available = NO;
+
+    listener = [[CountingListener alloc] init];
+    [timeline addChangeListener:listener];
+
+    base = [CorrelationFactory create:[sysclock ticks] Correlation:900000];
+}
+
+- (void)tearDown {
+    [timeline removeChangeListener:listener];
+    [super tearDown];
+}
+
+
+/**
+ *  The base correlation with the timeline moved on by some milliseconds
+ */
+- (Correlation) shifted:(int64_t) millis
+{
+    return [CorrelationFactory create:base.parentTickValue Correlation:base.tickValue + millis * (int64_t) kPTSTickRate / 1000];
+}
+
+
+- (void)testStepAppliesEveryNewCorrelation {
+    CorrelationUpdatePolicy *policy = [[CorrelationUpdatePolicy alloc] initWithMode:CorrelationUpdateStep];
+
+    XCTAssertEqual([policy updateClock:timeline Correlation:base Speed:1.0], CorrelationUpdateStepped);
+    XCTAssertTrue(timeline.available);
+    XCTAssertEqual([policy updateClock:timeline Correlation:[self shifted:1] Speed:1.0], CorrelationUpdateStepped);
+    XCTAssertEqual([policy updateClock:timeline Correlation:[self shifted:1] Speed:1.0], CorrelationUpdateIgnored, @"repeated");
+
+    XCTAssertEqual(timeline.correlation.tickValue, [self shifted:1].tickValue);
+    XCTAssertEqual(listener.notifications, 2, @"one notification per correlation");
+}
+
+
+- (void)testThresholdIgnoresJitter {
+    CorrelationUpdatePolicy *policy = [[CorrelationUpdatePolicy alloc] initWithMode:CorrelationUpdateThreshold];
+    NSUInteger i;
+
+    policy.thresholdNanos = 10 * kMillis;
+
+    [policy updateClock:timeline Correlation:base Speed:1.0];
+
+    for (i = 0; i < 100; i++)
+        [policy updateClock:timeline Correlation:[self shifted:(int64_t) (i % 5) - 2] Speed:1.0];
+
+    XCTAssertEqual(policy.stepCount, 1);
+    XCTAssertEqual(policy.ignoredCount, 100);
+    XCTAssertEqual(listener.notifications, 1, @"jitter does not reach the listeners");
+
+    XCTAssertEqual([policy updateClock:timeline Correlation:[self shifted:50] Speed:1.0], CorrelationUpdateStepped);
+    XCTAssertEqual([policy updateClock:timeline Correlation:[self shifted:50] Speed:0.0], CorrelationUpdateStepped, @"speed changes always apply");
+    XCTAssertEqual(timeline.speed, 0.0);
+}
+
+
+- (void)testSlewMovesTheTimelineWithoutAJump {
+    CorrelationUpdatePolicy *policy = [[CorrelationUpdatePolicy alloc] initWithMode:CorrelationUpdateSlew];
+
+    policy.slewWindow = 0.2;
+
+    [policy updateClock:timeline Correlation:base Speed:1.0];
+
+    Correlation target = [self shifted:50];
+
+    XCTAssertEqual([policy updateClock:timeline Correlation:target Speed:1.0], CorrelationUpdateSlewing);
+
+    // still where the old correlation put it, but catching up
+    XCTAssertEqualWithAccuracy([CorrelationUpdatePolicy errorOfClock:timeline Correlation:base Speed:1.0], 0, 1 * kMillis);
+    XCTAssertEqualWithAccuracy(timeline.speed, 1.25, 1e-3);
+
+    [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.4]];
+
+    XCTAssertEqual(timeline.correlation.parentTickValue, target.parentTickValue);
+    XCTAssertEqual(timeline.correlation.tickValue, target.tickValue);
+    XCTAssertEqual(timeline.speed, 1.0);
+    XCTAssertEqual(listener.notifications, 3, @"step, start of slew, end of slew");
+}
+
+
+- (void)testSlewStepsLargeErrors {
+    CorrelationUpdatePolicy *policy = [[CorrelationUpdatePolicy alloc] initWithMode:CorrelationUpdateSlew];
+
+    policy.maxSlewNanos = 250 * kMillis;
+
+    [policy updateClock:timeline Correlation:base Speed:1.0];
+
+    XCTAssertEqual([policy updateClock:timeline Correlation:[self shifted:2] Speed:1.0], CorrelationUpdateIgnored);
+    XCTAssertEqual([policy updateClock:timeline Correlation:[self shifted:1000] Speed:1.0], CorrelationUpdateStepped);
+    XCTAssertEqualWithAccuracy([CorrelationUpdatePolicy errorOfClock:timeline Correlation:[self shifted:1000] Speed:1.0], 0, 1 * kMillis);
+
+    // after a reset, e.g. the timeline going unavailable, the next correlation applies at once
+    [policy reset];
+    XCTAssertEqual([policy updateClock:timeline Correlation:[self shifted:1030] Speed:1.0], CorrelationUpdateStepped);
+}
+
+@end
@@ -0,0 +1,163 @@
+//
+//  TSSessionManagerTests.m
+//  TimelineSyncTests
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+#import <TimelineSync/TimelineSync.h>
+
+static NSString * const kEndpoint   = @"ws://127.0.0.1:7681/ts";
+static NSString * const kContent    = @"dvb://233a.1004.1044";
+static NSString * const kPTS        = @"urn:dvb:css:timeline:pts";
+static NSString * const kTEMI       = @"urn:dvb:css:timeline:temi:1:1";
+
+
+/**
+ *  A subscriber that records what it is sent
+ */
+@interface RecordingSubscriber : NSObject <TSClientDelegate>
+
+@property (nonatomic, readonly) NSMutableArray<ControlTimestamp *> *timestamps;
+@property (nonatomic) XCTestExpectation *expectation;
+
+@end
+
+@implementation RecordingSubscriber
+
+- (id) init
+{
+    self = [super init];
+    if (self != nil) _timestamps = [NSMutableArray array];
+    return self;
+}
+
+- (void) didReceiveNewControlTimetamp:(ControlTimestamp*) ctimetamp
+{
+    [_timestamps addObject:ctimetamp];
+    [_expectation fulfill];
+    _expectation = nil;
+}
+
+- (void) tsClient:(TSClient*) ts_client StateChanged:(TSClientState) state
+{
+}
+
+@end
+
+
+
+@interface TSSessionManagerTests : XCTestCase
+
+@end
+
+@implementation TSSessionManagerTests
+{
+    TSSessionManager *manager;
+}
+
+- (void)setUp {
+    [super setUp];
+    manager = [[TSSessionManager alloc] init];
+}
+
+- (void)tearDown {
+    [manager closeAll];
+    [super tearDown];
+}
+
+
+- (void)testSubscribersToATimelineShareAConnection {
+    RecordingSubscriber *a = [[RecordingSubscriber alloc] init];
+    RecordingSubscriber *b = [[RecordingSubscriber alloc] init];
+    RecordingSubscriber *c = [[RecordingSubscriber alloc] init];
+
+    [manager addSubscriber:a URL:kEndpoint ContentId:kContent TimelineSelector:kPTS];
+    [manager addSubscriber:b URL:kEndpoint ContentId:kContent TimelineSelector:kPTS];
+    [manager addSubscriber:c URL:kEndpoint ContentId:kContent TimelineSelector:kTEMI];
+
+    XCTAssertEqual(manager.sessionCount, 2);
+
+    // a Control Timestamp on the PTS connection goes to both its subscribers, and nobody else
+    TSClient *pts = [manager clientForURL:kEndpoint ContentId:kContent TimelineSelector:kPTS];
+    ControlTimestamp *ctimestamp = [ControlTimestamp ControlTimestampWithJSONString:@"{\"contentTime\":\"1\",\"wallClockTime\":\"2\",\"timelineSpeedMultiplier\":1}"];
+
+    [pts.delegate didReceiveNewControlTimetamp:ctimestamp];
+
+    XCTAssertEqualObjects(a.timestamps, @[ ctimestamp ]);
+    XCTAssertEqualObjects(b.timestamps, @[ ctimestamp ]);
+    XCTAssertEqual(c.timestamps.count, 0);
+}
+
+
+- (void)testLateSubscriberCatchesUp {
+    RecordingSubscriber *a = [[RecordingSubscriber alloc] init];
+    RecordingSubscriber *late = [[RecordingSubscriber alloc] init];
+
+    [manager addSubscriber:a URL:kEndpoint ContentId:kContent TimelineSelector:kPTS];
+
+    TSClient *pts = [manager clientForURL:kEndpoint ContentId:kContent TimelineSelector:kPTS];
+    ControlTimestamp *ctimestamp = [ControlTimestamp ControlTimestampWithJSONString:@"{\"contentTime\":\"1\",\"wallClockTime\":\"2\",\"timelineSpeedMultiplier\":1}"];
+
+    [pts.delegate tsClient:pts StateChanged:TSClientRunning];
+    [pts.delegate didReceiveNewControlTimetamp:ctimestamp];
+
+    late.expectation = [self expectationWithDescription:@"latest Control Timestamp replayed"];
+    [manager addSubscriber:late URL:kEndpoint ContentId:kContent TimelineSelector:kPTS];
+
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+    XCTAssertEqualObjects(late.timestamps, @[ ctimestamp ]);
+}
+
+
+- (void)testConnectionLingersForTheNextSubscriber {
+    RecordingSubscriber *a = [[RecordingSubscriber alloc] init];
+    RecordingSubscriber *b = [[RecordingSubscriber alloc] init];
+
+    manager.lingerInterval = 60;
+
+    [manager addSubscriber:a URL:kEndpoint ContentId:kContent TimelineSelector:kPTS];
+    TSClient *first = [manager clientForURL:kEndpoint ContentId:kContent TimelineSelector:kPTS];
+
+    [manager removeSubscriber:a URL:kEndpoint ContentId:kContent TimelineSelector:kPTS];
+    XCTAssertEqual(manager.sessionCount, 1, @"kept open");
+
+    [manager addSubscriber:b URL:kEndpoint ContentId:kContent TimelineSelector:kPTS];
+    XCTAssertEqual([manager clientForURL:kEndpoint ContentId:kContent TimelineSelector:kPTS], first);
+
+    // no lingering: closed with its last subscriber
+    manager.lingerInterval = 0;
+    [manager removeSubscriber:b URL:kEndpoint ContentId:kContent TimelineSelector:kPTS];
+    XCTAssertEqual(manager.sessionCount, 0);
+}
+
+
+- (void)testMatchAnyContentFollowsContentChanges {
+    RecordingSubscriber *a = [[RecordingSubscriber alloc] init];
+    RecordingSubscriber *b = [[RecordingSubscriber alloc] init];
+
+    manager.matchAnyContent = YES;
+
+    [manager addSubscriber:a URL:kEndpoint ContentId:kContent TimelineSelector:kPTS];
+    TSClient *first = [manager clientForURL:kEndpoint ContentId:kContent TimelineSelector:kPTS];
+    XCTAssertEqualObjects(first.contentId, @"");
+
+    [manager removeSubscriber:a URL:kEndpoint ContentId:kContent TimelineSelector:kPTS];
+    [manager addSubscriber:b URL:kEndpoint ContentId:@"dvb://233a.1004.1080" TimelineSelector:kPTS];
+
+    XCTAssertEqual(manager.sessionCount, 1);
+    XCTAssertEqual([manager clientForURL:kEndpoint ContentId:@"dvb://233a.1004.1080" TimelineSelector:kPTS], first);
+}
+
+
+- (void)testOpenTimelinesAhead {
+    [manager openURL:kEndpoint ContentId:kContent TimelineSelectors:@[ kPTS, kTEMI, kPTS ]];
+
+    XCTAssertEqual(manager.sessionCount, 2);
+    XCTAssertNotNil([manager clientForURL:kEndpoint ContentId:kContent TimelineSelector:kTEMI]);
+}
+
+@end
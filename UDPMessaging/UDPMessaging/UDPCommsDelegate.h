@@ -6,6 +6,24 @@
 //
 
 #import <Foundation/Foundation.h>
+#import <sys/socket.h>
+
+
+/**
+ *  A received datagram, borrowed from a UDPEndpoint's receive buffer pool. The bytes stay valid
+ *  until the datagram is handed back with -[UDPEndpoint releaseDatagram:], which may be done on
+ *  any thread.
+ */
+typedef struct {
+    const uint8_t           *bytes;         // payload, in a pool buffer of the endpoint's buffer size
+    size_t                  length;
+    struct sockaddr_storage address;        // sender's address
+    socklen_t               addressLength;
+    uint64_t                hostTime;       // receive time, in host time units (mach_absolute_time())
+    BOOL                    kernelTimestamp;// hostTime was taken by the kernel, on arrival
+    uint32_t                slot;           // pool buffer index
+} UDPDatagram;
+
 
 /**
  *  Callback methods for delegate  of a UDPEndpoint object.
@@ -27,6 +45,43 @@
 - (void) didReceiveData:(NSData *)data fromAddress:(NSData *)addr;
 
 
+/**
+ *  Called instead of -didReceiveData:fromAddress: when the endpoint's `receiveTimestamps`
+ *  option is set.
+ *
+ *  @param data -       bytes received.
+ *  @param addr -       an NSData containing some form of (struct sockaddr),
+ *                      specifically a (struct sockaddr_in) or (struct sockaddr_in6)
+ *  @param host_time -  time at which the kernel received the datagram, in host time units
+ *                      (mach_absolute_time()). If the kernel did not supply a timestamp, the
+ *                      time at which the datagram was read from the socket.
+ */
+- (void) didReceiveData:(NSData *)data fromAddress:(NSData *)addr hostTime:(uint64_t) host_time;
+
+
+/**
+ *  Zero-copy alternative to the -didReceiveData:... methods: if the delegate implements this
+ *  method, datagrams are read straight into a pooled buffer and no objects are created for them.
+ *  The delegate must hand each datagram back with -[UDPEndpoint releaseDatagram:] when it has
+ *  finished with it. While every pool buffer is borrowed, incoming datagrams are dropped.
+ *
+ *  @param datagram - a borrowed datagram
+ */
+- (void) didReceiveDatagram:(const UDPDatagram *)datagram;
+
+
+/**
+ *  Batched alternative to -didReceiveDatagram:, taking precedence over it: all datagrams
+ *  waiting on the socket are read (one recvmsg() each) and lent to the delegate in batches,
+ *  one call per batch rather than per datagram. The delegate must hand each datagram back
+ *  with -[UDPEndpoint releaseDatagram:]. A batch holds at most the endpoint's pool size.
+ *
+ *  @param datagrams - borrowed datagrams, in order of arrival
+ *  @param count     - number of datagrams
+ */
+- (void) didReceiveDatagrams:(const UDPDatagram * const *)datagrams Count:(NSUInteger) count;
+
+
 /**
  *  Called after a failure to receive data.
  *
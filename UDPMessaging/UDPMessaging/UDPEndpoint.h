@@ -57,6 +57,17 @@
  */
 - (id)initWithBufferSize:(size_t) size;
 
+/**
+ *  Initialise a UDPEndpoint instance with a buffer size and a pool of receive buffers for
+ *  zero-copy delivery through -didReceiveDatagram:
+ *
+ *  @param size         buffer size e.g. size of protocol message
+ *  @param pool_size    number of receive buffers that the delegate can borrow at once
+ *
+ *  @return initialised UDPEndpoint instance
+ */
+- (id)initWithBufferSize:(size_t) size PoolSize:(NSUInteger) pool_size;
+
 /**
  *   Starts a server on the specified port.  Will call the
  -echo:didStartWithAddress: delegate method on success and the
@@ -80,6 +91,15 @@
  */
 - (void)startConnectedToHostName:(NSString *)hostName port:(NSUInteger)port;
 
+/**
+ *  Starts an endpoint that is not connected to any one host, bound to a local port chosen by the
+ *  kernel, e.g. to exchange datagrams with several servers from one socket. Will call the
+ *  -didStartWithAddress: delegate method with the local address on success and
+ *  -didStopWithError: on failure. Datagrams are then sent with -sendDatagrams:Count:, to the
+ *  address of each datagram.
+ */
+- (void)startUnconnected;
+
 /**
  *   On the client, sends the specified data to the server.  The
  -echo:didSendData:toAddress: or -echo:didFailToSendData:toAddress:error:
@@ -122,6 +142,47 @@
  */
 - (BOOL) checkForIncomingPackets:(uint32_t) timeout_us;
 
+/**
+ *  Wait for incoming packets and read them as soon as they arrive. The calling thread blocks in
+ *  kevent() until the socket becomes readable, -wakeUp is called or the timeout elapses; all
+ *  datagrams queued on the socket are then read and passed to the delegate, one by one.
+ *
+ *  Unlike -checkForIncomingPackets:, no polling interval is added between a packet's arrival and
+ *  the -didReceiveData:fromAddress: delegate call. This method can be called in a loop on a
+ *  separate thread.
+ *
+ *  @param timeout_us maximum time to block, in microseconds
+ *
+ *  @return number of packets read, or -1 on error
+ */
+- (int) waitForIncomingPackets:(uint32_t) timeout_us;
+
+/**
+ *  Send several datagrams in one call, one sendmsg() each. Each datagram goes to its address or,
+ *  if its addressLength is 0, to the connected host.
+ *
+ *  @param to_send   datagrams to send; only bytes, length, address and addressLength are used
+ *  @param count     number of datagrams
+ *
+ *  @return number of datagrams sent; fewer than count if a send failed
+ */
+- (NSUInteger) sendDatagrams:(const UDPDatagram *) to_send Count:(NSUInteger) count;
+
+/**
+ *  Hand a datagram received through -didReceiveDatagram: or -didReceiveDatagrams:Count: back to
+ *  the receive buffer pool.
+ *  Safe to call from any thread.
+ *
+ *  @param datagram a datagram borrowed from this endpoint
+ */
+- (void) releaseDatagram:(const UDPDatagram *) datagram;
+
+/**
+ *  Wake up a thread blocked in -waitForIncomingPackets:, e.g. to stop it or to let it reschedule
+ *  its work. Safe to call from any thread.
+ */
+- (void) wakeUp;
+
 /**
  *  Start a listener thread to check for incoming packets.
  */
@@ -147,6 +208,18 @@
  */
 @property (nonatomic, copy,   readonly ) NSData *               hostAddress;    // valid in client mode after successful start
 
+/**
+ *  Request kernel receive timestamps for incoming datagrams (SO_TIMESTAMP_MONOTONIC), reported
+ *  to the delegate through -didReceiveData:fromAddress:hostTime:. Set before starting the
+ *  endpoint. Defaults to NO.
+ */
+@property (nonatomic, assign, readwrite) BOOL                   receiveTimestamps;
+
+/**
+ *  Number of datagrams dropped because every receive pool buffer was borrowed
+ */
+@property (nonatomic, assign, readonly) NSUInteger              droppedDatagrams;
+
 /**
  *   Remote host's port number targetted for sending data. Property value only valid in client mode
  */
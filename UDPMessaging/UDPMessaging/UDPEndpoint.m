@@ -28,11 +28,45 @@
 #import <sys/time.h>
 #import <sys/socket.h>
 #import <netinet/in.h>
+#import <sys/event.h>
+#import <stdatomic.h>
+#import <sys/uio.h>
+#if defined(__APPLE__)
+#import <mach/mach_time.h>
+#else
+#import <time.h>
+#endif
 #import <fcntl.h>
 #import <unistd.h>
 
 NSString *const UdpSocketThreadName = @"SyncKitUDPSocketThread";
 
+// kevent() identifier of the user event used to wake up a waiting thread
+static const uintptr_t kWakeUpEventIdent = 1;
+
+// receive buffers in the pool when none is specified
+static const NSUInteger kDefaultPoolSize = 8;
+
+// most datagrams read by one batched call
+#define UDP_MAX_BATCH 32
+
+// room for a timestamp control message, aligned
+#define UDP_CONTROL_WORDS 8
+
+
+// host time, in the units of kernel monotonic receive timestamps
+static inline uint64_t HostAbsoluteTime(void)
+{
+#if defined(__APPLE__)
+    return mach_absolute_time();
+#else
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+#endif
+}
+
 static NSThread *listenerThread;
 
 @interface UDPEndpoint()
@@ -43,6 +77,7 @@ static NSThread *listenerThread;
 @property (nonatomic, copy,   readwrite) NSData *               hostAddress;
 @property (nonatomic, assign, readwrite) NSUInteger             port;
 @property (nonatomic, assign)             size_t                bufferSize;
+@property (nonatomic, assign, readwrite)  NSUInteger            droppedDatagrams;
 
 // forward declarations
 
@@ -50,21 +85,35 @@ static NSThread *listenerThread;
 - (void)stopWithError:(NSError *)error;
 - (void)stopWithStreamError:(CFStreamError)streamError;
 - (void)listenerThread;
+- (BOOL)readData;
+- (NSUInteger)readDatagramBatch;
+- (BOOL)dropDatagram;
+- (UDPDatagram *)borrowDatagram;
+- (BOOL)setupEventQueue;
+- (void)setupReceiveTimestamps;
 
 
 @end
 
 
-// send and receive buffers
-uint8_t *recv_buf;
-uint8_t *send_buf;
-
 @implementation UDPEndpoint
 {
+    // send and receive buffers
+    uint8_t                 *recv_buf;
+    uint8_t                 *send_buf;
+    
+    // receive buffer pool for -didReceiveDatagram:, allocated once
+    UDPDatagram             *datagrams;
+    uint8_t                 *poolBuffers;
+    atomic_bool             *borrowed;
+    NSUInteger              poolSize;
+    NSUInteger              nextSlot;
+    
     CFHostRef               _cfHost;
     //    CFSocketRef             _cfSocket;
     int                     sockfd;
     fd_set                  read_fd_set;
+    int                     kq;                 // kqueue watching the socket
     BOOL                    continue_loop;
     
 }
@@ -73,17 +122,41 @@ uint8_t *send_buf;
 @synthesize hostName    = _hostName;
 @synthesize hostAddress = _hostAddress;
 @synthesize port        = _port;
+@synthesize receiveTimestamps = _receiveTimestamps;
+@synthesize droppedDatagrams = _droppedDatagrams;
 
 
 - (id)initWithBufferSize:(size_t) size
+{
+    return [self initWithBufferSize:size PoolSize:kDefaultPoolSize];
+}
+
+
+- (id)initWithBufferSize:(size_t) size PoolSize:(NSUInteger) pool_size
 {
     self = [super init];
     if (self != nil) {
+        NSUInteger i;
         
         self.bufferSize = size;
         recv_buf = (uint8_t *) malloc(size);
         send_buf = (uint8_t *) malloc(size);
+        kq = -1;
+        
+        poolSize = MAX(pool_size, 1);
+        nextSlot = 0;
+        datagrams = (UDPDatagram *) calloc(poolSize, sizeof(UDPDatagram));
+        poolBuffers = (uint8_t *) malloc(poolSize * size);
+        borrowed = (atomic_bool *) malloc(poolSize * sizeof(atomic_bool));
+        
+        if ((datagrams == NULL) || (poolBuffers == NULL) || (borrowed == NULL))
+            return nil;
         
+        for (i = 0; i < poolSize; i++) {
+            datagrams[i].bytes = poolBuffers + i * size;
+            datagrams[i].slot = (uint32_t) i;
+            atomic_init(&borrowed[i], false);
+        }
     }
     return self;
 }
@@ -92,6 +165,16 @@ uint8_t *send_buf;
 {
     close(sockfd);
     
+    if (kq >= 0)
+        close(kq);
+    kq = -1;
+    
+    free(recv_buf);
+    free(send_buf);
+    free(datagrams);
+    free(poolBuffers);
+    free(borrowed);
+    
     _cfHost = nil;
     
     
@@ -197,6 +280,184 @@ uint8_t *send_buf;
 }
 
 
+- (int) waitForIncomingPackets:(uint32_t) timeout_us
+{
+    struct kevent   events[2];
+    struct timespec timeout;
+    int             nevents;
+    int             i;
+    int             packets = 0;
+    
+    assert(kq >= 0);
+    
+    timeout.tv_sec = timeout_us / 1000000;
+    timeout.tv_nsec = (timeout_us % 1000000) * 1000;
+    
+    nevents = kevent(kq, NULL, 0, events, 2, &timeout);
+    
+    if (nevents < 0)
+    {
+        if (errno == EINTR) return 0;
+        
+        MWLogDebug(@"kevent error: %s", strerror(errno));
+        return -1;
+    }
+    
+    BOOL batched = (self.delegate != nil) && [self.delegate respondsToSelector:@selector(didReceiveDatagrams:Count:)];
+    NSUInteger n;
+    
+    for (i = 0; i < nevents; i++)
+    {
+        if (events[i].filter == EVFILT_READ)
+        {
+            // drain the socket; each datagram, or batch of datagrams, reaches the delegate as
+            // soon as it is read
+            if (batched) {
+                while ((n = [self readDatagramBatch]) > 0)
+                    packets += n;
+            } else {
+                while ([self readData])
+                    packets++;
+            }
+        }
+        // EVFILT_USER: woken up by -wakeUp, the event clears itself
+    }
+    
+    return packets;
+}
+
+
+- (void) wakeUp
+{
+    struct kevent event;
+    
+    if (kq < 0) return;
+    
+    EV_SET(&event, kWakeUpEventIdent, EVFILT_USER, 0, NOTE_TRIGGER, 0, NULL);
+    kevent(kq, &event, 1, NULL, 0, NULL);
+}
+
+
+- (void)setupReceiveTimestamps
+// Ask the kernel to attach a receive timestamp to each datagram, if the option is set.
+{
+    int on = 1;
+    int err;
+    
+    if (!self.receiveTimestamps) return;
+    
+#if defined(SO_TIMESTAMP_MONOTONIC)
+    err = setsockopt(sockfd, SOL_SOCKET, SO_TIMESTAMP_MONOTONIC, &on, sizeof(on));
+#else
+    err = setsockopt(sockfd, SOL_SOCKET, SO_TIMESTAMP, &on, sizeof(on));
+#endif
+    
+    // not fatal: datagrams are then timestamped when they are read
+    if (err < 0)
+        MWLogWarning(@"UDPEndpoint: receive timestamps not available: %s", strerror(errno));
+}
+
+
+/**
+ *  Kernel receive timestamp of a datagram, from recvmsg() ancillary data, in host time units.
+ *
+ *  @return YES if the message carried a timestamp
+ */
+static BOOL ReceiveTimestampFromMessage(struct msghdr *msg, uint64_t *host_time)
+{
+    struct cmsghdr *cmsg;
+    
+    for (cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL; cmsg = CMSG_NXTHDR(msg, cmsg))
+    {
+        if (cmsg->cmsg_level != SOL_SOCKET) continue;
+        
+#if defined(SCM_TIMESTAMP_MONOTONIC)
+        if (cmsg->cmsg_type == SCM_TIMESTAMP_MONOTONIC)
+        {
+            memcpy(host_time, CMSG_DATA(cmsg), sizeof(uint64_t));
+            return YES;
+        }
+#else
+        if (cmsg->cmsg_type == SCM_TIMESTAMP)
+        {
+            // wall-clock timestamp: carry it over to the monotonic host timescale (nanoseconds
+            // off Apple platforms) through the current offset between the two
+            struct timeval tv;
+            struct timeval now;
+            uint64_t host_now = HostAbsoluteTime();
+            
+            memcpy(&tv, CMSG_DATA(cmsg), sizeof(tv));
+            gettimeofday(&now, NULL);
+            *host_time = host_now - ((int64_t) (now.tv_sec - tv.tv_sec) * 1000000000LL
+                                     + (int64_t) (now.tv_usec - tv.tv_usec) * 1000LL);
+            return YES;
+        }
+#endif
+    }
+    return NO;
+}
+
+
+/**
+ *  Set up a recvmsg() header to read into a buffer.
+ */
+static void PrepareReceiveMessage(struct msghdr *msg, struct iovec *iov, void *buffer, size_t size,
+                                  struct sockaddr_storage *addr, uint64_t *control)
+{
+    iov->iov_base = buffer;
+    iov->iov_len = size;
+    
+    memset(msg, 0, sizeof(*msg));
+    msg->msg_name = addr;
+    msg->msg_namelen = sizeof(*addr);
+    msg->msg_iov = iov;
+    msg->msg_iovlen = 1;
+    if (control != NULL) {
+        msg->msg_control = control;
+        msg->msg_controllen = UDP_CONTROL_WORDS * sizeof(uint64_t);
+    }
+}
+
+
+/**
+ *  Fill in a datagram after recvmsg() read it.
+ */
+static void CompleteDatagram(UDPDatagram *datagram, struct msghdr *msg, size_t length, BOOL timestamps)
+{
+    datagram->length = length;
+    datagram->addressLength = msg->msg_namelen;
+    datagram->kernelTimestamp = timestamps && ReceiveTimestampFromMessage(msg, &datagram->hostTime);
+    
+    if (!datagram->kernelTimestamp)
+        datagram->hostTime = HostAbsoluteTime();
+}
+
+
+- (BOOL)setupEventQueue
+// Create the kqueue that -waitForIncomingPackets: blocks on: the socket's read filter and a user
+// event for -wakeUp.
+{
+    struct kevent events[2];
+    
+    if (kq < 0)
+        kq = kqueue();
+    
+    if (kq < 0) {
+        MWLogError(@"UDPEndpoint: kqueue error: %s", strerror(errno));
+        return NO;
+    }
+    
+    EV_SET(&events[0], sockfd, EVFILT_READ, EV_ADD, 0, 0, NULL);
+    EV_SET(&events[1], kWakeUpEventIdent, EVFILT_USER, EV_ADD | EV_CLEAR, 0, 0, NULL);
+    
+    if (kevent(kq, events, 2, NULL, 0, NULL) < 0) {
+        MWLogError(@"UDPEndpoint: kevent registration error: %s", strerror(errno));
+        return NO;
+    }
+    return YES;
+}
+
+
 
 - (void)startListenerThreadIfNeeded
 {
@@ -219,9 +480,7 @@ uint8_t *send_buf;
         
         do{
             
-            [self checkForIncomingPackets:10000];
-            
-            usleep(1000);
+            [self waitForIncomingPackets:10000];
             
         }while(continue_loop);
         
@@ -235,22 +494,69 @@ uint8_t *send_buf;
 
 
 
-- (void)readData
-// Called by the CFSocket read callback to actually read and process data
-// from the socket.
+- (BOOL)readData
+// Called when the socket is readable to actually read and process data
+// from the socket. Does not block; returns NO if no datagram was waiting.
 {
     int                     err;
     struct sockaddr_storage addr;
     socklen_t               addrLen;
     
     ssize_t                 bytesRead;
+    struct iovec            iov;
+    struct msghdr           msg;
+    uint64_t                control[UDP_CONTROL_WORDS];
+    uint64_t                hostTime = 0;
+    BOOL                    timestamped = NO;
+    UDPDatagram             *datagram = NULL;
+    BOOL                    zeroCopy;
+    
+    zeroCopy = (self.delegate != nil) && [self.delegate respondsToSelector:@selector(didReceiveDatagram:)];
+    
+    // read straight into a free pool buffer; with none free, into the scratch buffer (the
+    // datagram is then dropped)
+    if (zeroCopy)
+        datagram = [self borrowDatagram];
+    
+    PrepareReceiveMessage(&msg, &iov,
+                          (datagram != NULL) ? (void *) datagram->bytes : recv_buf, self.bufferSize,
+                          (datagram != NULL) ? &datagram->address : &addr,
+                          self.receiveTimestamps ? control : NULL);
+    
+    bytesRead = recvmsg(self->sockfd, &msg, MSG_DONTWAIT);
+    
+    if (bytesRead > 0) {
+        if (self.receiveTimestamps)
+            timestamped = ReceiveTimestampFromMessage(&msg, &hostTime);
+        if (!timestamped && (self.receiveTimestamps || zeroCopy))
+            hostTime = HostAbsoluteTime();
+    }
+    addrLen = msg.msg_namelen;
+    
+    if (bytesRead <= 0) {
+        if (datagram != NULL) [self releaseDatagram:datagram];
+    }
     
-    addrLen = sizeof(addr);
-    bytesRead = recvfrom(self->sockfd, recv_buf, self.bufferSize, 0, (struct sockaddr *) &addr, &addrLen);
     if (bytesRead < 0) {
         err = errno;
+        if ((err == EAGAIN) || (err == EWOULDBLOCK) || (err == EINTR))
+            return NO;
     } else if (bytesRead == 0) {
         err = EPIPE;
+    } else if (zeroCopy) {
+        err = 0;
+        
+        if (datagram != NULL) {
+            datagram->length = (size_t) bytesRead;
+            datagram->addressLength = addrLen;
+            datagram->hostTime = hostTime;
+            datagram->kernelTimestamp = timestamped;
+            
+            // Lend the datagram to the delegate, which releases it.
+            [self.delegate didReceiveDatagram:datagram];
+        } else {
+            self.droppedDatagrams++;
+        }
     } else {
         NSData *    dataObj;
         NSData *    addrObj;
@@ -264,7 +570,9 @@ uint8_t *send_buf;
         
         // Tell the delegate about the data.
         
-        if ( (self.delegate != nil) && [self.delegate respondsToSelector:@selector(didReceiveData:fromAddress:)] ) {
+        if ( self.receiveTimestamps && (self.delegate != nil) && [self.delegate respondsToSelector:@selector(didReceiveData:fromAddress:hostTime:)] ) {
+            [self.delegate didReceiveData:dataObj fromAddress:addrObj hostTime:hostTime];
+        } else if ( (self.delegate != nil) && [self.delegate respondsToSelector:@selector(didReceiveData:fromAddress:)] ) {
             [self.delegate didReceiveData:dataObj fromAddress:addrObj];
         }
     }
@@ -276,6 +584,135 @@ uint8_t *send_buf;
             [self.delegate didReceiveError:[NSError errorWithDomain:NSPOSIXErrorDomain code:err userInfo:nil]];
         }
     }
+    
+    return (err == 0);
+}
+
+
+- (NSUInteger)readDatagramBatch
+// Read up to UDP_MAX_BATCH datagrams straight into pool buffers and lend them to the delegate
+// in one -didReceiveDatagrams:Count: call. Darwin has no recvmmsg(), so each datagram is still
+// one recvmsg(); what the batch saves is the delegate call, and the wake-up, per datagram.
+// Does not block; returns the number of datagrams taken off the socket (read or dropped).
+{
+    UDPDatagram             *batch[UDP_MAX_BATCH];
+    struct msghdr           msg;
+    struct iovec            iov;
+    uint64_t                control[UDP_CONTROL_WORDS];
+    ssize_t                 bytesRead;
+    NSUInteger              n = 0;
+    NSUInteger              count = 0;
+    NSUInteger              i;
+    int                     err = 0;
+    BOOL                    timestamps = self.receiveTimestamps;
+    
+    while ((n < UDP_MAX_BATCH) && ((batch[n] = [self borrowDatagram]) != NULL))
+        n++;
+    
+    // every buffer is lent out: drop a datagram rather than leave the socket readable
+    if (n == 0)
+        return [self dropDatagram] ? 1 : 0;
+    
+    for (count = 0; count < n; count++)
+    {
+        PrepareReceiveMessage(&msg, &iov, (void *) batch[count]->bytes, self.bufferSize,
+                              &batch[count]->address, timestamps ? control : NULL);
+        
+        bytesRead = recvmsg(self->sockfd, &msg, MSG_DONTWAIT);
+        if (bytesRead <= 0) {
+            err = (bytesRead < 0) ? errno : 0;
+            break;
+        }
+        CompleteDatagram(batch[count], &msg, (size_t) bytesRead, timestamps);
+    }
+    
+    for (i = count; i < n; i++)
+        [self releaseDatagram:batch[i]];
+    
+    if (count > 0) {
+        [self.delegate didReceiveDatagrams:(const UDPDatagram * const *) batch Count:count];
+    }
+    
+    if ((err != 0) && (err != EAGAIN) && (err != EWOULDBLOCK) && (err != EINTR)) {
+        if ( (self.delegate != nil) && [self.delegate respondsToSelector:@selector(didReceiveError:)] ) {
+            [self.delegate didReceiveError:[NSError errorWithDomain:NSPOSIXErrorDomain code:err userInfo:nil]];
+        }
+    }
+    
+    return count;
+}
+
+
+- (BOOL)dropDatagram
+// Read a datagram into the scratch buffer and discard it.
+{
+    if (recv(self->sockfd, recv_buf, self.bufferSize, MSG_DONTWAIT) < 0)
+        return NO;
+    
+    self.droppedDatagrams++;
+    return YES;
+}
+
+
+- (NSUInteger) sendDatagrams:(const UDPDatagram *) to_send Count:(NSUInteger) count
+{
+    struct msghdr           msg;
+    struct iovec            iov;
+    NSUInteger              sent;
+    
+    assert(self->sockfd >= 0);
+    
+    // Darwin has no sendmmsg(): one sendmsg() per datagram
+    for (sent = 0; sent < count; sent++)
+    {
+        const UDPDatagram *d = &to_send[sent];
+        
+        iov.iov_base = (void *) d->bytes;
+        iov.iov_len = d->length;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_name = (d->addressLength > 0) ? (void *) &d->address : NULL;
+        msg.msg_namelen = d->addressLength;
+        
+        if (sendmsg(self->sockfd, &msg, 0) < 0) break;
+    }
+    
+    if (sent < count)
+        MWLogDebug(@"UDPEndpoint: sent %lu of %lu datagrams: %s", (unsigned long) sent, (unsigned long) count, strerror(errno));
+    
+    return sent;
+}
+
+
+- (UDPDatagram *)borrowDatagram
+// Take a free buffer from the pool, or NULL if all are borrowed. Only the reading thread
+// borrows; any thread may release.
+{
+    NSUInteger i;
+    
+    for (i = 0; i < poolSize; i++)
+    {
+        NSUInteger slot = (nextSlot + i) % poolSize;
+        
+        if (!atomic_load_explicit(&borrowed[slot], memory_order_acquire))
+        {
+            atomic_store_explicit(&borrowed[slot], true, memory_order_relaxed);
+            nextSlot = (slot + 1) % poolSize;
+            return &datagrams[slot];
+        }
+    }
+    return NULL;
+}
+
+
+- (void) releaseDatagram:(const UDPDatagram *) datagram
+{
+    assert(datagram != NULL);
+    assert(datagram->slot < poolSize);
+    assert(datagram == &datagrams[datagram->slot]);
+    
+    atomic_store_explicit(&borrowed[datagram->slot], false, memory_order_release);
 }
 
 
@@ -340,7 +777,11 @@ uint8_t *send_buf;
     FD_ZERO (&read_fd_set);
     FD_SET (self->sockfd, &read_fd_set);
     
+    if (err == 0)
+        [self setupReceiveTimestamps];
     
+    if ((err == 0) && ![self setupEventQueue])
+        err = EINVAL;
     
     return (err == 0);
 }
@@ -463,6 +904,11 @@ uint8_t *send_buf;
         FD_ZERO (&read_fd_set);
         FD_SET (self->sockfd, &read_fd_set);
         
+        if (err == 0)
+            [self setupReceiveTimestamps];
+        
+        if ((err == 0) && ![self setupEventQueue])
+            err = EINVAL;
     }
     return (err == 0);
 }
@@ -509,6 +955,30 @@ uint8_t *send_buf;
     }
 }
 
+- (void)startUnconnected
+// See comment in header.
+{
+    assert(self.port == 0);     // don't try and start a started object
+    if (self.port == 0) {
+        struct sockaddr_storage addr;
+        socklen_t               addrLen = sizeof(addr);
+        NSError *               error = nil;
+        
+        // bound to the wildcard address on a port chosen by the kernel
+        if (![self setupSocketConnectedToAddress:nil port:0 error:&error] ||
+            (getsockname(self->sockfd, (struct sockaddr *) &addr, &addrLen) < 0)) {
+            [self stopWithError:[NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil]];
+            return;
+        }
+        
+        self.port = ntohs(((struct sockaddr_in *) &addr)->sin_port);
+        
+        if ( (self.delegate != nil) && [self.delegate respondsToSelector:@selector(didStartWithAddress:)] ) {
+            [self.delegate didStartWithAddress:[NSData dataWithBytes:&addr length:addrLen]];
+        }
+    }
+}
+
 - (void)hostResolutionDone
 // Called by our CFHost resolution callback (HostResolveCallback) when host
 // resolution is complete.  We find the best IP address and create a socket
@@ -664,6 +1134,9 @@ static void HostResolveCallback(CFHostRef theHost, CFHostInfoType typeInfo, cons
     self.hostAddress = nil;
     self.port = 0;
     continue_loop = NO;
+    
+    // unblock a thread waiting for packets
+    [self wakeUp];
     //[self stopHostResolution];
     //    if (self->_cfSocket != NULL) {
     //        CFSocketInvalidate(self->_cfSocket);
@@ -0,0 +1,218 @@
+//
+//  UDPEndpointDatagramTests.m
+//  UDPMessagingTests
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+#import <UDPMessaging/UDPMessaging.h>
+#import <sys/socket.h>
+#import <netinet/in.h>
+#import <arpa/inet.h>
+#import <unistd.h>
+
+static const NSUInteger kDatagramTestPort   = 17778;
+static const NSUInteger kBatchTestPort      = 17779;
+static const NSUInteger kPoolSize           = 4;
+static const NSUInteger kBatchPoolSize      = 64;
+
+
+@interface UDPEndpointDatagramTests : XCTestCase <UDPCommsDelegate>
+
+@end
+
+@implementation UDPEndpointDatagramTests
+{
+    UDPEndpoint         *endpoint;
+    int                 sendsock;
+    const UDPDatagram   *borrowed[16];
+    uint32_t            payloads[16];
+    int                 received;
+    BOOL                releaseAtOnce;
+}
+
+- (void)setUp {
+    [super setUp];
+    struct sockaddr_in addr;
+
+    // no -didStartWithAddress: in this delegate, so the test drives the receive loop itself
+    endpoint = [[UDPEndpoint alloc] initWithBufferSize:sizeof(uint32_t) PoolSize:kPoolSize];
+    endpoint.delegate = self;
+    [endpoint startServerOnPort:kDatagramTestPort];
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_len = sizeof(addr);
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(kDatagramTestPort);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    sendsock = socket(AF_INET, SOCK_DGRAM, 0);
+    XCTAssertEqual(connect(sendsock, (const struct sockaddr *) &addr, sizeof(addr)), 0);
+
+    received = 0;
+}
+
+- (void)tearDown {
+    close(sendsock);
+    [endpoint stop];
+    endpoint = nil;
+    [super tearDown];
+}
+
+
+- (void) didReceiveDatagram:(const UDPDatagram *)datagram
+{
+    uint32_t value;
+
+    XCTAssertEqual(datagram->length, sizeof(value));
+    memcpy(&value, datagram->bytes, sizeof(value));
+    payloads[received] = value;
+    borrowed[received++] = datagram;
+
+    if (releaseAtOnce) [endpoint releaseDatagram:datagram];
+}
+
+
+- (void) sendValues:(uint32_t) count
+{
+    uint32_t i;
+
+    for (i = 0; i < count; i++)
+        send(sendsock, &i, sizeof(i), 0);
+
+    usleep(10000);
+    [endpoint waitForIncomingPackets:100000];
+}
+
+
+- (void)testDatagramsAreLentInPlace {
+    int i;
+
+    releaseAtOnce = YES;
+    [self sendValues:10];
+
+    XCTAssertEqual(received, 10);
+    for (i = 0; i < received; i++) {
+        XCTAssertEqual(payloads[i], (uint32_t) i);
+        XCTAssertLessThan(borrowed[i]->slot, kPoolSize);
+    }
+    XCTAssertEqual(endpoint.droppedDatagrams, 0);
+}
+
+
+- (void)testDatagramsDroppedWhilePoolIsBorrowed {
+    int i;
+
+    releaseAtOnce = NO;
+    [self sendValues:6];
+
+    // every buffer is held by the delegate, so the last two datagrams have nowhere to go
+    XCTAssertEqual(received, (int) kPoolSize);
+    XCTAssertEqual(endpoint.droppedDatagrams, 2);
+
+    // the borrowed bytes are untouched until released
+    for (i = 0; i < received; i++) {
+        uint32_t value;
+        memcpy(&value, borrowed[i]->bytes, sizeof(value));
+        XCTAssertEqual(value, (uint32_t) i);
+        [endpoint releaseDatagram:borrowed[i]];
+    }
+
+    received = 0;
+    [self sendValues:2];
+    XCTAssertEqual(received, 2);
+    XCTAssertEqual(endpoint.droppedDatagrams, 2);
+}
+
+@end
+
+
+
+@interface UDPEndpointBatchTests : XCTestCase <UDPCommsDelegate>
+
+@end
+
+@implementation UDPEndpointBatchTests
+{
+    UDPEndpoint         *endpoint;
+    NSUInteger          received;
+    NSUInteger          batches;
+    uint32_t            expected;
+}
+
+- (void)setUp {
+    [super setUp];
+
+    endpoint = [[UDPEndpoint alloc] initWithBufferSize:sizeof(uint32_t) PoolSize:kBatchPoolSize];
+    endpoint.delegate = self;
+    [endpoint startServerOnPort:kBatchTestPort];
+
+    received = 0;
+    batches = 0;
+    expected = 0;
+}
+
+- (void)tearDown {
+    [endpoint stop];
+    endpoint = nil;
+    [super tearDown];
+}
+
+
+- (void) didReceiveDatagrams:(const UDPDatagram * const *)datagrams Count:(NSUInteger)count
+{
+    NSUInteger i;
+
+    XCTAssertLessThanOrEqual(count, kBatchPoolSize);
+    batches++;
+
+    for (i = 0; i < count; i++) {
+        uint32_t value;
+
+        memcpy(&value, datagrams[i]->bytes, sizeof(value));
+        XCTAssertEqual(value, expected++, @"datagrams arrive in order");
+        received++;
+
+        [endpoint releaseDatagram:datagrams[i]];
+    }
+}
+
+
+- (void)testSendAndReceiveBatches {
+    const NSUInteger count = 100;
+    UDPDatagram *out = calloc(count, sizeof(UDPDatagram));
+    uint32_t *values = calloc(count, sizeof(uint32_t));
+    struct sockaddr_in *addr;
+    NSUInteger i;
+
+    // send to ourselves
+    for (i = 0; i < count; i++) {
+        values[i] = (uint32_t) i;
+        out[i].bytes = (const uint8_t *) &values[i];
+        out[i].length = sizeof(uint32_t);
+
+        addr = (struct sockaddr_in *) &out[i].address;
+        addr->sin_len = sizeof(*addr);
+        addr->sin_family = AF_INET;
+        addr->sin_port = htons(kBatchTestPort);
+        addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        out[i].addressLength = sizeof(*addr);
+    }
+
+    XCTAssertEqual([endpoint sendDatagrams:out Count:count], count);
+    usleep(10000);
+
+    while ((received < count) && ([endpoint waitForIncomingPackets:100000] > 0));
+
+    XCTAssertEqual(received, count);
+    XCTAssertLessThan(batches, count, @"several datagrams per delegate call");
+    XCTAssertEqual(endpoint.droppedDatagrams, 0);
+
+    free(out);
+    free(values);
+}
+
+@end
@@ -0,0 +1,213 @@
+//
+//  UDPEndpointLatencyTests.m
+//  UDPMessagingTests
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+#import <UDPMessaging/UDPMessaging.h>
+#import <mach/mach_time.h>
+#import <sys/socket.h>
+#import <netinet/in.h>
+#import <arpa/inet.h>
+#import <unistd.h>
+
+// Measures the delay from a packet's arrival on a loopback socket to its receive timestamp (taken
+// in the delegate, or by the kernel), with every core kept busy by spinning threads. Each packet
+// carries the host time at which it was sent.
+
+static const NSUInteger kLatencyTestPort    = 17777;
+static const int        kNumPackets         = 500;
+static const useconds_t kSendPeriodUSecs    = 2000;
+
+static int64_t HostUnitsToNanos(uint64_t units)
+{
+    static mach_timebase_info_data_t timebase;
+
+    if (timebase.denom == 0) mach_timebase_info(&timebase);
+
+    return (int64_t) (units * timebase.numer / timebase.denom);
+}
+
+static int64_t HostTimeNanos(void)
+{
+    return HostUnitsToNanos(mach_absolute_time());
+}
+
+static int CompareInt64(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *) a, y = *(const int64_t *) b;
+
+    return (x > y) - (x < y);
+}
+
+
+@interface UDPEndpointLatencyTests : XCTestCase <UDPCommsDelegate>
+
+@end
+
+@implementation UDPEndpointLatencyTests
+{
+    UDPEndpoint         *endpoint;
+    int                 sendsock;
+    int64_t             latencies[kNumPackets];
+    int64_t             gaps[kNumPackets];          // kernel timestamp to delegate call
+    int                 received;
+    volatile BOOL       running;
+}
+
+- (void)setUp {
+    [super setUp];
+    struct sockaddr_in addr;
+
+    endpoint = [[UDPEndpoint alloc] initWithBufferSize:sizeof(int64_t)];
+    endpoint.delegate = self;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_len = sizeof(addr);
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(kLatencyTestPort);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    sendsock = socket(AF_INET, SOCK_DGRAM, 0);
+    XCTAssertEqual(connect(sendsock, (const struct sockaddr *) &addr, sizeof(addr)), 0);
+}
+
+- (void)tearDown {
+    close(sendsock);
+    [endpoint stop];
+    endpoint = nil;
+    [super tearDown];
+}
+
+
+// no -didStartWithAddress: in this delegate, so the endpoint starts no listener thread and
+// the test drives the receive loop itself
+- (void) startEndpointWithReceiveTimestamps:(BOOL) timestamps
+{
+    endpoint.receiveTimestamps = timestamps;
+    [endpoint startServerOnPort:kLatencyTestPort];
+}
+
+
+- (void) didReceiveData:(NSData *)data fromAddress:(NSData *)addr hostTime:(uint64_t)host_time
+{
+    int64_t now = HostTimeNanos();
+    int64_t arrival = HostUnitsToNanos(host_time);
+    int64_t sent;
+
+    if (([data length] != sizeof(sent)) || (received >= kNumPackets)) return;
+
+    [data getBytes:&sent length:sizeof(sent)];
+    gaps[received] = now - arrival;
+    latencies[received++] = arrival - sent;
+}
+
+
+- (void) didReceiveData:(NSData *)data fromAddress:(NSData *)addr
+{
+    int64_t now = HostTimeNanos();
+    int64_t sent;
+
+    if (([data length] != sizeof(sent)) || (received >= kNumPackets)) return;
+
+    [data getBytes:&sent length:sizeof(sent)];
+    latencies[received++] = now - sent;
+}
+
+
+/**
+ *  Send packets while a receiver thread runs loop_body and all cores are loaded; returns the
+ *  median latency in nanoseconds.
+ */
+- (int64_t) medianLatencyWithReceiveLoop:(void (^)(void)) loop_body Label:(NSString*) label
+{
+    dispatch_group_t group = dispatch_group_create();
+    dispatch_queue_t queue = dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0);
+    NSUInteger cores = [[NSProcessInfo processInfo] activeProcessorCount];
+    NSUInteger i;
+    int n;
+
+    received = 0;
+    running = YES;
+
+    // load
+    for (i = 0; i < cores; i++) {
+        dispatch_group_async(group, dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+            volatile double x = 1.0;
+            while (running) x = x * 1.0000001 + 0.5;
+        });
+    }
+
+    dispatch_group_async(group, queue, ^{
+        while (running) loop_body();
+    });
+
+    for (n = 0; n < kNumPackets; n++) {
+        int64_t now = HostTimeNanos();
+        send(sendsock, &now, sizeof(now), 0);
+        usleep(kSendPeriodUSecs);
+    }
+    usleep(20000);
+
+    running = NO;
+    [endpoint wakeUp];
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+
+    XCTAssertGreaterThan(received, kNumPackets * 9 / 10);
+    if (received == 0) return INT64_MAX;
+
+    qsort(latencies, received, sizeof(int64_t), CompareInt64);
+    NSLog(@"%@: %d packets, latency p50 %lld us, p99 %lld us, max %lld us", label, received,
+          latencies[received / 2] / 1000, latencies[received * 99 / 100] / 1000, latencies[received - 1] / 1000);
+
+    return latencies[received / 2];
+}
+
+
+- (void)testTimestampLatencyUnderLoad {
+    UDPEndpoint *ep = endpoint;
+
+    [self startEndpointWithReceiveTimestamps:NO];
+
+    // the previous receive loop: select() with a timeout, then a 1ms sleep
+    int64_t polled = [self medianLatencyWithReceiveLoop:^{
+        [ep checkForIncomingPackets:1000];
+        usleep(1000);
+    } Label:@"select + usleep"];
+
+    int64_t evented = [self medianLatencyWithReceiveLoop:^{
+        [ep waitForIncomingPackets:10000];
+    } Label:@"kqueue"];
+
+    XCTAssertLessThan(evented, polled);
+}
+
+
+/**
+ *  With kernel receive timestamps, the time between arrival and the delegate call (the event
+ *  loop's wake-up and the copy out of the receive buffer) no longer adds to the response time.
+ */
+- (void)testKernelReceiveTimestampsUnderLoad {
+    UDPEndpoint *ep = endpoint;
+
+    [self startEndpointWithReceiveTimestamps:YES];
+
+    int64_t kernel = [self medianLatencyWithReceiveLoop:^{
+        [ep waitForIncomingPackets:10000];
+    } Label:@"kqueue, kernel timestamps"];
+    if (received == 0) return;
+
+    qsort(gaps, received, sizeof(int64_t), CompareInt64);
+    NSLog(@"kernel timestamp to delegate: p50 %lld us, p99 %lld us, max %lld us",
+          gaps[received / 2] / 1000, gaps[received * 99 / 100] / 1000, gaps[received - 1] / 1000);
+
+    // timestamps precede the delegate call, and were taken after the packet was sent
+    XCTAssertGreaterThanOrEqual(gaps[0], 0);
+    XCTAssertGreaterThanOrEqual(kernel, 0);
+}
+
+@end
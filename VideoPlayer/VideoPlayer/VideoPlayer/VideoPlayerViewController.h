@@ -378,6 +378,19 @@ reachedEndOfVideoFile:(AVPlayerItem *) videoAsset;
 
 //------------------------------------------------------------------------------
 
+/**
+ *  Pause the player at a time position in the media and fill its buffers from there, so that a
+ *  following setRate:time:atHostTime: at or shortly after this position starts playback without
+ *  waiting for media to load.
+ *
+ *  @param time    time position on media timeline in seconds
+ *  @param handler called on the main queue when prerolling completes; finished is NO if the
+ *                 player was not ready to play or the preroll was interrupted
+ */
+- (void) prerollAtTime:(Float64) time CompletionHandler:(void (^)(BOOL finished)) handler;
+
+//------------------------------------------------------------------------------
+
 /**
  *  Subscribe an observer to receive playback time notifications (VideoPlayerCurrentTimeNotification) every 'periodMS' milliseconds
  *
@@ -568,6 +568,30 @@ NSString * const AVPlayerCurrentTimeNotif                   = @"AVPlayerCurrentT
 
 //------------------------------------------------------------------------------
 
+- (void) prerollAtTime:(Float64) time CompletionHandler:(void (^)(BOOL finished)) handler
+{
+    AVPlayer *player = self.videoPlayer.player;
+    CMTime mediaObjectTime = CMTimeMakeWithSeconds(time, 1000000);
+    
+    [self pause];
+    
+    [self.playerItem seekToTime:mediaObjectTime toleranceBefore:kCMTimeZero toleranceAfter:kCMTimeZero completionHandler:^(BOOL seeked) {
+        
+        // AVPlayer only prerolls a ready, paused player
+        if ((!seeked) || (player.status != AVPlayerStatusReadyToPlay) || (player.rate != 0.0))
+        {
+            dispatch_async(dispatch_get_main_queue(), ^{ if (handler) handler(NO); });
+            return;
+        }
+        
+        [player prerollAtRate:1.0f completionHandler:^(BOOL finished) {
+            dispatch_async(dispatch_get_main_queue(), ^{ if (handler) handler(finished); });
+        }];
+    }];
+}
+
+//------------------------------------------------------------------------------
+
 
 - (BOOL) addPeriodicTime:(uint32_t) periodMs Observer: (id) observer
 {
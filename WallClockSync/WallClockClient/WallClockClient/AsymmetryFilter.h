@@ -0,0 +1,57 @@
+//
+//  AsymmetryFilter.h
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+#import "WindowedCandidateFilter.h"
+
+/**
+ *  Filter that rejects candidates whose request and response took very different times to
+ *  cross the network.
+ *
+ *  A candidate's offset assumes the two one-way delays were equal; taking the median offset of
+ *  recent candidates as the true offset instead, a candidate's one-way delays are
+ *  RTT/2 + (offset - median) and RTT/2 - (offset - median). The filter rejects candidates where
+ *  the difference between them, 2 |offset - median|, is more than a fraction of the round trip
+ *  time. A fraction of 1 rejects only candidates that imply a negative one-way delay.
+ *
+ *  Offsets are compared as offsets from the wallclock's parent clock.
+ */
+@interface AsymmetryFilter : WindowedCandidateFilter
+
+/**
+ *  Largest difference between the one-way delays, as a fraction of the round trip time
+ */
+@property (nonatomic, readonly) double maxAsymmetry;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Initialise the filter
+ *
+ *  @param max_asymmetry - largest difference between the one-way delays, as a fraction of the
+ *  round trip time, e.g. 0.8 to reject candidates where one direction took over 90% of it
+ *  @param window        - number of recent offsets to keep
+ *
+ *  @return initialised AsymmetryFilter instance
+ */
+- (id) initWithMaxAsymmetry:(double) max_asymmetry Window:(NSUInteger) window;
+
+@end
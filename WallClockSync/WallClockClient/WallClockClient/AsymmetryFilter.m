@@ -0,0 +1,72 @@
+//
+//  AsymmetryFilter.m
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "AsymmetryFilter.h"
+#import <SyncKitCollections/SyncKitCollections.h>
+
+
+@implementation AsymmetryFilter
+{
+    WindowedStats           *offsets;
+}
+
+
+- (id) initWithMaxAsymmetry:(double) max_asymmetry Window:(NSUInteger) window
+{
+    self = [super initWithWindow:window];
+    if (self != nil) {
+        _maxAsymmetry = MAX(max_asymmetry, 0.0);
+        offsets = [[WindowedStats alloc] initWithCapacity:self.window];
+    }
+    return self;
+}
+
+
+- (BOOL) comparesOffsets
+{
+    return YES;
+}
+
+
+- (void) filterBatch:(CandidateBatch*) batch
+{
+    double offset[CANDIDATE_BATCH_MAX];
+    BOOL judging = [self isJudging:offsets.count];
+    double median = judging ? [offsets median] : 0;
+    NSUInteger i, kept = 0, live = batch->live;
+
+    for (i = 0; i < live; i++)
+    {
+        uint8_t c = batch->selected[i];
+
+        offset[i] = (double) batch->offset[c];
+        batch->selected[kept] = c;
+        kept += !judging || (2.0 * fabs(offset[i] - median) <= _maxAsymmetry * (double) MAX(batch->RTT[c], 0));
+    }
+    batch->live = kept;
+
+    for (i = 0; i < live; i++)
+        [offsets put:offset[i]];
+
+    [self countBatch:live Kept:kept];
+}
+
+@end
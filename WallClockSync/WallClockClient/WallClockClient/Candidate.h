@@ -30,7 +30,7 @@
  If at a particular time T, the candidate's dispersion > MAX_TOLERABLE_DISPERSION, then the candidate is no longer useful
  and should be filtered out.
  */
-@interface Candidate : Node
+@interface Candidate : Node <NSCopying>
 
 /** T1 */
 @property (nonatomic, readwrite) int64_t           originateTime;  // T1
@@ -57,6 +57,20 @@
 
 @property (nonatomic, readwrite) int64_t          initialDispersion;
 
+/** index of the WC server this measurement was made against (0 with a single server) */
+@property (nonatomic, readwrite) uint32_t          source;
+
+/** YES for a candidate from a CandidateSink's pool: the sink recycles it once it has been
+ processed, so algorithms and filters that keep a candidate must keep a copy. Copies are not
+ recyclable. */
+@property (nonatomic, readwrite) BOOL              recyclable;
+
+/**
+ *  Initialise an empty candidate, to be filled in with resetWithPacket:
+ *  @param is_nanos Boolean flag, true if time is in nano seconds.
+ */
+- (id)initWithTimeIsNanos:(BOOL) is_nanos;
+
 /**
  *  Initialise a candidate object with a received WC Sync packet and calculate initial dispersion
  *  @param response_msg a WCSyncMessage response received from the Wall Clock server
@@ -65,6 +79,26 @@
  */
 - (id)initWithResponseMsg:(WCSyncMessage*) response_msg Quality: (int8_t) quality TimeIsNanos:(BOOL) is_nanos;
 
+/**
+ *  Initialise a candidate object straight from a received WC Sync packet, without a
+ *  WCSyncMessage, and calculate initial dispersion
+ *  @param packet a WC response packet; its fields are read, it is not kept
+ *  @param response_time time of arrival of the packet (T4)
+ *  @param quality the quality of the response
+ *  @param is_nanos Boolean flag, true if time is in nano seconds.
+ */
+- (id)initWithPacket:(const WCSyncMessagePkt*) packet ResponseTimeNanos:(int64_t) response_time Quality:(int8_t) quality TimeIsNanos:(BOOL) is_nanos;
+
+
+/**
+ *  Reuse this candidate for another response packet: all measurement fields are recalculated.
+ *  Only for candidates that are no longer referenced elsewhere, i.e. handed back to a pool.
+ *  @param packet a WC response packet; its fields are read, it is not kept
+ *  @param response_time time of arrival of the packet (T4)
+ *  @param quality the quality of the response
+ */
+- (void) resetWithPacket:(const WCSyncMessagePkt*) packet ResponseTimeNanos:(int64_t) response_time Quality:(int8_t) quality;
+
 
 /**
  *  Compute and return candidate offset
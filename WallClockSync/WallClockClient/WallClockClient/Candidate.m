@@ -36,59 +36,112 @@
 
 - (id)initWithResponseMsg:(WCSyncMessage*) response_msg Quality: (int8_t) quality TimeIsNanos:(BOOL) is_nanos
 {
-    WCSyncMessagePkt *pkt;
+    self = [self initWithPacket:response_msg.packet
+              ResponseTimeNanos:[response_msg responseTimeNanos]
+                        Quality:quality
+                    TimeIsNanos:is_nanos];
+    if (self != nil) {
+        _responseMsg = response_msg;
+    }
+    return self;
+}
+
+
+- (id)initWithTimeIsNanos:(BOOL) is_nanos
+{
     _config = [SyncKitGlobals getInstance];
     
     
     self = [super init];
     if (self != nil) {
         
-        _responseMsg = response_msg;
-        _responseTime =  [response_msg responseTimeNanos];
-        pkt = response_msg.packet;
-       
-         _originateTime = ((int64_t) ntohl(pkt->originate_timevalue.timevalue_secs)) * 1000000000 + (int64_t) ntohl(pkt->originate_timevalue.timevalue_nanos);
-        
-        _receiveTime = ((int64_t) ntohl(pkt->receive_timevalue.timevalue_secs)) * 1000000000 + (int64_t) ntohl(pkt->receive_timevalue.timevalue_nanos);
-        
-        _transmitTime = ((int64_t) ntohl(pkt->transmit_timevalue.timevalue_secs)) * 1000000000 + (int64_t) ntohl(pkt->transmit_timevalue.timevalue_nanos);
-        
         _nanos = is_nanos;
         
         // get client precision and frequency error from device config
         wcClientPrecisionInNanos = _config.ClientWCPrecisionInNanos;
         wcClientFreqError = _config.ClientWCFrequencyError;
-        
-        // get server  precision and frequency error from message
-        if (_config.ServerWCPrecisionInNanos == 0)
-        {
-           _config.ServerWCPrecisionInNanos = pow(2,  (int8_t) pkt->precision) * 1000000000  ; // server wall clock precision in nanos
-        }
-        _wcServerPrecisionInNanos = pow(2,  (int8_t) pkt->precision) * 1000000000  ;
-        
-        if (_config.ServerWCFrequencyError ==0 )
-            _config.ServerWCFrequencyError = ntohl(pkt->max_freq_error) / 256;
+    }
+    return self;
+}
 
-        _wcServerMaxFreqError = ntohl(pkt->max_freq_error) / 256;
-        
-        _quality = quality;
-        
-        
-        // calculate the offset value
-        int64_t diff = ((_receiveTime +  _transmitTime) - (_responseTime + _originateTime));
-        _offset =  diff / 2 ; 
-        
-        // calculate round trip time
-        _RTT =  (_responseTime - _originateTime) - (_transmitTime - _receiveTime);
-        
-        // calculate initial value for dispersion at the time of measurement
-         _initialDispersion = [self getDispersionAtTime:_responseTime];
-//         MWLogDebug(@"offset=%f ms \t     RTT = %f ms \t     Dispersion = %f ms", (float)_offset/1000000,  (float) _RTT/1000000, (float)_initialDispersion / 1000000);
+
+- (id)initWithPacket:(const WCSyncMessagePkt*) packet ResponseTimeNanos:(int64_t) response_time Quality:(int8_t) quality TimeIsNanos:(BOOL) is_nanos
+{
+    self = [self initWithTimeIsNanos:is_nanos];
+    if (self != nil) {
+        [self resetWithPacket:packet ResponseTimeNanos:response_time Quality:quality];
     }
     return self;
 }
 
 
+- (id) copyWithZone:(NSZone *)zone
+{
+    Candidate *copy = [[Candidate allocWithZone:zone] initWithTimeIsNanos:_nanos];
+    
+    if (copy != nil) {
+        copy->_originateTime = _originateTime;
+        copy->_receiveTime = _receiveTime;
+        copy->_transmitTime = _transmitTime;
+        copy->_responseTime = _responseTime;
+        copy->_offset = _offset;
+        copy->_RTT = _RTT;
+        copy->_wcServerPrecisionInNanos = _wcServerPrecisionInNanos;
+        copy->_wcServerMaxFreqError = _wcServerMaxFreqError;
+        copy->_responseMsg = _responseMsg;
+        copy->_quality = _quality;
+        copy->_initialDispersion = _initialDispersion;
+        copy->_source = _source;
+        copy->wcClientPrecisionInNanos = wcClientPrecisionInNanos;
+        copy->wcClientFreqError = wcClientFreqError;
+    }
+    return copy;
+}
+
+
+- (void) resetWithPacket:(const WCSyncMessagePkt*) pkt ResponseTimeNanos:(int64_t) response_time Quality:(int8_t) quality
+{
+    // a recycled candidate may still be linked to the candidate that followed it in a queue
+    self.next = nil;
+    _responseMsg = nil;
+    _source = 0;
+    
+    _responseTime =  response_time;
+   
+    _originateTime = ((int64_t) ntohl(pkt->originate_timevalue.timevalue_secs)) * 1000000000 + (int64_t) ntohl(pkt->originate_timevalue.timevalue_nanos);
+    
+    _receiveTime = ((int64_t) ntohl(pkt->receive_timevalue.timevalue_secs)) * 1000000000 + (int64_t) ntohl(pkt->receive_timevalue.timevalue_nanos);
+    
+    _transmitTime = ((int64_t) ntohl(pkt->transmit_timevalue.timevalue_secs)) * 1000000000 + (int64_t) ntohl(pkt->transmit_timevalue.timevalue_nanos);
+    
+    // get server  precision and frequency error from message
+    if (_config.ServerWCPrecisionInNanos == 0)
+    {
+       _config.ServerWCPrecisionInNanos = pow(2,  (int8_t) pkt->precision) * 1000000000  ; // server wall clock precision in nanos
+    }
+    _wcServerPrecisionInNanos = pow(2,  (int8_t) pkt->precision) * 1000000000  ;
+    
+    if (_config.ServerWCFrequencyError ==0 )
+        _config.ServerWCFrequencyError = ntohl(pkt->max_freq_error) / 256;
+
+    _wcServerMaxFreqError = ntohl(pkt->max_freq_error) / 256;
+    
+    _quality = quality;
+    
+    
+    // calculate the offset value
+    int64_t diff = ((_receiveTime +  _transmitTime) - (_responseTime + _originateTime));
+    _offset =  diff / 2 ; 
+    
+    // calculate round trip time
+    _RTT =  (_responseTime - _originateTime) - (_transmitTime - _receiveTime);
+    
+    // calculate initial value for dispersion at the time of measurement
+     _initialDispersion = [self getDispersionAtTime:_responseTime];
+//         MWLogDebug(@"offset=%f ms \t     RTT = %f ms \t     Dispersion = %f ms", (float)_offset/1000000,  (float) _RTT/1000000, (float)_initialDispersion / 1000000);
+}
+
+
 /**
  Cleanup code
  */
@@ -135,10 +188,15 @@
 
 - (int64_t) getCandidateExpirationTime:(int64_t) accuracy_target_nanos
 {
-    if (accuracy_target_nanos > _initialDispersion)
-           return _responseTime + ((accuracy_target_nanos - _initialDispersion) * (1/(1000*(wcClientFreqError + _wcServerMaxFreqError))));
-    else
+    uint32_t growth_ppm = wcClientFreqError + _wcServerMaxFreqError;
+    
+    if (accuracy_target_nanos <= _initialDispersion)
         return _responseTime;
+    else if (growth_ppm == 0)
+        return INT64_MAX;
+    else
+        // dispersion grows by growth_ppm nanoseconds every millisecond
+        return _responseTime + ((accuracy_target_nanos - _initialDispersion) * 1000000) / growth_ppm;
 }
 
 
@@ -0,0 +1,85 @@
+//
+//  CandidateFilterChain.h
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+#import "IBatchFilter.h"
+
+
+/**
+ *  An ordered list of candidate filters, compiled for running over batches of candidates.
+ *
+ *  When the chain is made, each filter's filterBatch: (for IBatchFilter filters) or
+ *  checkCandidate: implementation is looked up once, so running the chain makes no message
+ *  sends. A batch goes through the filters in order; each filter sees only the candidates that
+ *  passed the filters before it, and the chain stops once none are left.
+ *
+ *  The chain counts the candidates rejected by each filter. The counts can be read from any
+ *  thread; the chain itself is run by one thread at a time.
+ */
+@interface CandidateFilterChain : NSObject
+
+/**
+ *  The filters, in the order they are applied
+ */
+@property (nonatomic, readonly) NSArray<id<IFilter>> *filters;
+
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Compile a chain of filters
+ *
+ *  @param filters - the filters, in the order they are to be applied
+ *
+ *  @return a CandidateFilterChain instance
+ */
+- (instancetype) initWithFilters:(NSArray<id<IFilter>> *) filters;
+
+/**
+ *  Fill in a batch's measurement fields from candidates, all selected
+ *
+ *  @param batch      - the batch
+ *  @param candidates - up to CANDIDATE_BATCH_MAX candidates; not retained by the batch
+ *  @param count      - number of candidates
+ *  @param skew       - offset of the wallclock's parent clock from the wallclock, in nanoseconds,
+ *  to turn candidate offsets into offsets from the parent clock; 0 to leave them as they are
+ */
++ (void) loadBatch:(CandidateBatch*) batch
+    WithCandidates:(__unsafe_unretained Candidate * const *) candidates
+             Count:(NSUInteger) count
+        ParentSkew:(int64_t) skew;
+
+/**
+ *  Run the batch through the filters
+ *
+ *  @param batch - a loaded batch; on return, selected[0..live) lists the candidates that
+ *  passed every filter
+ */
+- (void) filterBatch:(CandidateBatch*) batch;
+
+/**
+ *  Number of candidates each filter has rejected
+ *
+ *  @return one count per filter, in the order of filters
+ */
+- (NSArray<NSNumber *> *) rejectionCounts;
+
+@end
@@ -0,0 +1,157 @@
+//
+//  CandidateFilterChain.m
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "CandidateFilterChain.h"
+#import "Candidate.h"
+#import <stdatomic.h>
+
+
+typedef void (*FilterBatchIMP)(id, SEL, CandidateBatch*);
+typedef BOOL (*CheckCandidateIMP)(id, SEL, Candidate*);
+
+/**
+ *  A compiled filter: the filter and the implementation to call
+ */
+typedef struct {
+    __unsafe_unretained id<IFilter> filter;     // retained by the filters array
+    FilterBatchIMP                  filterBatch;
+    CheckCandidateIMP               checkCandidate;
+} FilterStage;
+
+
+@implementation CandidateFilterChain
+{
+    FilterStage             *stages;
+    NSUInteger              stageCount;
+    atomic_uint_fast64_t    *rejections;
+}
+
+
+- (instancetype) initWithFilters:(NSArray<id<IFilter>> *) filters
+{
+    NSUInteger i;
+
+    self = [super init];
+    if (self != nil) {
+        _filters = [filters copy] ?: @[];
+        stageCount = _filters.count;
+        stages = calloc(MAX(stageCount, 1), sizeof(FilterStage));
+        rejections = calloc(MAX(stageCount, 1), sizeof(atomic_uint_fast64_t));
+        if ((stages == NULL) || (rejections == NULL)) return nil;
+
+        for (i = 0; i < stageCount; i++)
+        {
+            NSObject<IFilter> *filter = (NSObject<IFilter> *) _filters[i];
+
+            stages[i].filter = filter;
+            if ([filter conformsToProtocol:@protocol(IBatchFilter)])
+                stages[i].filterBatch = (FilterBatchIMP) [filter methodForSelector:@selector(filterBatch:)];
+            else
+                stages[i].checkCandidate = (CheckCandidateIMP) [filter methodForSelector:@selector(checkCandidate:)];
+
+            atomic_init(&rejections[i], 0);
+        }
+    }
+    return self;
+}
+
+
+- (void) dealloc
+{
+    free(stages);
+    free(rejections);
+}
+
+
++ (void) loadBatch:(CandidateBatch*) batch
+    WithCandidates:(__unsafe_unretained Candidate * const *) candidates
+             Count:(NSUInteger) count
+        ParentSkew:(int64_t) skew
+{
+    NSUInteger i;
+
+    assert(count <= CANDIDATE_BATCH_MAX);
+
+    batch->count = count;
+    batch->live = count;
+
+    for (i = 0; i < count; i++)
+    {
+        Candidate *candidate = candidates[i];
+
+        batch->selected[i] = (uint8_t) i;
+        batch->originateTime[i] = candidate.originateTime;
+        batch->receiveTime[i] = candidate.receiveTime;
+        batch->transmitTime[i] = candidate.transmitTime;
+        batch->responseTime[i] = candidate.responseTime;
+        batch->RTT[i] = candidate.RTT;
+        batch->offset[i] = candidate.offset - skew;
+        batch->dispersion[i] = candidate.initialDispersion;
+        batch->quality[i] = candidate.quality;
+        batch->source[i] = candidate.source;
+        batch->candidates[i] = candidate;
+    }
+}
+
+
+- (void) filterBatch:(CandidateBatch*) batch
+{
+    NSUInteger i, j, kept, before;
+
+    for (i = 0; (i < stageCount) && (batch->live > 0); i++)
+    {
+        FilterStage *stage = &stages[i];
+
+        before = batch->live;
+
+        if (stage->filterBatch != NULL)
+        {
+            stage->filterBatch(stage->filter, @selector(filterBatch:), batch);
+        }
+        else
+        {
+            for (j = 0, kept = 0; j < batch->live; j++)
+            {
+                uint8_t c = batch->selected[j];
+
+                if (stage->checkCandidate(stage->filter, @selector(checkCandidate:), batch->candidates[c]))
+                    batch->selected[kept++] = c;
+            }
+            batch->live = kept;
+        }
+
+        atomic_fetch_add_explicit(&rejections[i], before - batch->live, memory_order_relaxed);
+    }
+}
+
+
+- (NSArray<NSNumber *> *) rejectionCounts
+{
+    NSMutableArray<NSNumber *> *counts = [NSMutableArray arrayWithCapacity:stageCount];
+    NSUInteger i;
+
+    for (i = 0; i < stageCount; i++)
+        [counts addObject:@(atomic_load_explicit(&rejections[i], memory_order_relaxed))];
+
+    return counts;
+}
+
+@end
@@ -32,6 +32,22 @@
  *  measurement, passes it through a number of filters (See IFilter.h) and if the measurement
  *  survives the filtering process, it then submit it to a WC algorithm object (See IWCAlgo.h)
  *  for WC offset and dispersion calculation.
+ *
+ *  Candidates that queue up while the thread is busy are taken together and run through the
+ *  filters as one batch (see CandidateFilterChain). Filters that conform to IBatchFilter test a
+ *  field of the whole batch in one loop; a candidate rejected by one filter is not shown to the
+ *  filters after it.
+ *
+ *  With candidates from several WC servers (see Candidate source), a selection step comes before
+ *  the algorithm, as in NTP: the last candidate of each server gives a correctness interval
+ *  (offset +/- dispersion), and only candidates whose interval lies in the intersection of a
+ *  majority of the servers' intervals reach the algorithm. At least three servers are needed to
+ *  outvote one that is wrong.
+ *
+ *  Candidates made with candidateWithPacket:ResponseTimeNanos:Quality: come from a pool and are
+ *  recyclable: once a batch has been processed they are handed back to the pool, except each
+ *  server's last candidate, which is kept for the selection step until it is replaced. Filters
+ *  and algorithms that keep a candidate must keep a copy.
  */
 @interface CandidateSink : NSObject <ICandidateHandler>
 
@@ -78,6 +94,14 @@
  */
 - (id) addFilter:(id<IFilter>) filterobjref;
 
+/**
+ *  Number of candidates each filter has rejected, for monitoring. The counts start again from
+ *  zero when the filter list changes.
+ *
+ *  @return one count per filter, in the order of filterList
+ */
+- (NSArray<NSNumber *> *) filterRejectionCounts;
+
 /**
  *  Start this component
  */
@@ -19,7 +19,9 @@
 //  limitations under the License.
 
 #import "CandidateSink.h"
-#import <SyncKitCollections/BlockingQ.h>
+#import <SyncKitCollections/SPSCRingQ.h>
+#import <SyncKitCollections/ObjectPool.h>
+#import "CandidateFilterChain.h"
 #import <SyncKitConfiguration/SyncKitConfiguration.h>
 #import <pthread.h>
 #import "Candidate.h"
@@ -27,6 +29,40 @@
 #import <SimpleLogger/SimpleLogger.h>
 
 
+// candidates waiting to be processed; more than this and new ones are dropped
+#define CANDIDATE_QUEUE_CAPACITY 64
+
+// most processed candidates kept for reuse
+#define CANDIDATE_POOL_CAPACITY 32
+
+// most WC servers whose candidates take part in the selection
+#define CANDIDATE_MAX_SOURCES 16
+
+// a server's last candidate leaves the selection once it is this old
+#define CANDIDATE_SOURCE_TIMEOUT_NANOS 10000000000LL
+
+
+/**
+ *  Interval bound, for the intersection algorithm
+ */
+typedef struct {
+    int64_t     value;
+    int         type;       // +1 for a lower bound, -1 for an upper bound
+} CandidateBound;
+
+
+static int CompareBounds(const void *a, const void *b)
+{
+    const CandidateBound *x = (const CandidateBound *) a;
+    const CandidateBound *y = (const CandidateBound *) b;
+    
+    if (x->value != y->value) return (x->value > y->value) - (x->value < y->value);
+    
+    // lower bounds first, so that intervals that touch intersect
+    return y->type - x->type;
+}
+
+
 @interface CandidateSink()
 
 @property (nonatomic, readwrite) id<IWCAlgo> algorithm;
@@ -35,12 +71,25 @@
 // redeclare init as private to force use of explicit-value init
 - (id) init;
 
+/**
+ *  Selection step for candidates from several WC servers: keeps the last candidate of each server
+ *  and intersects their correctness intervals (offset +/- dispersion, now).
+ *
+ *  @param candidate - a candidate that survived the filters
+ *
+ *  @return YES if the candidate's interval is in the intersection of a majority of the servers'
+ *  intervals, or if only one server has sent candidates
+ */
+- (BOOL) selectCandidate:(Candidate*) candidate;
+
 
 @end
 
 @implementation CandidateSink
 {
-    BlockingQ           *candidateQ;
+    SPSCRingQ           *candidateQ;     // WCProtocolClient thread to QServicingThread
+    ObjectPool<Candidate *> *candidatePool; // processed candidates, for candidateWithPacket:
+    CandidateFilterChain *filterChain;  // filterList, compiled; guarded by mutex
     SyncKitGlobals       *config;
     NSThread            *QServicingThread;  // candidate processing thread
     pthread_mutex_t     mutex;          // mutex for read_to_go condition var
@@ -49,6 +98,14 @@
     uint32_t            wcClientMaxFreqError;
     uint64_t            target_accuracy_nanos;
     
+    // last candidate of each WC server, and the wallclock's offset from its parent clock when
+    // the candidate was selected
+    Candidate           *latestCandidates[CANDIDATE_MAX_SOURCES];
+    int64_t             latestSkews[CANDIDATE_MAX_SOURCES];
+    
+    // candidates dropped from latestCandidates during the current batch, recycled after it
+    Candidate           *releasedCandidates[CANDIDATE_MAX_SOURCES + CANDIDATE_BATCH_MAX];
+    NSUInteger          releasedCount;
 }
 
 @synthesize algorithm =_algorithm;
@@ -92,7 +149,12 @@
         
         assert(_algorithm !=nil);
         
-        candidateQ = [[BlockingQ alloc] init];
+        candidateQ = [[SPSCRingQ alloc] initWithCapacity:CANDIDATE_QUEUE_CAPACITY];
+        candidatePool = [[ObjectPool alloc] initWithCapacity:CANDIDATE_POOL_CAPACITY Factory:^Candidate *{
+            Candidate *candidate = [[Candidate alloc] initWithTimeIsNanos:YES];
+            candidate.recyclable = YES;
+            return candidate;
+        }];
         config = [SyncKitGlobals getInstance];
         wcClientPrecision = [config ClientWCPrecisionInNanos];
         wcClientMaxFreqError = [config ClientWCFrequencyError];
@@ -112,7 +174,9 @@
 
 - (id) addFilter:(id<IFilter>) filterobjref
 {
+    pthread_mutex_lock(&mutex);
     [_filterList addObject:filterobjref];
+    pthread_mutex_unlock(&mutex);
     
     return self;
 }
@@ -141,44 +205,65 @@
 
 
 #pragma mark filtering process methods
-/** Thread function to service the queue containing candidate measurements */
+/** Thread function to service the queue containing candidate measurements. Candidates that
+ queue up while a batch is processed are taken together and run through the filters as one
+ batch. */
 - (void) QServicingThreadFunc{
     
-    Candidate* newCandidate;
-    BOOL filtered = false;
+    Candidate* candidates[CANDIDATE_BATCH_MAX];
+    CandidateBatch batch;
+    CandidateFilterChain *chain;
+    NSUInteger i, n;
+    int64_t now, skew;
     
     MWLogDebug(@"CandidateSink: QServicingThread has started.");
     do{
-        
-        
-        newCandidate = nil;
-        
-        // get candidate from measurement process
-        newCandidate = [candidateQ take: 2000];
-        
-        
-        
-        if (newCandidate)
-        {
-           // MWLogDebug(@"CandidateSink: %@", [newCandidate description]);
+        // each pass drains its own autoreleased objects
+        @autoreleasepool {
             
-            filtered = false;
-
-            // pass candidate through filters
-            // if candidate filtered, bypass rest of loop
-            for (id<IFilter> filter in _filterList) {
-                if (![filter checkCandidate: newCandidate]){
-                    filtered = true;
-                    continue;
+            n = 0;
+            
+            // get candidates from measurement process
+            candidates[0] = [candidateQ take: 2000];
+            
+            if (candidates[0] != nil)
+            {
+                for (n = 1; n < CANDIDATE_BATCH_MAX; n++)
+                    if ((candidates[n] = [candidateQ take:0]) == nil) break;
+            }
+            
+            if (n > 0)
+            {
+                chain = [self filterChain];
+                
+                // offsets from the wallclock's parent clock, for filters that compare offsets over time
+                now = [_wallclockref nanoSeconds];
+                skew = (_wallclockref.parent != nil) ? [_wallclockref.parent nanoSeconds] - now : 0;
+                
+                [CandidateFilterChain loadBatch:&batch WithCandidates:candidates Count:n ParentSkew:skew];
+                [chain filterBatch:&batch];
+                
+                // survivors, in arrival order
+                for (i = 0; i < batch.live; i++)
+                {
+                    Candidate *candidate = candidates[batch.selected[i]];
+                    
+                    if ([self selectCandidate:candidate])
+                        [_algorithm processMeasurement: candidate];
                 }
+                
+                // free malloc'ed memory in the candidates' responseMsg to cleanup and discard them
+                for (i = 0; i < n; i++)
+                    free(candidates[i].responseMsg.packet);
+                
+                [self recycleCandidates:candidates Count:n];
+                
+                for (i = 0; i < n; i++)
+                    candidates[i] = nil;
             }
+            
         }
         
-        if (!filtered) [_algorithm processMeasurement: newCandidate];
-        
-        // free malloc'ed memory in the candidate's responseMsg to cleanup and discard the candidate
-        free(newCandidate.responseMsg.packet);
-        
         pthread_mutex_lock(&mutex);
         if (!continue_loop) {
             pthread_mutex_unlock(&mutex);
@@ -188,17 +273,184 @@
 
     }while(YES);
     
-    // clean up before thread exits
-    newCandidate =  nil;
     MWLogDebug(@"CandidateSink: QServicingThread has exited.");
 
 }
+
+
+/**
+ Hand a processed batch back to the candidate pool, with the candidates that left
+ latestCandidates while it was processed. Candidates still in latestCandidates stay out of the
+ pool until they are replaced there; candidates not from the pool are left to ARC.
+ */
+- (void) recycleCandidates:(Candidate * __strong *) candidates Count:(NSUInteger) count
+{
+    NSUInteger i, j;
+    
+    for (i = 0; i < count + releasedCount; i++)
+    {
+        Candidate *candidate = (i < count) ? candidates[i] : releasedCandidates[i - count];
+        BOOL kept = NO;
+        
+        if (!candidate.recyclable) continue;
+        
+        if (candidate.source < CANDIDATE_MAX_SOURCES)
+            kept = (latestCandidates[candidate.source] == candidate);
+        
+        // a released candidate may also be in the batch: recycle it once
+        for (j = 0; (j < i) && !kept; j++)
+            kept = (((j < count) ? candidates[j] : releasedCandidates[j - count]) == candidate);
+        
+        if (!kept)
+            [candidatePool recycle:candidate];
+    }
+    
+    for (i = 0; i < releasedCount; i++)
+        releasedCandidates[i] = nil;
+    releasedCount = 0;
+}
+
+
+/**
+ Drop a server's last candidate from the selection; it is recycled after the current batch
+ */
+- (void) releaseLatestCandidate:(NSUInteger) source
+{
+    if (latestCandidates[source] == nil) return;
+    
+    if (releasedCount < CANDIDATE_MAX_SOURCES + CANDIDATE_BATCH_MAX)
+        releasedCandidates[releasedCount++] = latestCandidates[source];
+    latestCandidates[source] = nil;
+}
+
+
+/**
+ The filter chain for the current filter list, compiled again if the list has changed
+ */
+- (CandidateFilterChain*) filterChain
+{
+    CandidateFilterChain *chain;
+    
+    pthread_mutex_lock(&mutex);
+    if ((filterChain == nil) || ![filterChain.filters isEqualToArray:_filterList])
+        filterChain = [[CandidateFilterChain alloc] initWithFilters:_filterList];
+    chain = filterChain;
+    pthread_mutex_unlock(&mutex);
+    
+    return chain;
+}
+
+
+// see comments in .h
+- (NSArray<NSNumber *> *) filterRejectionCounts
+{
+    return [[self filterChain] rejectionCounts];
+}
+
+
+#pragma mark selection
+/**
+ The servers' offsets are compared in the current wallclock's terms: a candidate's offset was
+ measured against the wallclock as it was then, so the adjustments made to the wallclock since
+ (the change in its offset from its parent clock) are taken into account. The intersection is
+ Marzullo's algorithm, as in NTP's selection of truechimers.
+ */
+- (BOOL) selectCandidate:(Candidate*) candidate
+{
+    CandidateBound bounds[2 * CANDIDATE_MAX_SOURCES];
+    int64_t lower[CANDIDATE_MAX_SOURCES], upper[CANDIDATE_MAX_SOURCES];
+    int64_t now, skew, intersect_lower = 0, intersect_upper = 0;
+    NSUInteger i, n = 0, mine = 0;
+    int count = 0, best = 0;
+    
+    if ((candidate == nil) || (candidate.source >= CANDIDATE_MAX_SOURCES)) return YES;
+    
+    now = [_wallclockref nanoSeconds];
+    skew = ((_wallclockref.parent != nil) ? [_wallclockref.parent nanoSeconds] : now) - now;
+    
+    if (latestCandidates[candidate.source] != candidate)
+        [self releaseLatestCandidate:candidate.source];
+    latestCandidates[candidate.source] = candidate;
+    latestSkews[candidate.source] = skew;
+    
+    for (i = 0; i < CANDIDATE_MAX_SOURCES; i++)
+    {
+        Candidate *c = latestCandidates[i];
+        int64_t offset, dispersion;
+        
+        if (c == nil) continue;
+        
+        if (now - c.responseTime > CANDIDATE_SOURCE_TIMEOUT_NANOS)
+        {
+            [self releaseLatestCandidate:i];
+            continue;
+        }
+        
+        offset = c.offset + skew - latestSkews[i];
+        dispersion = [c getDispersionAtTime:now];
+        
+        if (c == candidate) mine = n;
+        lower[n] = offset - dispersion;
+        upper[n] = offset + dispersion;
+        bounds[2 * n].value = lower[n];
+        bounds[2 * n].type = 1;
+        bounds[2 * n + 1].value = upper[n];
+        bounds[2 * n + 1].type = -1;
+        n++;
+    }
+    
+    // a single server: nothing to select from
+    if (n < 2) return YES;
+    
+    qsort(bounds, 2 * n, sizeof(CandidateBound), CompareBounds);
+    
+    for (i = 0; i < 2 * n; i++)
+    {
+        count += bounds[i].type;
+        
+        if (count > best)
+        {
+            best = count;
+            intersect_lower = bounds[i].value;
+            intersect_upper = bounds[i + 1].value;     // the next bound closes the intersection
+        }
+    }
+    
+    if (2 * best <= (int) n)
+    {
+        MWLogDebug(@"CandidateSink: no majority among %lu WC servers, candidate withheld", (unsigned long) n);
+        return NO;
+    }
+    
+    if ((lower[mine] > intersect_lower) || (upper[mine] < intersect_upper))
+    {
+        MWLogDebug(@"CandidateSink: candidate from WC server %u rejected as a falseticker", candidate.source);
+        return NO;
+    }
+    
+    return YES;
+}
+
+
+
 #pragma mark ICandidateFilter methods
-/** ICandidateFilter method to enqueue Candidate object in this object's blocking queue*/
+/** ICandidateHandler method: a candidate from the pool, recycled once it has been processed */
+- (Candidate*) candidateWithPacket:(const WCSyncMessagePkt*) packet ResponseTimeNanos:(int64_t) response_time Quality:(int8_t) quality
+{
+    Candidate *candidate = [candidatePool acquire];
+    
+    [candidate resetWithPacket:packet ResponseTimeNanos:response_time Quality:quality];
+    
+    return candidate;
+}
+
+
+/** ICandidateFilter method to enqueue Candidate object in this object's queue. Called from the
+ WCProtocolClient thread only: the queue has a single producer. */
 - (void) enqueueCandidate:(Candidate*) candidate{
   
-    if (candidateQ != nil)
-        [candidateQ put:candidate];
+    if ((candidateQ != nil) && ![candidateQ put:candidate])
+        MWLogWarning(@"CandidateSink: candidate queue full, candidate dropped");
     
 }
 
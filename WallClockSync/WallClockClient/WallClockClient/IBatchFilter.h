@@ -0,0 +1,74 @@
+//
+//  IBatchFilter.h
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+#import "IFilter.h"
+
+/** most candidates in a batch */
+#define CANDIDATE_BATCH_MAX 32
+
+
+/**
+ *  A batch of candidates laid out as one array per measurement field, for filters that test a
+ *  field of every candidate in one loop.
+ *
+ *  The candidates still in the running are listed, in arrival order, in selected[0..live).
+ *  A filter drops the candidates it rejects from this list; the filters that follow see only
+ *  the survivors, and the chain stops once the list is empty.
+ */
+typedef struct {
+    NSUInteger  count;                              // candidates in the batch
+    NSUInteger  live;                               // candidates still passing the filters
+    uint8_t     selected[CANDIDATE_BATCH_MAX];      // their indices
+
+    int64_t     originateTime[CANDIDATE_BATCH_MAX]; // T1
+    int64_t     receiveTime[CANDIDATE_BATCH_MAX];   // T2
+    int64_t     transmitTime[CANDIDATE_BATCH_MAX];  // T3
+    int64_t     responseTime[CANDIDATE_BATCH_MAX];  // T4
+    int64_t     RTT[CANDIDATE_BATCH_MAX];
+
+    // offset of the server's clock from the wallclock's parent clock: unlike the candidate's
+    // offset, this does not change when the wallclock is adjusted
+    int64_t     offset[CANDIDATE_BATCH_MAX];
+
+    int64_t     dispersion[CANDIDATE_BATCH_MAX];    // initial dispersion
+    int8_t      quality[CANDIDATE_BATCH_MAX];
+    uint32_t    source[CANDIDATE_BATCH_MAX];
+
+    __unsafe_unretained Candidate *candidates[CANDIDATE_BATCH_MAX];
+} CandidateBatch;
+
+
+/**
+ *  Protocol for candidate filters that can test a whole batch at once. CandidateSink calls
+ *  filterBatch: rather than checkCandidate: for filters that conform to it.
+ */
+@protocol IBatchFilter <IFilter>
+
+/**
+ *  Drop the candidates that fail this filter's test from the batch's selected list, keeping
+ *  the order of the rest, and count them
+ *
+ *  @param batch - candidates to test; only those in selected[0..live) are looked at
+ */
+- (void) filterBatch:(CandidateBatch*) batch;
+
+@end
@@ -34,5 +34,11 @@
 /** Get time between useful candidates */
 - (uint64_t) getTimeBetweenUsefulCandidates;
 
+@optional
+
+/** A candidate for a received WC response packet, from the recipient's pool of candidates. The
+ recipient recycles it once it has been processed; the packet is read, not kept. */
+- (Candidate*) candidateWithPacket:(const WCSyncMessagePkt*) packet ResponseTimeNanos:(int64_t) response_time Quality:(int8_t) quality;
+
 @end
 
@@ -17,7 +17,8 @@
 /**
  *  Test this candidate to see if it passes the filter criteria
  *
- *  @param candidate - a WC Candidate measurement object
+ *  @param candidate - a WC Candidate measurement object; if it is recyclable, the CandidateSink
+ *  reuses it once processed, so keep a copy of a candidate to be used later
  *
  *  @return true if candidate passes this filter test
  */
@@ -19,7 +19,8 @@
 ///-----------------------------------------------------------
 
 /** process this candidate measurement
- @param candidate a new candidate measurement
+ @param candidate a new candidate measurement; if it is recyclable, the CandidateSink reuses it
+ after this method returns, so keep a copy of a candidate to be used later
  @return the current offset
  */
 - (int64_t) processMeasurement:(Candidate*) candidate;
@@ -80,5 +81,21 @@
 - (float) usefulCandidatesPercent;
 
 
+/**
+ *  Get the rate at which WC requests are being sent, smoothed over recent requests.
+ *
+ *  @return requests per second
+ */
+- (double) requestsPerSecond;
+
+
+/**
+ *  Get the dispersion achieved by the algorithm, smoothed over recent candidates.
+ *
+ *  @return dispersion in nanoseconds
+ */
+- (int64_t) achievedDispersion;
+
+
 
 @end
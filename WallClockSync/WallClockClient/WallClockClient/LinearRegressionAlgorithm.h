@@ -0,0 +1,88 @@
+//
+//  LinearRegressionAlgorithm.h
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+#import "IWCAlgo.h"
+#import <ClockTimelines/ClockTimelines.h>
+
+
+/**
+ *  Algorithm that estimates both the offset and the frequency error (skew) of the Wall Clock
+ *  server with respect to the local wallclock's parent clock.
+ *
+ *  A weighted least-squares line is fitted through the offsets of a sliding window of candidates
+ *  (request-response measurement results), each weighted by the inverse square of its
+ *  measurement error bound (half the round-trip time plus the server's precision). The wallclock
+ *  is then made to run at the estimated server rate by setting its speed, and remaining offset
+ *  errors are slewed out over the interval to the next request instead of stepping the clock.
+ *  The clock is only stepped for the first candidates and for offset errors too large to slew.
+ *
+ *  Because drift is tracked, dispersion grows with the uncertainty of the skew estimate rather
+ *  than with the worst-case oscillator frequency errors. The algorithm uses this to space out
+ *  requests (see `getNextReqWaitTime`) while keeping the dispersion within the
+ *  `SyncAccuracyTargetMilliSecs` configuration setting.
+ *
+ *  Note: The Clock object must be the same one that is provided to the WallClockClient,
+ *  otherwise this algorithm will not synchronise correctly.
+ */
+@interface LinearRegressionAlgorithm : NSObject <IWCAlgo>
+
+/**
+ *  Candidate with the lowest initial dispersion in the current window
+ */
+@property (nonatomic, readonly) Candidate* bestCandidate;
+
+/**
+ *  Estimated frequency error of the WC server relative to the wallclock's parent clock, in ppm.
+ */
+@property (nonatomic, readonly) double skewPPM;
+
+/**
+ *  Number of candidates in the sliding window
+ */
+@property (nonatomic, readonly) NSUInteger windowSize;
+
+
+- (instancetype)init NS_UNAVAILABLE;
+
+
+/**
+ *  Initialise algorithm with the default window size (32 candidates)
+ *
+ *  @param wall_clock - a clock whose tick offset and speed can be adjusted.
+ *
+ *  @return Algorithm instance
+ */
+- (id)initWithWallClock:(TunableClock*) wall_clock;
+
+
+/**
+ *  Initialise algorithm
+ *
+ *  @param wall_clock  - a clock whose tick offset and speed can be adjusted.
+ *  @param window_size - number of most recent candidates to fit (at least 4)
+ *
+ *  @return Algorithm instance
+ */
+- (id)initWithWallClock:(TunableClock*) wall_clock
+             WindowSize:(NSUInteger) window_size;
+
+@end
@@ -0,0 +1,464 @@
+//
+//  LinearRegressionAlgorithm.m
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <pthread.h>
+#import <float.h>
+#import "LinearRegressionAlgorithm.h"
+#import <SyncKitConfiguration/SyncKitConfiguration.h>
+#import <SimpleLogger/SimpleLogger.h>
+
+
+// default number of candidates in the sliding window
+static const NSUInteger kDefaultWindowSize          = 32;
+
+// minimum number of candidates (and time span) before the skew estimate is used
+static const NSUInteger kMinFitCandidates           = 4;
+static const int64_t    kMinFitSpanNanos            = 1000000000;
+
+// request interval while the window fills up, and bounds on the adaptive request interval
+static const uint32_t   kBootstrapReqWaitMicros     = 100000;
+static const uint32_t   kMinReqWaitMicros           = 100000;
+static const uint32_t   kMaxReqWaitMicros           = 10000000;
+
+// fraction of the accuracy target that dispersion may grow to before the next request
+static const double     kDispersionBudget           = 0.5;
+
+// largest speed change used to slew out an offset error; larger errors step the clock
+static const double     kMaxSlewPPM                 = 500.0;
+
+// number of standard errors used for the dispersion bound
+static const double     kConfidence                 = 3.0;
+
+
+/**
+ *  One candidate measurement, as an offset of the server's time from the parent clock's time
+ */
+typedef struct {
+    int64_t parentNanos;    // parent clock time at the middle of the request-response exchange
+    double  offsetNanos;    // server time minus parent clock time at parentNanos
+    double  weight;         // 1 / errorBound^2
+    int64_t errorBound;     // half round-trip time plus server precision, in nanoseconds
+} RegressionSample;
+
+
+@interface LinearRegressionAlgorithm()
+
+/**
+ *  The current best Candidate measurement in the window
+ */
+@property (nonatomic, readwrite) Candidate* bestCandidate;
+@property (nonatomic, readwrite) double skewPPM;
+@property (nonatomic, readwrite) NSUInteger windowSize;
+
+@end
+
+
+@implementation LinearRegressionAlgorithm
+{
+    TunableClock            *wallclock;
+    SyncKitGlobals          *devinfo;
+    int64_t                 target_accuracy_nanos; // max tolerable dispersion
+    pthread_mutex_t         state_mutex;
+
+    // sliding window: samples and their candidates, oldest first
+    RegressionSample        *samples;
+    NSUInteger              sampleCount;
+    NSMutableArray          *candidates;
+
+    // line fit: offset(p) = fitOffset + skew * (p - fitMeanNanos), with standard errors
+    BOOL                    fitted;
+    double                  skew;
+    double                  fitOffset;
+    int64_t                 fitMeanNanos;
+    double                  seOffset;
+    double                  seSkew;
+    int64_t                 minErrorBound;
+
+    // last wallclock correction: offset error slewed out from slewStartNanos over slewPeriodNanos
+    int64_t                 current_offset;
+    int64_t                 slewStartNanos;
+    int64_t                 slewPeriodNanos;
+    uint32_t                nextReqWaitMicros;
+
+    Candidate               *prev_candidate;
+    Candidate               *last_candidate;
+    uint64_t                steppedCandidatesCount;
+    uint64_t                candidatesCount;
+}
+
+@synthesize bestCandidate = _bestCandidate;
+
+
+#pragma mark initialisation and deallocation routines
+
+
+- (id)initWithWallClock:(TunableClock*) wall_clock
+{
+    return [self initWithWallClock:wall_clock WindowSize:kDefaultWindowSize];
+}
+
+
+- (id)initWithWallClock:(TunableClock*) wall_clock
+             WindowSize:(NSUInteger) window_size
+{
+    self = [super init];
+    if (self != nil) {
+
+        wallclock = wall_clock;
+        assert(wallclock!=nil);
+        devinfo = [SyncKitGlobals getInstance];
+        assert(devinfo!=nil);
+        target_accuracy_nanos = ((int64_t) [devinfo SyncAccuracyTargetMilliSecs]) * 1000000;
+        assert(target_accuracy_nanos > 0);
+        pthread_mutex_init(&state_mutex, NULL);
+
+        _windowSize = MAX(window_size, kMinFitCandidates);
+        samples = (RegressionSample*) calloc(_windowSize, sizeof(RegressionSample));
+        sampleCount = 0;
+        candidates = [[NSMutableArray alloc] initWithCapacity:_windowSize];
+
+        fitted = NO;
+        skew = 0.0;
+        current_offset = 0;
+        slewPeriodNanos = 0;
+        nextReqWaitMicros = kBootstrapReqWaitMicros;
+        steppedCandidatesCount = 0;
+        candidatesCount = 0;
+    }
+    return self;
+}
+
+
+- (void)dealloc
+{
+    free(samples);
+    candidates = nil;
+    wallclock = nil;
+    devinfo = nil;
+    pthread_mutex_destroy(&state_mutex);
+}
+
+
+
+#pragma mark IWCAlgo protocol methods
+
+- (int64_t) processMeasurement:(Candidate*) candidate
+{
+    assert(wallclock!=nil);
+
+    if (candidate == nil) return 0;
+
+    pthread_mutex_lock(&state_mutex);
+
+    candidatesCount= (candidatesCount + 1)  % 1000000;
+    if (candidatesCount == 1) steppedCandidatesCount = 0;
+
+    // map the middle of the exchange from wallclock time to parent clock time. The parent is
+    // never adjusted, so samples stay comparable after the wallclock is stepped or slewed.
+    int64_t wallNow = [wallclock nanoSeconds];
+    int64_t parentNow = [wallclock.parent nanoSeconds];
+    int64_t localMid = candidate.originateTime + (candidate.responseTime - candidate.originateTime) / 2;
+    int64_t serverMid = candidate.receiveTime + (candidate.transmitTime - candidate.receiveTime) / 2;
+
+    RegressionSample s;
+    s.parentNanos   = parentNow - (int64_t) ((wallNow - localMid) / (double) wallclock.speed);
+    s.offsetNanos   = (double) (serverMid - s.parentNanos);
+    s.errorBound    = MAX([candidate getRTT] / 2 + candidate.wcServerPrecisionInNanos, 1000);
+    s.weight        = 1.0 / ((double) s.errorBound * s.errorBound);
+
+    [self addSample:s Candidate:[candidate copy]];   // the window outlives the candidate, which the sink recycles
+    [self fit];
+
+    // offset error of the wallclock now, and the speed that tracks the server
+    int64_t estimate = parentNow + (int64_t) [self offsetAtParentTime:parentNow];
+    int64_t error = estimate - wallNow;
+    double speed = 1.0 + skew;
+
+    // the new estimate replaces any correction still being slewed out
+    current_offset = error;
+    slewPeriodNanos = 0;
+    nextReqWaitMicros = [self waitTimeAtParentTime:parentNow];
+
+    int64_t period = MAX((int64_t) nextReqWaitMicros * 1000, kMinFitSpanNanos);
+
+    if (!fitted || llabs(error) > kMaxSlewPPM * 1.0e-6 * period)
+    {
+        // no skew estimate yet, or the error is too large to slew out: step the clock
+        wallclock.speed = speed;
+        [wallclock adjustTimeNanos:error
+                   WithStaticError:[self dispersionAtParentTime:parentNow]
+                      AndErrorRate:[self errorRatePPM]];
+        steppedCandidatesCount++;
+    }
+    else
+    {
+        // run at the server's rate, plus the rate that removes the error by the next request
+        wallclock.speed = speed + (double) error / period;
+        slewStartNanos = parentNow;
+        slewPeriodNanos = period;
+        wallclock.staticError = [self dispersionAtParentTime:parentNow];
+        wallclock.errorRate = [self errorRatePPM];
+        wallclock.errorTicksFrom = [wallclock ticks];
+    }
+
+    wallclock.available = YES;
+
+    self.skewPPM = skew * 1.0e6;
+
+    pthread_mutex_unlock(&state_mutex);
+
+    return error;
+}
+
+
+/** get dispersion at current time*/
+- (int64_t) getCurrentDispersion
+{
+    int64_t dispersion = 0;
+
+    pthread_mutex_lock(&state_mutex);
+    if (sampleCount > 0)
+        dispersion = [self dispersionAtParentTime:[wallclock.parent nanoSeconds]];
+    pthread_mutex_unlock(&state_mutex);
+
+    return dispersion;
+}
+
+
+/** get offset error of the wallclock at the last candidate */
+- (int64_t) getCandidateOffset
+{
+    return current_offset;
+}
+
+
+/** get wait time for next request */
+- (uint32_t) getNextReqWaitTime
+{
+    return nextReqWaitMicros;
+}
+
+
+- (Candidate*) getBestCandidate
+{
+    return self.bestCandidate;
+}
+
+
+- (int64_t) timeBetweenUsefulCandidatesNanos
+{
+    if ((prev_candidate) && (last_candidate))
+    {
+        return (last_candidate.responseTime - prev_candidate.responseTime);
+    }else
+        return -1;
+}
+
+
+- (float) usefulCandidatesPercent
+{
+    // every candidate refines the fit; report the share that needed a step of the clock
+    if (candidatesCount>0) {
+        return (((candidatesCount - steppedCandidatesCount)*1.0)/candidatesCount)*100.0;
+    }
+    else
+        return 0.0;
+}
+
+
+
+#pragma mark Private methods
+
+/**
+ *  Add a sample to the window. Once the window is full, a sample that comes sooner after the
+ *  newest than the window's average spacing takes the newest one's place (if it is more
+ *  precise) instead of pushing out the oldest. Bursts of requests then cannot shrink the
+ *  time span of the window, which is what the precision of the skew estimate depends on.
+ */
+- (void) addSample:(RegressionSample) s Candidate:(Candidate*) candidate
+{
+    if (sampleCount == _windowSize)
+    {
+        RegressionSample *newest = &samples[sampleCount - 1];
+        int64_t spacing = (newest->parentNanos - samples[0].parentNanos) / (int64_t) _windowSize;
+
+        if (s.parentNanos - newest->parentNanos < spacing)
+        {
+            if (s.errorBound < newest->errorBound) {
+                *newest = s;
+                [candidates replaceObjectAtIndex:sampleCount - 1 withObject:candidate];
+            }
+        }
+        else
+        {
+            memmove(samples, samples + 1, (sampleCount - 1) * sizeof(RegressionSample));
+            samples[sampleCount - 1] = s;
+            [candidates removeObjectAtIndex:0];
+            [candidates addObject:candidate];
+        }
+    }
+    else
+    {
+        samples[sampleCount++] = s;
+        [candidates addObject:candidate];
+    }
+
+    prev_candidate = last_candidate;
+    last_candidate = candidate;
+
+    // best candidate: smallest measurement error bound in the window
+    Candidate *best = nil;
+    int64_t bestBound = INT64_MAX;
+    for (Candidate *c in candidates) {
+        int64_t bound = [c getRTT] / 2 + c.wcServerPrecisionInNanos;
+        if (bound < bestBound) {
+            bestBound = bound;
+            best = c;
+        }
+    }
+    _bestCandidate = best;
+}
+
+
+/**
+ *  Weighted least-squares fit of offset against parent clock time. Times are taken relative to
+ *  the newest sample to keep the sums well conditioned.
+ */
+- (void) fit
+{
+    NSUInteger i;
+    int64_t ref = samples[sampleCount - 1].parentNanos;
+    int64_t oldest = ref;
+    double sw = 0, swx = 0, swy = 0;
+
+    minErrorBound = INT64_MAX;
+
+    for (i = 0; i < sampleCount; i++) {
+        const RegressionSample *s = &samples[i];
+        double x = (double) (s->parentNanos - ref);
+
+        sw  += s->weight;
+        swx += s->weight * x;
+        swy += s->weight * s->offsetNanos;
+
+        oldest = MIN(oldest, s->parentNanos);
+        minErrorBound = MIN(minErrorBound, s->errorBound);
+    }
+
+    double xm = swx / sw, ym = swy / sw;
+    double sxx = 0, sxy = 0;
+
+    for (i = 0; i < sampleCount; i++) {
+        const RegressionSample *s = &samples[i];
+        double dx = (double) (s->parentNanos - ref) - xm;
+
+        sxx += s->weight * dx * dx;
+        sxy += s->weight * dx * (s->offsetNanos - ym);
+    }
+
+    fitted = (sampleCount >= kMinFitCandidates) && (ref - oldest >= kMinFitSpanNanos) && (sxx > 0);
+
+    // until there are enough candidates, keep the previous skew estimate (initially zero)
+    if (fitted)
+        skew = sxy / sxx;
+
+    fitOffset = ym;
+    fitMeanNanos = ref + (int64_t) xm;
+
+    // residual variance, relative to the weights, then standard errors of the fitted line
+    double chi2 = 0;
+    for (i = 0; i < sampleCount; i++) {
+        const RegressionSample *s = &samples[i];
+        double r = s->offsetNanos - (ym + skew * ((double) (s->parentNanos - ref) - xm));
+        chi2 += s->weight * r * r;
+    }
+
+    double scale = (sampleCount > 2) ? chi2 / (sampleCount - 2) : 1.0;
+
+    seOffset = sqrt(scale / sw);
+
+    if (fitted)
+        seSkew = sqrt(scale / sxx);
+    else
+        seSkew = (devinfo.ClientWCFrequencyError + last_candidate.wcServerMaxFreqError) * 1.0e-6;
+}
+
+
+- (double) offsetAtParentTime:(int64_t) parentNanos
+{
+    return fitOffset + skew * (double) (parentNanos - fitMeanNanos);
+}
+
+
+/**
+ *  Rate at which dispersion grows: the skew estimate's uncertainty, plus the resolution of the
+ *  wallclock's (single precision) speed
+ */
+- (double) dispersionGrowthRate
+{
+    return kConfidence * seSkew + FLT_EPSILON;
+}
+
+
+- (uint32_t) errorRatePPM
+{
+    return (uint32_t) ceil([self dispersionGrowthRate] * 1.0e6);
+}
+
+
+- (int64_t) dispersionAtParentTime:(int64_t) parentNanos
+{
+    // any asymmetry in network delays is hidden from the fit; it is bounded by half the round-trip time
+    double dispersion = minErrorBound
+                        + kConfidence * seOffset
+                        + [self dispersionGrowthRate] * llabs(parentNanos - fitMeanNanos);
+
+    // offset error not yet slewed out
+    if (slewPeriodNanos > 0) {
+        double remaining = 1.0 - (double) (parentNanos - slewStartNanos) / slewPeriodNanos;
+        if (remaining > 0)
+            dispersion += llabs(current_offset) * remaining;
+    }
+
+    return (int64_t) dispersion;
+}
+
+
+/**
+ *  Time until the dispersion grows to its budget, bounded to [kMinReqWaitMicros, kMaxReqWaitMicros]
+ */
+- (uint32_t) waitTimeAtParentTime:(int64_t) parentNanos
+{
+    if (!fitted)
+        return kBootstrapReqWaitMicros;
+
+    double headroom = kDispersionBudget * target_accuracy_nanos - [self dispersionAtParentTime:parentNanos];
+
+    if (headroom <= 0)
+        return kMinReqWaitMicros;
+
+    double waitMicros = headroom / [self dispersionGrowthRate] / 1000.0;
+
+    return (uint32_t) MAX(kMinReqWaitMicros, MIN(waitMicros, kMaxReqWaitMicros));
+}
+
+
+@end
@@ -10,7 +10,7 @@
 #import <SyncKitConfiguration/SyncKitConfiguration.h>
 #import <SyncKitCollections/SyncKitCollections.h>
 #import <SimpleLogger/SimpleLogger.h>
-#import "SendPolicy.h"
+#import "WCRequestScheduler.h"
 
 @interface LowestDispersionAlgorithm()
 {
@@ -33,10 +33,7 @@
     SyncKitGlobals          *devinfo;
     int64_t                 current_offset;
     int64_t                 target_accuracy_nanos; // max tolerable dispersion
-    Queue*                  wcSendPolicyList;
-    SendPolicy*             currentPolicy;
-    pthread_mutex_t         current_policy_mutex;
-    int64_t                 best_cand_exp_time;
+    WCRequestScheduler      *scheduler;
     uint64_t                usefulCandidatesCount;
     uint64_t                candidatesCount;
 }
@@ -61,15 +58,9 @@
         current_offset = 0;
         target_accuracy_nanos = ((int64_t) [devinfo SyncAccuracyTargetMilliSecs]) * 1000000;
         assert(target_accuracy_nanos > 0);
-        wcSendPolicyList = [[Queue alloc] init];
-        currentPolicy = nil;
-        pthread_mutex_init(&current_policy_mutex, NULL);
-        best_cand_exp_time =0;
+        scheduler = [[WCRequestScheduler alloc] initWithClock:wallclock];
         usefulCandidatesCount= 0;
         candidatesCount = 0;
-        
-        // bootstrapping
-        [wcSendPolicyList put:[[SendPolicy alloc] init:20 WaitTimeUSeconds:100000]]; // send WC requests at 100ms for 5 secs
     }
     return self;
 }
@@ -82,9 +73,7 @@
     prev_best_candidate = nil;
     wallclock = nil;
     devinfo = nil;
-    wcSendPolicyList = nil;
-    currentPolicy = nil;
-    pthread_mutex_destroy(&current_policy_mutex);
+    scheduler = nil;
 }
 
 
@@ -113,7 +102,7 @@
     if (_bestCandidate == nil)
     {
         prev_best_candidate = _bestCandidate;
-        _bestCandidate = candidate;
+        _bestCandidate = [candidate copy];     // the sink recycles the candidate
         current_offset = [_bestCandidate getOffset];
        
         
@@ -139,7 +128,7 @@
         if (llabs(best_dispersion_now) > new_dispersion_now)
         {
             prev_best_candidate = _bestCandidate;
-            _bestCandidate = candidate;
+            _bestCandidate = [candidate copy];
             current_offset = [_bestCandidate getOffset];
 //             MWLogDebug(@"LowestDispersionAlgorithm:  wallclock time BEFORE adjustment =%lld", [wallclock nanoSeconds]);
             
@@ -163,29 +152,12 @@
     }
     
     
-//    // decide on next send policy if one is not ongoing
-//    
-//    best_cand_exp_time = [_bestCandidate getCandidateExpirationTime:target_accuracy_nanos];
-//    
-//    // if best candidate's dispersion has not yet grown out of bounds and we are hitting sync target accuracy
-//    // then wait and send request
-//    if ((now < best_cand_exp_time) && ([_bestCandidate initialDispersion] < target_accuracy_nanos))
-//    {
-//        wait_time = (uint32_t) (best_cand_exp_time - now)/1000;
-//        
-//        [wcSendPolicyList put:[[SendPolicy alloc] init:1 WaitTimeUSeconds: wait_time]];
-//    
-//    }else if ((now > best_cand_exp_time) || ([_bestCandidate initialDispersion] > target_accuracy_nanos)){
-//        
-//        pthread_mutex_lock(&current_policy_mutex);
-//        
-//        if (currentPolicy==nil) {
-//            [wcSendPolicyList put:[[SendPolicy alloc] init:20 WaitTimeUSeconds:100000]];
-//        }
-//        
-//        pthread_mutex_unlock(&current_policy_mutex);
-//        
-//    }
+    // decide on next send policy: back off while the best candidate's dispersion is well
+    // within target, burst when it degrades or the best candidate expires
+    [scheduler updateWithBestCandidate:_bestCandidate
+                            Dispersion:[_bestCandidate getDispersionAtTime:now]
+                                AtTime:now];
+    
 //    MWLogDebug(@"LowestDispersionAlgorithm: candidate count: %lld useful candidates:%lld", candidatesCount, usefulCandidatesCount);
     return best_offset;
 }
@@ -211,33 +183,7 @@
 /** get wait time for next request */
 - (uint32_t) getNextReqWaitTime
 {
-//    uint32_t wait_time;
-//    
-//    pthread_mutex_lock(&current_policy_mutex);
-//    if  (currentPolicy == nil)
-//        currentPolicy = [wcSendPolicyList take];
-//    
-//    
-//    if (currentPolicy != nil)
-//    {
-//        if (currentPolicy.count > 0)
-//        {
-//            currentPolicy.count--;
-//            wait_time = currentPolicy.waitTimeUSecs;
-//        }
-//        else // policy has expired, get a new one
-//            currentPolicy = nil;
-//    }
-//    
-//    if  (currentPolicy == nil)
-//        wait_time = [devinfo WCREQSendPeriodUSecs]; // default wait time
-//    else
-//        wait_time = currentPolicy.waitTimeUSecs;
-//    
-//    pthread_mutex_unlock(&current_policy_mutex);
-//    return wait_time;
-    
-    return 120000;
+    return [scheduler nextReqWaitTime];
 }
 
 
@@ -259,6 +205,18 @@
 }
 
 
+- (double) requestsPerSecond
+{
+    return scheduler.requestsPerSecond;
+}
+
+
+- (int64_t) achievedDispersion
+{
+    return scheduler.achievedDispersion;
+}
+
+
 - (float) usefulCandidatesPercent
 {
     if (candidatesCount>0) {
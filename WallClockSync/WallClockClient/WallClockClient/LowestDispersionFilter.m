@@ -13,9 +13,8 @@
 
 
 // TODO:
-// 1. rollover drop_count counter
-// 2. max dispersion
-// 3. moving average for dispersion
+// 1. max dispersion
+// 2. moving average for dispersion
 
 @interface LowestDispersionFilter()
 {
@@ -57,24 +56,23 @@
 {
     if (candidate == nil) return false;
     
-    // rollover counter if it is greater than 1 billion
-    count = count == 1e9?1:count++;
+    count++;
     
     int64_t dispersion = [candidate getDispersionAtTime:[self.wallclockRef nanoSeconds]];
 
     if (_bestCandidate == nil)
     {
-        _bestCandidate = candidate;
+        _bestCandidate = [candidate copy];     // the sink recycles the candidate
         return true;
     }else
     {
-       int64_t best_dispersion = [candidate getDispersionAtTime:[self.wallclockRef nanoSeconds]];
+       int64_t best_dispersion = [_bestCandidate getDispersionAtTime:[self.wallclockRef nanoSeconds]];
         
         if (dispersion < best_dispersion){
-            _bestCandidate = candidate;
+            _bestCandidate = [candidate copy];
             return true;
         }else{
-            drop_count = (drop_count == 1e9)?1:drop_count++;
+            drop_count++;
             return false;
         }
     }
@@ -0,0 +1,63 @@
+//
+//  OffsetOutlierFilter.h
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+#import "WindowedCandidateFilter.h"
+
+/**
+ *  Filter that rejects candidates whose offset is an outlier: further from the median offset of
+ *  recent candidates than a number of median absolute deviations (MADs).
+ *
+ *  Offsets are compared as offsets from the wallclock's parent clock, so that adjustments of the
+ *  wallclock do not make good candidates look like outliers. The MAD is a running one: the median
+ *  of each recent offset's distance from the median at the time it arrived.
+ *
+ *  As every candidate's offset joins the window, after a step change in the server's clock the
+ *  filter follows once half the window has seen it.
+ */
+@interface OffsetOutlierFilter : WindowedCandidateFilter
+
+/**
+ *  Number of MADs from the median beyond which candidates are rejected
+ */
+@property (nonatomic, readonly) double threshold;
+
+/**
+ *  Distance from the median within which candidates always pass, however small the MAD.
+ *  Defaults to 1 ms.
+ */
+@property (nonatomic, readwrite) int64_t minimumDeviationNanos;
+
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Initialise the filter
+ *
+ *  @param threshold - number of MADs, e.g. 3; scaled by 1.4826, so that for normally distributed
+ *  offsets it counts standard deviations
+ *  @param window    - number of recent offsets to keep
+ *
+ *  @return initialised OffsetOutlierFilter instance
+ */
+- (id) initWithThreshold:(double) threshold Window:(NSUInteger) window;
+
+@end
@@ -0,0 +1,86 @@
+//
+//  OffsetOutlierFilter.m
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "OffsetOutlierFilter.h"
+#import <SyncKitCollections/SyncKitCollections.h>
+
+// MAD to standard deviation, for normally distributed samples
+#define MAD_TO_SIGMA 1.4826
+
+
+@implementation OffsetOutlierFilter
+{
+    WindowedStats           *offsets;
+    WindowedStats           *deviations;
+}
+
+
+- (id) initWithThreshold:(double) threshold Window:(NSUInteger) window
+{
+    self = [super initWithWindow:window];
+    if (self != nil) {
+        _threshold = threshold;
+        _minimumDeviationNanos = 1000000;
+        offsets = [[WindowedStats alloc] initWithCapacity:self.window];
+        deviations = [[WindowedStats alloc] initWithCapacity:self.window];
+    }
+    return self;
+}
+
+
+- (BOOL) comparesOffsets
+{
+    return YES;
+}
+
+
+- (void) filterBatch:(CandidateBatch*) batch
+{
+    double offset[CANDIDATE_BATCH_MAX];
+    double median = 0, limit = INFINITY;
+    NSUInteger i, kept = 0, live = batch->live;
+
+    if ([self isJudging:offsets.count])
+    {
+        median = [offsets median];
+        limit = MAX(_threshold * MAD_TO_SIGMA * [deviations median], (double) _minimumDeviationNanos);
+    }
+
+    for (i = 0; i < live; i++)
+    {
+        uint8_t c = batch->selected[i];
+
+        offset[i] = (double) batch->offset[c];
+        batch->selected[kept] = c;
+        kept += (fabs(offset[i] - median) <= limit);
+    }
+    batch->live = kept;
+
+    for (i = 0; i < live; i++)
+    {
+        [offsets put:offset[i]];
+        [deviations put:fabs(offset[i] - [offsets median])];
+    }
+
+    [self countBatch:live Kept:kept];
+}
+
+@end
@@ -0,0 +1,59 @@
+//
+//  QualityScoreFilter.h
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+#import "IBatchFilter.h"
+
+/**
+ *  Filter that rejects candidates of poor quality: those whose quality score is below a minimum,
+ *  or whose dispersion when they arrived (the bound on their offset error from the round trip
+ *  time and the clocks' precision and frequency errors) is above a maximum.
+ *
+ *  A candidate's quality score is set by WCProtocolClient: 3 for a response, 4 for a follow-up,
+ *  2 for a response whose follow-up never came.
+ */
+@interface QualityScoreFilter : NSObject <IBatchFilter>
+
+/**
+ *  Lowest quality score that passes
+ */
+@property (nonatomic, readonly) int8_t minimumQuality;
+
+/**
+ *  Largest initial dispersion that passes, in nanoseconds
+ */
+@property (nonatomic, readonly) int64_t maximumDispersionNanos;
+
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Initialise the filter
+ *
+ *  @param minimum_quality  - lowest quality score that passes, e.g. 3 to reject responses whose
+ *  follow-up never came
+ *  @param max_dispersion_ms - largest initial dispersion that passes, in milliseconds
+ *
+ *  @return initialised QualityScoreFilter instance
+ */
+- (id) initWithMinimumQuality:(int8_t) minimum_quality MaxDispersion:(uint32_t) max_dispersion_ms;
+
+@end
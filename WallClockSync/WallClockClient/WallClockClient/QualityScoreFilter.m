@@ -0,0 +1,91 @@
+//
+//  QualityScoreFilter.m
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "QualityScoreFilter.h"
+#import "CandidateFilterChain.h"
+#import <stdatomic.h>
+
+
+@implementation QualityScoreFilter
+{
+    atomic_uint_fast64_t    drop_count;
+    atomic_uint_fast64_t    count;
+}
+
+
+- (id) initWithMinimumQuality:(int8_t) minimum_quality MaxDispersion:(uint32_t) max_dispersion_ms
+{
+    self = [super init];
+    if (self != nil) {
+        _minimumQuality = minimum_quality;
+        _maximumDispersionNanos = (int64_t) max_dispersion_ms * 1000000;
+        atomic_init(&drop_count, 0);
+        atomic_init(&count, 0);
+    }
+    return self;
+}
+
+
+- (void) filterBatch:(CandidateBatch*) batch
+{
+    NSUInteger i, kept = 0, live = batch->live;
+
+    for (i = 0; i < live; i++)
+    {
+        uint8_t c = batch->selected[i];
+
+        batch->selected[kept] = c;
+        kept += (batch->quality[c] >= _minimumQuality) & (batch->dispersion[c] <= _maximumDispersionNanos);
+    }
+    batch->live = kept;
+
+    atomic_fetch_add_explicit(&count, live, memory_order_relaxed);
+    atomic_fetch_add_explicit(&drop_count, live - kept, memory_order_relaxed);
+}
+
+
+- (BOOL) checkCandidate:(Candidate*) candidate
+{
+    if (!candidate) return false;
+
+    atomic_fetch_add_explicit(&count, 1, memory_order_relaxed);
+
+    if ((candidate.quality < _minimumQuality) || (candidate.initialDispersion > _maximumDispersionNanos))
+    {
+        atomic_fetch_add_explicit(&drop_count, 1, memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+
+- (uint64_t) getCandidateDropCount
+{
+    return atomic_load_explicit(&drop_count, memory_order_relaxed);
+}
+
+
+- (uint64_t) getCandidateTotal
+{
+    return atomic_load_explicit(&count, memory_order_relaxed);
+}
+
+@end
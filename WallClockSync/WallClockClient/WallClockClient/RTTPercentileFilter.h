@@ -0,0 +1,52 @@
+//
+//  RTTPercentileFilter.h
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+#import "WindowedCandidateFilter.h"
+
+/**
+ *  Filter that rejects candidates whose round trip time is above a percentile of the round trip
+ *  times of recent candidates, e.g. the slowest tenth. Unlike RTTThresholdFilter, it needs no
+ *  knowledge of the network: the threshold follows the round trip times seen.
+ *
+ *  Round trip times do not depend on the wallclock, so the filter can also check candidates
+ *  one at a time.
+ */
+@interface RTTPercentileFilter : WindowedCandidateFilter
+
+/**
+ *  Percentile of recent round trip times above which candidates are rejected, from 0.0 to 1.0
+ */
+@property (nonatomic, readonly) double percentile;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Initialise the filter
+ *
+ *  @param percentile - e.g. 0.9 to reject candidates slower than nine in ten recent candidates
+ *  @param window     - number of recent round trip times to keep
+ *
+ *  @return initialised RTTPercentileFilter instance
+ */
+- (id) initWithPercentile:(double) percentile Window:(NSUInteger) window;
+
+@end
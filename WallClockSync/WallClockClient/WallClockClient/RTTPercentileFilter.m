@@ -0,0 +1,68 @@
+//
+//  RTTPercentileFilter.m
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "RTTPercentileFilter.h"
+#import <SyncKitCollections/SyncKitCollections.h>
+
+
+@implementation RTTPercentileFilter
+{
+    WindowedStats           *rtts;
+}
+
+
+- (id) initWithPercentile:(double) percentile Window:(NSUInteger) window
+{
+    self = [super initWithWindow:window];
+    if (self != nil) {
+        _percentile = MIN(MAX(percentile, 0.0), 1.0);
+        rtts = [[WindowedStats alloc] initWithCapacity:self.window];
+    }
+    return self;
+}
+
+
+- (void) filterBatch:(CandidateBatch*) batch
+{
+    int64_t rtt[CANDIDATE_BATCH_MAX];
+    double threshold = INFINITY;
+    NSUInteger i, kept = 0, live = batch->live;
+
+    if ([self isJudging:rtts.count])
+        threshold = [rtts percentile:_percentile];
+
+    for (i = 0; i < live; i++)
+    {
+        uint8_t c = batch->selected[i];
+
+        rtt[i] = batch->RTT[c];
+        batch->selected[kept] = c;
+        kept += (rtt[i] <= threshold);
+    }
+    batch->live = kept;
+
+    for (i = 0; i < live; i++)
+        [rtts put:(double) rtt[i]];
+
+    [self countBatch:live Kept:kept];
+}
+
+@end
@@ -7,12 +7,12 @@
 //
 
 #import <Foundation/Foundation.h>
-#import "IFilter.h"
+#import "IBatchFilter.h"
 
 /**
  *  Simple filter that rejects all candidates where round trip time exceeds a specified threshold.
  */
-@interface RTTThresholdFilter : NSObject <IFilter>
+@interface RTTThresholdFilter : NSObject <IBatchFilter>
 
 /**
  *  RTT threshold in nano seconds
@@ -7,6 +7,7 @@
 //
 
 #import "RTTThresholdFilter.h"
+#import <stdatomic.h>
 
 
 @interface RTTThresholdFilter()
@@ -19,8 +20,8 @@
 
 @implementation RTTThresholdFilter
 {
-    uint64_t drop_count;
-    uint64_t count;
+    atomic_uint_fast64_t drop_count;
+    atomic_uint_fast64_t count;
 }
 
 @synthesize RTTThresholdNanos =  _RTTThresholdNanos;
@@ -30,7 +31,8 @@
     self = [super init];
     if (self != nil) {
         
-        drop_count = 0;
+        atomic_init(&drop_count, 0);
+        atomic_init(&count, 0);
         _RTTThresholdNanos = 200000000; // 200 ms
     }
     return self;
@@ -42,8 +44,9 @@
     self = [super init];
     if (self != nil) {
         
-        drop_count = 0;
-        _RTTThresholdNanos = rtt_threshold_ms * 1000000; // in nano secs
+        atomic_init(&drop_count, 0);
+        atomic_init(&count, 0);
+        _RTTThresholdNanos = (uint64_t) rtt_threshold_ms * 1000000; // in nano secs
     }
     return self;
 }
@@ -53,11 +56,10 @@
 {
     if (!candidate) return false;
     
-    // rollover counter if it is greater than 1 billion
-    count = count == 1e9?1:count++;
+    atomic_fetch_add_explicit(&count, 1, memory_order_relaxed);
     
     if ([candidate getRTT] > _RTTThresholdNanos) {
-        drop_count = (drop_count+1) &1000000000;
+        atomic_fetch_add_explicit(&drop_count, 1, memory_order_relaxed);
         //NSLog(@"REJECTED! Candidate RTT %lld > %lld",[candidate getRTT] , _RTTThresholdNanos);
         
         return false;
@@ -66,14 +68,33 @@
 }
 
 
+- (void) filterBatch:(CandidateBatch*) batch
+{
+    const uint64_t threshold = _RTTThresholdNanos;
+    NSUInteger i, kept = 0, live = batch->live;
+    
+    for (i = 0; i < live; i++)
+    {
+        uint8_t c = batch->selected[i];
+        
+        batch->selected[kept] = c;
+        kept += ((uint64_t) batch->RTT[c] <= threshold);     // as checkCandidate:, a negative RTT fails
+    }
+    batch->live = kept;
+    
+    atomic_fetch_add_explicit(&count, live, memory_order_relaxed);
+    atomic_fetch_add_explicit(&drop_count, live - kept, memory_order_relaxed);
+}
+
+
 - (uint64_t)getCandidateDropCount{
     
-    return drop_count;
+    return atomic_load_explicit(&drop_count, memory_order_relaxed);
 }
 
 -(uint64_t)getCandidateTotal
 {
-    return count;
+    return atomic_load_explicit(&count, memory_order_relaxed);
 }
 
 @end
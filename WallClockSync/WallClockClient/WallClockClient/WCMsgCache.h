@@ -0,0 +1,120 @@
+//
+//  WCMsgCache.h
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+#import "WCSyncMessage.h"
+
+
+/**
+ *  Handler for a cached message that expired
+ *
+ *  @param packet        the cached packet
+ *  @param response_time time the message was received, in nanoseconds (0 for requests)
+ *  @param source        the server the message was exchanged with
+ */
+typedef void (^WCMsgExpiryHandler)(const WCSyncMessagePkt *packet, int64_t response_time, uint32_t source);
+
+
+/**
+ *  Fixed-capacity cache of WC protocol messages awaiting a reply (requests awaiting a response,
+ *  responses awaiting a follow-up), keyed on originate time, message type and source (the server the
+ *  message was exchanged with).
+ *
+ *  Packets are copied into a slab of entries allocated when the cache is created. Entries are
+ *  found through an open-addressed (linear probing) hash table and expire through a timer wheel,
+ *  so insert, look-up and expiry are O(1) and do not allocate memory.
+ *
+ *  A WCMsgCache is not thread-safe; callers must serialise access.
+ */
+@interface WCMsgCache : NSObject
+
+/**
+ *  Maximum number of cached messages
+ */
+@property (nonatomic, readonly) NSUInteger capacity;
+
+/**
+ *  Number of cached messages
+ */
+@property (nonatomic, readonly) NSUInteger count;
+
+
+- (instancetype)init NS_UNAVAILABLE;
+
+
+/**
+ *  Initialise a cache
+ *
+ *  @param capacity - maximum number of cached messages (rounded up to a power of two)
+ *
+ *  @return WCMsgCache instance
+ */
+- (id) initWithCapacity:(NSUInteger) capacity;
+
+
+/**
+ *  Copy a packet into the cache. If the cache is full, the entry closest to expiry is dropped.
+ *
+ *  @param packet        - a WC protocol packet
+ *  @param response_time - time the packet was received, in nanoseconds (0 for requests)
+ *  @param expiry_time   - time after which the entry expires, in nanoseconds
+ *  @param source        - the server the packet was sent to or received from
+ */
+- (void) insertPacket:(const WCSyncMessagePkt*) packet
+    ResponseTimeNanos:(int64_t) response_time
+           ExpiryTime:(int64_t) expiry_time
+               Source:(uint32_t) source;
+
+
+/**
+ *  Remove the cached message with this originate time, message type and source.
+ *
+ *  @param originate_time - originate time value of the message, in nanoseconds
+ *  @param msg_type       - message type
+ *  @param source         - the server the message was exchanged with
+ *  @param now            - current time, in nanoseconds
+ *
+ *  @return YES if the message was cached and had not expired at time now
+ */
+- (BOOL) removeMessageWithOriginateTime:(int64_t) originate_time
+                                   Type:(uint8_t) msg_type
+                                 Source:(uint32_t) source
+                                 AtTime:(int64_t) now;
+
+
+/**
+ *  Remove messages that have expired by time now.
+ *
+ *  @param now     - current time, in nanoseconds
+ *  @param handler - called for each expired message, after it is removed (may be nil)
+ *
+ *  @return number of messages removed
+ */
+- (NSUInteger) expireMessagesAtTime:(int64_t) now
+                            Handler:(WCMsgExpiryHandler) handler;
+
+
+/**
+ *  Remove all messages
+ */
+- (void) removeAllMessages;
+
+@end
@@ -0,0 +1,349 @@
+//
+//  WCMsgCache.m
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "WCMsgCache.h"
+#import <SimpleLogger/SimpleLogger.h>
+#import <arpa/inet.h>
+
+
+// timer wheel: 1024 slots of 2^22 ns (about 4.2 ms), about 4.3 s per revolution. Entries that
+// expire further ahead wait in their slot for later revolutions.
+#define WHEEL_SLOTS         1024
+#define WHEEL_TICK_SHIFT    22
+
+#define NO_ENTRY            (-1)
+
+
+/**
+ *  A slab entry. Free entries are chained through next.
+ */
+typedef struct {
+    WCSyncMessagePkt    packet;
+    int64_t             originateTime;
+    int64_t             responseTime;
+    int64_t             expiryTime;
+    uint32_t            source;         // server the message was exchanged with
+    int32_t             prev;           // timer wheel slot list links
+    int32_t             next;
+    uint32_t            slot;           // timer wheel slot
+    uint8_t             msgType;
+} WCMsgCacheEntry;
+
+
+static inline int64_t OriginateTimeNanos(const WCSyncMessagePkt *packet)
+{
+    return ((int64_t) ntohl(packet->originate_timevalue.timevalue_secs)) * 1000000000
+            + (int64_t) ntohl(packet->originate_timevalue.timevalue_nanos);
+}
+
+
+@implementation WCMsgCache
+{
+    WCMsgCacheEntry     *entries;       // slab
+    int32_t             freeList;
+
+    int32_t             *table;         // hash table of entry indices
+    uint32_t            tableMask;
+    uint32_t            tableShift;
+
+    int32_t             wheel[WHEEL_SLOTS];
+    int64_t             lastTick;
+}
+
+
+#pragma mark initialisation and deallocation routines
+
+- (id) initWithCapacity:(NSUInteger) capacity
+{
+    self = [super init];
+    if (self != nil) {
+        NSUInteger i;
+
+        _capacity = 1;
+        while (_capacity < MAX(capacity, 2)) _capacity <<= 1;
+        _count = 0;
+
+        entries = (WCMsgCacheEntry*) calloc(_capacity, sizeof(WCMsgCacheEntry));
+
+        // table at most half full
+        tableMask = (uint32_t) (2 * _capacity) - 1;
+        tableShift = 64 - (uint32_t) __builtin_ctzll(2 * _capacity);
+        table = (int32_t*) malloc(2 * _capacity * sizeof(int32_t));
+
+        if ((entries == NULL) || (table == NULL))
+            return nil;
+
+        for (i = 0; i <= tableMask; i++) table[i] = NO_ENTRY;
+        for (i = 0; i < WHEEL_SLOTS; i++) wheel[i] = NO_ENTRY;
+        for (i = 0; i < _capacity; i++) entries[i].next = (i + 1 < _capacity) ? (int32_t) (i + 1) : NO_ENTRY;
+        freeList = 0;
+        lastTick = INT64_MIN;
+    }
+    return self;
+}
+
+
+- (void) dealloc
+{
+    free(entries);
+    free(table);
+}
+
+
+#pragma mark public methods
+
+- (void) insertPacket:(const WCSyncMessagePkt*) packet
+    ResponseTimeNanos:(int64_t) response_time
+           ExpiryTime:(int64_t) expiry_time
+               Source:(uint32_t) source
+{
+    int64_t originate = OriginateTimeNanos(packet);
+    uint8_t msg_type = packet->message_type;
+    uint32_t pos;
+    int32_t idx;
+
+    // replace an entry with the same key
+    if ([self findOriginateTime:originate Type:msg_type Source:source Position:&pos])
+        [self removeEntryAtPosition:pos];
+
+    if (freeList == NO_ENTRY)
+    {
+        MWLogDebug(@"WCMsgCache: cache full, dropping the entry closest to expiry");
+        [self evictEarliestEntry];
+    }
+
+    idx = freeList;
+    freeList = entries[idx].next;
+
+    WCMsgCacheEntry *e = &entries[idx];
+    memcpy(&e->packet, packet, sizeof(WCSyncMessagePkt));
+    e->originateTime = originate;
+    e->responseTime = response_time;
+    e->expiryTime = expiry_time;
+    e->msgType = msg_type;
+    e->source = source;
+
+    // first free table position along the probe sequence
+    pos = [self homePositionOf:originate Type:msg_type Source:source];
+    while (table[pos] != NO_ENTRY) pos = (pos + 1) & tableMask;
+    table[pos] = idx;
+
+    [self linkToWheel:idx];
+    _count++;
+}
+
+
+- (BOOL) removeMessageWithOriginateTime:(int64_t) originate_time
+                                   Type:(uint8_t) msg_type
+                                 Source:(uint32_t) source
+                                 AtTime:(int64_t) now
+{
+    uint32_t pos;
+
+    if (![self findOriginateTime:originate_time Type:msg_type Source:source Position:&pos])
+        return NO;
+
+    BOOL expired = now > entries[table[pos]].expiryTime;
+
+    [self removeEntryAtPosition:pos];
+
+    return !expired;
+}
+
+
+- (NSUInteger) expireMessagesAtTime:(int64_t) now
+                            Handler:(WCMsgExpiryHandler) handler
+{
+    int64_t nowTick = now >> WHEEL_TICK_SHIFT;
+    int64_t tick;
+    NSUInteger removed = 0;
+
+    // the first call, and steps of the clock back in time, restart the wheel at now
+    if ((lastTick == INT64_MIN) || (nowTick < lastTick))
+        lastTick = nowTick;
+
+    // slots from the last one visited (entries may have been added to it since) to now,
+    // visiting each slot at most once
+    if (nowTick - lastTick >= WHEEL_SLOTS)
+        lastTick = nowTick - WHEEL_SLOTS + 1;
+
+    for (tick = lastTick; tick <= nowTick; tick++)
+    {
+        int32_t idx = wheel[tick & (WHEEL_SLOTS - 1)];
+
+        while (idx != NO_ENTRY)
+        {
+            WCMsgCacheEntry *e = &entries[idx];
+            int32_t next = e->next;
+
+            if (e->expiryTime < now)
+            {
+                WCSyncMessagePkt packet = e->packet;
+                int64_t response_time = e->responseTime;
+                uint32_t source = e->source;
+                uint32_t pos;
+
+                if ([self findOriginateTime:e->originateTime Type:e->msgType Source:source Position:&pos])
+                    [self removeEntryAtPosition:pos];
+                removed++;
+
+                if (handler) handler(&packet, response_time, source);
+            }
+            idx = next;
+        }
+    }
+    lastTick = nowTick;
+
+    return removed;
+}
+
+
+- (void) removeAllMessages
+{
+    NSUInteger i;
+
+    for (i = 0; i <= tableMask; i++) table[i] = NO_ENTRY;
+    for (i = 0; i < WHEEL_SLOTS; i++) wheel[i] = NO_ENTRY;
+    for (i = 0; i < _capacity; i++) entries[i].next = (i + 1 < _capacity) ? (int32_t) (i + 1) : NO_ENTRY;
+    freeList = 0;
+    _count = 0;
+}
+
+
+#pragma mark Private methods
+
+- (uint32_t) homePositionOf:(int64_t) originate_time Type:(uint8_t) msg_type Source:(uint32_t) source
+{
+    uint64_t key = ((uint64_t) originate_time) ^ (((uint64_t) msg_type) << 56) ^ (((uint64_t) source) << 40);
+
+    // Fibonacci hashing: the top bits of the product are well mixed
+    return (uint32_t) ((key * 0x9E3779B97F4A7C15ULL) >> tableShift);
+}
+
+
+- (BOOL) findOriginateTime:(int64_t) originate_time Type:(uint8_t) msg_type Source:(uint32_t) source Position:(uint32_t*) position
+{
+    uint32_t pos = [self homePositionOf:originate_time Type:msg_type Source:source];
+
+    while (table[pos] != NO_ENTRY)
+    {
+        WCMsgCacheEntry *e = &entries[table[pos]];
+
+        if ((e->originateTime == originate_time) && (e->msgType == msg_type) && (e->source == source))
+        {
+            *position = pos;
+            return YES;
+        }
+        pos = (pos + 1) & tableMask;
+    }
+    return NO;
+}
+
+
+/**
+ *  Remove an entry from the table, the wheel and the slab. Later entries of the probe sequence
+ *  are shifted back into the gap, so that look-ups never need tombstones.
+ */
+- (void) removeEntryAtPosition:(uint32_t) position
+{
+    int32_t idx = table[position];
+    uint32_t gap = position;
+    uint32_t pos = position;
+
+    for (;;)
+    {
+        pos = (pos + 1) & tableMask;
+        if (table[pos] == NO_ENTRY) break;
+
+        WCMsgCacheEntry *e = &entries[table[pos]];
+        uint32_t home = [self homePositionOf:e->originateTime Type:e->msgType Source:e->source];
+
+        // the entry can fill the gap if its home position is not cyclically in (gap, pos]
+        if (((pos - home) & tableMask) >= ((pos - gap) & tableMask))
+        {
+            table[gap] = table[pos];
+            gap = pos;
+        }
+    }
+    table[gap] = NO_ENTRY;
+
+    [self unlinkFromWheel:idx];
+    entries[idx].next = freeList;
+    freeList = idx;
+    _count--;
+}
+
+
+- (void) evictEarliestEntry
+{
+    uint32_t pos, earliest = 0;
+    int64_t earliestExpiry = INT64_MAX;
+
+    for (pos = 0; pos <= tableMask; pos++)
+    {
+        if ((table[pos] != NO_ENTRY) && (entries[table[pos]].expiryTime < earliestExpiry))
+        {
+            earliestExpiry = entries[table[pos]].expiryTime;
+            earliest = pos;
+        }
+    }
+    [self removeEntryAtPosition:earliest];
+}
+
+
+- (uint32_t) wheelSlotOf:(int32_t) idx
+{
+    int64_t tick = entries[idx].expiryTime >> WHEEL_TICK_SHIFT;
+
+    // overdue entries go to the next slot to be visited
+    if ((lastTick != INT64_MIN) && (tick < lastTick))
+        tick = lastTick;
+
+    return (uint32_t) (tick & (WHEEL_SLOTS - 1));
+}
+
+
+- (void) linkToWheel:(int32_t) idx
+{
+    uint32_t slot = [self wheelSlotOf:idx];
+
+    entries[idx].slot = slot;
+    entries[idx].prev = NO_ENTRY;
+    entries[idx].next = wheel[slot];
+    if (wheel[slot] != NO_ENTRY) entries[wheel[slot]].prev = idx;
+    wheel[slot] = idx;
+}
+
+
+- (void) unlinkFromWheel:(int32_t) idx
+{
+    WCMsgCacheEntry *e = &entries[idx];
+
+    if (e->prev != NO_ENTRY)
+        entries[e->prev].next = e->next;
+    else
+        wheel[e->slot] = e->next;
+
+    if (e->next != NO_ENTRY)
+        entries[e->next].prev = e->prev;
+}
+
+@end
@@ -86,6 +86,22 @@
 - (id) initWithHost:(NSString*) hostname Port:(NSUInteger) port CandidateSink:(id<ICandidateHandler>) can_sink AndWallClock:(ClockBase*) clock;
 
 
+/**
+ *  Initialise a WallClock protocol client that exchanges messages with several WallClock servers
+ *  in parallel, from one socket and event loop. Each request is sent to every server; candidates
+ *  are tagged with the index of the server that answered (see Candidate source) for the candidate
+ *  sink to select among them.
+ *
+ *  @param hostnames - DNS-resolvable hostnames or addresses of the WallClock servers
+ *  @param ports     - the servers' ports (NSNumber), in the same order
+ *  @param can_sink  - a handler for candidate measurements. WCClient will enqueue candidate measurements
+ *  @param clock     - a clock to use for getting timestamps and calculating offsets, e.g. the local WallClock instance
+ *
+ *  @return an WCClient instance.
+ */
+- (id) initWithHosts:(NSArray<NSString*>*) hostnames Ports:(NSArray<NSNumber*>*) ports CandidateSink:(id<ICandidateHandler>) can_sink AndWallClock:(ClockBase*) clock;
+
+
 /**
  *  Start WallClock sync measurement collection session. Starts the emission of WC protocol request messages.
  */
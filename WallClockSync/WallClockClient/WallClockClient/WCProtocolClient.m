@@ -21,22 +21,32 @@
 #import "WCSyncMessage.h"
 #import "Candidate.h"
 #import "WCProtocolClient.h"
+#import "WCMsgCache.h"
 
 #import <SyncKitConfiguration/SyncKitConfiguration.h>
 #import <ClockTimelines/ClockTimelines.h>
 #import <SimpleLogger/SimpleLogger.h>
-#import <SyncKitCollections/NSStack.h>
 #import <SyncKitCollections/utils.h>
 
 #import <pthread.h>
 #import <sys/types.h> // for timeval
 #import <sys/time.h>
+#import <netdb.h>
 
 
 // max number of messages generated by this application per second
 #define WCMSG_RATELIMIT	10
 #define DEF_SEND_WCSYNC_REQ_PERIOD 500000 // in microsecs
 
+// max number of requests and responses awaiting a reply
+#define WCMSG_CACHE_CAPACITY 64
+
+// receive buffers the UDP endpoint lends out
+#define WCMSG_RECV_POOL_SIZE 8
+
+// max number of WC servers in multi-server mode
+#define WCMAX_SERVERS 16
+
 /** TODO:
  1. ratelimit emission of WC Sync Messages --> DONE
  2. write testcases for unit testing --> DONE
@@ -67,14 +77,10 @@
 ///-----------------------------------------------------------
 
 /**
- *  Thread function for sending WC request messages
- */
-- (void) requestSenderThreadFunc;
-
-/**
- *  A thread to check for incoming messages at the UDP endpoint
+ *  Event loop thread: waits for incoming messages at the UDP endpoint, sends WC request
+ *  messages when they are due and expires cached messages
  */
-- (void) MsgHandlerThreadFunc;
+- (void) eventLoopThreadFunc;
 
 
 /**
@@ -89,25 +95,62 @@
 
 
 /**
- *  Look up in message cache and return a matching message for the reply
+ *  Multi-server mode: resolves the server addresses and starts an unconnected UDP endpoint,
+ *  shared by the exchanges with every server
+ *
+ *  @return true if endpoint was created and started
+ */
+- (BOOL)runClientWithServers;
+
+
+/**
+ *  Index of the server that sent a datagram
  *
- *  @param reply - a WC reponse message fom a WC server
+ *  @param datagram - a datagram received in multi-server mode
  *
- *  @return corresponding request message for response message
+ *  @return the server's index, or NSNotFound for an unknown sender
  */
-- (WCSyncMessage *) WCSyncMsgCacheLookUp: (WCSyncMessage *) reply;
+- (NSUInteger) sourceOfDatagram:(const UDPDatagram *) datagram;
+
+
+/**
+ *  Process a response message from the WC server
+ *
+ *  @param wcRespPkt - response packet, borrowed from the UDP endpoint
+ *  @param now       - response time value (time of arrival) in nanoseconds, in the wallclock's timescale
+ *  @param source    - index of the server that sent the response (0 with a single server)
+ */
+- (void) handleResponsePacket:(const WCSyncMessagePkt *)wcRespPkt ResponseTimeNanos:(int64_t) now Source:(uint32_t) source;
+
+
+/**
+ *  A Candidate for a response packet, from the candidate sink's pool if it has one
+ *
+ *  @return an initialised candidate
+ */
+- (Candidate*) candidateWithPacket:(const WCSyncMessagePkt *)packet ResponseTimeNanos:(int64_t) response_time Quality:(int8_t) quality Source:(uint32_t) source;
+
+
+/**
+ *  Look up in message cache and remove the message matching the reply
+ *
+ *  @param reply  - a WC reponse message packet fom a WC server
+ *  @param source - index of the server that sent the reply
+ *
+ *  @return true if a corresponding message for the response message was cached and had not expired
+ */
+- (BOOL) WCSyncMsgCacheLookUp: (const WCSyncMessagePkt *) reply Source:(uint32_t) source;
 
 @end
 
 @implementation WCProtocolClient
 {
     // msg cache
-    NSMutableArray          *wcSyncMessageCache;
+    WCMsgCache              *wcSyncMessageCache;
     
     // threads and mutexes
-    NSThread                *requestSenderThread;       // send request thread
-    NSThread                *recvPollThread;
-    pthread_mutex_t         WCMsgCacheMutex;            // mutex to avoid race conditions on wcSyncReqHistory by
+    NSThread                *eventLoopThread;           // receives responses, sends requests
+    pthread_mutex_t         WCMsgCacheMutex;            // mutex to avoid race conditions on wcSyncMessageCache
     pthread_mutex_t         mutex;                      // mutex for ready_to_go condition var
     pthread_cond_t          condition;
     Boolean                 ready_to_go;                // condition variable
@@ -117,9 +160,14 @@
     struct timeval          wcMsgRateArray[WCMSG_RATELIMIT];
     int                     num_req_msgs;
     
-    // clean up stale messages
-    NSStack                 *removables;
+    // request packet in the UDP endpoint's send buffer, wrapped once
+    NSData                  *sendBufferData;
     
+    // multi-server mode: servers, and one request datagram per server
+    NSArray<NSString *>     *serverHosts;
+    NSArray<NSNumber *>     *serverPorts;
+    UDPDatagram             serverRequests[WCMAX_SERVERS];
+    NSUInteger              numServers;
 }
 
 @synthesize udp_endpoint = _udp_endpoint;
@@ -154,27 +202,18 @@
         ready_to_go = false;
         continue_loop = true;
         
-        wcSyncMessageCache = [[NSMutableArray alloc] initWithCapacity:5];
+        wcSyncMessageCache = [[WCMsgCache alloc] initWithCapacity:WCMSG_CACHE_CAPACITY];
         pthread_mutex_init(&WCMsgCacheMutex, NULL);
-        removables = [[NSStack alloc] init];
         
         pthread_mutex_init(&mutex, NULL);
         
         pthread_cond_init(&condition, NULL);
         
-        // create our send request thread, thread started after UDP endpoint has been set up
-        requestSenderThread =   [[NSThread alloc]
-                                 initWithTarget:self
-                                 selector:@selector(requestSenderThreadFunc)
-                                 object:nil];
-        
-       
-        
-        // create our receive thread, thread started after UDP endpoint has been set up
-        recvPollThread =   [[NSThread alloc]
-                            initWithTarget:self
-                            selector:@selector(MsgHandlerThreadFunc)
-                            object:nil];
+        // create our event loop thread, thread started after UDP endpoint has been set up
+        eventLoopThread =   [[NSThread alloc]
+                             initWithTarget:self
+                             selector:@selector(eventLoopThreadFunc)
+                             object:nil];
         
         // start the UDP comms component in client mode
         [self runClientWithHost:_hostName port:_port];
@@ -207,27 +246,18 @@
         continue_loop = true;
         
         // init Request mesg list
-        wcSyncMessageCache = [[NSMutableArray alloc] initWithCapacity:5];
+        wcSyncMessageCache = [[WCMsgCache alloc] initWithCapacity:WCMSG_CACHE_CAPACITY];
          pthread_mutex_init(&WCMsgCacheMutex, NULL);
         
-        removables = [[NSStack alloc] init];
         
         pthread_mutex_init(&mutex, NULL);
         pthread_cond_init(&condition, NULL);
         
-        // create our send request thread, thread started after UDP endpoint has been set up
-        requestSenderThread =   [[NSThread alloc]
-                                 initWithTarget:self
-                                 selector:@selector(requestSenderThreadFunc)
-                                 object:nil];
-        
-        
-        
-        // create our receive thread, thread started after UDP endpoint has been set up
-        recvPollThread =   [[NSThread alloc]
-                            initWithTarget:self
-                            selector:@selector(MsgHandlerThreadFunc)
-                            object:nil];
+        // create our event loop thread, thread started after UDP endpoint has been set up
+        eventLoopThread =   [[NSThread alloc]
+                             initWithTarget:self
+                             selector:@selector(eventLoopThreadFunc)
+                             object:nil];
         
         num_req_msgs = 0;
         
@@ -267,10 +297,9 @@
         continue_loop = true;
         
         // init Request mesg list
-        wcSyncMessageCache = [[NSMutableArray alloc] initWithCapacity:5];
+        wcSyncMessageCache = [[WCMsgCache alloc] initWithCapacity:WCMSG_CACHE_CAPACITY];
         pthread_mutex_init(&WCMsgCacheMutex, NULL);
         
-        removables = [[NSStack alloc] init];
         
         pthread_mutex_init(&mutex, NULL);
         pthread_cond_init(&condition, NULL);
@@ -286,6 +315,28 @@
 
 
 
+/**
+ Initialise the measurement collector for several WC servers
+ */
+- (id) initWithHosts:(NSArray<NSString*>*) hostnames Ports:(NSArray<NSNumber*>*) ports CandidateSink:(id<ICandidateHandler>) can_sink AndWallClock:(ClockBase*) clock
+{
+    assert([hostnames count] > 0);
+    assert([hostnames count] == [ports count]);
+    
+    self = [self initWithHost:hostnames[0] Port:[ports[0] unsignedIntegerValue] CandidateSink:can_sink AndWallClock:clock];
+    if (self != nil) {
+        
+        if ([hostnames count] > WCMAX_SERVERS)
+            MWLogWarning(@"WallClockProtocolClient: only the first %d of %lu WC servers are used", WCMAX_SERVERS, (unsigned long) [hostnames count]);
+        
+        serverHosts = [hostnames copy];
+        serverPorts = [ports copy];
+    }
+    return self;
+}
+
+
+
 /**
  Clean up code when instance is destroyed
  */
@@ -317,44 +368,47 @@
 /// @name UDPCommsDelegate methods
 ///-----------------------------------------------------------
 /**
- This UDPComms delegate method is called after successfully receiving data.
+ This UDPComms delegate method is called with the packets read from the socket in one go. The
+ packets are read in place in the endpoint's receive buffer pool and handed back once processed.
 */
-- (void) didReceiveData:(NSData *)data fromAddress:(NSData *)addr
+- (void) didReceiveDatagrams:(const UDPDatagram * const *)datagrams Count:(NSUInteger) count
 {
-    NSUInteger          dataLength;
-    WCSyncMessagePkt    *wcRespPkt;
-    WCSyncMessage       *wcResponseMsg;
-    WCSyncMessage       *cachedMsg=nil;
+    NSUInteger i;
+    int64_t now;
+    
+    for (i = 0; i < count; i++)
+    {
+        const UDPDatagram *datagram = datagrams[i];
+        NSUInteger source = (numServers > 0) ? [self sourceOfDatagram:datagram] : 0;
+        
+        // the kernel's receive timestamp (or, without one, the time the packet was read) in the
+        // wallclock's timescale
+        now = [_wallclockRef ticksToNanoSeconds:[_wallclockRef ticksAtHostTime:datagram->hostTime]];
+        
+        if (source == NSNotFound)
+            MWLogDebug(@"WallClockProtocolClient: packet from an unknown server dropped");
+        else if (datagram->length >= sizeof(WCSyncMessagePkt))
+            [self handleResponsePacket:(const WCSyncMessagePkt *) datagram->bytes ResponseTimeNanos:now Source:(uint32_t) source];
+        else
+            MWLogDebug(@"WallClockProtocolClient: short packet dropped, %zu bytes", datagram->length);
+        
+        [self.udp_endpoint releaseDatagram:datagram];
+    }
+}
+
+
+- (void) handleResponsePacket:(const WCSyncMessagePkt *)wcRespPkt ResponseTimeNanos:(int64_t) now Source:(uint32_t) source
+{
+    BOOL                cached;
     Candidate*          candidate;
-    uint64_t            now;
+    int64_t             originate_time;
     int                 quality = 0; // response quality
     
-    assert(data != nil);
-    assert(addr != nil);
-    //NSLog(@"received packet  from %@ ... ", DisplayAddressForAddress(addr));
-    
-    
-    // get packet bytes
-    dataLength = [data length];
-    wcRespPkt = (WCSyncMessagePkt*) [data bytes];
     assert(wcRespPkt != nil);
     
-    // get timestamp for response time value as early as possible
-    now = [_wallclockRef nanoSeconds];
-    
-    // build the response message, packet is deep-copied
-    //MWLogDebug(@"WCClientProtocolImpl: reponse packet creation from receive buffer");
-    wcResponseMsg = [[WCSyncMessage alloc] initWithPacket:wcRespPkt AndResponseTimeNanos:now];
+    cached = [self WCSyncMsgCacheLookUp:wcRespPkt Source:source];
     
-    cachedMsg = [self WCSyncMsgCacheLookUp:wcResponseMsg];
-    
-    if (cachedMsg){
-        quality = 0;
-        free(cachedMsg.packet);
-        cachedMsg = nil;
-    }
-    else
-        quality = -10;
+    quality = cached ? 0 : -10;
     
     switch (wcRespPkt->message_type) {
         
@@ -368,8 +422,16 @@
             // should not result in a candidate measurement unless follow-up is not received within timeout
             quality +=2;
             
+            originate_time = ((int64_t) ntohl(wcRespPkt->originate_timevalue.timevalue_secs)) * 1000000000
+                                + (int64_t) ntohl(wcRespPkt->originate_timevalue.timevalue_nanos);
+            
             // cache this message 
-            [wcSyncMessageCache addObject:wcResponseMsg];
+            pthread_mutex_lock(&WCMsgCacheMutex);
+            [wcSyncMessageCache insertPacket:wcRespPkt
+                           ResponseTimeNanos:now
+                                  ExpiryTime:originate_time + ((int64_t) [_config CachedWCRESPTimeOutUSecs]) * 1000
+                                      Source:source];
+            pthread_mutex_unlock(&WCMsgCacheMutex);
             break;
             
         case WCMSG_FOLLOWUP:
@@ -384,15 +446,27 @@
     
     if (quality >=3)
     {
-        candidate = [[Candidate alloc] initWithResponseMsg:wcResponseMsg Quality:quality TimeIsNanos:true];
-       // MWLogDebug(@"WCProtocolClient.didReceiveData: %@", [wcResponseMsg description]);
+        candidate = [self candidateWithPacket:wcRespPkt ResponseTimeNanos:now Quality:quality Source:source];
         
         if (_candidateSink !=nil)
             [_candidateSink enqueueCandidate:candidate];
     }
+}
+
+
+- (Candidate*) candidateWithPacket:(const WCSyncMessagePkt *)packet ResponseTimeNanos:(int64_t) response_time Quality:(int8_t) quality Source:(uint32_t) source
+{
+    Candidate *candidate;
     
+    // a sink with a pool of candidates recycles them once they have been processed
+    if ([_candidateSink respondsToSelector:@selector(candidateWithPacket:ResponseTimeNanos:Quality:)])
+        candidate = [_candidateSink candidateWithPacket:packet ResponseTimeNanos:response_time Quality:quality];
+    else
+        candidate = [[Candidate alloc] initWithPacket:packet ResponseTimeNanos:response_time Quality:quality TimeIsNanos:true];
     
+    candidate.source = source;
     
+    return candidate;
 }
 
 
@@ -438,10 +512,8 @@
 //        [self start];
 //    }
     
-    // start the thread, it will block on the condition var ready_to_go
-    [requestSenderThread start];
-    // start the thread
-    [recvPollThread start];
+    // start the thread, it sends requests once ready_to_go is set
+    [eventLoopThread start];
 }
 
 - (void) didStopWithError:(NSError *)error
@@ -462,25 +534,20 @@
 
 - (void) start{
     continue_loop= true;
-    // create our send request thread, thread started after UDP endpoint has been set up
-    requestSenderThread =   [[NSThread alloc]
-                             initWithTarget:self
-                             selector:@selector(requestSenderThreadFunc)
-                             object:nil];
-    
-    
-    
-    // create our receive thread, thread started after UDP endpoint has been set up
-    recvPollThread =   [[NSThread alloc]
-                        initWithTarget:self
-                        selector:@selector(MsgHandlerThreadFunc)
-                        object:nil];
+    // create our event loop thread, thread started after UDP endpoint has been set up
+    eventLoopThread =   [[NSThread alloc]
+                         initWithTarget:self
+                         selector:@selector(eventLoopThreadFunc)
+                         object:nil];
 
     
     
     _running = true;
     // start the UDP comms component in client mode
-    [self runClientWithHost:_hostName port:_port];
+    if (serverHosts != nil)
+        [self runClientWithServers];
+    else
+        [self runClientWithHost:_hostName port:_port];
     
     
     
@@ -491,6 +558,9 @@
     pthread_cond_signal(&condition);
     
     pthread_mutex_unlock(&mutex);
+    
+    // the event loop may be waiting for packets; let it send the first request now
+    [self.udp_endpoint wakeUp];
 }
 
 //
@@ -508,7 +578,10 @@
 
 - (void) stop{
     continue_loop = false;
-    [wcSyncMessageCache removeAllObjects];
+    [self.udp_endpoint wakeUp];
+    pthread_mutex_lock(&WCMsgCacheMutex);
+    [wcSyncMessageCache removeAllMessages];
+    pthread_mutex_unlock(&WCMsgCacheMutex);
     
    // udpendpoint object is stopped after thread loop exits
     
@@ -544,11 +617,17 @@
     
     assert(self.udp_endpoint == nil);
     
-    self.udp_endpoint = [[UDPEndpoint alloc] initWithBufferSize:WCSYNCMSG_SIZE];
+    self.udp_endpoint = [[UDPEndpoint alloc] initWithBufferSize:WCSYNCMSG_SIZE PoolSize:WCMSG_RECV_POOL_SIZE];
     assert(self.udp_endpoint != nil);
     
     self.udp_endpoint.delegate = self;
     
+    // timestamp responses in the kernel, on arrival
+    self.udp_endpoint.receiveTimestamps = YES;
+    
+    // the send buffer does not move, so one NSData object can wrap it for every request
+    sendBufferData = [NSData dataWithBytesNoCopy:[self.udp_endpoint getSendBuffer] length:sizeof(WCSyncMessagePkt) freeWhenDone:NO];
+    
     [self.udp_endpoint startConnectedToHostName:host port:port];
     
     
@@ -566,66 +645,119 @@
 
 
 /**
- Look up and return a matching message for the reply
+ Private method
+ Resolves the WC servers' addresses and creates an unconnected UDP endpoint for exchanges with
+ all of them. Servers that cannot be resolved are left out.
  */
-- (WCSyncMessage *) WCSyncMsgCacheLookUp: (WCSyncMessage *) reply
+- (BOOL)runClientWithServers
 {
-    WCSyncMessage* temp = nil;
-    BOOL expired = false;
-    BOOL match = false;
-    uint64_t OriginateTimeNanos = 0;
-    uint64_t now= 0;
+    struct addrinfo hints, *res;
+    NSUInteger i;
+    
+    assert(self.udp_endpoint == nil);
+    
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    
+    numServers = 0;
+    for (i = 0; (i < [serverHosts count]) && (numServers < WCMAX_SERVERS); i++)
+    {
+        UDPDatagram *request = &serverRequests[numServers];
+        
+        if ((getaddrinfo([serverHosts[i] UTF8String], NULL, &hints, &res) != 0) || (res == NULL))
+        {
+            MWLogError(@"WallClockProtocolClient: could not resolve WC server %@", serverHosts[i]);
+            continue;
+        }
+        memset(request, 0, sizeof(UDPDatagram));
+        memcpy(&request->address, res->ai_addr, res->ai_addrlen);
+        ((struct sockaddr_in *) &request->address)->sin_port = htons([serverPorts[i] unsignedShortValue]);
+        request->addressLength = res->ai_addrlen;
+        
+        // unused when sending: holds the server's index, the source of its candidates
+        request->slot = (uint32_t) i;
+        
+        freeaddrinfo(res);
+        numServers++;
+    }
+    
+    if (numServers == 0) return NO;
+    
+    self.udp_endpoint = [[UDPEndpoint alloc] initWithBufferSize:WCSYNCMSG_SIZE PoolSize:WCMSG_RECV_POOL_SIZE];
+    assert(self.udp_endpoint != nil);
+    
+    self.udp_endpoint.delegate = self;
+    self.udp_endpoint.receiveTimestamps = YES;
+    
+    // every server gets the request built in the send buffer
+    for (i = 0; i < numServers; i++)
+    {
+        serverRequests[i].bytes = [self.udp_endpoint getSendBuffer];
+        serverRequests[i].length = sizeof(WCSyncMessagePkt);
+    }
+    
+    [self.udp_endpoint startUnconnected];
+    
+    // on failure, -didStopWithError: has released the endpoint
+    return (self.udp_endpoint != nil);
+}
+
+
+- (NSUInteger) sourceOfDatagram:(const UDPDatagram *) datagram
+{
+    const struct sockaddr_in *from = (const struct sockaddr_in *) &datagram->address;
+    NSUInteger i;
+    
+    for (i = 0; i < numServers; i++)
+    {
+        const struct sockaddr_in *server = (const struct sockaddr_in *) &serverRequests[i].address;
+        
+        if ((from->sin_addr.s_addr == server->sin_addr.s_addr) && (from->sin_port == server->sin_port))
+            return serverRequests[i].slot;
+    }
+    return NSNotFound;
+}
+
+
+/**
+ Look up and remove a matching message for the reply
+ */
+- (BOOL) WCSyncMsgCacheLookUp: (const WCSyncMessagePkt *) reply Source:(uint32_t) source
+{
+    BOOL match;
+    int64_t originate_time;
     uint8_t lookuptype;
-    uint64_t timeout = 0; // in nanos
     
     // define lookup type i.e. type of msg we are looking for in the message cache
-    if ([reply getMessageType] == WCMSG_RESP)
+    if ((reply->message_type == WCMSG_RESP) || (reply->message_type == WCMSG_RESP_WITH_FOLLOWUP))
     {
         // if we get a response, we do a lookup for the corresponding request in the cache
         lookuptype = WCMSG_REQ;
-        timeout = ((uint64_t) [_config CachedWCREQTimeOutUSecs]) * 1000;
-    }
-    else if ([reply getMessageType] == WCMSG_RESP_WITH_FOLLOWUP)
-    {
-        lookuptype = WCMSG_REQ;
-        timeout = ((uint64_t) [_config CachedWCREQTimeOutUSecs])* 1000;
     }
-    else if ([reply getMessageType] == WCMSG_FOLLOWUP)
+    else if (reply->message_type == WCMSG_FOLLOWUP)
     {
         lookuptype = WCMSG_RESP_WITH_FOLLOWUP;
-        timeout = ((uint64_t) [_config CachedWCRESPTimeOutUSecs]) * 1000;
     }else{
-        MWLogError(@"WallClockProtocolClient: invalid msg lookup, received type = %u", [reply getMessageType]);
-        return nil;
+        MWLogError(@"WallClockProtocolClient: invalid msg lookup, received type = %u", reply->message_type);
+        return false;
     }
     
+    originate_time = ((int64_t) ntohl(reply->originate_timevalue.timevalue_secs)) * 1000000000
+                        + (int64_t) ntohl(reply->originate_timevalue.timevalue_nanos);
+    
     // get the lock on the message cache
     pthread_mutex_lock(&WCMsgCacheMutex);
     
-    now = [_wallclockRef nanoSeconds];
-    
-    // look up in cache for match
-    for (WCSyncMessage * cached_msg in wcSyncMessageCache) {
-        OriginateTimeNanos = [cached_msg getOriginateTimeNanos];
-        match = ( OriginateTimeNanos == [reply getOriginateTimeNanos]) && ([cached_msg getMessageType] == lookuptype);
-        expired = now > (OriginateTimeNanos + timeout);
-        
-        if (match && !expired)
-        {
-            temp = cached_msg;
-            break;
-        }
-    }
-    
-    if (temp !=nil){
-        // MWLogDebug(@"WCClientProtocolImpl: Cache hit: %d", temp.hash);
-        [wcSyncMessageCache removeObject:temp];
-    }
+    match = [wcSyncMessageCache removeMessageWithOriginateTime:originate_time
+                                                          Type:lookuptype
+                                                        Source:source
+                                                        AtTime:[_wallclockRef nanoSeconds]];
     
     // release the lock
     pthread_mutex_unlock(&WCMsgCacheMutex);
     
-    return temp;
+    return match;
 }
 
 
@@ -646,12 +778,14 @@
 - (void) sendWCSyncRequestPacket
 
 {
-    NSData *    data;
-    WCSyncMessage* wcmsg;
+    WCSyncMessagePkt* pkt;
+    int64_t originate_time;
     struct timeval now;
     
+    NSUInteger i;
+    
     assert(self.udp_endpoint != nil);
-    assert( ! self.udp_endpoint.isServer );
+    assert( (numServers > 0) || ! self.udp_endpoint.isServer );
     
     
     // Rate limit stuff
@@ -679,30 +813,30 @@
     }
     
     
-    // build packet using buffer in UDPComms component
-    wcmsg = [[WCSyncMessage alloc] initWithBuffer:[self.udp_endpoint getSendBuffer]];
-    
-    [[[[[wcmsg setVersion:0] setMessageType:WCMSG_REQ] setPrecision:0] setReserved:0] setMaxFreqError:0];
+    // build packet in place in the UDPComms component's send buffer
+    pkt = (WCSyncMessagePkt *)[self.udp_endpoint getSendBuffer];
+    memset(pkt, 0, sizeof(WCSyncMessagePkt));
+    pkt->message_type = WCMSG_REQ;
     
     // Originate (T1) timestamp
-    [wcmsg setOriginateTimeValue:[_wallclockRef nanoSeconds]];
-    // MWLogDebug(@"WCReq.originatetime=%llu", [wcmsg getOriginateTimeNanos]);
-    
-    // make an NSData object out of the bytes, no mem copy
-    data = [NSData dataWithBytesNoCopy:[self.udp_endpoint getSendBuffer] length:sizeof(WCSyncMessagePkt) freeWhenDone:NO];
-    assert(data != nil);
-    
-    // clone the packet and store in cache
-    wcmsg = [[WCSyncMessage alloc] initWithPacket:(WCSyncMessagePkt *)[self.udp_endpoint getSendBuffer]  AndResponseTimeNanos:0];
-    
-    // send
-    [self.udp_endpoint sendData:data];
+    originate_time = [_wallclockRef nanoSeconds];
+    setCurrentTimeValueFromClock(&(pkt->originate_timevalue), originate_time);
     
+    // send, in multi-server mode the same request to every server in one batch
+    if (numServers > 0)
+        [self.udp_endpoint sendDatagrams:serverRequests Count:numServers];
+    else
+        [self.udp_endpoint sendData:sendBufferData];
     
-    // save request msg to list, after getting the lock
+    // copy the request packet to the cache, once per server, after getting the lock
     pthread_mutex_lock(&WCMsgCacheMutex);
-    [wcSyncMessageCache addObject:wcmsg];
-    
+    for (i = 0; i < MAX(numServers, 1); i++)
+    {
+        [wcSyncMessageCache insertPacket:pkt
+                       ResponseTimeNanos:0
+                              ExpiryTime:originate_time + ((int64_t) [_config CachedWCREQTimeOutUSecs]) * 1000
+                                  Source:(numServers > 0) ? serverRequests[i].slot : 0];
+    }
     pthread_mutex_unlock(&WCMsgCacheMutex);
     
     }
@@ -712,55 +846,23 @@
  */
 - (void) refreshWCSyncMsgCache
 {
-    WCSyncMessage *wcmsg = nil;
-    BOOL expired;
-    uint64_t now = 0;
-    Candidate* candidate;
-    
-    
     pthread_mutex_lock(&WCMsgCacheMutex);
     
-    now = [_wallclockRef nanoSeconds];
-    
-    for (WCSyncMessage *wcmsg_temp in wcSyncMessageCache) {
+    [wcSyncMessageCache expireMessagesAtTime:[_wallclockRef nanoSeconds]
+                                     Handler:^(const WCSyncMessagePkt *packet, int64_t response_time, uint32_t source) {
         
-        if ([wcmsg_temp getMessageType] == WCMSG_RESP_WITH_FOLLOWUP)
-        {
-            expired = now > ([wcmsg_temp getOriginateTimeNanos] + ([_config CachedWCRESPTimeOutUSecs] * 1000));
-             if (expired)
-             {
-                 // This is the only response we have from the TV device so far since
-                 // the follow up response was not received within the timeout period
-                 // we therefore create a candidate object and enqueue it. The followup
-                 // response will be discarded as the response has already expired.
-                 MWLogDebug(@"WallClockProtocolClient: WCMSG_RESP_WITH_FOLLOWUP packet %d expired", wcmsg.hash);
-                 candidate = [[Candidate alloc] initWithResponseMsg:wcmsg_temp Quality:2 TimeIsNanos:true];
-                 if (_candidateSink!=nil)
-                     [_candidateSink enqueueCandidate:candidate];
-                 [removables pushObject:wcmsg_temp];
-             }
-        }else if ([wcmsg_temp getMessageType] == WCMSG_REQ)
-        {
-            
-            // do nothing, just drop request
-            expired = now > ([wcmsg_temp getOriginateTimeNanos] + ([_config CachedWCREQTimeOutUSecs] * 1000));
-            if (expired)
-                [removables pushObject:wcmsg_temp];
-        }
+        // expired requests are just dropped
+        if (packet->message_type != WCMSG_RESP_WITH_FOLLOWUP) return;
         
-    }
-    
-    // 
-    do{
-        wcmsg = [removables popObject];
-        if (wcmsg!=nil)
-        {
-            //MWLogDebug(@"WallClockProtocolClient: dropping stale wallclock protocol packet %d", wcmsg.hash);
-            [wcSyncMessageCache removeObject:wcmsg];
-            // free our malloc'ed memory chunk
-            free(wcmsg.packet);
-        }
-    }while (wcmsg !=nil);
+        // This is the only response we have from the TV device so far since
+        // the follow up response was not received within the timeout period
+        // we therefore create a candidate object and enqueue it. The followup
+        // response will be discarded as the response has already expired.
+        MWLogDebug(@"WallClockProtocolClient: WCMSG_RESP_WITH_FOLLOWUP packet expired");
+        Candidate *candidate = [self candidateWithPacket:packet ResponseTimeNanos:response_time Quality:2 Source:source];
+        if (_candidateSink!=nil)
+            [_candidateSink enqueueCandidate:candidate];
+    }];
    
     pthread_mutex_unlock(&WCMsgCacheMutex);
 }
@@ -801,61 +903,56 @@
 /// @name Thread functions
 ///-----------------------------------------------------------
 
-- (void) requestSenderThreadFunc
+- (void) eventLoopThreadFunc
 {
-    uint32_t default_sleep_period = [_config WCREQSendPeriodUSecs] ;
+    uint32_t default_sleep_period = [_config WCREQSendPeriodUSecs];
+    int64_t next_send_time = 0;
+    int64_t now;
+    uint32_t wait_time;
+    
+    // requests are scheduled in host time: the wall clock is stepped by the sync algorithm (possibly
+    // by hours, backwards too), and is only used to timestamp the requests themselves
+    MonotonicTime *hostTime = [[MonotonicTime alloc] init];
+    
+    MWLogInfo(@"WallClockProtocolClient: eventLoopThread has started.");
     
-    MWLogInfo(@"WallClockProtocolClient: requestSenderThread has started.");
     do{
+        now = (int64_t) [hostTime timeNanos];
         
-        // Lock the mutex.
+        // send a request when one is due, once start has been called
         pthread_mutex_lock(&mutex);
         
-        // If the predicate is already set, then the while loop is bypassed;
-        // otherwise, the thread sleeps until the predicate is set.
-        while(ready_to_go == false)
+        if (ready_to_go && (now >= next_send_time))
         {
-            pthread_cond_wait(&condition, &mutex);
+            [self sendWCSyncRequestPacket];
+            
+            // Reset the predicate.
+            if (!_running) ready_to_go = false;
+            
+            if (self.candidateSink != nil)
+                wait_time = [self.candidateSink getNextRequestWaitTime];
+            else
+                wait_time = default_sleep_period;
+            
+            next_send_time = now + ((int64_t) wait_time) * 1000;
         }
         
-        // Do work. (The mutex should stay locked.)
-        [self sendWCSyncRequestPacket];
-        
-        
-        // Reset the predicate and release the mutex.
-        if (!_running) ready_to_go = false;
+        // block until a response arrives, the next request is due or the socket timeout
+        // elapses, whichever comes first
+        wait_time = [_config SocketSelectTimeOutUSecs];
+        if (ready_to_go)
+            wait_time = (uint32_t) MAX(MIN((int64_t) wait_time, (next_send_time - now) / 1000), 0);
         
         pthread_mutex_unlock(&mutex);
         
-        
-        if (self.candidateSink != nil)
-            usleep([self.candidateSink getNextRequestWaitTime]);
-         else
-             usleep(default_sleep_period);
-        
-    }while (continue_loop);
-    
-    MWLogInfo(@"WallClockProtocolClient: requestSenderThread has exited.");
-}
-
-- (void) MsgHandlerThreadFunc
-{
-     MWLogInfo(@"WallClockProtocolClient: MsgHandlerThread has started.");
-    
-    do{
-
-       
-
-        
-        [_udp_endpoint checkForIncomingPackets:[_config SocketSelectTimeOutUSecs]];
+        // responses are timestamped by the kernel, and read in place by didReceiveDatagrams:Count:
+        [_udp_endpoint waitForIncomingPackets:wait_time];
         
         if (continue_loop) [self refreshWCSyncMsgCache];
         
-        usleep(1000);
-        
     }while(continue_loop);
     
-     MWLogInfo(@"WallClockProtocolClient: MsgHandlerThread has exited.");
+    MWLogInfo(@"WallClockProtocolClient: eventLoopThread has exited.");
     
     [_udp_endpoint stop];
     
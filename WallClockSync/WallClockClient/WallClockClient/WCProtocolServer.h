@@ -0,0 +1,113 @@
+//
+//  WCProtocolServer.h
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+#import <UDPMessaging/UDPMessaging.h>
+#import <ClockTimelines/ClockTimelines.h>
+
+
+/**
+ *  A class implementing the server-side (TV) functionality of the DVB-CSS WallClock protocol, for
+ *  serving many companion devices.
+ *
+ *  The server runs one thread with one UDPEndpoint. Darwin delivers a unicast datagram to a
+ *  single socket even when several are bound to the port, so more threads would not share the
+ *  load. Throughput comes from batching instead: requests are read in batches, in place in the
+ *  endpoint's receive buffer pool, and the responses to a batch are sent together. The
+ *  receive_timevalue of a response is the kernel's receive timestamp of the request; the
+ *  transmit_timevalue is read from the wall clock just before the response is sent. With
+ *  followUp set, responses are sent as WCMSG_RESP_WITH_FOLLOWUP and each is followed by a
+ *  WCMSG_FOLLOWUP carrying the time at which the response left the socket.
+ */
+@interface WCProtocolServer : NSObject
+
+/**
+ *  Port the server listens on
+ */
+@property (nonatomic, assign, readonly) NSUInteger          port;
+
+/**
+ *  The wall clock that timestamps are read from
+ */
+@property (nonatomic, strong, readonly) ClockBase*          wallclockRef;
+
+/**
+ *  Send responses as WCMSG_RESP_WITH_FOLLOWUP followed by a WCMSG_FOLLOWUP with the precise
+ *  transmit time. Set before starting the server. Defaults to NO.
+ */
+@property (nonatomic, assign, readwrite) BOOL               followUp;
+
+/**
+ *  Precision of the wall clock, as a power of two in seconds, reported in responses. Defaults
+ *  to the measured precision of the wall clock.
+ */
+@property (nonatomic, assign, readwrite) int8_t             precision;
+
+/**
+ *  Maximum frequency error of the wall clock, in 1/256 ppm, reported in responses. Defaults to
+ *  the configured server frequency error.
+ */
+@property (nonatomic, assign, readwrite) uint32_t           maxFreqError;
+
+/**
+ *  Running status of the server
+ */
+@property (atomic, readonly, getter = isRunning) BOOL       running;
+
+/**
+ *  Number of requests answered since the server was started
+ */
+@property (nonatomic, readonly) uint64_t                    requestsServed;
+
+/**
+ *  Number of packets discarded since the server was started: malformed requests, and requests
+ *  dropped because the receive buffers were all in use
+ */
+@property (nonatomic, readonly) uint64_t                    requestsDropped;
+
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Initialise a WallClock protocol server
+ *
+ *  @param port  - port to listen on
+ *  @param clock - the wall clock to serve, e.g. the local WallClock instance
+ *
+ *  @return a WCProtocolServer instance
+ */
+- (id) initWithPort:(NSUInteger) port WallClock:(ClockBase*) clock;
+
+
+/**
+ *  Bind the server's socket and start serving requests
+ *
+ *  @return YES if the socket was bound to the port
+ */
+- (BOOL) start;
+
+
+/**
+ *  Stop serving requests. Returns once the server thread has exited.
+ */
+- (void) stop;
+
+@end
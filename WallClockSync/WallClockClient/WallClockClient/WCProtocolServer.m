@@ -0,0 +1,329 @@
+//
+//  WCProtocolServer.m
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "WCProtocolServer.h"
+#import "WCSyncMessage.h"
+
+#import <SyncKitConfiguration/SyncKitConfiguration.h>
+#import <SimpleLogger/SimpleLogger.h>
+#import <arpa/inet.h>
+#import <stdatomic.h>
+#import <math.h>
+
+
+// receive buffers of the server socket; also the largest batch of requests handled at once
+#define WCSERVER_POOL_SIZE 64
+
+// longest the server thread blocks before checking whether it should stop
+#define WCSERVER_WAIT_USECS 100000
+
+#define WCSERVER_THREAD_NAME @"WallClockServerThread"
+
+
+/**
+ *  The server thread and its socket
+ */
+@interface WCServerThread : NSObject <UDPCommsDelegate>
+
+@property (nonatomic, strong, readonly) UDPEndpoint *endpoint;
+
+- (id) initWithServer:(WCProtocolServer*) server;
+- (BOOL) startOnPort:(NSUInteger) port;
+- (void) stop;
+- (uint64_t) served;
+- (uint64_t) dropped;
+
+@end
+
+
+@implementation WCServerThread
+{
+    __weak WCProtocolServer *server;
+    ClockBase               *clock;
+    BOOL                    followUp;
+    uint8_t                 precision;
+    uint32_t                maxFreqError;
+
+    atomic_bool             running;
+    dispatch_semaphore_t    exited;
+
+    atomic_uint_fast64_t    served;
+    atomic_uint_fast64_t    malformed;
+
+    // responses and follow-ups of the batch being handled
+    WCSyncMessagePkt        responses[WCSERVER_POOL_SIZE];
+    WCSyncMessagePkt        followUps[WCSERVER_POOL_SIZE];
+    UDPDatagram             out[WCSERVER_POOL_SIZE];
+}
+
+
+- (id) initWithServer:(WCProtocolServer*) wc_server
+{
+    self = [super init];
+    if (self != nil) {
+        server = wc_server;
+        clock = wc_server.wallclockRef;
+
+        _endpoint = [[UDPEndpoint alloc] initWithBufferSize:WCSYNCMSG_SIZE PoolSize:WCSERVER_POOL_SIZE];
+        if (_endpoint == nil) return nil;
+
+        // no -didStartWithAddress:, so the endpoint starts no listener thread of its own
+        _endpoint.delegate = self;
+        _endpoint.receiveTimestamps = YES;
+
+        atomic_init(&running, false);
+        atomic_init(&served, 0);
+        atomic_init(&malformed, 0);
+        exited = dispatch_semaphore_create(0);
+    }
+    return self;
+}
+
+
+- (BOOL) startOnPort:(NSUInteger) port
+{
+    WCProtocolServer *wc_server = server;
+
+    // response fields that do not change while the server runs
+    followUp = wc_server.followUp;
+    precision = (uint8_t) wc_server.precision;
+    maxFreqError = htonl(wc_server.maxFreqError);
+
+    [_endpoint startServerOnPort:port];
+    if (_endpoint.port == 0) return NO;
+
+    atomic_store(&running, true);
+    [NSThread detachNewThreadSelector:@selector(threadFunc) toTarget:self withObject:nil];
+
+    return YES;
+}
+
+
+- (void) stop
+{
+    if (!atomic_exchange(&running, false)) return;
+
+    [_endpoint wakeUp];
+    dispatch_semaphore_wait(exited, DISPATCH_TIME_FOREVER);
+
+    [_endpoint stop];
+}
+
+
+- (uint64_t) served
+{
+    return atomic_load_explicit(&served, memory_order_relaxed);
+}
+
+
+- (uint64_t) dropped
+{
+    return atomic_load_explicit(&malformed, memory_order_relaxed) + _endpoint.droppedDatagrams;
+}
+
+
+- (void) threadFunc
+{
+    [[NSThread currentThread] setName:WCSERVER_THREAD_NAME];
+
+    MWLogInfo(@"WallClockProtocolServer: thread started on port %lu", (unsigned long) _endpoint.port);
+
+    while (atomic_load_explicit(&running, memory_order_relaxed))
+        [_endpoint waitForIncomingPackets:WCSERVER_WAIT_USECS];
+
+    MWLogInfo(@"WallClockProtocolServer: thread exited.");
+
+    dispatch_semaphore_signal(exited);
+}
+
+
+///-----------------------------------------------------------
+/// @name UDPCommsDelegate methods
+///-----------------------------------------------------------
+/**
+ Requests are read in place, in batches. Each is answered from a response built in the response
+ array; the request buffers go back to the endpoint before the responses are sent.
+ */
+- (void) didReceiveDatagrams:(const UDPDatagram * const *)datagrams Count:(NSUInteger) count
+{
+    NSUInteger i, n = 0;
+    int64_t now;
+
+    assert(count <= WCSERVER_POOL_SIZE);
+
+    for (i = 0; i < count; i++)
+    {
+        const UDPDatagram *datagram = datagrams[i];
+        const WCSyncMessagePkt *request = (const WCSyncMessagePkt *) datagram->bytes;
+        WCSyncMessagePkt *response = &responses[n];
+
+        if ((datagram->length < WCSYNCMSG_SIZE) || (request->version != 0) || (request->message_type != WCMSG_REQ))
+        {
+            atomic_fetch_add_explicit(&malformed, 1, memory_order_relaxed);
+            [_endpoint releaseDatagram:datagram];
+            continue;
+        }
+
+        response->version = 0;
+        response->message_type = followUp ? WCMSG_RESP_WITH_FOLLOWUP : WCMSG_RESP;
+        response->precision = precision;
+        response->reserved = 0;
+        response->max_freq_error = maxFreqError;
+        response->originate_timevalue = request->originate_timevalue;
+
+        // the kernel's receive timestamp, in the wall clock's timescale
+        setCurrentTimeValueFromClock(&response->receive_timevalue,
+                                     [clock ticksToNanoSeconds:[clock ticksAtHostTime:datagram->hostTime]]);
+
+        out[n].bytes = (const uint8_t *) response;
+        out[n].length = WCSYNCMSG_SIZE;
+        memcpy(&out[n].address, &datagram->address, datagram->addressLength);
+        out[n].addressLength = datagram->addressLength;
+        n++;
+
+        [_endpoint releaseDatagram:datagram];
+    }
+
+    if (n == 0) return;
+
+    if (!followUp)
+    {
+        // one timestamp for the batch, taken just before it is sent
+        now = [clock nanoSeconds];
+        for (i = 0; i < n; i++)
+            setCurrentTimeValueFromClock(&responses[i].transmit_timevalue, now);
+
+        n = [_endpoint sendDatagrams:out Count:n];
+    }
+    else
+    {
+        // responses go out one by one, so that each follow-up carries the time its own
+        // response left the socket; the follow-ups are then sent together
+        for (i = 0; i < n; i++)
+        {
+            setCurrentTimeValueFromClock(&responses[i].transmit_timevalue, [clock nanoSeconds]);
+            if ([_endpoint sendDatagrams:&out[i] Count:1] == 0) break;
+
+            followUps[i] = responses[i];
+            followUps[i].message_type = WCMSG_FOLLOWUP;
+            setCurrentTimeValueFromClock(&followUps[i].transmit_timevalue, [clock nanoSeconds]);
+            out[i].bytes = (const uint8_t *) &followUps[i];
+        }
+        [_endpoint sendDatagrams:out Count:i];
+        n = i;
+    }
+
+    atomic_fetch_add_explicit(&served, n, memory_order_relaxed);
+}
+
+@end
+
+
+
+@implementation WCProtocolServer
+{
+    WCServerThread  *serverThread;
+}
+
+
+#pragma mark Initialisation routines
+///-----------------------------------------------------------
+/// @name Initialiser methods
+///-----------------------------------------------------------
+
+- (id) initWithPort:(NSUInteger) port WallClock:(ClockBase*) clock
+{
+    assert( (port > 0) && (port < 65536) );
+    assert(clock != nil);
+
+    self = [super init];
+    if (self != nil) {
+        double clock_precision = [clock estimatePrecision:100];
+
+        _port = port;
+        _wallclockRef = clock;
+        _followUp = NO;
+        _running = NO;
+
+        // smallest power of two (in seconds) not below the clock's measured precision
+        _precision = (int8_t) MAX(ceil(log2(MAX(clock_precision, 1e-9))), -128);
+        _maxFreqError = [[SyncKitGlobals getInstance] ServerWCFrequencyError] * 256;
+    }
+    return self;
+}
+
+
+- (void) dealloc
+{
+    [self stop];
+}
+
+
+#pragma mark public methods
+///-----------------------------------------------------------
+/// @name Public methods
+///-----------------------------------------------------------
+
+- (BOOL) start
+{
+    WCServerThread *thread;
+
+    if (_running) return YES;
+
+    thread = [[WCServerThread alloc] initWithServer:self];
+    if ((thread == nil) || ![thread startOnPort:_port])
+    {
+        MWLogError(@"WallClockProtocolServer: could not start server on port %lu", (unsigned long) _port);
+        return NO;
+    }
+
+    serverThread = thread;
+    _running = YES;
+
+    MWLogInfo(@"WallClockProtocolServer: serving on port %lu", (unsigned long) _port);
+
+    return YES;
+}
+
+
+- (void) stop
+{
+    if (!_running) return;
+
+    [serverThread stop];
+    _running = NO;
+
+    MWLogInfo(@"WallClockProtocolServer: stopped after serving %llu requests", self.requestsServed);
+}
+
+
+- (uint64_t) requestsServed
+{
+    return [serverThread served];
+}
+
+
+- (uint64_t) requestsDropped
+{
+    return [serverThread dropped];
+}
+
+@end
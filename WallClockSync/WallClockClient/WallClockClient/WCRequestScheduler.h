@@ -0,0 +1,89 @@
+//
+//  WCRequestScheduler.h
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+#import <ClockTimelines/ClockTimelines.h>
+#import "Candidate.h"
+
+
+/**
+ *  Schedules WC requests from the growth of the wallclock's dispersion, using a queue of
+ *  SendPolicy objects.
+ *
+ *  After each processed candidate, the algorithm reports the best candidate and the current
+ *  dispersion. While the dispersion is comfortably inside the accuracy target, the wait between
+ *  requests doubles (up to the `WCREQMaxSendPeriodUSecs` setting), but never beyond the best
+ *  candidate's expiration time. When the dispersion nears the target or the best candidate
+ *  expires, a burst of closely-spaced requests is queued and the back-off is reset.
+ *
+ *  The scheduler also measures the request rate and the dispersion it achieves.
+ */
+@interface WCRequestScheduler : NSObject
+
+/**
+ *  Request rate, in requests per second, smoothed over recent requests
+ */
+@property (nonatomic, readonly) double requestsPerSecond;
+
+/**
+ *  Dispersion achieved, in nanoseconds, smoothed over recent candidates
+ */
+@property (nonatomic, readonly) int64_t achievedDispersion;
+
+/**
+ *  Largest dispersion reported since the scheduler started, in nanoseconds
+ */
+@property (nonatomic, readonly) int64_t maxDispersion;
+
+
+- (instancetype)init NS_UNAVAILABLE;
+
+
+/**
+ *  Initialise a scheduler. Accuracy target and maximum wait are read from SyncKitGlobals.
+ *
+ *  @param clock - clock used to timestamp requests, for the request rate
+ *
+ *  @return WCRequestScheduler instance
+ */
+- (id)initWithClock:(ClockBase*) clock;
+
+
+/**
+ *  Decide the next send policy after a candidate was processed.
+ *
+ *  @param best_candidate - the algorithm's current best candidate
+ *  @param dispersion     - dispersion of the wallclock now, in nanoseconds
+ *  @param now            - current time of the clock that timestamps candidates, in nanoseconds
+ */
+- (void) updateWithBestCandidate:(Candidate*) best_candidate
+                      Dispersion:(int64_t) dispersion
+                          AtTime:(int64_t) now;
+
+
+/**
+ *  Wait time before the next WC request. Each call counts as one request sent.
+ *
+ *  @return wait time in microseconds
+ */
+- (uint32_t) nextReqWaitTime;
+
+@end
@@ -0,0 +1,216 @@
+//
+//  WCRequestScheduler.m
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <pthread.h>
+#import "WCRequestScheduler.h"
+#import "SendPolicy.h"
+#import <SyncKitConfiguration/SyncKitConfiguration.h>
+#import <SyncKitCollections/SyncKitCollections.h>
+#import <SimpleLogger/SimpleLogger.h>
+
+
+// bootstrap: send WC requests at 100ms for 2 secs
+static const int        kBootstrapCount         = 20;
+static const uint32_t   kBurstWaitUSecs         = 100000;
+
+// requests in a burst, once accuracy degrades
+static const int        kBurstCount             = 5;
+
+// dispersion below this fraction of the target is comfortable (back off); above the
+// degraded fraction, burst
+static const double     kComfortableFraction    = 0.5;
+static const double     kDegradedFraction       = 0.9;
+
+// weight of the newest value in the smoothed metrics
+static const double     kMetricsWeight          = 0.125;
+
+
+@implementation WCRequestScheduler
+{
+    ClockBase               *timer;
+    int64_t                 target_accuracy_nanos; // max tolerable dispersion
+    uint32_t                max_wait_usecs;
+    uint32_t                backoff_usecs;         // wait time while accuracy is comfortable
+    Queue*                  wcSendPolicyList;
+    SendPolicy*             currentPolicy;
+    BOOL                    bursting;
+    pthread_mutex_t         current_policy_mutex;
+
+    int64_t                 last_request_time;
+    double                  mean_interval_nanos;
+    double                  mean_dispersion;
+}
+
+
+#pragma mark initialisation and deallocation routines
+
+- (id)initWithClock:(ClockBase*) clock
+{
+    self = [super init];
+    if (self != nil) {
+        SyncKitGlobals *devinfo = [SyncKitGlobals getInstance];
+
+        timer = clock;
+        assert(timer != nil);
+        target_accuracy_nanos = ((int64_t) [devinfo SyncAccuracyTargetMilliSecs]) * 1000000;
+        max_wait_usecs = MAX([devinfo WCREQMaxSendPeriodUSecs], kBurstWaitUSecs);
+        backoff_usecs = kBurstWaitUSecs;
+        wcSendPolicyList = [[Queue alloc] init];
+        currentPolicy = nil;
+        pthread_mutex_init(&current_policy_mutex, NULL);
+
+        last_request_time = -1;
+        mean_interval_nanos = 0;
+        mean_dispersion = 0;
+        _maxDispersion = 0;
+
+        // bootstrapping
+        [wcSendPolicyList put:[[SendPolicy alloc] init:kBootstrapCount WaitTimeUSeconds:kBurstWaitUSecs]];
+        bursting = YES;
+    }
+    return self;
+}
+
+
+- (void)dealloc
+{
+    timer = nil;
+    wcSendPolicyList = nil;
+    currentPolicy = nil;
+    pthread_mutex_destroy(&current_policy_mutex);
+}
+
+
+#pragma mark scheduling
+
+- (void) updateWithBestCandidate:(Candidate*) best_candidate
+                      Dispersion:(int64_t) dispersion
+                          AtTime:(int64_t) now
+{
+    if (best_candidate == nil) return;
+
+    pthread_mutex_lock(&current_policy_mutex);
+
+    mean_dispersion = (mean_dispersion == 0) ? dispersion
+                        : mean_dispersion + kMetricsWeight * (dispersion - mean_dispersion);
+    _achievedDispersion = (int64_t) mean_dispersion;
+    _maxDispersion = MAX(_maxDispersion, dispersion);
+
+    // a burst or the bootstrap is ongoing; let it run its course
+    if (bursting)
+    {
+        pthread_mutex_unlock(&current_policy_mutex);
+        return;
+    }
+
+    int64_t best_cand_exp_time = [best_candidate getCandidateExpirationTime:target_accuracy_nanos];
+
+    if ((now >= best_cand_exp_time) || (dispersion > kDegradedFraction * target_accuracy_nanos))
+    {
+        // accuracy has degraded: drop pending policies and burst
+        while ([wcSendPolicyList take] != nil);
+        currentPolicy = nil;
+        [wcSendPolicyList put:[[SendPolicy alloc] init:kBurstCount WaitTimeUSeconds:kBurstWaitUSecs]];
+        backoff_usecs = kBurstWaitUSecs;
+        bursting = YES;
+    }
+    else
+    {
+        if (dispersion < kComfortableFraction * target_accuracy_nanos)
+            backoff_usecs = MIN(backoff_usecs * 2, max_wait_usecs);
+
+        // send again before the best candidate expires
+        int64_t time_left_usecs = (best_cand_exp_time - now) / 1000;
+        uint32_t wait_time = (uint32_t) MAX(MIN((int64_t) backoff_usecs, time_left_usecs), kBurstWaitUSecs);
+
+        // the newest decision replaces any that has not been used yet
+        while ([wcSendPolicyList take] != nil);
+        [wcSendPolicyList put:[[SendPolicy alloc] init:1 WaitTimeUSeconds:wait_time]];
+    }
+
+    pthread_mutex_unlock(&current_policy_mutex);
+}
+
+
+- (uint32_t) nextReqWaitTime
+{
+    uint32_t wait_time;
+
+    pthread_mutex_lock(&current_policy_mutex);
+
+    [self recordRequest];
+
+    if (currentPolicy == nil)
+        currentPolicy = [wcSendPolicyList take];
+
+    if ((currentPolicy != nil) && (currentPolicy.count > 0))
+    {
+        currentPolicy.count--;
+        wait_time = currentPolicy.waitTimeUSecs;
+
+        // policy has expired (which ends a burst), get a new one next time
+        if (currentPolicy.count == 0) {
+            currentPolicy = nil;
+            bursting = NO;
+        }
+    }
+    else
+    {
+        currentPolicy = nil;
+        bursting = NO;
+        wait_time = backoff_usecs;
+    }
+
+    pthread_mutex_unlock(&current_policy_mutex);
+
+    return wait_time;
+}
+
+
+#pragma mark metrics
+
+- (double) requestsPerSecond
+{
+    double rate;
+
+    pthread_mutex_lock(&current_policy_mutex);
+    rate = (mean_interval_nanos > 0) ? 1.0e9 / mean_interval_nanos : 0.0;
+    pthread_mutex_unlock(&current_policy_mutex);
+
+    return rate;
+}
+
+
+- (void) recordRequest
+{
+    int64_t now = [timer nanoSeconds];
+
+    if (last_request_time >= 0)
+    {
+        double interval = (double) (now - last_request_time);
+
+        mean_interval_nanos = (mean_interval_nanos == 0) ? interval
+                                : mean_interval_nanos + kMetricsWeight * (interval - mean_interval_nanos);
+    }
+    last_request_time = now;
+}
+
+@end
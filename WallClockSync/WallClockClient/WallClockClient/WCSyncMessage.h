@@ -59,6 +59,15 @@ typedef struct __attribute__((packed)){
 #define WCMSG_FOLLOWUP              3
 
 
+/**
+ *  Set a packet time value from a time in nanoseconds
+ *
+ *  @param tv   - time value field of a WCSyncMessagePkt
+ *  @param time - time in nanoseconds
+ */
+void setCurrentTimeValueFromClock(WCTimeValue* tv, int64_t time);
+
+
 
 /**
  A class that provides helper functions to build and parse Wall Clock protocol request/response
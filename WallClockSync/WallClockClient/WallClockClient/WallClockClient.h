@@ -35,5 +35,14 @@ FOUNDATION_EXPORT const unsigned char WallClockClientVersionString[];
 #import <WallClockClient/IWCAlgo.h>
 #import <WallClockClient/LowestDispersionFilter.h>
 #import <WallClockClient/RTTThresholdFilter.h>
+#import <WallClockClient/IBatchFilter.h>
+#import <WallClockClient/CandidateFilterChain.h>
+#import <WallClockClient/WindowedCandidateFilter.h>
+#import <WallClockClient/RTTPercentileFilter.h>
+#import <WallClockClient/OffsetOutlierFilter.h>
+#import <WallClockClient/AsymmetryFilter.h>
+#import <WallClockClient/QualityScoreFilter.h>
 #import <WallClockClient/LowestDispersionAlgorithm.h>
-#import <WallClockClient/WallClockSynchroniser.h>
\ No newline at end of file
+#import <WallClockClient/LinearRegressionAlgorithm.h>
+#import <WallClockClient/WallClockSynchroniser.h>
+#import <WallClockClient/WCProtocolServer.h>
\ No newline at end of file
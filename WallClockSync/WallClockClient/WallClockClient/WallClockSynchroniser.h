@@ -156,6 +156,23 @@
 - (float) getUsefulCandidatesPercent;
 
 
+/**
+ *  Get the rate at which WC requests are being sent, if the algorithm reports it.
+ *
+ *  @return requests per second, or -1 if not reported
+ */
+- (double) getRequestsPerSecond;
+
+
+/**
+ *  Get the dispersion achieved by the algorithm, smoothed over recent candidates, if the
+ *  algorithm reports it.
+ *
+ *  @return dispersion in nanoseconds, or -1 if not reported
+ */
+- (int64_t) getAchievedDispersion;
+
+
 /**
  *  Get the current dispersion of the best candidate.
  *
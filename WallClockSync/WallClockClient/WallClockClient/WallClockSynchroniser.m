@@ -203,6 +203,34 @@
 }
 
 
+/**
+ *  Get the rate at which WC requests are being sent
+ *
+ *  @return requests per second
+ */
+- (double) getRequestsPerSecond
+{
+    if ([self.algorithm respondsToSelector:@selector(requestsPerSecond)]) {
+        return [self.algorithm requestsPerSecond];
+    }else
+        return -1;
+}
+
+
+/**
+ *  Get the dispersion achieved by the algorithm
+ *
+ *  @return dispersion in nanoseconds
+ */
+- (int64_t) getAchievedDispersion
+{
+    if ([self.algorithm respondsToSelector:@selector(achievedDispersion)]) {
+        return [self.algorithm achievedDispersion];
+    }else
+        return -1;
+}
+
+
 /**
  *  Get the current dispersion of the best candidate.
  *
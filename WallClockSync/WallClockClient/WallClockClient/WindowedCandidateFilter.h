@@ -0,0 +1,81 @@
+//
+//  WindowedCandidateFilter.h
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <Foundation/Foundation.h>
+#import "IBatchFilter.h"
+
+/**
+ *  Base class for batch filters that judge candidates against a window of recent samples, e.g.
+ *  round trip times or offsets.
+ *
+ *  Whatever a batch is judged by (a percentile, a median) is taken once for the batch, from the
+ *  samples before it; the batch's samples are then added to the window, whether its candidates
+ *  pass or not. Until the window holds a few samples, every candidate passes.
+ *
+ *  Offsets are compared as offsets from the wallclock's parent clock, which the CandidateSink
+ *  works out for each batch (see CandidateFilterChain loadBatch:WithCandidates:Count:ParentSkew:).
+ *  A filter that compares offsets can therefore only be run on batches: its checkCandidate:
+ *  raises an exception.
+ *
+ *  Subclasses implement filterBatch:, and call countBatch:Kept: from it.
+ */
+@interface WindowedCandidateFilter : NSObject <IBatchFilter>
+
+/**
+ *  Number of recent samples the filter keeps
+ */
+@property (nonatomic, readonly) NSUInteger window;
+
+/**
+ *  Whether the filter compares candidates' offsets. Subclasses that do override this to return YES.
+ */
+@property (nonatomic, readonly) BOOL comparesOffsets;
+
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Initialise the filter. For use by subclasses.
+ *
+ *  @param window - number of recent samples to keep (at least one)
+ *
+ *  @return initialised instance
+ */
+- (id) initWithWindow:(NSUInteger) window;
+
+/**
+ *  Whether the window holds enough samples for the filter to reject candidates. For use by
+ *  subclasses.
+ *
+ *  @param samples - number of samples in the window
+ */
+- (BOOL) isJudging:(NSUInteger) samples;
+
+/**
+ *  Count the candidates a batch was filtered down from and the ones that passed. For use by
+ *  subclasses.
+ *
+ *  @param live - candidates in the batch before the filter ran
+ *  @param kept - candidates that passed
+ */
+- (void) countBatch:(NSUInteger) live Kept:(NSUInteger) kept;
+
+@end
@@ -0,0 +1,110 @@
+//
+//  WindowedCandidateFilter.m
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import "WindowedCandidateFilter.h"
+#import "CandidateFilterChain.h"
+#import <stdatomic.h>
+
+// samples needed before a filter rejects anything
+#define WINDOWED_FILTER_MIN_SAMPLES 8
+
+
+@implementation WindowedCandidateFilter
+{
+    atomic_uint_fast64_t    drop_count;
+    atomic_uint_fast64_t    count;
+}
+
+
+- (id) initWithWindow:(NSUInteger) window
+{
+    self = [super init];
+    if (self != nil) {
+        _window = MAX(window, 1);
+        atomic_init(&drop_count, 0);
+        atomic_init(&count, 0);
+    }
+    return self;
+}
+
+
+- (BOOL) comparesOffsets
+{
+    return NO;
+}
+
+
+- (BOOL) isJudging:(NSUInteger) samples
+{
+    return (samples >= MIN(WINDOWED_FILTER_MIN_SAMPLES, _window));
+}
+
+
+- (void) countBatch:(NSUInteger) live Kept:(NSUInteger) kept
+{
+    atomic_fetch_add_explicit(&count, live, memory_order_relaxed);
+    atomic_fetch_add_explicit(&drop_count, live - kept, memory_order_relaxed);
+}
+
+
+- (void) filterBatch:(CandidateBatch*) batch
+{
+    [self doesNotRecognizeSelector:_cmd];
+}
+
+
+- (BOOL) checkCandidate:(Candidate*) candidate
+{
+    __unsafe_unretained Candidate *candidates[1] = { candidate };
+    CandidateBatch batch;
+
+    if (!candidate) return false;
+
+    // without the wallclock, this candidate's offset cannot be put in the same frame as the
+    // offsets the filter has seen in batches
+    if (self.comparesOffsets)
+    {
+        NSException *e = [NSException
+                          exceptionWithName:@"BatchOnlyFilter"
+                          reason:@"filter compares offsets from the wallclock's parent clock; use it in a CandidateSink"
+                          userInfo:nil];
+        @throw e;
+    }
+
+    [CandidateFilterChain loadBatch:&batch WithCandidates:candidates Count:1 ParentSkew:0];
+    [self filterBatch:&batch];
+
+    return (batch.live == 1);
+}
+
+
+- (uint64_t) getCandidateDropCount
+{
+    return atomic_load_explicit(&drop_count, memory_order_relaxed);
+}
+
+
+- (uint64_t) getCandidateTotal
+{
+    return atomic_load_explicit(&count, memory_order_relaxed);
+}
+
+@end
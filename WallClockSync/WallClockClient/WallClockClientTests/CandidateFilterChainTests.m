@@ -0,0 +1,208 @@
+//
+//  CandidateFilterChainTests.m
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+#import "WCSyncMessage.h"
+#import "Candidate.h"
+#import "CandidateFilterChain.h"
+#import "RTTThresholdFilter.h"
+#import "RTTPercentileFilter.h"
+#import "OffsetOutlierFilter.h"
+#import "AsymmetryFilter.h"
+#import "QualityScoreFilter.h"
+
+static const int64_t kMillis = 1000000;
+
+
+/**
+ *  A filter without batch support, that passes everything and records what it was shown
+ */
+@interface RecordingFilter : NSObject <IFilter>
+
+@property (nonatomic, readonly) NSMutableArray<Candidate *> *seen;
+
+@end
+
+@implementation RecordingFilter
+
+- (id) init
+{
+    self = [super init];
+    if (self != nil) _seen = [NSMutableArray array];
+    return self;
+}
+
+- (BOOL) checkCandidate:(Candidate*) candidate
+{
+    [_seen addObject:candidate];
+    return YES;
+}
+
+- (uint64_t) getCandidateDropCount { return 0; }
+- (uint64_t) getCandidateTotal { return _seen.count; }
+
+@end
+
+
+
+@interface CandidateFilterChainTests : XCTestCase
+
+@end
+
+@implementation CandidateFilterChainTests
+
+/**
+ *  A candidate with the given round trip time, whose server clock is offset_nanos ahead
+ */
+- (Candidate*) candidateWithOffset:(int64_t) offset_nanos RTT:(int64_t) rtt_nanos Quality:(int8_t) quality
+{
+    WCSyncMessagePkt pkt;
+    int64_t t1 = 1000 * kMillis;
+
+    memset(&pkt, 0, sizeof(pkt));
+    pkt.message_type = WCMSG_RESP;
+    pkt.precision = (uint8_t) -20;
+    setCurrentTimeValueFromClock(&pkt.originate_timevalue, t1);
+    setCurrentTimeValueFromClock(&pkt.receive_timevalue, t1 + rtt_nanos / 2 + offset_nanos);
+    setCurrentTimeValueFromClock(&pkt.transmit_timevalue, t1 + rtt_nanos / 2 + offset_nanos);
+
+    return [[Candidate alloc] initWithPacket:&pkt ResponseTimeNanos:t1 + rtt_nanos Quality:quality TimeIsNanos:YES];
+}
+
+
+- (Candidate*) candidateWithOffset:(int64_t) offset_nanos RTT:(int64_t) rtt_nanos
+{
+    return [self candidateWithOffset:offset_nanos RTT:rtt_nanos Quality:3];
+}
+
+
+/**
+ *  Run candidates through a chain as one batch, and return the survivors
+ */
+- (NSArray<Candidate *> *) filter:(NSArray<Candidate *> *) candidates With:(CandidateFilterChain*) chain
+{
+    __unsafe_unretained Candidate *array[CANDIDATE_BATCH_MAX];
+    NSMutableArray<Candidate *> *passed = [NSMutableArray array];
+    CandidateBatch batch;
+    NSUInteger i;
+
+    for (i = 0; i < candidates.count; i++) array[i] = candidates[i];
+
+    [CandidateFilterChain loadBatch:&batch WithCandidates:array Count:candidates.count ParentSkew:0];
+    [chain filterBatch:&batch];
+
+    for (i = 0; i < batch.live; i++) [passed addObject:candidates[batch.selected[i]]];
+
+    return passed;
+}
+
+
+- (void)testLaterFiltersSeeOnlySurvivors {
+    RTTThresholdFilter *rtt_filter = [[RTTThresholdFilter alloc] initWithThreshold:10];
+    RecordingFilter *recorder = [[RecordingFilter alloc] init];
+    CandidateFilterChain *chain = [[CandidateFilterChain alloc] initWithFilters:@[ rtt_filter, recorder ]];
+
+    Candidate *fast = [self candidateWithOffset:0 RTT:2 * kMillis];
+    Candidate *slow = [self candidateWithOffset:0 RTT:50 * kMillis];
+    Candidate *fast2 = [self candidateWithOffset:0 RTT:5 * kMillis];
+
+    NSArray *passed = [self filter:@[ fast, slow, fast2 ] With:chain];
+
+    XCTAssertEqualObjects(passed, (@[ fast, fast2 ]), @"survivors in arrival order");
+    XCTAssertEqualObjects(recorder.seen, (@[ fast, fast2 ]));
+    XCTAssertEqualObjects([chain rejectionCounts], (@[ @1, @0 ]));
+    XCTAssertEqual([rtt_filter getCandidateDropCount], 1);
+    XCTAssertEqual([rtt_filter getCandidateTotal], 3);
+
+    // nothing left after the first filter: the second is not run
+    [self filter:@[ slow ] With:chain];
+    XCTAssertEqual(recorder.seen.count, 2);
+    XCTAssertEqualObjects([chain rejectionCounts], (@[ @2, @0 ]));
+}
+
+
+- (void)testRTTPercentile {
+    RTTPercentileFilter *filter = [[RTTPercentileFilter alloc] initWithPercentile:0.9 Window:20];
+    CandidateFilterChain *chain = [[CandidateFilterChain alloc] initWithFilters:@[ filter ]];
+    NSMutableArray *history = [NSMutableArray array];
+    int64_t i;
+
+    for (i = 1; i <= 20; i++) [history addObject:[self candidateWithOffset:0 RTT:i * kMillis]];
+    XCTAssertEqual([self filter:history With:chain].count, 20, @"all pass until the window fills");
+
+    Candidate *slow = [self candidateWithOffset:0 RTT:19 * kMillis];
+    Candidate *fast = [self candidateWithOffset:0 RTT:2 * kMillis];
+
+    XCTAssertEqualObjects([self filter:@[ slow, fast ] With:chain], (@[ fast ]));
+
+    // round trip times need no wallclock, so a candidate can be checked on its own
+    XCTAssertFalse([filter checkCandidate:[self candidateWithOffset:0 RTT:40 * kMillis]]);
+    XCTAssertTrue([filter checkCandidate:fast]);
+}
+
+
+- (void)testOffsetOutlier {
+    OffsetOutlierFilter *filter = [[OffsetOutlierFilter alloc] initWithThreshold:3 Window:16];
+    CandidateFilterChain *chain = [[CandidateFilterChain alloc] initWithFilters:@[ filter ]];
+    NSMutableArray *history = [NSMutableArray array];
+    int64_t i;
+
+    filter.minimumDeviationNanos = 0;
+
+    for (i = 0; i < 16; i++)
+        [history addObject:[self candidateWithOffset:((i % 5) - 2) * 100000 RTT:2 * kMillis]];
+    [self filter:history With:chain];
+
+    Candidate *outlier = [self candidateWithOffset:20 * kMillis RTT:2 * kMillis];
+    Candidate *inlier = [self candidateWithOffset:150000 RTT:2 * kMillis];
+
+    XCTAssertEqualObjects([self filter:@[ outlier, inlier ] With:chain], (@[ inlier ]));
+    XCTAssertEqual([filter getCandidateDropCount], 1);
+
+    // an offset on its own cannot be put in the frame of the parent clock
+    XCTAssertThrows([filter checkCandidate:inlier]);
+    XCTAssertEqual([filter getCandidateTotal], 18);
+}
+
+
+- (void)testAsymmetry {
+    AsymmetryFilter *filter = [[AsymmetryFilter alloc] initWithMaxAsymmetry:0.8 Window:16];
+    CandidateFilterChain *chain = [[CandidateFilterChain alloc] initWithFilters:@[ filter ]];
+    NSMutableArray *history = [NSMutableArray array];
+    int64_t i;
+
+    for (i = 0; i < 16; i++)
+        [history addObject:[self candidateWithOffset:5 * kMillis + (i % 3) * 10000 RTT:2 * kMillis]];
+    [self filter:history With:chain];
+
+    // 1.5ms off the median with a 2ms round trip: one way took 1.75ms of it
+    Candidate *lopsided = [self candidateWithOffset:5 * kMillis + 1500000 RTT:2 * kMillis];
+    // the same deviation over a 10ms round trip is unremarkable
+    Candidate *slow = [self candidateWithOffset:5 * kMillis + 1500000 RTT:10 * kMillis];
+
+    XCTAssertEqualObjects([self filter:@[ lopsided, slow ] With:chain], (@[ slow ]));
+}
+
+
+- (void)testQualityScore {
+    QualityScoreFilter *filter = [[QualityScoreFilter alloc] initWithMinimumQuality:3 MaxDispersion:10];
+    CandidateFilterChain *chain = [[CandidateFilterChain alloc] initWithFilters:@[ filter ]];
+
+    Candidate *good = [self candidateWithOffset:0 RTT:2 * kMillis Quality:3];
+    Candidate *expired = [self candidateWithOffset:0 RTT:2 * kMillis Quality:2];
+    Candidate *wide = [self candidateWithOffset:0 RTT:40 * kMillis Quality:4];
+
+    XCTAssertEqualObjects([self filter:@[ good, expired, wide ] With:chain], (@[ good ]));
+    XCTAssertEqual([filter getCandidateDropCount], 2);
+
+    XCTAssertTrue([filter checkCandidate:good]);
+    XCTAssertFalse([filter checkCandidate:expired]);
+}
+
+@end
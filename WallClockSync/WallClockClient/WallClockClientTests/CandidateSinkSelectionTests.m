@@ -0,0 +1,176 @@
+//
+//  CandidateSinkSelectionTests.m
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+#import <ClockTimelines/ClockTimelines.h>
+#import "WCSyncMessage.h"
+#import "Candidate.h"
+#import "CandidateSink.h"
+#import "IWCAlgo.h"
+
+
+/**
+ *  An algorithm that records the candidates it is given
+ */
+@interface RecordingAlgorithm : NSObject <IWCAlgo>
+
+@property (atomic, readonly) NSMutableArray<Candidate *> *candidates;
+
+@end
+
+@implementation RecordingAlgorithm
+
+- (id) init
+{
+    self = [super init];
+    if (self != nil) _candidates = [NSMutableArray array];
+    return self;
+}
+
+- (int64_t) processMeasurement:(Candidate*) candidate
+{
+    if (candidate != nil) {
+        // pooled candidates are recycled after this call: keep a copy
+        @synchronized (self) { [_candidates addObject:[candidate copy]]; }
+    }
+    return 0;
+}
+
+- (int64_t) getCurrentDispersion { return 0; }
+- (int64_t) getCandidateOffset { return 0; }
+- (Candidate*) getBestCandidate { return nil; }
+- (uint32_t) getNextReqWaitTime { return 1000000; }
+
+@end
+
+
+
+@interface CandidateSinkSelectionTests : XCTestCase
+
+@end
+
+@implementation CandidateSinkSelectionTests
+{
+    TunableClock        *wallclock;
+    RecordingAlgorithm  *algorithm;
+    CandidateSink       *sink;
+}
+
+- (void)setUp {
+    [super setUp];
+
+    SystemClock *sysclock = [[SystemClock alloc] initWithTickRate:_kOneThousandMillion];
+    wallclock = [[TunableClock alloc] initWithParentClock:sysclock TickRate:_kOneThousandMillion Ticks:0];
+    algorithm = [[RecordingAlgorithm alloc] init];
+    sink = [[CandidateSink alloc] initWith:wallclock Algorithm:algorithm AndFilters:nil];
+    [sink start];
+}
+
+- (void)tearDown {
+    [sink stop];
+    sink = nil;
+    [super tearDown];
+}
+
+
+/**
+ *  A candidate measured now, with a 2ms round trip (about 1ms dispersion), from a server whose
+ *  clock is offset_nanos ahead of the wallclock
+ */
+- (Candidate*) candidateWithOffset:(int64_t) offset_nanos Source:(uint32_t) source
+{
+    WCSyncMessagePkt pkt;
+    int64_t t4 = [wallclock nanoSeconds];
+    int64_t t1 = t4 - 2000000;
+
+    memset(&pkt, 0, sizeof(pkt));
+    pkt.message_type = WCMSG_RESP;
+    pkt.precision = (uint8_t) -20;
+    setCurrentTimeValueFromClock(&pkt.originate_timevalue, t1);
+    setCurrentTimeValueFromClock(&pkt.receive_timevalue, t1 + 1000000 + offset_nanos);
+    setCurrentTimeValueFromClock(&pkt.transmit_timevalue, t1 + 1000000 + offset_nanos);
+
+    Candidate *candidate = [[Candidate alloc] initWithPacket:&pkt ResponseTimeNanos:t4 Quality:3 TimeIsNanos:YES];
+    candidate.source = source;
+
+    return candidate;
+}
+
+
+- (NSArray<Candidate *> *) processedAfterEnqueuing:(NSArray<Candidate *> *) candidates
+{
+    for (Candidate *candidate in candidates) {
+        [sink enqueueCandidate:candidate];
+        usleep(20000);
+    }
+    @synchronized (algorithm) { return [algorithm.candidates copy]; }
+}
+
+
+- (void)testSingleServerPassesThrough {
+    NSArray *processed = [self processedAfterEnqueuing:@[ [self candidateWithOffset:0 Source:0],
+                                                          [self candidateWithOffset:500000000 Source:0] ]];
+
+    XCTAssertEqual(processed.count, 2);
+}
+
+
+- (void)testFalsetickerIsRejected {
+    Candidate *good0 = [self candidateWithOffset:100000 Source:0];
+    Candidate *good1 = [self candidateWithOffset:-200000 Source:1];
+    Candidate *bad = [self candidateWithOffset:1000000000 Source:2];
+    Candidate *good2 = [self candidateWithOffset:300000 Source:0];
+
+    NSArray *processed = [self processedAfterEnqueuing:@[ good0, good1, bad, good2 ]];
+
+    XCTAssertEqual(processed.count, 3);
+    XCTAssertFalse([[processed valueForKey:@"offset"] containsObject:@(bad.offset)]);
+    XCTAssertTrue([[processed valueForKey:@"offset"] containsObject:@(good2.offset)]);
+}
+
+
+- (void)testNoMajority {
+    Candidate *a = [self candidateWithOffset:0 Source:0];
+    Candidate *b = [self candidateWithOffset:1000000000 Source:1];
+
+    // two servers that disagree: neither can be told apart from the other
+    NSArray *processed = [self processedAfterEnqueuing:@[ a, b ]];
+
+    XCTAssertEqual(processed.count, 1);
+    XCTAssertEqual(processed.firstObject.offset, a.offset);
+}
+
+
+- (void)testPooledCandidatesAreRecycledOnceReleased {
+    WCSyncMessagePkt pkt;
+    int64_t t4 = [wallclock nanoSeconds];
+
+    memset(&pkt, 0, sizeof(pkt));
+    pkt.message_type = WCMSG_RESP;
+    pkt.precision = (uint8_t) -20;
+    setCurrentTimeValueFromClock(&pkt.originate_timevalue, t4 - 2000000);
+    setCurrentTimeValueFromClock(&pkt.receive_timevalue, t4 - 1000000);
+    setCurrentTimeValueFromClock(&pkt.transmit_timevalue, t4 - 1000000);
+
+    Candidate *first = [sink candidateWithPacket:&pkt ResponseTimeNanos:t4 Quality:3];
+    Candidate *second = [sink candidateWithPacket:&pkt ResponseTimeNanos:t4 + 1000 Quality:3];
+    XCTAssertTrue(first.recyclable);
+    XCTAssertNotEqual(first, second);
+
+    // the first stays out of the pool while it is the server's last candidate
+    [self processedAfterEnqueuing:@[ first ]];
+    XCTAssertNotEqual([sink candidateWithPacket:&pkt ResponseTimeNanos:t4 Quality:3], first);
+
+    // ... and is recycled once the second replaces it
+    NSArray *processed = [self processedAfterEnqueuing:@[ second ]];
+    XCTAssertEqual([sink candidateWithPacket:&pkt ResponseTimeNanos:t4 + 2000 Quality:3], first);
+    XCTAssertEqual([processed.firstObject responseTime], t4, @"the algorithm's copy is untouched");
+}
+
+@end
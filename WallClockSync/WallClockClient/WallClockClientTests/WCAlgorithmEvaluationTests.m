@@ -0,0 +1,320 @@
+//
+//  WCAlgorithmEvaluationTests.m
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+//
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+#import <objc/runtime.h>
+#import <ClockTimelines/ClockTimelines.h>
+#import <SyncKitConfiguration/SyncKitConfiguration.h>
+#import <SimpleLogger/SimpleLogger.h>
+#import "WCSyncMessage.h"
+#import "Candidate.h"
+#import "LowestDispersionAlgorithm.h"
+#import "LinearRegressionAlgorithm.h"
+
+
+/**
+ *  One recorded request-response exchange. t1 and t4 are times of the client's monotonic
+ *  clock, t2 and t3 are times of the WC server, all in nanoseconds.
+ */
+typedef struct {
+    int64_t     t1;
+    int64_t     t2;
+    int64_t     t3;
+    int64_t     t4;
+    int8_t      precision;      // log2 of the server precision in seconds
+    uint32_t    maxFreqError;   // server max frequency error in ppm
+} WCTraceRecord;
+
+
+/**
+ *  Results of replaying a trace through one algorithm
+ */
+typedef struct {
+    NSUInteger  requests;       // records used as candidates
+    NSUInteger  evaluated;      // records used to measure the wallclock error
+    int64_t     maxError;       // largest |wallclock - server| at a record midpoint
+    double      meanError;
+    int64_t     maxDispersion;  // largest dispersion reported by the algorithm
+} WCTraceResult;
+
+
+// trace records before this time are not used to measure the error (algorithm start-up)
+static const int64_t kWarmUpNanos = 10000000000;
+
+
+/**
+ *  Offline evaluation harness for Wall Clock algorithms.
+ *
+ *  Recorded candidate traces are replayed through LowestDispersionAlgorithm and
+ *  LinearRegressionAlgorithm against a mock monotonic time (the time method of the
+ *  MonotonicTime class is swizzled). Each algorithm only gets the records that it would have
+ *  requested, going by its getNextReqWaitTime; the error of its wallclock is measured at the
+ *  midpoint of every record.
+ *
+ *  A trace is a CSV file of "t1,t2,t3,t4,precision,maxFreqErrorPPM" lines, named by the
+ *  WC_CANDIDATE_TRACE environment variable. Without one, a simulated trace is replayed.
+ */
+@interface WCAlgorithmEvaluationTests : XCTestCase
+
+@end
+
+
+// mock monotonic time, in seconds
+static double __evalTimeNow;
+
+
+static void SetTimeValue(WCTimeValue *tv, int64_t nanos)
+{
+    tv->timevalue_secs = htonl((uint32_t) (nanos / 1000000000));
+    tv->timevalue_nanos = htonl((uint32_t) (nanos % 1000000000));
+}
+
+
+Float64 __evalMockTime(id self, SEL _cmd)
+{
+    return __evalTimeNow;
+}
+
+
+@implementation WCAlgorithmEvaluationTests
+{
+    SyncKitGlobals *config;
+}
+
+
+- (void)setUp {
+    [super setUp];
+    static dispatch_once_t onceToken;
+
+    dispatch_once(&onceToken, ^{
+
+        // swizzle time method in MonotonicTime class
+        Class montime_cls = [MonotonicTime class];
+        SEL originalTimeSelector = @selector(time);
+        IMP mockTimeMethodImp = (IMP) __evalMockTime;
+        char* method_types = "d@:";
+
+        class_replaceMethod(montime_cls, originalTimeSelector, mockTimeMethodImp, method_types);
+    });
+
+    config = [SyncKitGlobals getInstance];
+    if (config.SyncAccuracyTargetMilliSecs == 0) config.SyncAccuracyTargetMilliSecs = 10;
+    if (config.ClientWCFrequencyError == 0) config.ClientWCFrequencyError = 500;
+}
+
+- (void)tearDown {
+    [super tearDown];
+}
+
+
+- (void) testCompareAlgorithmsOnSimulatedTrace
+{
+    // 10 minutes of requests every 100ms to a server running 40ppm fast, 2-10ms one-way delays
+    NSData *trace = [self simulatedTraceWithDuration:600 IntervalMillis:100 SkewPPM:40 Seed:42];
+
+    WCTraceResult ld = [self replayTrace:trace UsingLinearRegression:NO];
+    WCTraceResult lr = [self replayTrace:trace UsingLinearRegression:YES];
+
+    [self logResult:ld Name:@"LowestDispersionAlgorithm"];
+    [self logResult:lr Name:@"LinearRegressionAlgorithm"];
+
+    int64_t target = ((int64_t) config.SyncAccuracyTargetMilliSecs) * 1000000;
+
+    // requests at a fixed 120ms period, for comparison
+    NSUInteger fixedRateRequests = 600000 / 120;
+
+    XCTAssertGreaterThan(ld.evaluated, 0);
+    XCTAssertGreaterThan(lr.evaluated, 0);
+    XCTAssertLessThanOrEqual(ld.maxError, target, @"wallclock error within accuracy target");
+    XCTAssertLessThanOrEqual(lr.maxError, target, @"wallclock error within accuracy target");
+    XCTAssertLessThanOrEqual(lr.maxDispersion, target, @"dispersion within accuracy target");
+    XCTAssertLessThan(ld.requests * 4, fixedRateRequests, @"far fewer WC requests");
+    XCTAssertLessThan(lr.requests * 4, fixedRateRequests, @"far fewer WC requests");
+}
+
+
+- (void) testCompareAlgorithmsOnRecordedTrace
+{
+    NSString *path = [[[NSProcessInfo processInfo] environment] objectForKey:@"WC_CANDIDATE_TRACE"];
+
+    if (path == nil) return;
+
+    NSData *trace = [self loadTrace:path];
+    XCTAssertNotNil(trace, @"trace file %@ could not be read", path);
+    if (trace == nil) return;
+
+    [self logResult:[self replayTrace:trace UsingLinearRegression:NO] Name:@"LowestDispersionAlgorithm"];
+    [self logResult:[self replayTrace:trace UsingLinearRegression:YES] Name:@"LinearRegressionAlgorithm"];
+}
+
+
+
+#pragma mark harness
+
+- (WCTraceResult) replayTrace:(NSData*) trace UsingLinearRegression:(BOOL) useLR
+{
+    const WCTraceRecord *records = trace.bytes;
+    NSUInteger count = trace.length / sizeof(WCTraceRecord);
+    WCTraceResult result = {0, 0, 0, 0.0, 0};
+    double sumError = 0;
+
+    if (count == 0) return result;
+
+    __evalTimeNow = records[0].t1 * 1.0e-9;
+
+    SystemClock *sysCLK = [[SystemClock alloc] initWithTickRate:_kOneThousandMillion];
+    TunableClock *wallclock = [[TunableClock alloc] initWithParentClock:sysCLK TickRate:_kOneThousandMillion Ticks:0];
+    id<IWCAlgo> algorithm;
+
+    if (useLR)
+        algorithm = [[LinearRegressionAlgorithm alloc] initWithWallClock:wallclock];
+    else
+        algorithm = [[LowestDispersionAlgorithm alloc] initWithWallClock:wallclock];
+
+    int64_t nextSend = records[0].t1;
+
+    for (NSUInteger i = 0; i < count; i++) {
+        const WCTraceRecord *r = &records[i];
+
+        // error of the wallclock at the record midpoint, against the server's time there
+        if ((result.requests > 0) && (r->t1 - records[0].t1 >= kWarmUpNanos)) {
+            __evalTimeNow = (r->t1 + (r->t4 - r->t1) / 2) * 1.0e-9;
+
+            int64_t error = llabs([wallclock nanoSeconds] - (r->t2 + (r->t3 - r->t2) / 2));
+
+            result.maxError = MAX(result.maxError, error);
+            result.maxDispersion = MAX(result.maxDispersion, [algorithm getCurrentDispersion]);
+            sumError += error;
+            result.evaluated++;
+        }
+
+        // only the records the algorithm would have asked for are measurements
+        if (r->t1 < nextSend) continue;
+
+        Candidate *candidate = [self candidateForRecord:r Clock:wallclock];
+
+        [algorithm processMeasurement:candidate];
+        result.requests++;
+
+        nextSend = r->t4 + ((int64_t) [algorithm getNextReqWaitTime]) * 1000;
+    }
+
+    result.meanError = (result.evaluated > 0) ? sumError / result.evaluated : 0;
+
+    return result;
+}
+
+
+/**
+ *  Candidate for a recorded exchange, with client timestamps read from the wallclock as the
+ *  WCProtocolClient would: the wallclock is only adjusted after the response.
+ */
+- (Candidate*) candidateForRecord:(const WCTraceRecord*) r Clock:(ClockBase*) wallclock
+{
+    WCSyncMessagePkt pkt;
+
+    memset(&pkt, 0, sizeof(pkt));
+    pkt.version = 0;
+    pkt.message_type = WCMSG_RESP;
+    pkt.precision = (uint8_t) r->precision;
+    pkt.max_freq_error = htonl(r->maxFreqError * 256);
+
+    __evalTimeNow = r->t1 * 1.0e-9;
+    SetTimeValue(&pkt.originate_timevalue, [wallclock nanoSeconds]);
+    SetTimeValue(&pkt.receive_timevalue, r->t2);
+    SetTimeValue(&pkt.transmit_timevalue, r->t3);
+
+    __evalTimeNow = r->t4 * 1.0e-9;
+
+    WCSyncMessage *msg = [[WCSyncMessage alloc] initWithPacket:&pkt AndResponseTimeNanos:[wallclock nanoSeconds]];
+
+    return [[Candidate alloc] initWithResponseMsg:msg Quality:0 TimeIsNanos:YES];
+}
+
+
+/**
+ *  Simulated exchanges with a server whose clock runs skew_ppm fast, with independent
+ *  random one-way delays. Deterministic for a given seed.
+ */
+- (NSData*) simulatedTraceWithDuration:(NSUInteger) seconds
+                        IntervalMillis:(NSUInteger) interval
+                               SkewPPM:(double) skew_ppm
+                                  Seed:(unsigned short) seed
+{
+    NSUInteger count = seconds * 1000 / interval;
+    NSMutableData *trace = [NSMutableData dataWithLength:count * sizeof(WCTraceRecord)];
+    WCTraceRecord *records = trace.mutableBytes;
+    unsigned short xsubi[3] = {seed, seed, seed};
+
+    const int64_t start = 1000000000000;        // client monotonic time at the first request
+    const int64_t serverOffset = 3600000000000; // server time at client time zero
+
+    for (NSUInteger i = 0; i < count; i++) {
+        WCTraceRecord *r = &records[i];
+        int64_t upDelay = 2000000 + (int64_t) (erand48(xsubi) * 8000000);
+        int64_t downDelay = 2000000 + (int64_t) (erand48(xsubi) * 8000000);
+
+        r->t1 = start + (int64_t) i * interval * 1000000;
+        r->t2 = serverOffset + (int64_t) ((r->t1 + upDelay) * (1.0 + skew_ppm * 1.0e-6));
+        r->t3 = r->t2 + 50000;
+        r->t4 = r->t1 + upDelay + 50000 + downDelay;
+        r->precision = -20;
+        r->maxFreqError = 50;
+    }
+
+    return trace;
+}
+
+
+- (NSData*) loadTrace:(NSString*) path
+{
+    NSString *contents = [NSString stringWithContentsOfFile:path encoding:NSUTF8StringEncoding error:nil];
+
+    if (contents == nil) return nil;
+
+    NSMutableData *trace = [NSMutableData data];
+
+    for (NSString *line in [contents componentsSeparatedByCharactersInSet:[NSCharacterSet newlineCharacterSet]]) {
+        WCTraceRecord r;
+        int precision;
+
+        if (sscanf([line UTF8String], "%lld,%lld,%lld,%lld,%d,%u",
+                   &r.t1, &r.t2, &r.t3, &r.t4, &precision, &r.maxFreqError) != 6)
+            continue;
+
+        r.precision = (int8_t) precision;
+        [trace appendBytes:&r length:sizeof(r)];
+    }
+
+    return trace;
+}
+
+
+- (void) logResult:(WCTraceResult) result Name:(NSString*) name
+{
+    MWLogInfo(@"%@: requests=%lu max error=%.3f ms mean error=%.3f ms max dispersion=%.3f ms",
+              name, (unsigned long) result.requests, result.maxError / 1.0e6,
+              result.meanError / 1.0e6, result.maxDispersion / 1.0e6);
+}
+
+
+@end
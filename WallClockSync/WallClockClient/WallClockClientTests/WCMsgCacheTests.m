@@ -0,0 +1,153 @@
+//
+//  WCMsgCacheTests.m
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+#import "WCSyncMessage.h"
+#import "WCMsgCache.h"
+
+@interface WCMsgCacheTests : XCTestCase
+
+@end
+
+@implementation WCMsgCacheTests
+{
+    WCMsgCache *cache;
+}
+
+- (void)setUp {
+    [super setUp];
+    cache = [[WCMsgCache alloc] initWithCapacity:16];
+}
+
+- (void)tearDown {
+    cache = nil;
+    [super tearDown];
+}
+
+
+- (WCSyncMessagePkt) packetWithType:(uint8_t) msg_type OriginateTime:(int64_t) originate_time
+{
+    WCSyncMessagePkt pkt;
+
+    memset(&pkt, 0, sizeof(pkt));
+    pkt.message_type = msg_type;
+    setCurrentTimeValueFromClock(&pkt.originate_timevalue, originate_time);
+
+    return pkt;
+}
+
+
+- (void)testLookUpRemovesMatchingMessage {
+    WCSyncMessagePkt req = [self packetWithType:WCMSG_REQ OriginateTime:1000000000123];
+    WCSyncMessagePkt resp = [self packetWithType:WCMSG_RESP_WITH_FOLLOWUP OriginateTime:1000000000123];
+
+    [cache insertPacket:&req ResponseTimeNanos:0 ExpiryTime:1002000000000 Source:0];
+    [cache insertPacket:&resp ResponseTimeNanos:1000010000000 ExpiryTime:1001000000000 Source:0];
+    XCTAssertEqual(cache.count, 2);
+
+    // same originate time, different message types
+    XCTAssertTrue([cache removeMessageWithOriginateTime:1000000000123 Type:WCMSG_REQ Source:0 AtTime:1000010000000]);
+    XCTAssertFalse([cache removeMessageWithOriginateTime:1000000000123 Type:WCMSG_REQ Source:0 AtTime:1000010000000]);
+    XCTAssertFalse([cache removeMessageWithOriginateTime:1000000000124 Type:WCMSG_RESP_WITH_FOLLOWUP Source:0 AtTime:1000010000000]);
+    XCTAssertEqual(cache.count, 1);
+
+    // an expired message is removed, but is not a match
+    XCTAssertFalse([cache removeMessageWithOriginateTime:1000000000123 Type:WCMSG_RESP_WITH_FOLLOWUP Source:0 AtTime:1001000000001]);
+    XCTAssertEqual(cache.count, 0);
+}
+
+
+- (void)testSourcesAreSeparate {
+    WCSyncMessagePkt req = [self packetWithType:WCMSG_REQ OriginateTime:3000000000000];
+    uint32_t source;
+
+    // one request, sent to three servers at once
+    for (source = 0; source < 3; source++)
+        [cache insertPacket:&req ResponseTimeNanos:0 ExpiryTime:3002000000000 Source:source];
+    XCTAssertEqual(cache.count, 3);
+
+    XCTAssertTrue([cache removeMessageWithOriginateTime:3000000000000 Type:WCMSG_REQ Source:1 AtTime:3000010000000]);
+    XCTAssertFalse([cache removeMessageWithOriginateTime:3000000000000 Type:WCMSG_REQ Source:1 AtTime:3000010000000]);
+    XCTAssertFalse([cache removeMessageWithOriginateTime:3000000000000 Type:WCMSG_REQ Source:3 AtTime:3000010000000]);
+    XCTAssertEqual(cache.count, 2);
+
+    __block uint32_t expired_sources = 0;
+    XCTAssertEqual([cache expireMessagesAtTime:3000010000000 Handler:nil], 0);
+    [cache expireMessagesAtTime:3003000000000 Handler:^(const WCSyncMessagePkt *packet, int64_t response_time, uint32_t expired_source) {
+        expired_sources |= 1 << expired_source;
+    }];
+    XCTAssertEqual(expired_sources, 0x5);
+}
+
+
+- (void)testExpiry {
+    __block NSUInteger followups = 0;
+    int64_t t = 5000000000000;
+    int i;
+
+    for (i = 0; i < 10; i++) {
+        WCSyncMessagePkt req = [self packetWithType:WCMSG_REQ OriginateTime:t + i * 100000000];
+        [cache insertPacket:&req ResponseTimeNanos:0 ExpiryTime:t + i * 100000000 + 2000000000 Source:0];
+    }
+    WCSyncMessagePkt resp = [self packetWithType:WCMSG_RESP_WITH_FOLLOWUP OriginateTime:t];
+    [cache insertPacket:&resp ResponseTimeNanos:t + 5000000 ExpiryTime:t + 1000000000 Source:0];
+
+    WCMsgExpiryHandler handler = ^(const WCSyncMessagePkt *packet, int64_t response_time, uint32_t source) {
+        if (packet->message_type == WCMSG_RESP_WITH_FOLLOWUP) {
+            XCTAssertEqual(response_time, t + 5000000);
+            followups++;
+        }
+    };
+
+    XCTAssertEqual([cache expireMessagesAtTime:t + 500000000 Handler:handler], 0);
+    XCTAssertEqual([cache expireMessagesAtTime:t + 1100000000 Handler:handler], 1);
+    XCTAssertEqual(followups, 1);
+
+    // requests expire 2s after their originate time, 100ms apart
+    XCTAssertEqual([cache expireMessagesAtTime:t + 2250000000 Handler:handler], 3);
+    XCTAssertEqual([cache expireMessagesAtTime:t + 60000000000 Handler:handler], 7);
+    XCTAssertEqual(cache.count, 0);
+}
+
+
+- (void)testFullCacheDropsEarliestExpiry {
+    int64_t t = 7000000000000;
+    int i;
+
+    for (i = 0; i < 20; i++) {
+        WCSyncMessagePkt req = [self packetWithType:WCMSG_REQ OriginateTime:t + i];
+        [cache insertPacket:&req ResponseTimeNanos:0 ExpiryTime:t + i + 2000000000 Source:0];
+    }
+    XCTAssertEqual(cache.count, cache.capacity);
+
+    // the four earliest to expire were dropped; all others can still be found
+    for (i = 0; i < 20; i++) {
+        BOOL found = [cache removeMessageWithOriginateTime:t + i Type:WCMSG_REQ Source:0 AtTime:t + 20];
+        XCTAssertEqual(found, i >= 4);
+    }
+    XCTAssertEqual(cache.count, 0);
+}
+
+
+- (void)testPerformanceInsertLookUp {
+    __block int64_t t = 9000000000000;
+
+    [self measureBlock:^{
+        int i;
+        for (i = 0; i < 100000; i++) {
+            WCSyncMessagePkt req = [self packetWithType:WCMSG_REQ OriginateTime:t];
+            [cache insertPacket:&req ResponseTimeNanos:0 ExpiryTime:t + 2000000000 Source:0];
+            [cache removeMessageWithOriginateTime:t Type:WCMSG_REQ Source:0 AtTime:t + 10000000];
+            [cache expireMessagesAtTime:t Handler:nil];
+            t += 1000000;
+        }
+    }];
+}
+
+@end
@@ -0,0 +1,237 @@
+//
+//  WCProtocolServerTests.m
+//  WallClockClient
+//
+//  Created by Rajiv Ramdhany on 17/10/2016.
+//  Copyright (c) 2016 BBC RD. All rights reserved.
+//
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+#import <ClockTimelines/ClockTimelines.h>
+#import "WCSyncMessage.h"
+#import "WCProtocolServer.h"
+#import <sys/socket.h>
+#import <netinet/in.h>
+#import <arpa/inet.h>
+#import <unistd.h>
+#import <pthread.h>
+
+static const NSUInteger kServerTestPort     = 17780;
+
+// load generator: client threads, requests in flight per client, and test duration
+static const NSUInteger kLoadClients        = 4;
+static const NSUInteger kLoadWindow         = 16;
+static const int64_t    kLoadDurationNanos  = 3000000000LL;
+static const NSUInteger kMaxSamples         = 200000;
+
+
+static int64_t TimeValueNanos(const WCTimeValue *tv)
+{
+    return ((int64_t) ntohl(tv->timevalue_secs)) * 1000000000 + (int64_t) ntohl(tv->timevalue_nanos);
+}
+
+static int CompareInt64(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *) a, y = *(const int64_t *) b;
+
+    return (x > y) - (x < y);
+}
+
+
+@interface WCProtocolServerTests : XCTestCase
+
+@end
+
+@implementation WCProtocolServerTests
+{
+    SystemClock         *clock;
+    WCProtocolServer    *server;
+
+    // receive_time - originate_time and arrival_time - transmit_time of each response: the
+    // request's and response's trips through the network stacks, which bound the error of the
+    // server's receive and transmit timestamps
+    int64_t             *receiveDelays;
+    int64_t             *transmitDelays;
+    NSUInteger          samples;
+    pthread_mutex_t     samplesMutex;
+}
+
+- (void)setUp {
+    [super setUp];
+
+    clock = [[SystemClock alloc] initWithTickRate:_kOneThousandMillion];
+    server = [[WCProtocolServer alloc] initWithPort:kServerTestPort WallClock:clock];
+
+    receiveDelays = calloc(kMaxSamples, sizeof(int64_t));
+    transmitDelays = calloc(kMaxSamples, sizeof(int64_t));
+    samples = 0;
+    pthread_mutex_init(&samplesMutex, NULL);
+}
+
+- (void)tearDown {
+    [server stop];
+    server = nil;
+    free(receiveDelays);
+    free(transmitDelays);
+    pthread_mutex_destroy(&samplesMutex);
+    [super tearDown];
+}
+
+
+- (int) clientSocket
+{
+    struct sockaddr_in addr;
+    struct timeval timeout = { 0, 100000 };
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_len = sizeof(addr);
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(kServerTestPort);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    XCTAssertEqual(connect(sock, (const struct sockaddr *) &addr, sizeof(addr)), 0);
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    return sock;
+}
+
+
+- (void) sendRequest:(int) sock
+{
+    WCSyncMessagePkt req;
+
+    memset(&req, 0, sizeof(req));
+    req.message_type = WCMSG_REQ;
+    setCurrentTimeValueFromClock(&req.originate_timevalue, [clock nanoSeconds]);
+    send(sock, &req, sizeof(req), 0);
+}
+
+
+- (void)testResponse {
+    WCSyncMessagePkt resp;
+    int sock;
+
+    XCTAssertTrue([server start]);
+    sock = [self clientSocket];
+
+    [self sendRequest:sock];
+    XCTAssertEqual(recv(sock, &resp, sizeof(resp), 0), (ssize_t) sizeof(resp));
+    int64_t arrival = [clock nanoSeconds];
+
+    XCTAssertEqual(resp.message_type, WCMSG_RESP);
+    XCTAssertEqual((int8_t) resp.precision, server.precision);
+    XCTAssertEqual(ntohl(resp.max_freq_error), server.maxFreqError);
+
+    int64_t originate = TimeValueNanos(&resp.originate_timevalue);
+    int64_t receive = TimeValueNanos(&resp.receive_timevalue);
+    int64_t transmit = TimeValueNanos(&resp.transmit_timevalue);
+
+    XCTAssertLessThanOrEqual(originate, receive);
+    XCTAssertLessThanOrEqual(receive, transmit);
+    XCTAssertLessThanOrEqual(transmit, arrival);
+    XCTAssertEqual(server.requestsServed, 1);
+
+    // not a request
+    resp.message_type = WCMSG_RESP;
+    send(sock, &resp, sizeof(resp), 0);
+    XCTAssertLessThan(recv(sock, &resp, sizeof(resp), 0), 0);
+    XCTAssertEqual(server.requestsDropped, 1);
+
+    close(sock);
+}
+
+
+- (void)testFollowUp {
+    WCSyncMessagePkt resp, followup;
+    int sock;
+
+    server.followUp = YES;
+    XCTAssertTrue([server start]);
+    sock = [self clientSocket];
+
+    [self sendRequest:sock];
+    XCTAssertEqual(recv(sock, &resp, sizeof(resp), 0), (ssize_t) sizeof(resp));
+    XCTAssertEqual(recv(sock, &followup, sizeof(followup), 0), (ssize_t) sizeof(followup));
+
+    XCTAssertEqual(resp.message_type, WCMSG_RESP_WITH_FOLLOWUP);
+    XCTAssertEqual(followup.message_type, WCMSG_FOLLOWUP);
+    XCTAssertEqual(TimeValueNanos(&followup.originate_timevalue), TimeValueNanos(&resp.originate_timevalue));
+    XCTAssertEqual(TimeValueNanos(&followup.receive_timevalue), TimeValueNanos(&resp.receive_timevalue));
+
+    // the follow-up's transmit time is taken once the response has been sent
+    XCTAssertGreaterThanOrEqual(TimeValueNanos(&followup.transmit_timevalue), TimeValueNanos(&resp.transmit_timevalue));
+
+    close(sock);
+}
+
+
+/**
+ *  Load generator: each client thread keeps kLoadWindow requests in flight, sending a new request
+ *  for each response (or after a receive timeout, for a lost one).
+ */
+- (NSUInteger) runLoadClient
+{
+    int sock = [self clientSocket];
+    int64_t end = [clock nanoSeconds] + kLoadDurationNanos;
+    NSUInteger i, responses = 0;
+    WCSyncMessagePkt resp;
+
+    for (i = 0; i < kLoadWindow; i++) [self sendRequest:sock];
+
+    while ([clock nanoSeconds] < end)
+    {
+        if (recv(sock, &resp, sizeof(resp), 0) == (ssize_t) sizeof(resp))
+        {
+            int64_t arrival = [clock nanoSeconds];
+
+            pthread_mutex_lock(&samplesMutex);
+            if (samples < kMaxSamples) {
+                receiveDelays[samples] = TimeValueNanos(&resp.receive_timevalue) - TimeValueNanos(&resp.originate_timevalue);
+                transmitDelays[samples++] = arrival - TimeValueNanos(&resp.transmit_timevalue);
+            }
+            pthread_mutex_unlock(&samplesMutex);
+            responses++;
+        }
+        [self sendRequest:sock];
+    }
+    close(sock);
+
+    return responses;
+}
+
+
+- (void)testSustainedLoad {
+    dispatch_group_t group = dispatch_group_create();
+    __block NSUInteger total = 0;
+    NSUInteger i;
+
+    XCTAssertTrue([server start]);
+
+    for (i = 0; i < kLoadClients; i++) {
+        dispatch_group_async(group, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+            NSUInteger n = [self runLoadClient];
+            @synchronized (self) { total += n; }
+        });
+    }
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+
+    XCTAssertGreaterThan(total, 0);
+    XCTAssertGreaterThan(samples, 0);
+    if (samples == 0) return;
+
+    qsort(receiveDelays, samples, sizeof(int64_t), CompareInt64);
+    qsort(transmitDelays, samples, sizeof(int64_t), CompareInt64);
+
+    NSLog(@"WCProtocolServer: %lu clients, %.0f requests/s, %llu dropped", (unsigned long) kLoadClients,
+          total * 1e9 / kLoadDurationNanos, server.requestsDropped);
+    NSLog(@"originate to receive timestamp: p50 %lld us, p99 %lld us", receiveDelays[samples / 2] / 1000, receiveDelays[samples * 99 / 100] / 1000);
+    NSLog(@"transmit timestamp to arrival:  p50 %lld us, p99 %lld us", transmitDelays[samples / 2] / 1000, transmitDelays[samples * 99 / 100] / 1000);
+
+    // timestamps are causally ordered with the client's
+    XCTAssertGreaterThanOrEqual(receiveDelays[samples / 2], 0);
+    XCTAssertGreaterThanOrEqual(transmitDelays[samples / 2], 0);
+}
+
+@end